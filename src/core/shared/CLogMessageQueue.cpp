@@ -0,0 +1,97 @@
+#include <cstdint>
+#include <utility>
+
+#include "CLogMessageQueue.h"
+
+CLogMessageQueue::CLogMessageQueue()
+	: m_uiEnqueuePos( 0 )
+	, m_uiDequeuePos( 0 )
+	, m_uiDropped( 0 )
+{
+	for( size_t uiIndex = 0; uiIndex < QUEUE_SIZE; ++uiIndex )
+	{
+		m_Slots[ uiIndex ].sequence.store( uiIndex, std::memory_order_relaxed );
+	}
+}
+
+bool CLogMessageQueue::Push( const LogType type, std::string& szMessage )
+{
+	size_t uiPos = m_uiEnqueuePos.load( std::memory_order_relaxed );
+
+	Slot_t* pSlot;
+
+	for( ;; )
+	{
+		pSlot = &m_Slots[ uiPos & ( QUEUE_SIZE - 1 ) ];
+
+		const size_t uiSequence = pSlot->sequence.load( std::memory_order_acquire );
+
+		const intptr_t iDiff = static_cast<intptr_t>( uiSequence ) - static_cast<intptr_t>( uiPos );
+
+		if( iDiff == 0 )
+		{
+			//Slot is free, try to claim it.
+			if( m_uiEnqueuePos.compare_exchange_weak( uiPos, uiPos + 1, std::memory_order_relaxed ) )
+				break;
+		}
+		else if( iDiff < 0 )
+		{
+			//Consumer hasn't caught up yet; queue is full.
+			return false;
+		}
+		else
+		{
+			//Another producer claimed this slot.
+			uiPos = m_uiEnqueuePos.load( std::memory_order_relaxed );
+		}
+	}
+
+	pSlot->message.type = type;
+	pSlot->message.szMessage.swap( szMessage );
+
+	pSlot->sequence.store( uiPos + 1, std::memory_order_release );
+
+	return true;
+}
+
+bool CLogMessageQueue::Pop( LogQueueMessage_t& message )
+{
+	size_t uiPos = m_uiDequeuePos.load( std::memory_order_relaxed );
+
+	Slot_t* pSlot;
+
+	for( ;; )
+	{
+		pSlot = &m_Slots[ uiPos & ( QUEUE_SIZE - 1 ) ];
+
+		const size_t uiSequence = pSlot->sequence.load( std::memory_order_acquire );
+
+		const intptr_t iDiff = static_cast<intptr_t>( uiSequence ) - static_cast<intptr_t>( uiPos + 1 );
+
+		if( iDiff == 0 )
+		{
+			if( m_uiDequeuePos.compare_exchange_weak( uiPos, uiPos + 1, std::memory_order_relaxed ) )
+				break;
+		}
+		else if( iDiff < 0 )
+		{
+			//Empty.
+			return false;
+		}
+		else
+		{
+			uiPos = m_uiDequeuePos.load( std::memory_order_relaxed );
+		}
+	}
+
+	message.type = pSlot->message.type;
+	message.szMessage = std::move( pSlot->message.szMessage );
+
+	//Don't let the slot hold on to large messages.
+	pSlot->message.szMessage.clear();
+	pSlot->message.szMessage.shrink_to_fit();
+
+	pSlot->sequence.store( uiPos + QUEUE_SIZE, std::memory_order_release );
+
+	return true;
+}
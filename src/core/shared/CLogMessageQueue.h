@@ -0,0 +1,89 @@
+#ifndef COMMON_CLOGMESSAGEQUEUE_H
+#define COMMON_CLOGMESSAGEQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+#include "Logging.h"
+
+/**
+*	A queued log message.
+*/
+struct LogQueueMessage_t
+{
+	LogType type = LogType::MESSAGE;
+	std::string szMessage;
+};
+
+/**
+*	Bounded multi-producer, multi-consumer ring buffer of log messages.
+*	Producers and consumers only synchronize through per-slot sequence numbers, so no locks are taken.
+*	The message text is moved in and out of the slots; formatting and allocation happens outside of the queue.
+*/
+class HLCORE_API CLogMessageQueue final
+{
+public:
+	/**
+	*	Number of slots in the queue. Must be a power of 2.
+	*/
+	static const size_t QUEUE_SIZE = 4096;
+
+	CLogMessageQueue();
+	~CLogMessageQueue() = default;
+
+	/**
+	*	Attempts to add a message to the queue.
+	*	@param type Message type.
+	*	@param szMessage Message to add. Moved into the queue on success, left untouched otherwise.
+	*	@return Whether the message was added. False if the queue is full.
+	*/
+	bool Push( const LogType type, std::string& szMessage );
+
+	/**
+	*	Attempts to remove the oldest message from the queue.
+	*	@param message Receives the message.
+	*	@return Whether a message was removed. False if the queue is empty.
+	*/
+	bool Pop( LogQueueMessage_t& message );
+
+	/**
+	*	Gets the number of messages that were dropped because the queue was full, and resets the counter.
+	*/
+	size_t TakeDroppedCount() { return m_uiDropped.exchange( 0, std::memory_order_relaxed ); }
+
+	/**
+	*	Records that a message was dropped.
+	*/
+	void MessageDropped() { m_uiDropped.fetch_add( 1, std::memory_order_relaxed ); }
+
+private:
+	struct Slot_t
+	{
+		std::atomic<size_t> sequence;
+		LogQueueMessage_t message;
+	};
+
+	static_assert( ( QUEUE_SIZE & ( QUEUE_SIZE - 1 ) ) == 0, "CLogMessageQueue::QUEUE_SIZE must be a power of 2" );
+
+	static const size_t CACHE_LINE_SIZE = 64;
+
+	Slot_t m_Slots[ QUEUE_SIZE ];
+
+	//The positions are kept on separate cache lines so producers and consumers don't contend.
+	//Padding is used instead of alignas because operator new doesn't guarantee over-aligned allocations before C++17.
+	char m_EnqueuePadding[ CACHE_LINE_SIZE ];
+	std::atomic<size_t> m_uiEnqueuePos;
+
+	char m_DequeuePadding[ CACHE_LINE_SIZE - sizeof( std::atomic<size_t> ) ];
+	std::atomic<size_t> m_uiDequeuePos;
+
+	char m_DroppedPadding[ CACHE_LINE_SIZE - sizeof( std::atomic<size_t> ) ];
+	std::atomic<size_t> m_uiDropped;
+
+private:
+	CLogMessageQueue( const CLogMessageQueue& ) = delete;
+	CLogMessageQueue& operator=( const CLogMessageQueue& ) = delete;
+};
+
+#endif //COMMON_CLOGMESSAGEQUEUE_H
@@ -1,10 +1,13 @@
 #include <cassert>
 #include <chrono>
+#include <string>
 
 #include "utility/StringUtils.h"
 
 #include "cvar/CCVar.h"
 
+#include "CLogMessageQueue.h"
+
 #include "Logging.h"
 
 static cvar::CCVar developer( "developer", cvar::CCVarArgsBuilder().HelpInfo( "Developer level for logging" ).FloatValue( 0 ) );
@@ -59,6 +62,9 @@ static CStdOutLogListener g_StdOutListener;
 static ILogListener* m_pDefaultLogListener = &g_NullLogListener;
 
 static CLogging g_Logging;
+
+//Don't trigger recursive logging. Tracked per thread so threads don't block each other's messages.
+static thread_local bool g_bInLog = false;
 }
 
 ILogListener* GetNullLogListener()
@@ -89,12 +95,16 @@ CLogging& logging()
 }
 
 CLogging::CLogging()
+	: m_pQueue( new CLogMessageQueue() )
+	, m_DispatchThreadId( std::this_thread::get_id() )
 {
 }
 
 CLogging::~CLogging()
 {
 	CloseLogFile();
+
+	delete m_pQueue;
 }
 
 void CLogging::SetLogListener( ILogListener* pListener )
@@ -144,13 +154,13 @@ void CLogging::VLog( const LogType type, const DevLevel::DevLevel devLevel, cons
 {
 	assert( pszFormat != nullptr && *pszFormat );
 
-	if( m_bInLog )
+	if( g_bInLog )
 		return;
 
 	if( developer.GetInt() < devLevel )
 		return;
 
-	m_bInLog = true;
+	g_bInLog = true;
 
 	char szBuffer[ 8192 ];
 
@@ -169,9 +179,107 @@ void CLogging::VLog( const LogType type, const DevLevel::DevLevel devLevel, cons
 		fprintf( m_pLogFile, "%s", szBuffer );
 	}
 
-	GetLogListener()->LogMessage( type, szBuffer );
+	QueueMessage( type, szBuffer );
+
+	g_bInLog = false;
+}
+
+void CLogging::SetQueuedDeliveryEnabled( const bool bEnabled )
+{
+	m_bQueuedDelivery = bEnabled;
+
+	if( !m_bQueuedDelivery )
+		DispatchQueuedMessages();
+}
+
+void CLogging::DispatchQueuedMessages()
+{
+	if( !IsDispatchThread() || m_bDispatching )
+		return;
+
+	m_bDispatching = true;
+
+	const bool bWasInLog = g_bInLog;
+
+	g_bInLog = true;
+
+	ILogListener* pListener = GetLogListener();
+
+	bool bInBatch = false;
+
+	LogQueueMessage_t message;
+
+	//Limit the batch size so producers can't keep this going forever.
+	for( size_t uiCount = 0; uiCount < CLogMessageQueue::QUEUE_SIZE && m_pQueue->Pop( message ); ++uiCount )
+	{
+		if( !bInBatch )
+		{
+			pListener->BeginLogBatch();
+			bInBatch = true;
+		}
+
+		pListener->LogMessage( message.type, message.szMessage.c_str() );
+	}
+
+	const size_t uiDropped = m_pQueue->TakeDroppedCount();
+
+	if( uiDropped > 0 )
+	{
+		if( !bInBatch )
+		{
+			pListener->BeginLogBatch();
+			bInBatch = true;
+		}
+
+		char szBuffer[ 128 ];
+
+		snprintf( szBuffer, sizeof( szBuffer ), "%u log messages were dropped because the log queue was full\n", static_cast<unsigned int>( uiDropped ) );
+
+		pListener->LogMessage( LogType::WARNING, szBuffer );
+	}
+
+	if( bInBatch )
+		pListener->EndLogBatch();
+
+	g_bInLog = bWasInLog;
+
+	m_bDispatching = false;
+}
+
+void CLogging::QueueMessage( const LogType type, const char* const pszMessage )
+{
+	const bool bIsDispatchThread = IsDispatchThread();
+
+	//Fatal errors are delivered immediately since the program may be about to terminate.
+	if( bIsDispatchThread && ( !m_bQueuedDelivery || type == LogType::FATAL_ERROR ) )
+	{
+		//Deliver anything other threads queued first so messages stay in order.
+		DispatchQueuedMessages();
 
-	m_bInLog = false;
+		GetLogListener()->LogMessage( type, pszMessage );
+		return;
+	}
+
+	std::string szMessage( pszMessage );
+
+	if( m_pQueue->Push( type, szMessage ) )
+		return;
+
+	//Queue is full. The dispatch thread can make room, other threads have to drop the message.
+	if( bIsDispatchThread )
+	{
+		DispatchQueuedMessages();
+
+		if( m_pQueue->Push( type, szMessage ) )
+			return;
+	}
+
+	m_pQueue->MessageDropped();
+}
+
+bool CLogging::IsDispatchThread() const
+{
+	return std::this_thread::get_id() == m_DispatchThreadId;
 }
 
 bool CLogging::OpenLogFile( const char* const pszFilename, const bool bAppend )
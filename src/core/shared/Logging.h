@@ -3,6 +3,7 @@
 
 #include <cstdarg>
 #include <cstdio>
+#include <thread>
 
 #include "core/LibHLCore.h"
 
@@ -58,6 +59,17 @@ public:
 	*	Log a message of the given type, containing the given message.
 	*/
 	virtual void LogMessage( const LogType type, const char* const pszMessage ) = 0;
+
+	/**
+	*	Called before a batch of queued messages is delivered.
+	*	Listeners can use this to defer expensive updates until EndLogBatch.
+	*/
+	virtual void BeginLogBatch() {}
+
+	/**
+	*	Called after a batch of queued messages has been delivered.
+	*/
+	virtual void EndLogBatch() {}
 };
 
 inline ILogListener::~ILogListener()
@@ -85,8 +97,12 @@ extern "C" HLCORE_API ILogListener* GetDefaultLogListener();
 */
 extern "C" HLCORE_API void SetDefaultLogListener( ILogListener* pListener );
 
+class CLogMessageQueue;
+
 /**
 *	This class manages logging state.
+*	Messages can be logged from any thread. Messages are queued and delivered to the listener on the thread that created the logging instance (the dispatch thread).
+*	If queued delivery is disabled, messages logged on the dispatch thread are delivered immediately. Messages logged on other threads are always queued.
 */
 class HLCORE_API CLogging final
 {
@@ -139,17 +155,49 @@ public:
 	*/
 	void VLog( const LogType type, const DevLevel::DevLevel devLevel, const char* const pszFormat, va_list list );
 
+	/**
+	*	Returns whether messages logged on the dispatch thread are queued until the next call to DispatchQueuedMessages.
+	*/
+	bool IsQueuedDeliveryEnabled() const { return m_bQueuedDelivery; }
+
+	/**
+	*	Sets whether messages logged on the dispatch thread are queued. Applications that call DispatchQueuedMessages every frame should enable this.
+	*	Disabling queued delivery dispatches any pending messages.
+	*/
+	void SetQueuedDeliveryEnabled( const bool bEnabled );
+
+	/**
+	*	Delivers all queued messages to the listener as a single batch.
+	*	Must be called on the dispatch thread. Has no effect when called on other threads.
+	*/
+	void DispatchQueuedMessages();
+
 	bool IsLogFileOpen() const { return m_pLogFile != nullptr; }
 
 	bool OpenLogFile( const char* const pszFilename, const bool bAppend = true );
 
 	void CloseLogFile();
 
+private:
+	/**
+	*	Queues a formatted message, or delivers it directly if that's allowed on this thread.
+	*/
+	void QueueMessage( const LogType type, const char* const pszMessage );
+
+	bool IsDispatchThread() const;
+
 private:
 	ILogListener* m_pListener = nullptr;
 
-	//Don't trigger recursive logging.
-	bool m_bInLog = false;
+	CLogMessageQueue* m_pQueue;
+
+	//Thread that delivers messages.
+	std::thread::id m_DispatchThreadId;
+
+	bool m_bQueuedDelivery = false;
+
+	//Listeners may run event loops while handling messages; don't dispatch recursively.
+	bool m_bDispatching = false;
 
 	FILE* m_pLogFile = nullptr;
 
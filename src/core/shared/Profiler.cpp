@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "utility/CCommand.h"
+
+#include "cvar/CCVar.h"
+#include "cvar/CConCommand.h"
+
+#include "Logging.h"
+
+#include "Profiler.h"
+
+namespace prof
+{
+std::atomic<bool> g_bEnabled{ false };
+
+namespace
+{
+const char DEFAULT_TRACE_FILENAME[] = "profile.json";
+
+const double DEFAULT_TRACE_SECONDS = 10;
+
+enum class EventType : uint8_t
+{
+	ZONE = 0,
+	COUNTER,
+	FRAME
+};
+
+struct Event_t
+{
+	const char* pszName;
+	int64_t iTimestamp;
+
+	/**
+	*	Duration for zones, value for counters.
+	*/
+	int64_t iValue;
+
+	EventType type;
+};
+
+/**
+*	Storage for an event in a thread buffer.
+*	Readers can copy a slot while the owning thread overwrites it, so the fields are atomic. Relaxed accesses compile to plain loads and stores.
+*/
+struct EventSlot_t
+{
+	std::atomic<const char*> pszName;
+	std::atomic<int64_t> iTimestamp;
+	std::atomic<int64_t> iValue;
+	std::atomic<EventType> type;
+};
+
+static_assert( ( MAX_EVENTS_PER_THREAD & ( MAX_EVENTS_PER_THREAD - 1 ) ) == 0, "prof::MAX_EVENTS_PER_THREAD must be a power of 2" );
+
+/**
+*	Events recorded by a single thread.
+*	Only the owning thread writes events. Readers copy events out and then check the write position again
+*	to discard any events that were overwritten while copying.
+*/
+struct ThreadBuffer_t
+{
+	explicit ThreadBuffer_t( const unsigned int uiThreadId )
+		: uiThreadId( uiThreadId )
+	{
+	}
+
+	/**
+	*	Allocated when the thread records its first event, so threads that only set their name while recording is disabled cost next to nothing.
+	*	Allocated while holding the registry mutex.
+	*/
+	std::unique_ptr<EventSlot_t[]> events;
+
+	/**
+	*	Total number of events written. The next event is written to uiWritePos % MAX_EVENTS_PER_THREAD.
+	*/
+	std::atomic<uint64_t> uiWritePos{ 0 };
+
+	const unsigned int uiThreadId;
+
+	/**
+	*	Protected by the registry mutex.
+	*/
+	std::string szName;
+};
+
+struct Registry_t
+{
+	std::mutex mutex;
+	std::vector<std::unique_ptr<ThreadBuffer_t>> buffers;
+
+	/**
+	*	Buffers of threads that have exited. New threads reuse these, so short lived threads don't keep adding buffers.
+	*	Their events are kept until the buffer is reused.
+	*/
+	std::vector<ThreadBuffer_t*> freeBuffers;
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+};
+
+Registry_t& GetRegistry()
+{
+	//Never destroyed so threads that are still running during static destruction can keep recording.
+	static Registry_t* const pRegistry = new Registry_t();
+
+	return *pRegistry;
+}
+
+thread_local ThreadBuffer_t* t_pBuffer = nullptr;
+
+/**
+*	Returns the buffer of a thread to the registry when the thread exits.
+*	Kept separate from t_pBuffer so recording doesn't pay for the thread local's destructor registration.
+*/
+struct ThreadBufferOwner_t
+{
+	ThreadBuffer_t* pBuffer = nullptr;
+
+	~ThreadBufferOwner_t()
+	{
+		if( !pBuffer )
+			return;
+
+		auto& registry = GetRegistry();
+
+		std::lock_guard<std::mutex> lock( registry.mutex );
+
+		registry.freeBuffers.push_back( pBuffer );
+
+		t_pBuffer = nullptr;
+	}
+};
+
+thread_local ThreadBufferOwner_t t_BufferOwner;
+
+ThreadBuffer_t& GetThreadBuffer()
+{
+	if( !t_pBuffer )
+	{
+		auto& registry = GetRegistry();
+
+		std::lock_guard<std::mutex> lock( registry.mutex );
+
+		if( !registry.freeBuffers.empty() )
+		{
+			t_pBuffer = registry.freeBuffers.back();
+			registry.freeBuffers.pop_back();
+
+			//The previous thread's events would otherwise show up under this thread's name.
+			t_pBuffer->uiWritePos.store( 0, std::memory_order_relaxed );
+			t_pBuffer->szName.clear();
+		}
+		else
+		{
+			registry.buffers.emplace_back( std::make_unique<ThreadBuffer_t>( static_cast<unsigned int>( registry.buffers.size() + 1 ) ) );
+
+			t_pBuffer = registry.buffers.back().get();
+		}
+
+		t_BufferOwner.pBuffer = t_pBuffer;
+	}
+
+	return *t_pBuffer;
+}
+
+void Record( const EventType type, const char* const pszName, const int64_t iTimestamp, const int64_t iValue )
+{
+	auto& buffer = GetThreadBuffer();
+
+	if( !buffer.events )
+	{
+		std::lock_guard<std::mutex> lock( GetRegistry().mutex );
+
+		buffer.events.reset( new EventSlot_t[ MAX_EVENTS_PER_THREAD ] );
+	}
+
+	const uint64_t uiPos = buffer.uiWritePos.load( std::memory_order_relaxed );
+
+	auto& slot = buffer.events[ uiPos & ( MAX_EVENTS_PER_THREAD - 1 ) ];
+
+	slot.pszName.store( pszName, std::memory_order_relaxed );
+	slot.iTimestamp.store( iTimestamp, std::memory_order_relaxed );
+	slot.iValue.store( iValue, std::memory_order_relaxed );
+	slot.type.store( type, std::memory_order_relaxed );
+
+	buffer.uiWritePos.store( uiPos + 1, std::memory_order_release );
+}
+
+/**
+*	Copies the events of a thread that were recorded at or after iCutoff.
+*/
+void CopyEvents( const ThreadBuffer_t& buffer, const int64_t iCutoff, std::vector<Event_t>& events )
+{
+	events.clear();
+
+	if( !buffer.events )
+		return;
+
+	const uint64_t uiEnd = buffer.uiWritePos.load( std::memory_order_acquire );
+	const uint64_t uiBegin = uiEnd > MAX_EVENTS_PER_THREAD ? uiEnd - MAX_EVENTS_PER_THREAD : 0;
+
+	events.reserve( static_cast<size_t>( uiEnd - uiBegin ) );
+
+	for( uint64_t uiPos = uiBegin; uiPos < uiEnd; ++uiPos )
+	{
+		const auto& slot = buffer.events[ uiPos & ( MAX_EVENTS_PER_THREAD - 1 ) ];
+
+		events.push_back( {
+			slot.pszName.load( std::memory_order_relaxed ),
+			slot.iTimestamp.load( std::memory_order_relaxed ),
+			slot.iValue.load( std::memory_order_relaxed ),
+			slot.type.load( std::memory_order_relaxed )
+		} );
+	}
+
+	//The thread kept recording while we were copying; the oldest events may have been overwritten.
+	std::atomic_thread_fence( std::memory_order_acquire );
+
+	const uint64_t uiNewEnd = buffer.uiWritePos.load( std::memory_order_acquire );
+
+	if( uiNewEnd - uiBegin > MAX_EVENTS_PER_THREAD )
+	{
+		const size_t uiOverwritten = static_cast<size_t>( std::min<uint64_t>( uiNewEnd - uiBegin - MAX_EVENTS_PER_THREAD, events.size() ) );
+
+		events.erase( events.begin(), events.begin() + uiOverwritten );
+	}
+
+	events.erase( std::remove_if( events.begin(), events.end(),
+		[ = ]( const Event_t& event )
+		{
+			const int64_t iEnd = event.type == EventType::ZONE ? event.iTimestamp + event.iValue : event.iTimestamp;
+
+			return iEnd < iCutoff;
+		} ), events.end() );
+}
+
+void WriteJSONString( FILE* pFile, const char* pszString )
+{
+	fputc( '"', pFile );
+
+	for( ; *pszString; ++pszString )
+	{
+		const char c = *pszString;
+
+		if( c == '"' || c == '\\' )
+		{
+			fputc( '\\', pFile );
+			fputc( c, pFile );
+		}
+		else if( static_cast<unsigned char>( c ) < ' ' )
+		{
+			fprintf( pFile, "\\u%04x", c );
+		}
+		else
+		{
+			fputc( c, pFile );
+		}
+	}
+
+	fputc( '"', pFile );
+}
+
+void ProfileEnableChanged( cvar::CCVar& cvar, const char* pszOldValue, float flOldValue )
+{
+	SetEnabled( cvar.GetBool() );
+}
+
+void ProfileDump( const util::CCommand& args )
+{
+	const char* const pszFilename = args.ArgC() >= 2 ? args.Arg( 1 ) : DEFAULT_TRACE_FILENAME;
+	const double flSeconds = args.ArgC() >= 3 ? atof( args.Arg( 2 ) ) : DEFAULT_TRACE_SECONDS;
+
+	if( flSeconds <= 0 )
+	{
+		Message( "Usage: prof_dump [filename] [seconds]\n" );
+		return;
+	}
+
+	size_t uiEventCount;
+
+	if( WriteChromeTrace( pszFilename, flSeconds, &uiEventCount ) )
+	{
+		Message( "Wrote %u profiler events to \"%s\"\n", static_cast<unsigned int>( uiEventCount ), pszFilename );
+	}
+	else
+	{
+		Error( "Couldn't write profiler events to \"%s\"\n", pszFilename );
+	}
+}
+
+static cvar::CCVar prof_enable( "prof_enable",
+	cvar::CCVarArgsBuilder()
+	.HelpInfo( "If non-zero, records zones, counters and frames for prof_dump" )
+	.FloatValue( 0 )
+	.Callback( &ProfileEnableChanged ) );
+
+static cvar::CConCommand prof_dump( "prof_dump", &ProfileDump, cvar::Flag::NONE,
+	"Writes recorded profiler events as a Chrome trace. Usage: prof_dump [filename] [seconds]" );
+}
+
+void SetEnabled( const bool bEnabled )
+{
+	if( bEnabled )
+	{
+		//Start the clock now so the first zone doesn't measure it.
+		GetRegistry();
+	}
+
+	g_bEnabled.store( bEnabled, std::memory_order_relaxed );
+}
+
+int64_t GetTimestamp()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - GetRegistry().start ).count();
+}
+
+void RecordZone( const char* const pszName, const int64_t iStart, const int64_t iEnd )
+{
+	Record( EventType::ZONE, pszName, iStart, iEnd - iStart );
+}
+
+void RecordCounter( const char* const pszName, const int64_t iValue )
+{
+	Record( EventType::COUNTER, pszName, GetTimestamp(), iValue );
+}
+
+void RecordFrame()
+{
+	Record( EventType::FRAME, "Frame", GetTimestamp(), 0 );
+}
+
+void SetThreadName( const char* const pszName )
+{
+	auto& buffer = GetThreadBuffer();
+
+	std::lock_guard<std::mutex> lock( GetRegistry().mutex );
+
+	buffer.szName = pszName;
+}
+
+bool WriteChromeTrace( const char* const pszFilename, const double flSeconds, size_t* puiOutEventCount )
+{
+	if( puiOutEventCount )
+		*puiOutEventCount = 0;
+
+	FILE* pFile = fopen( pszFilename, "w" );
+
+	if( !pFile )
+		return false;
+
+	const int64_t iCutoff = GetTimestamp() - static_cast<int64_t>( flSeconds * 1e9 );
+
+	auto& registry = GetRegistry();
+
+	size_t uiEventCount = 0;
+
+	fprintf( pFile, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" );
+
+	{
+		//Only blocks threads that start, exit, record their first event or change their name while writing.
+		std::lock_guard<std::mutex> lock( registry.mutex );
+
+		std::vector<Event_t> events;
+
+		bool bFirst = true;
+
+		for( const auto& buffer : registry.buffers )
+		{
+			fprintf( pFile, "%s\n{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": ",
+					 bFirst ? "" : ",", buffer->uiThreadId );
+
+			if( !buffer->szName.empty() )
+			{
+				WriteJSONString( pFile, buffer->szName.c_str() );
+			}
+			else
+			{
+				fprintf( pFile, "\"Thread %u\"", buffer->uiThreadId );
+			}
+
+			fprintf( pFile, "}}" );
+
+			bFirst = false;
+
+			CopyEvents( *buffer, iCutoff, events );
+
+			for( const auto& event : events )
+			{
+				fprintf( pFile, ",\n{\"name\": " );
+
+				WriteJSONString( pFile, event.pszName );
+
+				//Chrome traces use microseconds.
+				fprintf( pFile, ", \"pid\": 1, \"tid\": %u, \"ts\": %.3f", buffer->uiThreadId, event.iTimestamp / 1000.0 );
+
+				switch( event.type )
+				{
+				case EventType::ZONE:
+					fprintf( pFile, ", \"ph\": \"X\", \"dur\": %.3f}", event.iValue / 1000.0 );
+					break;
+
+				case EventType::COUNTER:
+					fprintf( pFile, ", \"ph\": \"C\", \"args\": {\"value\": %lld}}", static_cast<long long>( event.iValue ) );
+					break;
+
+				case EventType::FRAME:
+					fprintf( pFile, ", \"ph\": \"i\", \"s\": \"g\"}" );
+					break;
+				}
+			}
+
+			uiEventCount += events.size();
+		}
+	}
+
+	fprintf( pFile, "\n]}\n" );
+
+	const bool bSuccess = !ferror( pFile );
+
+	fclose( pFile );
+
+	if( puiOutEventCount )
+		*puiOutEventCount = uiEventCount;
+
+	return bSuccess;
+}
+}
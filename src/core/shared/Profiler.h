@@ -0,0 +1,150 @@
+#ifndef COMMON_PROFILER_H
+#define COMMON_PROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/LibHLCore.h"
+
+/**
+*	@defgroup Profiler Profiler
+*
+*	Lightweight instrumentation of hot paths.
+*	Zones, counters and frame markers are recorded into per-thread ring buffers that only the owning thread writes to,
+*	so recording never takes a lock. Recording is toggled at runtime with the prof_enable cvar;
+*	when disabled, every instrumentation point costs a single relaxed load.
+*	prof_dump writes the last few seconds of events as a Chrome trace (chrome://tracing, Perfetto).
+*
+*	Names must be string literals or otherwise outlive the profiler, only the pointer is stored.
+*
+*	@{
+*/
+
+namespace prof
+{
+/**
+*	Number of events kept for each thread. Once full, the oldest events are overwritten. Must be a power of 2.
+*/
+const size_t MAX_EVENTS_PER_THREAD = 1 << 16;
+
+/**
+*	Whether events are being recorded. Use IsEnabled instead.
+*/
+extern HLCORE_API std::atomic<bool> g_bEnabled;
+
+/**
+*	@return Whether events are being recorded.
+*/
+inline bool IsEnabled()
+{
+	return g_bEnabled.load( std::memory_order_relaxed );
+}
+
+/**
+*	Enables or disables recording. Events recorded so far are kept.
+*/
+HLCORE_API void SetEnabled( const bool bEnabled );
+
+/**
+*	@return Time in nanoseconds since the profiler was first used.
+*/
+HLCORE_API int64_t GetTimestamp();
+
+/**
+*	Records a zone on the calling thread. Prefer CScopedZone.
+*	@param pszName Name of the zone.
+*	@param iStart Timestamp at which the zone was entered.
+*	@param iEnd Timestamp at which the zone was left.
+*/
+HLCORE_API void RecordZone( const char* const pszName, const int64_t iStart, const int64_t iEnd );
+
+/**
+*	Records the value of a counter at the current time.
+*/
+HLCORE_API void RecordCounter( const char* const pszName, const int64_t iValue );
+
+/**
+*	Records the start of a new frame.
+*/
+HLCORE_API void RecordFrame();
+
+/**
+*	Sets the name of the calling thread, as shown in traces.
+*	Cheap enough to call from short lived threads: the event buffer isn't allocated until the thread records an event,
+*	and buffers are reused once their thread exits.
+*	@param pszName Name of the thread. Copied.
+*/
+HLCORE_API void SetThreadName( const char* const pszName );
+
+/**
+*	Writes the events recorded in the last flSeconds seconds as a Chrome trace.
+*	@param pszFilename Name of the file to write.
+*	@param flSeconds How far back to include events.
+*	@param puiOutEventCount Optional. Receives the number of events that were written.
+*	@return Whether the file was written.
+*/
+HLCORE_API bool WriteChromeTrace( const char* const pszFilename, const double flSeconds, size_t* puiOutEventCount = nullptr );
+
+/**
+*	Records the time between construction and destruction as a zone.
+*	If recording is disabled when the zone is entered, nothing is recorded.
+*/
+class CScopedZone final
+{
+public:
+	explicit CScopedZone( const char* const pszName )
+		: m_pszName( IsEnabled() ? pszName : nullptr )
+		, m_iStart( m_pszName ? GetTimestamp() : 0 )
+	{
+	}
+
+	~CScopedZone()
+	{
+		if( m_pszName )
+			RecordZone( m_pszName, m_iStart, GetTimestamp() );
+	}
+
+private:
+	const char* const m_pszName;
+	const int64_t m_iStart;
+
+private:
+	CScopedZone( const CScopedZone& ) = delete;
+	CScopedZone& operator=( const CScopedZone& ) = delete;
+};
+}
+
+#define PROF_CONCAT_IMPL( a, b ) a##b
+#define PROF_CONCAT( a, b ) PROF_CONCAT_IMPL( a, b )
+
+/**
+*	Records the remainder of the enclosing scope as a zone.
+*/
+#define PROF_ZONE( pszName ) const prof::CScopedZone PROF_CONCAT( profZone, __LINE__ )( pszName )
+
+/**
+*	Records the value of a counter. The value is not evaluated if recording is disabled.
+*/
+#define PROF_COUNTER( pszName, value )						\
+do															\
+{															\
+	if( prof::IsEnabled() )									\
+		prof::RecordCounter( pszName, ( value ) );			\
+}															\
+while( false )
+
+/**
+*	Records the start of a new frame.
+*/
+#define PROF_FRAME()										\
+do															\
+{															\
+	if( prof::IsEnabled() )									\
+		prof::RecordFrame();								\
+}															\
+while( false )
+
+/** @} */
+
+#endif //COMMON_PROFILER_H
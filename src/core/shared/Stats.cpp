@@ -0,0 +1,466 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdarg>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "utility/CCommand.h"
+
+#include "cvar/CCVar.h"
+#include "cvar/CConCommand.h"
+
+#include "Logging.h"
+#include "Utility.h"
+
+#include "Stats.h"
+
+namespace stats
+{
+namespace
+{
+void AppendFormat( std::string& szOutput, const char* const pszFormat, ... )
+{
+	char szBuffer[ 256 ];
+
+	va_list list;
+
+	va_start( list, pszFormat );
+
+	const int iResult = vsnprintf( szBuffer, sizeof( szBuffer ), pszFormat, list );
+
+	va_end( list );
+
+	if( iResult > 0 )
+		szOutput.append( szBuffer, std::min( static_cast<size_t>( iResult ), sizeof( szBuffer ) - 1 ) );
+}
+
+/**
+*	Appends a value followed by its unit. Byte sizes are scaled to a readable unit.
+*/
+void AppendValue( std::string& szOutput, double flValue, const std::string& szUnit )
+{
+	if( szUnit == "bytes" )
+	{
+		static const char* const UNITS[] = { "bytes", "KiB", "MiB", "GiB" };
+
+		size_t uiUnit = 0;
+
+		while( uiUnit + 1 < ARRAYSIZE( UNITS ) && std::abs( flValue ) >= 1024 )
+		{
+			flValue /= 1024;
+			++uiUnit;
+		}
+
+		AppendFormat( szOutput, uiUnit == 0 ? "%.0f %s" : "%.2f %s", flValue, UNITS[ uiUnit ] );
+		return;
+	}
+
+	AppendFormat( szOutput, flValue == std::floor( flValue ) && std::abs( flValue ) < 1e15 ? "%.0f" : "%.3f", flValue );
+
+	if( !szUnit.empty() )
+	{
+		szOutput += ' ';
+		szOutput += szUnit;
+	}
+}
+
+/**
+*	Atomically applies an operation to a double. std::atomic<double> has no arithmetic operations in C++14.
+*/
+template<typename OP>
+void UpdateDouble( std::atomic<double>& value, const OP& op )
+{
+	double flOld = value.load( std::memory_order_relaxed );
+
+	while( !value.compare_exchange_weak( flOld, op( flOld ), std::memory_order_relaxed ) )
+	{
+	}
+}
+
+void StatsExportChanged( cvar::CCVar& cvar, const char* pszOldValue, float flOldValue );
+
+static cvar::CCVar stats_export_file( "stats_export_file",
+	cvar::CCVarArgsBuilder()
+	.HelpInfo( "If not empty, stats are periodically appended to this file as lines of JSON" )
+	.StringValue( "" )
+	.Callback( &StatsExportChanged ) );
+
+static cvar::CCVar stats_export_interval( "stats_export_interval",
+	cvar::CCVarArgsBuilder()
+	.HelpInfo( "Time between stats exports, in seconds" )
+	.FloatValue( 10 )
+	.MinValue( 0.1f )
+	.Callback( &StatsExportChanged ) );
+
+void StatsExportChanged( cvar::CCVar& cvar, const char* pszOldValue, float flOldValue )
+{
+	Registry().SetPeriodicExport( stats_export_file.GetString(), stats_export_interval.GetFloat() );
+}
+
+void StatsPrint( const util::CCommand& args )
+{
+	std::vector<std::string> lines;
+
+	Registry().Format( lines, args.ArgC() >= 2 ? args.Arg( 1 ) : nullptr );
+
+	for( const auto& szLine : lines )
+	{
+		Message( "%s\n", szLine.c_str() );
+	}
+}
+
+void StatsReset( const util::CCommand& args )
+{
+	Registry().ResetAll();
+}
+
+static cvar::CConCommand stats_print( "stats_print", &StatsPrint, cvar::Flag::NONE, "Prints all stats. Usage: stats_print [filter]" );
+static cvar::CConCommand stats_reset( "stats_reset", &StatsReset, cvar::Flag::NONE, "Resets all stats" );
+}
+
+const char* StatTypeToString( const StatType type )
+{
+	switch( type )
+	{
+	case StatType::COUNTER:		return "counter";
+	case StatType::GAUGE:		return "gauge";
+	case StatType::HISTOGRAM:	return "histogram";
+
+	default: return "unknown";
+	}
+}
+
+CStat::CStat( std::string&& szName, std::string&& szUnit )
+	: m_szName( std::move( szName ) )
+	, m_szUnit( std::move( szUnit ) )
+{
+}
+
+CStat::~CStat()
+{
+}
+
+void CCounter::Format( std::string& szOutput ) const
+{
+	AppendValue( szOutput, static_cast<double>( Get() ), GetUnit() );
+}
+
+void CCounter::FormatJSON( std::string& szOutput ) const
+{
+	AppendFormat( szOutput, "{\"type\": \"counter\", \"value\": %llu}", static_cast<unsigned long long>( Get() ) );
+}
+
+void CGauge::Add( const double flAmount )
+{
+	UpdateDouble( m_flValue, [ = ]( const double flValue ) { return flValue + flAmount; } );
+}
+
+void CGauge::Format( std::string& szOutput ) const
+{
+	AppendValue( szOutput, Get(), GetUnit() );
+}
+
+void CGauge::FormatJSON( std::string& szOutput ) const
+{
+	AppendFormat( szOutput, "{\"type\": \"gauge\", \"value\": %.17g}", Get() );
+}
+
+CHistogram::CHistogram( std::string&& szName, std::string&& szUnit )
+	: CStat( std::move( szName ), std::move( szUnit ) )
+{
+	Reset();
+}
+
+void CHistogram::Record( const double flValue )
+{
+	int iBucket = 0;
+
+	if( flValue > 0 )
+		iBucket = std::max( 0, std::min( NUM_BUCKETS - 1, std::ilogb( flValue ) + BUCKET_BIAS ) );
+
+	m_Buckets[ iBucket ].fetch_add( 1, std::memory_order_relaxed );
+	m_uiCount.fetch_add( 1, std::memory_order_relaxed );
+
+	UpdateDouble( m_flSum, [ = ]( const double flSum ) { return flSum + flValue; } );
+	UpdateDouble( m_flMin, [ = ]( const double flMin ) { return std::min( flMin, flValue ); } );
+	UpdateDouble( m_flMax, [ = ]( const double flMax ) { return std::max( flMax, flValue ); } );
+}
+
+HistogramSummary_t CHistogram::GetSummary() const
+{
+	HistogramSummary_t summary;
+
+	//Values can be recorded while the summary is being made, so use the bucket counts as the total to keep percentiles consistent.
+	uint64_t buckets[ NUM_BUCKETS ];
+
+	for( int iBucket = 0; iBucket < NUM_BUCKETS; ++iBucket )
+	{
+		buckets[ iBucket ] = m_Buckets[ iBucket ].load( std::memory_order_relaxed );
+		summary.uiCount += buckets[ iBucket ];
+	}
+
+	if( summary.uiCount == 0 )
+		return summary;
+
+	summary.flMin = m_flMin.load( std::memory_order_relaxed );
+	summary.flMax = m_flMax.load( std::memory_order_relaxed );
+	summary.flMean = m_flSum.load( std::memory_order_relaxed ) / std::max<uint64_t>( 1, m_uiCount.load( std::memory_order_relaxed ) );
+
+	auto percentile = [ & ]( const double flFraction )
+	{
+		const uint64_t uiRank = static_cast<uint64_t>( std::ceil( flFraction * summary.uiCount ) );
+
+		uint64_t uiSeen = 0;
+
+		for( int iBucket = 0; iBucket < NUM_BUCKETS; ++iBucket )
+		{
+			uiSeen += buckets[ iBucket ];
+
+			if( uiSeen >= uiRank )
+			{
+				//Middle of the bucket, limited to the values that were actually seen.
+				const double flEstimate = std::ldexp( 1.5, iBucket - BUCKET_BIAS );
+
+				return std::max( summary.flMin, std::min( summary.flMax, flEstimate ) );
+			}
+		}
+
+		return summary.flMax;
+	};
+
+	summary.flP50 = percentile( 0.50 );
+	summary.flP95 = percentile( 0.95 );
+	summary.flP99 = percentile( 0.99 );
+
+	return summary;
+}
+
+void CHistogram::Format( std::string& szOutput ) const
+{
+	const auto summary = GetSummary();
+
+	AppendFormat( szOutput, "n=%llu", static_cast<unsigned long long>( summary.uiCount ) );
+
+	if( summary.uiCount == 0 )
+		return;
+
+	const struct
+	{
+		const char* pszName;
+		double flValue;
+	} values[] =
+	{
+		{ "mean", summary.flMean },
+		{ "p50", summary.flP50 },
+		{ "p95", summary.flP95 },
+		{ "p99", summary.flP99 },
+		{ "max", summary.flMax }
+	};
+
+	for( const auto& value : values )
+	{
+		AppendFormat( szOutput, " %s=", value.pszName );
+		AppendValue( szOutput, value.flValue, GetUnit() );
+	}
+}
+
+void CHistogram::FormatJSON( std::string& szOutput ) const
+{
+	const auto summary = GetSummary();
+
+	AppendFormat( szOutput,
+		"{\"type\": \"histogram\", \"count\": %llu, \"min\": %.17g, \"max\": %.17g, \"mean\": %.17g, \"p50\": %.17g, \"p95\": %.17g, \"p99\": %.17g}",
+		static_cast<unsigned long long>( summary.uiCount ), summary.flMin, summary.flMax, summary.flMean, summary.flP50, summary.flP95, summary.flP99 );
+}
+
+void CHistogram::Reset()
+{
+	for( auto& bucket : m_Buckets )
+	{
+		bucket.store( 0, std::memory_order_relaxed );
+	}
+
+	m_uiCount.store( 0, std::memory_order_relaxed );
+	m_flSum.store( 0, std::memory_order_relaxed );
+	m_flMin.store( std::numeric_limits<double>::max(), std::memory_order_relaxed );
+	m_flMax.store( std::numeric_limits<double>::lowest(), std::memory_order_relaxed );
+}
+
+CStatsRegistry::CStatsRegistry()
+	: m_Start( std::chrono::steady_clock::now() )
+{
+}
+
+CStatsRegistry::~CStatsRegistry()
+{
+}
+
+template<typename T>
+T& CStatsRegistry::GetStat( const char* const pszName, const char* const pszUnit, const StatType type )
+{
+	assert( pszName && *pszName );
+	assert( pszUnit );
+
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	std::string szName = pszName;
+
+	auto it = m_Stats.find( szName );
+
+	if( it != m_Stats.end() && it->second->GetType() != type )
+	{
+		Error( "CStatsRegistry: stat \"%s\" is a %s, not a %s\n", pszName, StatTypeToString( it->second->GetType() ), StatTypeToString( type ) );
+
+		//Keep the caller working with a stat of its own.
+		szName = szName + " (" + StatTypeToString( type ) + ')';
+
+		it = m_Stats.find( szName );
+	}
+
+	if( it == m_Stats.end() )
+	{
+		it = m_Stats.emplace( szName, std::make_unique<T>( std::string( szName ), std::string( pszUnit ) ) ).first;
+	}
+
+	return *static_cast<T*>( it->second.get() );
+}
+
+CCounter& CStatsRegistry::GetCounter( const char* const pszName, const char* const pszUnit )
+{
+	return GetStat<CCounter>( pszName, pszUnit, StatType::COUNTER );
+}
+
+CGauge& CStatsRegistry::GetGauge( const char* const pszName, const char* const pszUnit )
+{
+	return GetStat<CGauge>( pszName, pszUnit, StatType::GAUGE );
+}
+
+CHistogram& CStatsRegistry::GetHistogram( const char* const pszName, const char* const pszUnit )
+{
+	return GetStat<CHistogram>( pszName, pszUnit, StatType::HISTOGRAM );
+}
+
+void CStatsRegistry::Format( std::vector<std::string>& lines, const char* const pszFilter ) const
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	for( const auto& stat : m_Stats )
+	{
+		if( pszFilter && *pszFilter && !strstr( stat.first.c_str(), pszFilter ) )
+			continue;
+
+		std::string szLine = stat.first + ": ";
+
+		stat.second->Format( szLine );
+
+		lines.emplace_back( std::move( szLine ) );
+	}
+}
+
+void CStatsRegistry::FormatJSON( std::string& szOutput ) const
+{
+	AppendFormat( szOutput, "{\"time\": %.3f, \"stats\": {", GetTime() );
+
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	bool bFirst = true;
+
+	for( const auto& stat : m_Stats )
+	{
+		if( !bFirst )
+			szOutput += ", ";
+
+		bFirst = false;
+
+		//Names are identifiers separated by periods, so they don't need escaping.
+		szOutput += '"' + stat.first + "\": ";
+
+		stat.second->FormatJSON( szOutput );
+	}
+
+	szOutput += "}}";
+}
+
+void CStatsRegistry::ResetAll()
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	for( const auto& stat : m_Stats )
+	{
+		stat.second->Reset();
+	}
+}
+
+bool CStatsRegistry::ExportToFile( const char* const pszFilename )
+{
+	assert( pszFilename );
+
+	std::string szLine;
+
+	FormatJSON( szLine );
+
+	szLine += '\n';
+
+	FILE* pFile = fopen( pszFilename, "a" );
+
+	if( !pFile )
+		return false;
+
+	//Write the line in one call so lines from multiple processes don't interleave.
+	const bool bSuccess = fwrite( szLine.c_str(), 1, szLine.size(), pFile ) == szLine.size();
+
+	fclose( pFile );
+
+	return bSuccess;
+}
+
+void CStatsRegistry::SetPeriodicExport( const char* const pszFilename, const double flInterval )
+{
+	assert( pszFilename );
+
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	m_szExportFilename = pszFilename;
+	m_flExportInterval = flInterval;
+	m_flNextExportTime = GetTime() + flInterval;
+}
+
+void CStatsRegistry::RunFrame()
+{
+	std::string szFilename;
+
+	{
+		std::lock_guard<std::mutex> lock( m_Mutex );
+
+		if( m_szExportFilename.empty() )
+			return;
+
+		const double flTime = GetTime();
+
+		if( flTime < m_flNextExportTime )
+			return;
+
+		m_flNextExportTime = flTime + m_flExportInterval;
+
+		szFilename = m_szExportFilename;
+	}
+
+	if( !ExportToFile( szFilename.c_str() ) )
+		Warning( "Couldn't write stats to \"%s\"\n", szFilename.c_str() );
+}
+
+double CStatsRegistry::GetTime() const
+{
+	return std::chrono::duration<double>( std::chrono::steady_clock::now() - m_Start ).count();
+}
+
+CStatsRegistry& Registry()
+{
+	//Never destroyed so stats can be updated during static destruction.
+	static CStatsRegistry* const pRegistry = new CStatsRegistry();
+
+	return *pRegistry;
+}
+}
@@ -0,0 +1,274 @@
+#ifndef COMMON_STATS_H
+#define COMMON_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "core/LibHLCore.h"
+
+/**
+*	@defgroup Stats Runtime statistics
+*
+*	Named statistics that any subsystem can publish to.
+*	Stats are created on first use and live until the program exits, so references to them can be cached:
+*	<pre>
+*	static auto& loads = stats::Registry().GetCounter( "studiomodel.loads" );
+*	loads.Add();
+*	</pre>
+*	Updating a stat is lock free and safe to do from any thread.
+*	Names use the form "subsystem.name".
+*
+*	@{
+*/
+
+namespace stats
+{
+enum class StatType
+{
+	/**
+	*	Total number of events.
+	*/
+	COUNTER = 0,
+
+	/**
+	*	Current value of a quantity.
+	*/
+	GAUGE,
+
+	/**
+	*	Distribution of measured values.
+	*/
+	HISTOGRAM
+};
+
+HLCORE_API const char* StatTypeToString( const StatType type );
+
+class HLCORE_API CStat
+{
+public:
+	CStat( std::string&& szName, std::string&& szUnit );
+	virtual ~CStat();
+
+	const std::string& GetName() const { return m_szName; }
+
+	/**
+	*	Unit that values are in, e.g. "ms" or "bytes". May be empty.
+	*/
+	const std::string& GetUnit() const { return m_szUnit; }
+
+	virtual StatType GetType() const = 0;
+
+	/**
+	*	Appends a human readable description of the current value.
+	*/
+	virtual void Format( std::string& szOutput ) const = 0;
+
+	/**
+	*	Appends the current value as a JSON object.
+	*/
+	virtual void FormatJSON( std::string& szOutput ) const = 0;
+
+	/**
+	*	Resets the stat to its initial state.
+	*/
+	virtual void Reset() = 0;
+
+private:
+	const std::string m_szName;
+	const std::string m_szUnit;
+
+private:
+	CStat( const CStat& ) = delete;
+	CStat& operator=( const CStat& ) = delete;
+};
+
+class HLCORE_API CCounter final : public CStat
+{
+public:
+	using CStat::CStat;
+
+	StatType GetType() const override { return StatType::COUNTER; }
+
+	uint64_t Get() const { return m_uiValue.load( std::memory_order_relaxed ); }
+
+	void Add( const uint64_t uiAmount = 1 ) { m_uiValue.fetch_add( uiAmount, std::memory_order_relaxed ); }
+
+	void Format( std::string& szOutput ) const override;
+	void FormatJSON( std::string& szOutput ) const override;
+
+	void Reset() override { m_uiValue.store( 0, std::memory_order_relaxed ); }
+
+private:
+	std::atomic<uint64_t> m_uiValue{ 0 };
+};
+
+class HLCORE_API CGauge final : public CStat
+{
+public:
+	using CStat::CStat;
+
+	StatType GetType() const override { return StatType::GAUGE; }
+
+	double Get() const { return m_flValue.load( std::memory_order_relaxed ); }
+
+	void Set( const double flValue ) { m_flValue.store( flValue, std::memory_order_relaxed ); }
+
+	void Add( const double flAmount );
+
+	void Format( std::string& szOutput ) const override;
+	void FormatJSON( std::string& szOutput ) const override;
+
+	void Reset() override { Set( 0 ); }
+
+private:
+	std::atomic<double> m_flValue{ 0 };
+};
+
+/**
+*	Summary of the values recorded by a histogram.
+*/
+struct HistogramSummary_t
+{
+	uint64_t uiCount = 0;
+
+	double flMin = 0;
+	double flMax = 0;
+	double flMean = 0;
+
+	//Percentiles are estimated from power of 2 buckets.
+	double flP50 = 0;
+	double flP95 = 0;
+	double flP99 = 0;
+};
+
+class HLCORE_API CHistogram final : public CStat
+{
+public:
+	/**
+	*	Bucket i holds values in the range [2^(i - BUCKET_BIAS), 2^(i - BUCKET_BIAS + 1)).
+	*	Values outside of the range of all buckets are put in the first or last one.
+	*/
+	static const int NUM_BUCKETS = 64;
+	static const int BUCKET_BIAS = 24;
+
+public:
+	CHistogram( std::string&& szName, std::string&& szUnit );
+
+	StatType GetType() const override { return StatType::HISTOGRAM; }
+
+	void Record( const double flValue );
+
+	HistogramSummary_t GetSummary() const;
+
+	void Format( std::string& szOutput ) const override;
+	void FormatJSON( std::string& szOutput ) const override;
+
+	void Reset() override;
+
+private:
+	std::atomic<uint64_t> m_Buckets[ NUM_BUCKETS ];
+
+	std::atomic<uint64_t> m_uiCount;
+	std::atomic<double> m_flSum;
+	std::atomic<double> m_flMin;
+	std::atomic<double> m_flMax;
+};
+
+/**
+*	Owns all stats and exports them.
+*/
+class HLCORE_API CStatsRegistry final
+{
+public:
+	CStatsRegistry();
+	~CStatsRegistry();
+
+	/**
+	*	Gets or creates a counter.
+	*	@param pszName Name of the stat. Must not be in use by a stat of another type.
+	*	@param pszUnit Unit of the values. Only used when the stat is created.
+	*/
+	CCounter& GetCounter( const char* const pszName, const char* const pszUnit = "" );
+
+	/**
+	*	@copydoc GetCounter
+	*/
+	CGauge& GetGauge( const char* const pszName, const char* const pszUnit = "" );
+
+	/**
+	*	@copydoc GetCounter
+	*/
+	CHistogram& GetHistogram( const char* const pszName, const char* const pszUnit = "" );
+
+	/**
+	*	Formats all stats whose name contains pszFilter as text, one stat per line.
+	*	@param pszFilter Optional. If null or empty, all stats are formatted.
+	*/
+	void Format( std::vector<std::string>& lines, const char* const pszFilter = nullptr ) const;
+
+	/**
+	*	Formats all stats as a single line JSON object.
+	*/
+	void FormatJSON( std::string& szOutput ) const;
+
+	/**
+	*	Resets all stats.
+	*/
+	void ResetAll();
+
+	/**
+	*	Appends the current values as a line of JSON to the given file.
+	*	@return Whether the file was written.
+	*/
+	bool ExportToFile( const char* const pszFilename );
+
+	/**
+	*	Sets up periodic export. Every flInterval seconds, RunFrame appends the current values to the file.
+	*	@param pszFilename File to append to. If empty, periodic export is disabled.
+	*	@param flInterval Time between exports, in seconds.
+	*/
+	void SetPeriodicExport( const char* const pszFilename, const double flInterval );
+
+	/**
+	*	Exports stats if periodic export is enabled and the interval has passed. Call once per frame or batch item.
+	*/
+	void RunFrame();
+
+private:
+	template<typename T>
+	T& GetStat( const char* const pszName, const char* const pszUnit, const StatType type );
+
+	/**
+	*	@return Seconds since the registry was created.
+	*/
+	double GetTime() const;
+
+private:
+	const std::chrono::steady_clock::time_point m_Start;
+
+	mutable std::mutex m_Mutex;
+
+	std::map<std::string, std::unique_ptr<CStat>> m_Stats;
+
+	std::string m_szExportFilename;
+	double m_flExportInterval = 0;
+	double m_flNextExportTime = 0;
+
+private:
+	CStatsRegistry( const CStatsRegistry& ) = delete;
+	CStatsRegistry& operator=( const CStatsRegistry& ) = delete;
+};
+
+HLCORE_API CStatsRegistry& Registry();
+}
+
+/** @} */
+
+#endif //COMMON_STATS_H
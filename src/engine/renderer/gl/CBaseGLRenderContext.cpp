@@ -1,6 +1,11 @@
+#include <algorithm>
+
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
 
 #include "core/shared/Logging.h"
+#include "core/shared/Profiler.h"
+#include "core/shared/Stats.h"
 
 #include "CBaseGLRenderContext.h"
 
@@ -8,6 +13,17 @@ static_assert( sizeof( renderer::HTexture_t ) == sizeof( GLuint ), "Unsupported
 
 namespace renderer
 {
+namespace
+{
+void SetCapability( const GLenum capability, const bool bEnabled )
+{
+	if( bEnabled )
+		glEnable( capability );
+	else
+		glDisable( capability );
+}
+}
+
 GLenum ImageFormatToGL( const ImageFormat format )
 {
 	switch( format )
@@ -64,6 +80,48 @@ GLenum MagFilterToGL( const MagFilter mag )
 	}
 }
 
+GLenum BlendFactorToGL( const BlendFactor factor )
+{
+	switch( factor )
+	{
+	case BlendFactor::ZERO:					return GL_ZERO;
+	case BlendFactor::ONE:					return GL_ONE;
+	case BlendFactor::SRC_COLOR:			return GL_SRC_COLOR;
+	case BlendFactor::ONE_MINUS_SRC_COLOR:	return GL_ONE_MINUS_SRC_COLOR;
+	case BlendFactor::SRC_ALPHA:			return GL_SRC_ALPHA;
+	case BlendFactor::ONE_MINUS_SRC_ALPHA:	return GL_ONE_MINUS_SRC_ALPHA;
+	case BlendFactor::DST_ALPHA:			return GL_DST_ALPHA;
+	case BlendFactor::ONE_MINUS_DST_ALPHA:	return GL_ONE_MINUS_DST_ALPHA;
+
+	default:
+		{
+			Error( "BlendFactorToGL: Invalid blend factor \"%d\"\n", factor );
+			return GL_ONE;
+		}
+	}
+}
+
+GLenum CompareFuncToGL( const CompareFunc func )
+{
+	switch( func )
+	{
+	case CompareFunc::NEVER:	return GL_NEVER;
+	case CompareFunc::LESS:		return GL_LESS;
+	case CompareFunc::EQUAL:	return GL_EQUAL;
+	case CompareFunc::LEQUAL:	return GL_LEQUAL;
+	case CompareFunc::GREATER:	return GL_GREATER;
+	case CompareFunc::NOTEQUAL:	return GL_NOTEQUAL;
+	case CompareFunc::GEQUAL:	return GL_GEQUAL;
+	case CompareFunc::ALWAYS:	return GL_ALWAYS;
+
+	default:
+		{
+			Error( "CompareFuncToGL: Invalid compare function \"%d\"\n", func );
+			return GL_ALWAYS;
+		}
+	}
+}
+
 void CBaseGLRenderContext::Viewport( int iX, int iY, int iWidth, int iHeight )
 {
 	glViewport( iX, iY, iWidth, iHeight );
@@ -105,6 +163,95 @@ void CBaseGLRenderContext::Clear( const ClearBits_t bits )
 	glClear( mask );
 }
 
+bool CBaseGLRenderContext::CountStateChange( const bool bChanged )
+{
+	static auto& issued = stats::Registry().GetCounter( "renderer.state_changes_issued" );
+	static auto& filtered = stats::Registry().GetCounter( "renderer.state_changes_filtered" );
+
+	if( bChanged )
+	{
+		++m_StateStats.uiIssued;
+		issued.Add();
+	}
+	else
+	{
+		++m_StateStats.uiFiltered;
+		filtered.Add();
+	}
+
+	return bChanged;
+}
+
+void CBaseGLRenderContext::InvalidateState()
+{
+	m_BlendEnabled.bKnown = false;
+	m_BlendFunc.bKnown = false;
+
+	m_DepthTestEnabled.bKnown = false;
+	m_DepthMask.bKnown = false;
+	m_DepthFunc.bKnown = false;
+
+	m_AlphaTestEnabled.bKnown = false;
+	m_AlphaFunc.bKnown = false;
+
+	m_CullFaceEnabled.bKnown = false;
+	m_CullFace.bKnown = false;
+	m_FrontFace.bKnown = false;
+
+	m_PolygonMode.bKnown = false;
+
+	m_Texture2DEnabled.bKnown = false;
+	m_BoundTexture.bKnown = false;
+}
+
+void CBaseGLRenderContext::SetBlendEnabled( const bool bEnabled )
+{
+	if( CountStateChange( m_BlendEnabled.Update( bEnabled ) ) )
+		SetCapability( GL_BLEND, bEnabled );
+}
+
+void CBaseGLRenderContext::SetBlendFunc( const BlendFactor src, const BlendFactor dst )
+{
+	if( CountStateChange( m_BlendFunc.Update( std::make_pair( src, dst ) ) ) )
+		glBlendFunc( BlendFactorToGL( src ), BlendFactorToGL( dst ) );
+}
+
+void CBaseGLRenderContext::SetDepthTestEnabled( const bool bEnabled )
+{
+	if( CountStateChange( m_DepthTestEnabled.Update( bEnabled ) ) )
+		SetCapability( GL_DEPTH_TEST, bEnabled );
+}
+
+void CBaseGLRenderContext::SetDepthMask( const bool bWrite )
+{
+	if( CountStateChange( m_DepthMask.Update( bWrite ) ) )
+		glDepthMask( bWrite ? GL_TRUE : GL_FALSE );
+}
+
+void CBaseGLRenderContext::SetDepthFunc( const CompareFunc func )
+{
+	if( CountStateChange( m_DepthFunc.Update( func ) ) )
+		glDepthFunc( CompareFuncToGL( func ) );
+}
+
+void CBaseGLRenderContext::SetAlphaTestEnabled( const bool bEnabled )
+{
+	if( CountStateChange( m_AlphaTestEnabled.Update( bEnabled ) ) )
+		SetCapability( GL_ALPHA_TEST, bEnabled );
+}
+
+void CBaseGLRenderContext::SetAlphaFunc( const CompareFunc func, const float flRef )
+{
+	if( CountStateChange( m_AlphaFunc.Update( std::make_pair( func, flRef ) ) ) )
+		glAlphaFunc( CompareFuncToGL( func ), flRef );
+}
+
+void CBaseGLRenderContext::SetCullFaceEnabled( const bool bEnabled )
+{
+	if( CountStateChange( m_CullFaceEnabled.Update( bEnabled ) ) )
+		SetCapability( GL_CULL_FACE, bEnabled );
+}
+
 void CBaseGLRenderContext::SetCullFace( const CullFace cullFace )
 {
 	GLenum mode;
@@ -136,7 +283,55 @@ void CBaseGLRenderContext::SetCullFace( const CullFace cullFace )
 		}
 	}
 
-	glCullFace( mode );
+	if( CountStateChange( m_CullFace.Update( cullFace ) ) )
+		glCullFace( mode );
+}
+
+void CBaseGLRenderContext::SetFrontFace( const FrontFace frontFace )
+{
+	if( CountStateChange( m_FrontFace.Update( frontFace ) ) )
+		glFrontFace( frontFace == FrontFace::CW ? GL_CW : GL_CCW );
+}
+
+void CBaseGLRenderContext::SetPolygonMode( const PolygonMode mode )
+{
+	GLenum glMode;
+
+	switch( mode )
+	{
+	case PolygonMode::POINT:
+		{
+			glMode = GL_POINT;
+			break;
+		}
+
+	case PolygonMode::LINE:
+		{
+			glMode = GL_LINE;
+			break;
+		}
+
+	case PolygonMode::FILL:
+		{
+			glMode = GL_FILL;
+			break;
+		}
+
+	default:
+		{
+			Error( "CBaseGLRenderContext::SetPolygonMode: Invalid mode \"%d\" specified!\n", mode );
+			return;
+		}
+	}
+
+	if( CountStateChange( m_PolygonMode.Update( mode ) ) )
+		glPolygonMode( GL_FRONT_AND_BACK, glMode );
+}
+
+void CBaseGLRenderContext::SetTexture2DEnabled( const bool bEnabled )
+{
+	if( CountStateChange( m_Texture2DEnabled.Update( bEnabled ) ) )
+		SetCapability( GL_TEXTURE_2D, bEnabled );
 }
 
 ReadBuffer CBaseGLRenderContext::GetReadBuffer() const
@@ -172,6 +367,8 @@ HTexture_t CBaseGLRenderContext::CreateTexture( const int mipmaps, const ImageFo
 
 	glBindTexture( GL_TEXTURE_2D, texture );
 
+	m_BoundTexture.Update( GLToTexHandle( texture ) );
+
 	glTexImage2D( GL_TEXTURE_2D, mipmaps, imageFormat, iWidth, iHeight, 0, imageFormat, GL_UNSIGNED_BYTE, pData );
 
 	//TODO: error handling.
@@ -191,11 +388,16 @@ void CBaseGLRenderContext::DestroyTexture( HTexture_t hTexture )
 	GLuint tex = TexHandleToGL( hTexture );
 
 	glDeleteTextures( 1, &tex );
+
+	//Deleting the bound texture reverts the binding to the default texture.
+	if( m_BoundTexture.bKnown && m_BoundTexture.value == hTexture )
+		m_BoundTexture.value = NULL_TEXTURE_HANDLE;
 }
 
 void CBaseGLRenderContext::BindTexture( HTexture_t hTexture )
 {
-	glBindTexture( GL_TEXTURE_2D, TexHandleToGL( hTexture ) );
+	if( CountStateChange( m_BoundTexture.Update( hTexture ) ) )
+		glBindTexture( GL_TEXTURE_2D, TexHandleToGL( hTexture ) );
 }
 
 void CBaseGLRenderContext::SetMinMagFilters( const MinFilter min, const MagFilter mag )
@@ -203,4 +405,124 @@ void CBaseGLRenderContext::SetMinMagFilters( const MinFilter min, const MagFilte
 	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, MinFilterToGL( min ) );
 	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, MagFilterToGL( mag ) );
 }
-}
\ No newline at end of file
+
+void CBaseGLRenderContext::SubmitCommands( const CRenderCommandBuffer* const* ppBuffers, const size_t uiNumBuffers )
+{
+	PROF_ZONE( "CBaseGLRenderContext::SubmitCommands" );
+
+	static auto& commandsSubmitted = stats::Registry().GetCounter( "renderer.commands_submitted" );
+
+	m_SubmitOrder.clear();
+
+	for( uint32_t uiBuffer = 0; uiBuffer < uiNumBuffers; ++uiBuffer )
+	{
+		const auto& commands = ppBuffers[ uiBuffer ]->GetCommands();
+
+		for( uint32_t uiCommand = 0; uiCommand < commands.size(); ++uiCommand )
+		{
+			const auto& command = commands[ uiCommand ];
+
+			if( command.uiNumVertices == 0 )
+				continue;
+
+			//Only solid commands are sorted by state; the stable sort keeps the others in recorded order.
+			const uint64_t uiKey = command.layer == RenderLayer::SOLID ? command.state.GetSortKey() : 0;
+
+			m_SubmitOrder.push_back( SubmitEntry_t{ command.layer, uiKey, uiBuffer, uiCommand } );
+		}
+	}
+
+	if( m_SubmitOrder.empty() )
+		return;
+
+	std::stable_sort( m_SubmitOrder.begin(), m_SubmitOrder.end(),
+		[]( const SubmitEntry_t& lhs, const SubmitEntry_t& rhs )
+		{
+			if( lhs.layer != rhs.layer )
+				return lhs.layer < rhs.layer;
+
+			return lhs.uiKey < rhs.uiKey;
+		}
+	);
+
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+	glEnableClientState( GL_COLOR_ARRAY );
+
+	glPushMatrix();
+
+	const CRenderCommandBuffer* pCurrentBuffer = nullptr;
+	const Mat4x4* pCurrentMatrix = nullptr;
+
+	for( const auto& entry : m_SubmitOrder )
+	{
+		const CRenderCommandBuffer* const pBuffer = ppBuffers[ entry.uiBuffer ];
+
+		const auto& command = pBuffer->GetCommands()[ entry.uiCommand ];
+
+		if( pBuffer != pCurrentBuffer )
+		{
+			const RenderVertex_t* const pVertices = pBuffer->GetVertices().data();
+
+			glVertexPointer( 3, GL_FLOAT, sizeof( RenderVertex_t ), glm::value_ptr( pVertices->vecPosition ) );
+			glTexCoordPointer( 2, GL_FLOAT, sizeof( RenderVertex_t ), glm::value_ptr( pVertices->vecTexCoord ) );
+			glColorPointer( 4, GL_FLOAT, sizeof( RenderVertex_t ), glm::value_ptr( pVertices->vecColor ) );
+
+			pCurrentBuffer = pBuffer;
+			pCurrentMatrix = nullptr;
+		}
+
+		const Mat4x4& matrix = pBuffer->GetMatrices()[ command.uiMatrix ];
+
+		if( &matrix != pCurrentMatrix )
+		{
+			glPopMatrix();
+			glPushMatrix();
+			glMultMatrixf( glm::value_ptr( matrix ) );
+
+			pCurrentMatrix = &matrix;
+		}
+
+		ApplyState( command.state );
+
+		glDrawArrays( GL_TRIANGLES, command.uiFirstVertex, command.uiNumVertices );
+	}
+
+	glPopMatrix();
+
+	glDisableClientState( GL_COLOR_ARRAY );
+	glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+	glDisableClientState( GL_VERTEX_ARRAY );
+
+	commandsSubmitted.Add( m_SubmitOrder.size() );
+
+	PROF_COUNTER( "Render commands", m_SubmitOrder.size() );
+}
+
+void CBaseGLRenderContext::ApplyState( const RenderState_t& state )
+{
+	SetPolygonMode( state.polygonMode );
+
+	SetBlendEnabled( state.bBlend );
+
+	if( state.bBlend )
+		SetBlendFunc( state.blendSrc, state.blendDst );
+
+	SetDepthTestEnabled( state.bDepthTest );
+	SetDepthMask( state.bDepthMask );
+	SetDepthFunc( state.depthFunc );
+
+	SetAlphaTestEnabled( state.bAlphaTest );
+
+	if( state.bAlphaTest )
+		SetAlphaFunc( state.alphaFunc, state.flAlphaRef );
+
+	SetCullFaceEnabled( state.bCullFace );
+	SetCullFace( state.cullFace );
+
+	SetTexture2DEnabled( state.bTexture2D );
+
+	if( state.bTexture2D )
+		BindTexture( state.hTexture );
+}
+}
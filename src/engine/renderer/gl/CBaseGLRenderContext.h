@@ -1,8 +1,13 @@
 #ifndef ENGINE_RENDERER_GL_CBASEGLRENDERCONTEXT_H
 #define ENGINE_RENDERER_GL_CBASEGLRENDERCONTEXT_H
 
+#include <utility>
+#include <vector>
+
 #include "engine/renderer/CBaseRenderContext.h"
 
+#include "engine/shared/renderer/CRenderCommandBuffer.h"
+
 #include "graphics/OpenGL.h"
 
 namespace renderer
@@ -23,6 +28,14 @@ GLenum MinFilterToGL( const MinFilter min );
 
 GLenum MagFilterToGL( const MagFilter mag );
 
+GLenum BlendFactorToGL( const BlendFactor factor );
+
+GLenum CompareFuncToGL( const CompareFunc func );
+
+/**
+*	Base class for OpenGL render contexts.
+*	Keeps a shadow copy of the render state it sets, so redundant state changes never reach the driver.
+*/
 class CBaseGLRenderContext : public CBaseRenderContext
 {
 public:
@@ -39,8 +52,36 @@ public:
 
 	void Clear( const ClearBits_t bits ) override;
 
+	void InvalidateState() override;
+
+	RenderStateStats_t GetStateStats() const override { return m_StateStats; }
+
+	void ResetStateStats() override { m_StateStats = RenderStateStats_t(); }
+
+	void SetBlendEnabled( const bool bEnabled ) override;
+
+	void SetBlendFunc( const BlendFactor src, const BlendFactor dst ) override;
+
+	void SetDepthTestEnabled( const bool bEnabled ) override;
+
+	void SetDepthMask( const bool bWrite ) override;
+
+	void SetDepthFunc( const CompareFunc func ) override;
+
+	void SetAlphaTestEnabled( const bool bEnabled ) override;
+
+	void SetAlphaFunc( const CompareFunc func, const float flRef ) override;
+
+	void SetCullFaceEnabled( const bool bEnabled ) override;
+
 	void SetCullFace( const CullFace cullFace ) override;
 
+	void SetFrontFace( const FrontFace frontFace ) override;
+
+	void SetPolygonMode( const PolygonMode mode ) override;
+
+	void SetTexture2DEnabled( const bool bEnabled ) override;
+
 	ReadBuffer GetReadBuffer() const override;
 
 	void SetReadBuffer( const ReadBuffer buffer ) override;
@@ -55,7 +96,85 @@ public:
 
 	void SetMinMagFilters( const MinFilter min, const MagFilter mag ) override;
 
+	void SubmitCommands( const CRenderCommandBuffer* const* ppBuffers, const size_t uiNumBuffers ) override;
+
+private:
+	/**
+	*	Cached value of a piece of render state. The value is unknown until it is first set.
+	*/
+	template<typename T>
+	struct CachedState_t
+	{
+		T value{};
+		bool bKnown = false;
+
+		/**
+		*	Stores a new value.
+		*	@return Whether the value changed.
+		*/
+		bool Update( const T& newValue )
+		{
+			if( bKnown && value == newValue )
+				return false;
+
+			value = newValue;
+			bKnown = true;
+
+			return true;
+		}
+	};
+
+	/**
+	*	Counts a state change.
+	*	@param bChanged Whether the state changed.
+	*	@return bChanged.
+	*/
+	bool CountStateChange( const bool bChanged );
+
+	/**
+	*	Sets the state used by a recorded command.
+	*/
+	void ApplyState( const RenderState_t& state );
+
+private:
+	/**
+	*	Command to submit, and the key it is sorted by.
+	*/
+	struct SubmitEntry_t
+	{
+		RenderLayer layer;
+		uint64_t uiKey;
+
+		uint32_t uiBuffer;
+		uint32_t uiCommand;
+	};
+
 private:
+	CachedState_t<bool> m_BlendEnabled;
+	CachedState_t<std::pair<BlendFactor, BlendFactor>> m_BlendFunc;
+
+	CachedState_t<bool> m_DepthTestEnabled;
+	CachedState_t<bool> m_DepthMask;
+	CachedState_t<CompareFunc> m_DepthFunc;
+
+	CachedState_t<bool> m_AlphaTestEnabled;
+	CachedState_t<std::pair<CompareFunc, float>> m_AlphaFunc;
+
+	CachedState_t<bool> m_CullFaceEnabled;
+	CachedState_t<CullFace> m_CullFace;
+	CachedState_t<FrontFace> m_FrontFace;
+
+	CachedState_t<PolygonMode> m_PolygonMode;
+
+	CachedState_t<bool> m_Texture2DEnabled;
+	CachedState_t<HTexture_t> m_BoundTexture;
+
+	RenderStateStats_t m_StateStats;
+
+	/**
+	*	Kept around to avoid reallocating it for every submission.
+	*/
+	std::vector<SubmitEntry_t> m_SubmitOrder;
 };
 }
 
@@ -13,6 +13,8 @@
 
 #include "engine/shared/sprite/sprite.h"
 
+#include "engine/renderer/gl/imode/CRenderContextIMode.h"
+
 #include "CSpriteRenderer.h"
 
 namespace sprite
@@ -22,6 +24,7 @@ REGISTER_SINGLE_INTERFACE( ISPRITERENDERER_NAME, CSpriteRenderer );
 const float CSpriteRenderer::DEFAULT_FRAMERATE = 10;
 
 CSpriteRenderer::CSpriteRenderer()
+	: m_pRenderContext( renderer::GLIModeContext() )
 {
 }
 
@@ -172,9 +175,9 @@ void CSpriteRenderer::DrawSprite( const glm::vec3& vecOrigin, const glm::vec2& v
 		pFrame = pGroup->frames[ iIndex ];
 	}
 
-	glEnable( GL_TEXTURE_2D );
+	m_pRenderContext->SetTexture2DEnabled( true );
 	glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
-	glBindTexture( GL_TEXTURE_2D, pFrame->gl_texturenum );
+	m_pRenderContext->BindTexture( renderer::GLToTexHandle( pFrame->gl_texturenum ) );
 
 	//TODO: set up the sprite's orientation in the world according to its type.
 	//TODO: the size of the sprite should change based on its distance from the viewer.
@@ -187,44 +190,44 @@ void CSpriteRenderer::DrawSprite( const glm::vec3& vecOrigin, const glm::vec2& v
 	case TexFormat::SPR_NORMAL:
 		{
 			glTexEnvi( GL_TEXTURE_2D, GL_TEXTURE_ENV_MODE, GL_MODULATE );
-			glDisable( GL_BLEND );
+			m_pRenderContext->SetBlendEnabled( false );
 			break;
 		}
 
 	case TexFormat::SPR_ADDITIVE:
 		{
-			glEnable( GL_BLEND );
-			glBlendFunc( GL_SRC_ALPHA, GL_ONE );
+			m_pRenderContext->SetBlendEnabled( true );
+			m_pRenderContext->SetBlendFunc( renderer::BlendFactor::SRC_ALPHA, renderer::BlendFactor::ONE );
 			break;
 		}
 
 	case TexFormat::SPR_INDEXALPHA:
 	case TexFormat::SPR_ALPHTEST:
 		{
-			glEnable( GL_BLEND );
-			glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+			m_pRenderContext->SetBlendEnabled( true );
+			m_pRenderContext->SetBlendFunc( renderer::BlendFactor::SRC_ALPHA, renderer::BlendFactor::ONE_MINUS_SRC_ALPHA );
 			break;
 		}
 	}
 
 	if( texFormat == TexFormat::SPR_ALPHTEST )
 	{
-		glEnable( GL_ALPHA_TEST );
-		glAlphaFunc( GL_GREATER, 0.0f );
+		m_pRenderContext->SetAlphaTestEnabled( true );
+		m_pRenderContext->SetAlphaFunc( renderer::CompareFunc::GREATER, 0.0f );
 	}
 	else
 	{
-		glDisable( GL_ALPHA_TEST );
+		m_pRenderContext->SetAlphaTestEnabled( false );
 	}
 
 	const glm::vec4 vecRect{ vecOrigin.x - vecSize.x / 2, vecOrigin.y - vecSize.y / 2, vecOrigin.x + vecSize.x / 2, vecOrigin.y + vecSize.y / 2 };
 
 	if( !( flags & renderer::DrawFlag::NODRAW ) )
 	{
-		glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
-		glEnable( GL_TEXTURE_2D );
-		glEnable( GL_CULL_FACE );
-		glEnable( GL_DEPTH_TEST );
+		m_pRenderContext->SetPolygonMode( renderer::PolygonMode::FILL );
+		m_pRenderContext->SetTexture2DEnabled( true );
+		m_pRenderContext->SetCullFaceEnabled( true );
+		m_pRenderContext->SetDepthTestEnabled( true );
 		glShadeModel( GL_SMOOTH );
 		glColor4f( 1, 1, 1, 1 );
 
@@ -247,10 +250,10 @@ void CSpriteRenderer::DrawSprite( const glm::vec3& vecOrigin, const glm::vec2& v
 
 	if( flags & renderer::DrawFlag::WIREFRAME_OVERLAY )
 	{
-		glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
-		glDisable( GL_TEXTURE_2D );
-		glDisable( GL_CULL_FACE );
-		glDisable( GL_DEPTH_TEST );
+		m_pRenderContext->SetPolygonMode( renderer::PolygonMode::LINE );
+		m_pRenderContext->SetTexture2DEnabled( false );
+		m_pRenderContext->SetCullFaceEnabled( false );
+		m_pRenderContext->SetDepthTestEnabled( false );
 		glColor4f( 1, 1, 1, 1 );
 
 		glBegin( GL_TRIANGLE_STRIP );
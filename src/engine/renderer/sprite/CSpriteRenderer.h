@@ -5,6 +5,7 @@
 #include <glm/vec3.hpp>
 
 #include "engine/shared/renderer/DrawConstants.h"
+#include "engine/shared/renderer/IRenderContext.h"
 
 #include "engine/shared/renderer/sprite/ISpriteRenderer.h"
 
@@ -35,6 +36,12 @@ private:
 					 const msprite_t* pSprite, const float flFrame, 
 					 const renderer::DrawFlags_t flags, const sprite::Type::Type* pTypeOverride = nullptr, const sprite::TexFormat::TexFormat* pTexFormatOverride = nullptr );
 
+private:
+	/**
+	*	Context used to set render state.
+	*/
+	renderer::IRenderContext* m_pRenderContext;
+
 private:
 	CSpriteRenderer( const CSpriteRenderer& ) = delete;
 	CSpriteRenderer& operator=( const CSpriteRenderer& ) = delete;
@@ -1,8 +1,13 @@
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include <algorithm>
+#include <cassert>
+#include <tuple>
 
 #include "shared/Logging.h"
+#include "shared/Profiler.h"
+#include "shared/Stats.h"
 
 #include "lib/LibInterface.h"
 
@@ -11,7 +16,12 @@
 
 #include "graphics/GraphicsUtils.h"
 
+#include "engine/renderer/gl/imode/CRenderContextIMode.h"
+
 #include "shared/studiomodel/CStudioModel.h"
+#include "shared/studiomodel/StudioPose.h"
+#include "shared/studiomodel/StudioSkinning.h"
+#include "shared/renderer/studiomodel/CStudioModelPoseCache.h"
 #include "shared/renderer/studiomodel/IStudioModelRendererListener.h"
 #include "StudioSorting.h"
 
@@ -33,9 +43,68 @@ DEFINE_COLOR_CVAR( , r_wireframecolor, 255, 0, 0, "Wireframe overlay color", cva
 
 namespace studiomdl
 {
+namespace
+{
+/**
+*	Body part of a group of instances.
+*/
+struct InstanceBodyPart_t
+{
+	CStudioModel::BatchGeometry_t* pGeometry;
+
+	/**
+	*	Index of the first vertex of the first instance. The vertices of each instance follow each other.
+	*/
+	size_t uiFirstVertex;
+};
+
+/**
+*	Binds the element buffer of a submodel, making sure it holds indices for at least the given number of instances.
+*	@param indices Scratch buffer used to build the indices.
+*/
+void BindInstanceIndices( CStudioModel::BatchGeometry_t& geometry, const size_t uiNumInstances, std::vector<uint32_t>& indices )
+{
+	if( !geometry.indexBuffer )
+		glGenBuffers( 1, &geometry.indexBuffer );
+
+	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, geometry.indexBuffer );
+
+	if( geometry.uiIndexBufferInstances >= uiNumInstances )
+		return;
+
+	//Grow in steps so the buffer isn't rebuilt every time an instance is added.
+	const size_t uiInstances = std::max( uiNumInstances, geometry.uiIndexBufferInstances * 2 );
+
+	const uint32_t uiNumVertices = static_cast<uint32_t>( geometry.vertices.size() );
+
+	indices.resize( geometry.indices.size() * uiInstances );
+
+	uint32_t* pIndex = indices.data();
+
+	//The indices of each mesh are repeated for every instance, so all instances of a mesh can be drawn with one call.
+	for( const auto& mesh : geometry.meshes )
+	{
+		for( size_t uiInstance = 0; uiInstance < uiInstances; ++uiInstance )
+		{
+			const uint32_t uiOffset = static_cast<uint32_t>( uiInstance ) * uiNumVertices;
+
+			for( uint32_t uiIndex = mesh.uiFirstIndex; uiIndex < mesh.uiFirstIndex + mesh.uiNumIndices; ++uiIndex )
+			{
+				*pIndex++ = geometry.indices[ uiIndex ] + uiOffset;
+			}
+		}
+	}
+
+	glBufferData( GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof( uint32_t ), indices.data(), GL_STATIC_DRAW );
+
+	geometry.uiIndexBufferInstances = uiInstances;
+}
+}
+
 REGISTER_SINGLE_INTERFACE( ISTUDIOMODELRENDERER_NAME, CStudioModelRenderer );
 
 CStudioModelRenderer::CStudioModelRenderer()
+	: m_pRenderContext( renderer::GLIModeContext() )
 {
 }
 
@@ -46,6 +115,7 @@ CStudioModelRenderer::~CStudioModelRenderer()
 bool CStudioModelRenderer::Initialize()
 {
 	m_uiModelsDrawnCount = 0;
+	m_uiChromeAge = 0;
 
 	m_uiDrawnPolygonsCount = 0;
 
@@ -62,55 +132,21 @@ void CStudioModelRenderer::RunFrame()
 
 unsigned int CStudioModelRenderer::DrawModel( studiomdl::CModelRenderInfo* const pRenderInfo, const renderer::DrawFlags_t flags )
 {
-	if( !pRenderInfo )
-	{
-		Error( "CStudioModelRenderer::DrawModel: Called with null render info!\n" );
-		return 0;
-	}
+	PROF_ZONE( "CStudioModelRenderer::DrawModel" );
 
-	m_pRenderInfo = pRenderInfo;
-
-	if( pRenderInfo->pModel )
-	{
-		m_pStudioHdr = pRenderInfo->pModel->GetStudioHeader();
-		m_pTextureHdr = pRenderInfo->pModel->GetTextureHeader();
-	}
-	else
-	{
-		Error( "CStudioModelRenderer::DrawModel: Called with null model!\n" );
+	if( !SetUpRenderInfo( pRenderInfo, "DrawModel" ) )
 		return 0;
-	}
 
 	++m_uiModelsDrawnCount; // render data cache cookie
 
-	m_pxformverts = &m_xformverts[ 0 ];
-	m_pvlightvalues = &m_lightvalues[ 0 ];
-
 	if( m_pStudioHdr->numbodyparts == 0 )
 		return 0;
 
 	glPushMatrix();
 
-	auto origin = m_pRenderInfo->vecOrigin;
-
-	//The game applies a 1 unit offset to make view models look nicer
-	//See https://github.com/ValveSoftware/halflife/blob/c76dd531a79a176eef7cdbca5a80811123afbbe2/cl_dll/view.cpp#L665-L668
-	if( flags & renderer::DrawFlag::IS_VIEW_MODEL )
-	{
-		origin.z -= 1;
-	}
-
-	glTranslatef( origin[ 0 ], origin[ 1 ], origin[ 2 ] );
+	glMultMatrixf( glm::value_ptr( GetModelMatrix( flags ) ) );
 
-	glRotatef( m_pRenderInfo->vecAngles[ 1 ], 0, 0, 1 );
-	glRotatef( m_pRenderInfo->vecAngles[ 0 ], 0, 1, 0 );
-	glRotatef( m_pRenderInfo->vecAngles[ 2 ], 1, 0, 0 );
-
-	glScalef( m_pRenderInfo->vecScale.x, m_pRenderInfo->vecScale.y, m_pRenderInfo->vecScale.z );
-
-	SetUpBones();
-
-	SetupLighting();
+	SetUpPose();
 
 	unsigned int uiDrawnPolys = 0;
 
@@ -130,10 +166,10 @@ unsigned int CStudioModelRenderer::DrawModel( studiomdl::CModelRenderInfo* const
 	if( flags & renderer::DrawFlag::WIREFRAME_OVERLAY )
 	{
 		//TODO: restore render mode after this? - Solokiller
-		glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
-		glDisable( GL_TEXTURE_2D );
-		glDisable( GL_CULL_FACE );
-		glEnable( GL_DEPTH_TEST );
+		m_pRenderContext->SetPolygonMode( renderer::PolygonMode::LINE );
+		m_pRenderContext->SetTexture2DEnabled( false );
+		m_pRenderContext->SetCullFaceEnabled( false );
+		m_pRenderContext->SetDepthTestEnabled( true );
 
 		for( int i = 0; i < m_pStudioHdr->numbodyparts; i++ )
 		{
@@ -177,17 +213,373 @@ unsigned int CStudioModelRenderer::DrawModel( studiomdl::CModelRenderInfo* const
 
 	m_uiDrawnPolygonsCount += uiDrawnPolys;
 
+	PROF_COUNTER( "Studio model polygons", uiDrawnPolys );
+
+	static auto& modelsDrawn = stats::Registry().GetCounter( "renderer.models_drawn" );
+	static auto& polygonsDrawn = stats::Registry().GetCounter( "renderer.polygons_drawn" );
+
+	modelsDrawn.Add();
+	polygonsDrawn.Add( uiDrawnPolys );
+
+	return uiDrawnPolys;
+}
+
+unsigned int CStudioModelRenderer::DrawModelInstances( CModelRenderInfo* const* ppRenderInfos, const size_t uiCount, const renderer::DrawFlags_t flags )
+{
+	PROF_ZONE( "CStudioModelRenderer::DrawModelInstances" );
+
+	//Overlays and listeners work on one model at a time.
+	const bool bDrawSeparately =
+		( flags & ( renderer::DrawFlag::NODRAW | renderer::DrawFlag::WIREFRAME_OVERLAY ) ) ||
+		m_pListener ||
+		g_ShowBones.GetBool() ||
+		g_ShowAttachments.GetBool() ||
+		g_ShowEyePosition.GetBool() ||
+		g_ShowHitboxes.GetBool() ||
+		g_ShowStudioNormals.GetBool();
+
+	unsigned int uiDrawnPolys = 0;
+
+	m_Instances.clear();
+
+	for( size_t uiIndex = 0; uiIndex < uiCount; ++uiIndex )
+	{
+		CModelRenderInfo* const pRenderInfo = ppRenderInfos[ uiIndex ];
+
+		//Only validated models have batch geometry. DrawModel also reports invalid render infos.
+		if( bDrawSeparately || !pRenderInfo || !pRenderInfo->pModel || !pRenderInfo->pModel->IsValidated() )
+			uiDrawnPolys += DrawModel( pRenderInfo, flags );
+		else if( pRenderInfo->flTransparency > 0.0f )
+			m_Instances.push_back( pRenderInfo );
+	}
+
+	auto getGroup = []( const CModelRenderInfo* pRenderInfo )
+	{
+		return std::make_tuple( pRenderInfo->pModel, pRenderInfo->iSkin, pRenderInfo->iBodygroup, pRenderInfo->flTransparency < 1.0f );
+	};
+
+	std::sort( m_Instances.begin(), m_Instances.end(),
+		[ & ]( const CModelRenderInfo* pLHS, const CModelRenderInfo* pRHS )
+		{
+			return getGroup( pLHS ) < getGroup( pRHS );
+		}
+	);
+
+	for( size_t uiFirst = 0; uiFirst < m_Instances.size(); )
+	{
+		size_t uiEnd = uiFirst + 1;
+
+		while( uiEnd < m_Instances.size() && getGroup( m_Instances[ uiEnd ] ) == getGroup( m_Instances[ uiFirst ] ) )
+			++uiEnd;
+
+		uiDrawnPolys += DrawInstanceGroup( m_Instances.data() + uiFirst, uiEnd - uiFirst, flags );
+
+		uiFirst = uiEnd;
+	}
+
+	return uiDrawnPolys;
+}
+
+unsigned int CStudioModelRenderer::DrawInstanceGroup( CModelRenderInfo* const* ppRenderInfos, const size_t uiCount, const renderer::DrawFlags_t flags )
+{
+	PROF_ZONE( "CStudioModelRenderer::DrawInstanceGroup" );
+
+	CStudioModel* const pStudioModel = ppRenderInfos[ 0 ]->pModel;
+
+	const studiohdr_t* const pStudioHdr = pStudioModel->GetStudioHeader();
+	const studiohdr_t* const pTextureHdr = pStudioModel->GetTextureHeader();
+
+	const int iNumBodyParts = pStudioHdr->numbodyparts;
+
+	if( iNumBodyParts == 0 )
+		return 0;
+
+	InstanceBodyPart_t bodyParts[ MAXSTUDIOBODYPARTS ];
+
+	size_t uiNumVertices = 0;
+
+	//All instances use the same submodels. The vertices of each body part are stored together, one instance after the other.
+	for( int iBodyPart = 0; iBodyPart < iNumBodyParts; ++iBodyPart )
+	{
+		auto& bodyPart = bodyParts[ iBodyPart ];
+
+		bodyPart.pGeometry = pStudioModel->GetBatchGeometry( iBodyPart, pStudioModel->GetModelByBodyPart( ppRenderInfos[ 0 ]->iBodygroup, iBodyPart ) );
+		bodyPart.uiFirstVertex = uiNumVertices;
+
+		assert( bodyPart.pGeometry );
+
+		uiNumVertices += bodyPart.pGeometry->vertices.size() * uiCount;
+	}
+
+	m_InstanceVertices.resize( uiNumVertices );
+
+	const mstudiotexture_t* const ptexture = pTextureHdr->GetTextures();
+
+	const short* pskinref = pTextureHdr->GetSkins();
+
+	if( ppRenderInfos[ 0 ]->iSkin != 0 && ppRenderInfos[ 0 ]->iSkin < pTextureHdr->numskinfamilies )
+		pskinref += ( ppRenderInfos[ 0 ]->iSkin * pTextureHdr->numskinref );
+
+	//Pose, skin and light each instance, and store its vertices in world space so all instances can be drawn together.
+	for( size_t uiInstance = 0; uiInstance < uiCount; ++uiInstance )
+	{
+		SetUpRenderInfo( ppRenderInfos[ uiInstance ], "DrawModelInstances" );
+
+		++m_uiModelsDrawnCount; // render data cache cookie
+
+		SetUpPose();
+
+		const Mat4x4 matrix = GetModelMatrix( flags );
+
+		for( int iBodyPart = 0; iBodyPart < iNumBodyParts; ++iBodyPart )
+		{
+			const auto& bodyPart = bodyParts[ iBodyPart ];
+			const auto& geometry = *bodyPart.pGeometry;
+
+			SetupModel( iBodyPart );
+			SetupVertices( ptexture, pskinref, nullptr );
+
+			renderer::RenderVertex_t* pVertex = m_InstanceVertices.data() + bodyPart.uiFirstVertex + uiInstance * geometry.vertices.size();
+
+			for( const auto& mesh : geometry.meshes )
+			{
+				const mstudiotexture_t& texture = ptexture[ pskinref[ mesh.pMesh->skinref ] ];
+
+				const float s = 1.0f / ( float ) texture.width;
+				const float t = 1.0f / ( float ) texture.height;
+
+				for( uint32_t uiVertex = mesh.uiFirstVertex; uiVertex < mesh.uiFirstVertex + mesh.uiNumVertices; ++uiVertex, ++pVertex )
+				{
+					const auto& vertex = geometry.vertices[ uiVertex ];
+
+					pVertex->vecPosition = glm::vec3( matrix * glm::vec4( m_pxformverts[ vertex.iVertex ], 1.0f ) );
+
+					if( texture.flags & STUDIO_NF_CHROME )
+					{
+						pVertex->vecTexCoord = glm::vec2( m_pchrome[ vertex.iNormal ][ 0 ] * s, m_pchrome[ vertex.iNormal ][ 1 ] * t );
+					}
+					else
+					{
+						pVertex->vecTexCoord = glm::vec2( vertex.s * s, vertex.t * t );
+					}
+
+					if( texture.flags & STUDIO_NF_ADDITIVE )
+					{
+						pVertex->vecColor = glm::vec4( 1.0f, 1.0f, 1.0f, m_pRenderInfo->flTransparency );
+					}
+					else
+					{
+						pVertex->vecColor = glm::vec4( m_pvlightvalues[ vertex.iNormal ], m_pRenderInfo->flTransparency );
+					}
+				}
+			}
+		}
+	}
+
+	unsigned int uiDrawnPolys = 0;
+
+	//Polygons may overlap, so make sure they can blend together. - Solokiller
+	m_pRenderContext->SetDepthFunc( renderer::CompareFunc::LEQUAL );
+
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+	glEnableClientState( GL_COLOR_ARRAY );
+
+	for( int iBodyPart = 0; iBodyPart < iNumBodyParts; ++iBodyPart )
+	{
+		auto& geometry = *bodyParts[ iBodyPart ].pGeometry;
+
+		if( geometry.meshes.empty() || geometry.indices.empty() )
+			continue;
+
+		BindInstanceIndices( geometry, uiCount, m_InstanceIndices );
+
+		const renderer::RenderVertex_t* const pVertices = m_InstanceVertices.data() + bodyParts[ iBodyPart ].uiFirstVertex;
+
+		glVertexPointer( 3, GL_FLOAT, sizeof( renderer::RenderVertex_t ), glm::value_ptr( pVertices->vecPosition ) );
+		glTexCoordPointer( 2, GL_FLOAT, sizeof( renderer::RenderVertex_t ), glm::value_ptr( pVertices->vecTexCoord ) );
+		glColorPointer( 4, GL_FLOAT, sizeof( renderer::RenderVertex_t ), glm::value_ptr( pVertices->vecColor ) );
+
+		SortedMesh_t meshes[ MAXSTUDIOMESHES ];
+
+		const int iNumMeshes = static_cast<int>( geometry.meshes.size() );
+
+		for( int j = 0; j < iNumMeshes; ++j )
+		{
+			meshes[ j ].pMesh = const_cast<mstudiomesh_t*>( geometry.meshes[ j ].pMesh );
+			meshes[ j ].flags = ptexture[ pskinref[ geometry.meshes[ j ].pMesh->skinref ] ].flags;
+		}
+
+		//Same order as DrawPoints.
+		std::stable_sort( meshes, meshes + iNumMeshes, CompareSortedMeshes );
+
+		for( int j = 0; j < iNumMeshes; ++j )
+		{
+			const auto& mesh = geometry.meshes[ meshes[ j ].pMesh - geometry.meshes[ 0 ].pMesh ];
+
+			if( mesh.uiNumIndices == 0 )
+				continue;
+
+			SetupMeshState( ptexture[ pskinref[ mesh.pMesh->skinref ] ] );
+
+			m_pRenderContext->BindTexture( renderer::GLToTexHandle( pStudioModel->GetTextureId( pskinref[ mesh.pMesh->skinref ] ) ) );
+
+			//The indices of all instances of a mesh follow each other.
+			glDrawElements( GL_TRIANGLES, static_cast<GLsizei>( mesh.uiNumIndices * uiCount ), GL_UNSIGNED_INT,
+							reinterpret_cast<const void*>( sizeof( uint32_t ) * mesh.uiFirstIndex * geometry.uiIndexBufferInstances ) );
+
+			uiDrawnPolys += ( mesh.uiNumIndices / 3 ) * uiCount;
+		}
+	}
+
+	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+
+	glDisableClientState( GL_COLOR_ARRAY );
+	glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+	glDisableClientState( GL_VERTEX_ARRAY );
+
+	//Leave alpha testing disabled for other draw calls.
+	m_pRenderContext->SetAlphaTestEnabled( false );
+	m_pRenderContext->SetDepthMask( true );
+
+	m_uiDrawnPolygonsCount += uiDrawnPolys;
+
+	PROF_COUNTER( "Studio model polygons", uiDrawnPolys );
+
+	static auto& modelsDrawn = stats::Registry().GetCounter( "renderer.models_drawn" );
+	static auto& polygonsDrawn = stats::Registry().GetCounter( "renderer.polygons_drawn" );
+	static auto& instanceGroups = stats::Registry().GetCounter( "renderer.instance_groups" );
+
+	modelsDrawn.Add( uiCount );
+	polygonsDrawn.Add( uiDrawnPolys );
+	instanceGroups.Add();
+
+	return uiDrawnPolys;
+}
+
+unsigned int CStudioModelRenderer::RecordModel( studiomdl::CModelRenderInfo* const pRenderInfo, renderer::CRenderCommandBuffer& commands,
+												 const renderer::RenderState_t& baseState, const renderer::DrawFlags_t flags )
+{
+	PROF_ZONE( "CStudioModelRenderer::RecordModel" );
+
+	if( !SetUpRenderInfo( pRenderInfo, "RecordModel" ) )
+		return 0;
+
+	++m_uiModelsDrawnCount; // render data cache cookie
+
+	if( m_pStudioHdr->numbodyparts == 0 )
+		return 0;
+
+	commands.SetMatrix( GetModelMatrix( flags ) );
+
+	SetUpPose();
+
+	unsigned int uiDrawnPolys = 0;
+
+	if( !( flags & renderer::DrawFlag::NODRAW ) )
+	{
+		for( int i = 0; i < m_pStudioHdr->numbodyparts; i++ )
+		{
+			SetupModel( i );
+			if( m_pRenderInfo->flTransparency > 0.0f )
+				uiDrawnPolys += RecordPoints( commands, baseState, false );
+		}
+	}
+
+	if( flags & renderer::DrawFlag::WIREFRAME_OVERLAY )
+	{
+		renderer::RenderState_t wireframeState = baseState;
+
+		wireframeState.polygonMode = renderer::PolygonMode::LINE;
+		wireframeState.bTexture2D = false;
+		wireframeState.bCullFace = false;
+		wireframeState.bDepthTest = true;
+
+		for( int i = 0; i < m_pStudioHdr->numbodyparts; i++ )
+		{
+			SetupModel( i );
+			if( m_pRenderInfo->flTransparency > 0.0f )
+				uiDrawnPolys += RecordPoints( commands, wireframeState, true );
+		}
+	}
+
+	m_uiDrawnPolygonsCount += uiDrawnPolys;
+
+	PROF_COUNTER( "Studio model polygons", uiDrawnPolys );
+
+	static auto& modelsDrawn = stats::Registry().GetCounter( "renderer.models_drawn" );
+	static auto& polygonsDrawn = stats::Registry().GetCounter( "renderer.polygons_drawn" );
+
+	modelsDrawn.Add();
+	polygonsDrawn.Add( uiDrawnPolys );
+
 	return uiDrawnPolys;
 }
 
+bool CStudioModelRenderer::SetUpRenderInfo( CModelRenderInfo* const pRenderInfo, const char* const pszFunction )
+{
+	if( !pRenderInfo )
+	{
+		Error( "CStudioModelRenderer::%s: Called with null render info!\n", pszFunction );
+		return false;
+	}
+
+	m_pRenderInfo = pRenderInfo;
+	if( pRenderInfo->pPoseCache )
+	{
+		m_pPoseCache = pRenderInfo->pPoseCache;
+	}
+	else
+	{
+		m_pPoseCache = &m_LocalPoseCache;
+		m_pPoseCache->Invalidate();
+	}
+
+	if( pRenderInfo->pModel )
+	{
+		m_pStudioHdr = pRenderInfo->pModel->GetStudioHeader();
+		m_pTextureHdr = pRenderInfo->pModel->GetTextureHeader();
+	}
+	else
+	{
+		Error( "CStudioModelRenderer::%s: Called with null model!\n", pszFunction );
+		return false;
+	}
+
+	//Models are validated on load; offsets and indices read from the headers below are trusted.
+	assert( pRenderInfo->pModel->IsValidated() );
+
+	return true;
+}
+
+Mat4x4 CStudioModelRenderer::GetModelMatrix( const renderer::DrawFlags_t flags ) const
+{
+	auto origin = m_pRenderInfo->vecOrigin;
+
+	//The game applies a 1 unit offset to make view models look nicer
+	//See https://github.com/ValveSoftware/halflife/blob/c76dd531a79a176eef7cdbca5a80811123afbbe2/cl_dll/view.cpp#L665-L668
+	if( flags & renderer::DrawFlag::IS_VIEW_MODEL )
+	{
+		origin.z -= 1;
+	}
+
+	Mat4x4 matrix = glm::translate( Mat4x4( 1.0f ), origin );
+
+	matrix = glm::rotate( matrix, glm::radians( m_pRenderInfo->vecAngles[ 1 ] ), glm::vec3( 0, 0, 1 ) );
+	matrix = glm::rotate( matrix, glm::radians( m_pRenderInfo->vecAngles[ 0 ] ), glm::vec3( 0, 1, 0 ) );
+	matrix = glm::rotate( matrix, glm::radians( m_pRenderInfo->vecAngles[ 2 ] ), glm::vec3( 1, 0, 0 ) );
+
+	return glm::scale( matrix, m_pRenderInfo->vecScale );
+}
+
 void CStudioModelRenderer::DrawSingleBone( const int iBone )
 {
 	if( !m_pStudioHdr || iBone < 0 || iBone >= m_pStudioHdr->numbones )
 		return;
 
 	const mstudiobone_t* const pbones = m_pStudioHdr->GetBones();
-	glDisable( GL_TEXTURE_2D );
-	glDisable( GL_DEPTH_TEST );
+	m_pRenderContext->SetTexture2DEnabled( false );
+	m_pRenderContext->SetDepthTestEnabled( false );
 
 	if( pbones[ iBone ].parent >= 0 )
 	{
@@ -223,9 +615,9 @@ void CStudioModelRenderer::DrawSingleAttachment( const int iAttachment )
 	if( !m_pStudioHdr || iAttachment < 0 || iAttachment >= m_pStudioHdr->numattachments )
 		return;
 
-	glDisable( GL_TEXTURE_2D );
-	glDisable( GL_CULL_FACE );
-	glDisable( GL_DEPTH_TEST );
+	m_pRenderContext->SetTexture2DEnabled( false );
+	m_pRenderContext->SetCullFaceEnabled( false );
+	m_pRenderContext->SetDepthTestEnabled( false );
 
 	mstudioattachment_t *pattachments = m_pStudioHdr->GetAttachments();
 	glm::vec3 v[ 4 ];
@@ -259,8 +651,8 @@ void CStudioModelRenderer::DrawSingleAttachment( const int iAttachment )
 void CStudioModelRenderer::DrawBones()
 {
 	const mstudiobone_t* const pbones = m_pStudioHdr->GetBones();
-	glDisable( GL_TEXTURE_2D );
-	glDisable( GL_DEPTH_TEST );
+	m_pRenderContext->SetTexture2DEnabled( false );
+	m_pRenderContext->SetDepthTestEnabled( false );
 
 	for( int i = 0; i < m_pStudioHdr->numbones; i++ )
 	{
@@ -296,9 +688,9 @@ void CStudioModelRenderer::DrawBones()
 
 void CStudioModelRenderer::DrawAttachments()
 {
-	glDisable( GL_TEXTURE_2D );
-	glDisable( GL_CULL_FACE );
-	glDisable( GL_DEPTH_TEST );
+	m_pRenderContext->SetTexture2DEnabled( false );
+	m_pRenderContext->SetCullFaceEnabled( false );
+	m_pRenderContext->SetDepthTestEnabled( false );
 
 	for( int i = 0; i < m_pStudioHdr->numattachments; i++ )
 	{
@@ -334,9 +726,9 @@ void CStudioModelRenderer::DrawAttachments()
 
 void CStudioModelRenderer::DrawEyePosition()
 {
-	glDisable( GL_TEXTURE_2D );
-	glDisable( GL_CULL_FACE );
-	glDisable( GL_DEPTH_TEST );
+	m_pRenderContext->SetTexture2DEnabled( false );
+	m_pRenderContext->SetCullFaceEnabled( false );
+	m_pRenderContext->SetDepthTestEnabled( false );
 
 	glPointSize( 7 );
 	glColor3f( 1, 0, 1 );
@@ -348,18 +740,15 @@ void CStudioModelRenderer::DrawEyePosition()
 
 void CStudioModelRenderer::DrawHitBoxes()
 {
-	glDisable( GL_TEXTURE_2D );
-	glDisable( GL_CULL_FACE );
-	if( m_pRenderInfo->flTransparency < 1.0f )
-		glDisable( GL_DEPTH_TEST );
-	else
-		glEnable( GL_DEPTH_TEST );
+	m_pRenderContext->SetTexture2DEnabled( false );
+	m_pRenderContext->SetCullFaceEnabled( false );
+	m_pRenderContext->SetDepthTestEnabled( m_pRenderInfo->flTransparency >= 1.0f );
 
 	glColor4f( 1, 0, 0, 0.5f );
 
-	glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
-	glEnable( GL_BLEND );
-	glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	m_pRenderContext->SetPolygonMode( renderer::PolygonMode::LINE );
+	m_pRenderContext->SetBlendEnabled( true );
+	m_pRenderContext->SetBlendFunc( renderer::BlendFactor::SRC_ALPHA, renderer::BlendFactor::ONE_MINUS_SRC_ALPHA );
 
 	for( int i = 0; i < m_pStudioHdr->numhitboxes; i++ )
 	{
@@ -416,7 +805,7 @@ void CStudioModelRenderer::DrawHitBoxes()
 
 void CStudioModelRenderer::DrawNormals()
 {
-	glDisable( GL_TEXTURE_2D );
+	m_pRenderContext->SetTexture2DEnabled( false );
 
 	glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
 	glBegin( GL_LINES );
@@ -425,15 +814,10 @@ void CStudioModelRenderer::DrawNormals()
 	{
 		SetupModel( iBodyPart );
 
-		auto pvertbone = ( const byte* ) ( m_pStudioHdr->GetData() + m_pModel->vertinfoindex );
-		auto pnormbone = ( const byte* ) ( m_pStudioHdr->GetData() + m_pModel->norminfoindex );
 		auto ptexture = m_pTextureHdr->GetTextures();
 
 		auto pMeshes = ( const mstudiomesh_t* ) ( m_pStudioHdr->GetData() + m_pModel->meshindex );
 
-		auto pstudioverts = ( const glm::vec3* ) ( m_pStudioHdr->GetData() + m_pModel->vertindex );
-		auto pstudionorms = ( const glm::vec3* ) ( m_pStudioHdr->GetData() + m_pModel->normindex );
-
 		auto pskinref = m_pTextureHdr->GetSkins();
 
 		const int iSkinNum = m_pRenderInfo->iSkin;
@@ -441,38 +825,12 @@ void CStudioModelRenderer::DrawNormals()
 		if( iSkinNum != 0 && iSkinNum < m_pTextureHdr->numskinfamilies )
 			pskinref += ( iSkinNum * m_pTextureHdr->numskinref );
 
-		for( int i = 0; i < m_pModel->numverts; i++ )
-		{
-			VectorTransform( pstudioverts[ i ], m_bonetransform[ pvertbone[ i ] ], m_pxformverts[ i ] );
-		}
-
-		//
-		// clip and draw all triangles
-		//
-
-		glm::vec3* lv = m_pvlightvalues;
+		SetupVertices( ptexture, pskinref, nullptr );
 
 		for( int j = 0; j < m_pModel->nummesh; j++ )
 		{
-			int flags = ptexture[ pskinref[ pMeshes[ j ].skinref ] ].flags;
-
-			for( int i = 0; i < pMeshes[ j ].numnorms; i++, ++lv, ++pstudionorms, pnormbone++ )
-			{
-				Lighting( *lv, *pnormbone, flags, *pstudionorms );
-
-				// FIX: move this check out of the inner loop
-				if( flags & STUDIO_NF_CHROME )
-					Chrome( m_chrome[ reinterpret_cast<glm::vec3*>( lv ) - m_pvlightvalues ], *pnormbone, *pstudionorms );
-			}
-		}
-
-		//Reset
-		pstudionorms = ( const glm::vec3* ) ( m_pStudioHdr->GetData() + m_pModel->normindex );
-
-		for( int j = 0; j < m_pModel->nummesh; j++ )
-		{
-			auto& mesh = pMeshes[ j ];
-			auto ptricmds = ( const short* ) ( m_pStudioHdr->GetData() + mesh.triindex );
+			auto& mesh = pMeshes[ j ];
+			auto ptricmds = ( const short* ) ( m_pStudioHdr->GetData() + mesh.triindex );
 
 			const mstudiotexture_t& texture = ptexture[ pskinref[ mesh.skinref ] ];
 
@@ -546,298 +904,109 @@ void CStudioModelRenderer::DrawNormals()
 	glEnd();
 }
 
-void CStudioModelRenderer::SetUpBones()
+void CStudioModelRenderer::SetUpPose()
 {
-	static glm::vec3 pos[ MAXSTUDIOBONES ];
-	static glm::vec4 q[ MAXSTUDIOBONES ];
-					 
-	static glm::vec3 pos2[ MAXSTUDIOBONES ];
-	static glm::vec4 q2[ MAXSTUDIOBONES ];
-	static glm::vec3 pos3[ MAXSTUDIOBONES ];
-	static glm::vec4 q3[ MAXSTUDIOBONES ];
-	static glm::vec3 pos4[ MAXSTUDIOBONES ];
-	static glm::vec4 q4[ MAXSTUDIOBONES ];
-
 	if( m_pRenderInfo->iSequence >= m_pStudioHdr->numseq )
 	{
 		m_pRenderInfo->iSequence = 0;
 	}
 
-	mstudioseqdesc_t* const pseqdesc = m_pStudioHdr->GetSequence( m_pRenderInfo->iSequence );
-
-	const mstudioanim_t* panim = m_pRenderInfo->pModel->GetAnim( pseqdesc );
-
-	CalcRotations( pos, q, pseqdesc, panim, m_pRenderInfo->flFrame );
-
-	if( pseqdesc->numblends > 1 )
-	{
-		panim += m_pStudioHdr->numbones;
-		CalcRotations( pos2, q2, pseqdesc, panim, m_pRenderInfo->flFrame );
-		float s = m_pRenderInfo->iBlender[ 0 ] / 255.0;
+	SetupLighting();
 
-		SlerpBones( q, pos, q2, pos2, s );
+	static auto& cacheHits = stats::Registry().GetCounter( "renderer.pose_cache_hits" );
+	static auto& cacheMisses = stats::Registry().GetCounter( "renderer.pose_cache_misses" );
 
-		if( pseqdesc->numblends == 4 )
-		{
-			panim += m_pStudioHdr->numbones;
-			CalcRotations( pos3, q3, pseqdesc, panim, m_pRenderInfo->flFrame );
+	PoseCacheKey_t key;
 
-			panim += m_pStudioHdr->numbones;
-			CalcRotations( pos4, q4, pseqdesc, panim, m_pRenderInfo->flFrame );
+	key.pModel = m_pRenderInfo->pModel;
+	key.iSequence = m_pRenderInfo->iSequence;
+	key.flFrame = m_pRenderInfo->flFrame;
+	key.iBodygroup = m_pRenderInfo->iBodygroup;
+	key.iSkin = m_pRenderInfo->iSkin;
 
-			s = m_pRenderInfo->iBlender[ 0 ] / 255.0;
-			SlerpBones( q3, pos3, q4, pos4, s );
+	memcpy( key.iBlender, m_pRenderInfo->iBlender, sizeof( key.iBlender ) );
+	memcpy( key.iController, m_pRenderInfo->iController, sizeof( key.iController ) );
 
-			s = m_pRenderInfo->iBlender[ 1 ] / 255.0;
-			SlerpBones( q, pos, q3, pos3, s );
-		}
-	}
+	key.iMouth = m_pRenderInfo->iMouth;
 
-	const mstudiobone_t* const pbones = m_pStudioHdr->GetBones();
+	key.vecLightVector = m_lightvec;
+	key.vecLightColor = glm::vec3( m_lightcolor.GetRed(), m_lightcolor.GetGreen(), m_lightcolor.GetBlue() );
+	key.flLambert = m_flLambert;
 
-	glm::mat3x4 bonematrix;
+	auto& cache = *m_pPoseCache;
 
-	for( int i = 0; i < m_pStudioHdr->numbones; i++ )
+	if( cache.bValid && cache.key == key && cache.iNumBones == m_pStudioHdr->numbones )
 	{
-		QuaternionMatrix( q[ i ], bonematrix );
+		cacheHits.Add();
 
-		bonematrix[ 0 ][ 3 ] = pos[ i ][ 0 ];
-		bonematrix[ 1 ][ 3 ] = pos[ i ][ 1 ];
-		bonematrix[ 2 ][ 3 ] = pos[ i ][ 2 ];
+		memcpy( m_bonetransform, cache.boneTransforms, sizeof( glm::mat3x4 ) * cache.iNumBones );
+		memcpy( m_blightvec, cache.boneLightVectors, sizeof( glm::vec3 ) * cache.iNumBones );
 
-		if( pbones[ i ].parent == -1 )
-		{
-			m_bonetransform[ i ] = bonematrix;
-		}
-		else
-		{
-			R_ConcatTransforms( m_bonetransform[ pbones[ i ].parent ], bonematrix, m_bonetransform[ i ] );
-		}
+		return;
 	}
-}
 
-void CStudioModelRenderer::CalcRotations( glm::vec3* pos, glm::vec4* q, const mstudioseqdesc_t* const pseqdesc, const mstudioanim_t* panim, const float f )
-{
-	const int frame = ( int ) f;
-	const float s = ( f - frame );
+	cacheMisses.Add();
 
-	// add in programatic controllers
-	CalcBoneAdj();
+	SetUpBones();
+	SetupBoneLighting();
 
-	auto pbone = m_pStudioHdr->GetBones();
+	cache.bValid = true;
+	cache.key = key;
+	cache.iNumBones = m_pStudioHdr->numbones;
 
-	for( int i = 0; i < m_pStudioHdr->numbones; i++, pbone++, panim++ )
-	{
-		CalcBoneQuaternion( frame, s, pbone, panim, q[ i ] );
-		CalcBonePosition( frame, s, pbone, panim, pos[ i ] );
-	}
+	memcpy( cache.boneTransforms, m_bonetransform, sizeof( glm::mat3x4 ) * cache.iNumBones );
+	memcpy( cache.boneLightVectors, m_blightvec, sizeof( glm::vec3 ) * cache.iNumBones );
 
-	if( pseqdesc->motiontype & STUDIO_X )
-		pos[ pseqdesc->motionbone ][ 0 ] = 0.0;
-	if( pseqdesc->motiontype & STUDIO_Y )
-		pos[ pseqdesc->motionbone ][ 1 ] = 0.0;
-	if( pseqdesc->motiontype & STUDIO_Z )
-		pos[ pseqdesc->motionbone ][ 2 ] = 0.0;
-}
-
-void CStudioModelRenderer::CalcBoneAdj()
-{
-	const auto* const pbonecontroller = m_pStudioHdr->GetBoneControllers();
+	//Vertices are transformed again when each body part is drawn. Keep the buffers around to avoid reallocating them.
+	cache.bodyParts.resize( m_pStudioHdr->numbodyparts );
 
-	for( int j = 0; j < m_pStudioHdr->numbonecontrollers; j++ )
+	for( auto& bodyPart : cache.bodyParts )
 	{
-		const auto i = pbonecontroller[ j ].index;
-
-		float value;
-
-		if( i <= 3 )
-		{
-			// check for 360% wrapping
-			if( pbonecontroller[ j ].type & STUDIO_RLOOP )
-			{
-				value = m_pRenderInfo->iController[ i ] * ( 360.0 / 256.0 ) + pbonecontroller[ j ].start;
-			}
-			else
-			{
-				value = m_pRenderInfo->iController[ i ] / 255.0;
-				if( value < 0 ) value = 0;
-				if( value > 1.0 ) value = 1.0;
-				value = ( 1.0 - value ) * pbonecontroller[ j ].start + value * pbonecontroller[ j ].end;
-			}
-			// Con_DPrintf( "%d %d %f : %f\n", m_controller[j], m_prevcontroller[j], value, dadt );
-		}
-		else
-		{
-			value = m_pRenderInfo->iMouth / 64.0;
-			if( value > 1.0 ) value = 1.0;
-			value = ( 1.0 - value ) * pbonecontroller[ j ].start + value * pbonecontroller[ j ].end;
-			// Con_DPrintf("%d %f\n", mouthopen, value );
-		}
-		switch( pbonecontroller[ j ].type & STUDIO_TYPES )
-		{
-		case STUDIO_XR:
-		case STUDIO_YR:
-		case STUDIO_ZR:
-			m_Adj[ j ] = value * ( Q_PI / 180.0 );
-			break;
-		case STUDIO_X:
-		case STUDIO_Y:
-		case STUDIO_Z:
-			m_Adj[ j ] = value;
-			break;
-		}
+		bodyPart.pModel = nullptr;
 	}
 }
 
-void CStudioModelRenderer::CalcBoneQuaternion( const int frame, const float s, const mstudiobone_t* const pbone, const mstudioanim_t* const panim, glm::vec4& q )
+void CStudioModelRenderer::SetUpBones()
 {
-	glm::vec3			angle1, angle2;
+	PROF_ZONE( "CStudioModelRenderer::SetUpBones" );
 
-	for( int j = 0; j < 3; j++ )
-	{
-		if( panim->offset[ j + 3 ] == 0 )
-		{
-			angle2[ j ] = angle1[ j ] = pbone->value[ j + 3 ]; // default;
-		}
-		else
-		{
-			auto panimvalue = ( const mstudioanimvalue_t* ) ( ( const byte* ) panim + panim->offset[ j + 3 ] );
-			auto k = frame;
-			while( panimvalue->num.total <= k )
-			{
-				k -= panimvalue->num.total;
-				panimvalue += panimvalue->num.valid + 1;
-			}
-			// Bah, missing blend!
-			if( panimvalue->num.valid > k )
-			{
-				angle1[ j ] = panimvalue[ k + 1 ].value;
-
-				if( panimvalue->num.valid > k + 1 )
-				{
-					angle2[ j ] = panimvalue[ k + 2 ].value;
-				}
-				else
-				{
-					if( panimvalue->num.total > k + 1 )
-						angle2[ j ] = angle1[ j ];
-					else
-						angle2[ j ] = panimvalue[ panimvalue->num.valid + 2 ].value;
-				}
-			}
-			else
-			{
-				angle1[ j ] = panimvalue[ panimvalue->num.valid ].value;
-				if( panimvalue->num.total > k + 1 )
-				{
-					angle2[ j ] = angle1[ j ];
-				}
-				else
-				{
-					angle2[ j ] = panimvalue[ panimvalue->num.valid + 2 ].value;
-				}
-			}
-			angle1[ j ] = pbone->value[ j + 3 ] + angle1[ j ] * pbone->scale[ j + 3 ];
-			angle2[ j ] = pbone->value[ j + 3 ] + angle2[ j ] * pbone->scale[ j + 3 ];
-		}
+	mstudioseqdesc_t* const pseqdesc = m_pStudioHdr->GetSequence( m_pRenderInfo->iSequence );
 
-		if( pbone->bonecontroller[ j + 3 ] != -1 )
-		{
-			angle1[ j ] += m_Adj[ pbone->bonecontroller[ j + 3 ] ];
-			angle2[ j ] += m_Adj[ pbone->bonecontroller[ j + 3 ] ];
-		}
-	}
+	const mstudioanim_t* panim = m_pRenderInfo->pModel->GetAnim( pseqdesc );
 
-	if( !VectorCompare( angle1, angle2 ) )
-	{
-		glm::vec4 q1, q2;
+	// add in programatic controllers
+	CalcBoneAdj( *m_pStudioHdr, m_pRenderInfo->iController, m_pRenderInfo->iMouth, m_Adj );
 
-		AngleQuaternion( angle1, q1 );
-		AngleQuaternion( angle2, q2 );
-		QuaternionSlerp( q1, q2, s, q );
-	}
-	else
+	//The sequence's group is still loading.
+	if( !panim )
 	{
-		AngleQuaternion( angle1, q );
+		SetUpBindPoseTransforms( *m_pStudioHdr, m_Adj, m_bonetransform );
 	}
-}
-
-void CStudioModelRenderer::CalcBonePosition( const int frame, const float s, const mstudiobone_t* const pbone, const mstudioanim_t* const panim, glm::vec3& pos )
-{
-	for( int j = 0; j < 3; j++ )
+	//Only evaluate the channels that change, if the model has been analyzed.
+	else if( auto pChannels = m_pRenderInfo->pModel->GetSequenceChannels( m_pRenderInfo->iSequence ) )
 	{
-		pos[ j ] = pbone->value[ j ]; // default;
-		if( panim->offset[ j ] != 0 )
-		{
-			auto panimvalue = ( mstudioanimvalue_t * ) ( ( byte * ) panim + panim->offset[ j ] );
-
-			auto k = frame;
-			// find span of values that includes the frame we want
-			while( panimvalue->num.total <= k )
-			{
-				k -= panimvalue->num.total;
-				panimvalue += panimvalue->num.valid + 1;
-			}
-			// if we're inside the span
-			if( panimvalue->num.valid > k )
-			{
-				// and there's more data in the span
-				if( panimvalue->num.valid > k + 1 )
-				{
-					pos[ j ] += ( panimvalue[ k + 1 ].value * ( 1.0 - s ) + s * panimvalue[ k + 2 ].value ) * pbone->scale[ j ];
-				}
-				else
-				{
-					pos[ j ] += panimvalue[ k + 1 ].value * pbone->scale[ j ];
-				}
-			}
-			else
-			{
-				// are we at the end of the repeating values section and there's another section with data?
-				if( panimvalue->num.total <= k + 1 )
-				{
-					pos[ j ] += ( panimvalue[ panimvalue->num.valid ].value * ( 1.0 - s ) + s * panimvalue[ panimvalue->num.valid + 2 ].value ) * pbone->scale[ j ];
-				}
-				else
-				{
-					pos[ j ] += panimvalue[ panimvalue->num.valid ].value * pbone->scale[ j ];
-				}
-			}
-		}
-		if( pbone->bonecontroller[ j ] != -1 )
-		{
-			pos[ j ] += m_Adj[ pbone->bonecontroller[ j ] ];
-		}
+		SetUpBoneTransforms( *m_pStudioHdr, *pseqdesc, panim, m_pRenderInfo->flFrame, m_pRenderInfo->iBlender, m_Adj, *pChannels, m_bonetransform );
 	}
-}
-
-void CStudioModelRenderer::SlerpBones( glm::vec4* q1, glm::vec3* pos1, glm::vec4* q2, glm::vec3* pos2, float s )
-{
-	glm::vec4 q3;
-
-	if( s < 0 ) s = 0;
-	else if( s > 1.0 ) s = 1.0;
-
-	const float s1 = 1.0 - s;
-
-	for( int i = 0; i < m_pStudioHdr->numbones; i++ )
+	else
 	{
-		QuaternionSlerp( q1[ i ], q2[ i ], s, q3 );
-		q1[ i ] = q3;
-
-		pos1[ i ] = pos1[ i ] * s1 + pos2[ i ] * s;
+		SetUpBoneTransforms( *m_pStudioHdr, *pseqdesc, panim, m_pRenderInfo->flFrame, m_pRenderInfo->iBlender, m_Adj, m_bonetransform );
 	}
 }
 
 void CStudioModelRenderer::SetupLighting()
 {
+	PROF_ZONE( "CStudioModelRenderer::SetupLighting" );
+
 	m_ambientlight = 32;
 	m_shadelight = 192;
 
 	m_lightcolor[ 0 ] = r_lighting_r.GetInt();
 	m_lightcolor[ 1 ] = r_lighting_g.GetInt();
 	m_lightcolor[ 2 ] = r_lighting_b.GetInt();
+}
 
+void CStudioModelRenderer::SetupBoneLighting()
+{
 	for( int i = 0; i < m_pStudioHdr->numbones; i++ )
 	{
 		VectorIRotate( m_lightvec, m_bonetransform[ i ], m_blightvec[ i ] );
@@ -846,75 +1015,148 @@ void CStudioModelRenderer::SetupLighting()
 
 void CStudioModelRenderer::SetupModel( int bodypart )
 {
-	if( bodypart > m_pStudioHdr->numbodyparts )
-	{
-		// Con_DPrintf ("CStudioModelRenderer::SetupModel: no such bodypart %d\n", bodypart);
-		bodypart = 0;
-	}
+	assert( bodypart >= 0 && bodypart < m_pStudioHdr->numbodyparts );
 
 	m_pModel = m_pRenderInfo->pModel->GetModelByBodyPart( m_pRenderInfo->iBodygroup, bodypart );
+	m_iBodyPart = bodypart;
 }
 
-unsigned int CStudioModelRenderer::DrawPoints( const bool bWireframe )
+void CStudioModelRenderer::SetupVertices( const mstudiotexture_t* ptexture, const short* pskinref, SortedMesh_t* pMeshes )
 {
-	unsigned int uiDrawnPolys = 0;
+	auto pmesh = ( mstudiomesh_t* ) ( ( byte* ) m_pStudioHdr + m_pModel->meshindex );
 
-	auto pvertbone = ( ( byte * ) m_pStudioHdr + m_pModel->vertinfoindex );
-	auto pnormbone = ( ( byte * ) m_pStudioHdr + m_pModel->norminfoindex );
-	auto ptexture = m_pTextureHdr->GetTextures();
+	auto& cached = m_pPoseCache->bodyParts[ m_iBodyPart ];
 
-	auto pmesh = ( mstudiomesh_t * ) ( ( byte * ) m_pStudioHdr + m_pModel->meshindex );
+	bool bUseCached = cached.pModel == m_pModel;
 
-	auto pstudioverts = ( const glm::vec3* ) ( ( const byte* ) m_pStudioHdr + m_pModel->vertindex );
-	auto pstudionorms = ( const glm::vec3* ) ( ( const byte* ) m_pStudioHdr + m_pModel->normindex );
+	for( int j = 0; j < m_pModel->nummesh; ++j )
+	{
+		const int flags = ptexture[ pskinref[ pmesh[ j ].skinref ] ].flags;
 
-	auto pskinref = m_pTextureHdr->GetSkins();
+		if( pMeshes )
+		{
+			pMeshes[ j ].pMesh = &pmesh[ j ];
+			pMeshes[ j ].flags = flags;
+		}
 
-	if( m_pRenderInfo->iSkin != 0 && m_pRenderInfo->iSkin < m_pTextureHdr->numskinfamilies )
-		pskinref += ( m_pRenderInfo->iSkin * m_pTextureHdr->numskinref );
+		//Texture flags affect lighting; they can be changed at any time.
+		if( bUseCached && cached.meshFlags[ j ] != flags )
+			bUseCached = false;
+	}
 
-	for( int i = 0; i < m_pModel->numverts; i++ )
+	if( !bUseCached )
 	{
-		VectorTransform( pstudioverts[ i ], m_bonetransform[ pvertbone[ i ] ], m_pxformverts[ i ] );
+		cached.pModel = m_pModel;
+		cached.xformVerts.resize( m_pModel->numverts );
+		cached.lightValues.resize( m_pModel->numnorms );
+		cached.meshFlags.resize( m_pModel->nummesh );
+		cached.chrome.resize( m_pModel->numnorms );
+		cached.bChromeValid = false;
 	}
 
-	SortedMesh_t meshes[ MAXSTUDIOMESHES ];
+	const bool bUseCachedChrome = cached.bChromeValid
+		&& cached.vecChromeViewerOrigin == m_vecViewerOrigin
+		&& cached.vecChromeViewerRight == m_vecViewerRight;
 
-	//
-	// clip and draw all triangles
-	//
+	m_pxformverts = cached.xformVerts.data();
+	m_pvlightvalues = cached.lightValues.data();
+	m_pchrome = cached.chrome.data();
+
+	if( bUseCached && bUseCachedChrome )
+		return;
+
+	auto pnormbone = ( ( const byte* ) m_pStudioHdr + m_pModel->norminfoindex );
+	auto pstudionorms = ( const glm::vec3* ) ( ( const byte* ) m_pStudioHdr + m_pModel->normindex );
+
+	if( !bUseCached )
+	{
+		auto pvertbone = ( ( const byte* ) m_pStudioHdr + m_pModel->vertinfoindex );
+		auto pstudioverts = ( const glm::vec3* ) ( ( const byte* ) m_pStudioHdr + m_pModel->vertindex );
+
+		TransformVertices( pstudioverts, pvertbone, m_pModel->numverts, m_bonetransform, m_pxformverts );
+	}
+
+	const SkinningKernel kernel = GetBestSkinningKernel();
+
+	LightingParams_t lighting;
 
-	glm::vec3* lv = m_pvlightvalues;
+	lighting.flAmbient = std::max( 0.1f, ( float ) m_ambientlight / 255.0f ); // to avoid divison by zero
+	lighting.flShade = m_shadelight / 255.0f;
+	lighting.flLambert = std::max( 1.0f, m_flLambert );
+	lighting.vecLightColor = glm::vec3( m_lightcolor.GetRed() / 255.0f, m_lightcolor.GetGreen() / 255.0f, m_lightcolor.GetBlue() / 255.0f );
+
+	int iNorm = 0;
+
+	//Each mesh is lit and chrome mapped with the kernel for its flags.
 	for( int j = 0; j < m_pModel->nummesh; j++ )
 	{
-		int flags = ptexture[ pskinref[ pmesh[ j ].skinref ] ].flags;
+		const int flags = ptexture[ pskinref[ pmesh[ j ].skinref ] ].flags;
 
-		meshes[ j ].pMesh = &pmesh[ j ];
-		meshes[ j ].flags = flags;
+		const int iNumNorms = pmesh[ j ].numnorms;
 
-		for( int i = 0; i < pmesh[ j ].numnorms; i++, ++lv, ++pstudionorms, pnormbone++ )
+		if( !bUseCached )
 		{
-			Lighting( *lv, *pnormbone, flags, *pstudionorms );
+			cached.meshFlags[ j ] = flags;
 
-			// FIX: move this check out of the inner loop
-			if( flags & STUDIO_NF_CHROME )
-				Chrome( m_chrome[ reinterpret_cast<glm::vec3*>( lv ) - m_pvlightvalues ], *pnormbone, *pstudionorms );
+			if( flags & STUDIO_NF_FULLBRIGHT )
+			{
+				LightNormalsFullbright( iNumNorms, m_pvlightvalues + iNorm );
+			}
+			else if( flags & STUDIO_NF_FLATSHADE )
+			{
+				LightNormalsFlat( lighting, iNumNorms, m_pvlightvalues + iNorm );
+			}
+			else
+			{
+				LightNormals( kernel, lighting, pstudionorms + iNorm, pnormbone + iNorm, iNumNorms, m_blightvec, m_pvlightvalues + iNorm );
+			}
 		}
+
+		if( ( flags & STUDIO_NF_CHROME ) && !bUseCachedChrome )
+		{
+			//The chrome basis of every bone is computed once per draw, the first time a mesh needs it.
+			if( m_uiChromeAge != m_uiModelsDrawnCount )
+			{
+				SetupChromeVectors( m_pStudioHdr->numbones, m_bonetransform, m_vecViewerOrigin, m_vecViewerRight, m_chromeup, m_chromeright );
+
+				m_uiChromeAge = m_uiModelsDrawnCount;
+			}
+
+			ComputeChrome( kernel, pstudionorms + iNorm, pnormbone + iNorm, iNumNorms, m_chromeup, m_chromeright, m_pchrome + iNorm );
+		}
+
+		iNorm += iNumNorms;
 	}
 
-	//Sort meshes by render modes so additive meshes are drawn after solid meshes.
-	//Masked meshes are drawn before solid meshes.
-	std::stable_sort( meshes, meshes + m_pModel->nummesh, CompareSortedMeshes );
+	cached.bChromeValid = true;
+	cached.vecChromeViewerOrigin = m_vecViewerOrigin;
+	cached.vecChromeViewerRight = m_vecViewerRight;
+}
+
+unsigned int CStudioModelRenderer::DrawPoints( const bool bWireframe )
+{
+	PROF_ZONE( "CStudioModelRenderer::DrawPoints" );
+
+	unsigned int uiDrawnPolys = 0;
+
+	const mstudiotexture_t* ptexture;
+	const short* pskinref;
+
+	SortedMesh_t meshes[ MAXSTUDIOMESHES ];
+
+	SetupMeshes( meshes, ptexture, pskinref );
 
 	uiDrawnPolys += DrawMeshes( bWireframe, meshes, ptexture, pskinref );
 
-	glDepthMask( GL_TRUE );
+	m_pRenderContext->SetDepthMask( true );
 
 	return uiDrawnPolys;
 }
 
 unsigned int CStudioModelRenderer::DrawMeshes( const bool bWireframe, const SortedMesh_t* pMeshes, const mstudiotexture_t* pTextures, const short* pSkinRef )
 {
+	PROF_ZONE( "CStudioModelRenderer::DrawMeshes" );
+
 	//Set here since it never changes. Much more efficient.
 	if( bWireframe )
 		glColor4f( r_wireframecolor_r.GetFloat() / 255.0f,
@@ -925,7 +1167,7 @@ unsigned int CStudioModelRenderer::DrawMeshes( const bool bWireframe, const Sort
 	unsigned int uiDrawnPolys = 0;
 
 	//Polygons may overlap, so make sure they can blend together. - Solokiller
-	glDepthFunc( GL_LEQUAL );
+	m_pRenderContext->SetDepthFunc( renderer::CompareFunc::LEQUAL );
 
 	for( int j = 0; j < m_pModel->nummesh; j++ )
 	{
@@ -937,33 +1179,11 @@ unsigned int CStudioModelRenderer::DrawMeshes( const bool bWireframe, const Sort
 		const auto s = 1.0 / ( float ) texture.width;
 		const auto t = 1.0 / ( float ) texture.height;
 
-		if( texture.flags & STUDIO_NF_ADDITIVE )
-			glDepthMask( GL_FALSE );
-		else
-			glDepthMask( GL_TRUE );
-
-		if( texture.flags & STUDIO_NF_ADDITIVE )
-		{
-			glEnable( GL_BLEND );
-			glBlendFunc( GL_SRC_ALPHA, GL_ONE );
-		}
-		else if( m_pRenderInfo->flTransparency < 1.0f )
-		{
-			glEnable( GL_BLEND );
-			glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-		}
-		else
-			glDisable( GL_BLEND );
-
-		if( texture.flags & STUDIO_NF_MASKED )
-		{
-			glEnable( GL_ALPHA_TEST );
-			glAlphaFunc( GL_GREATER, 0.5f );
-		}
+		SetupMeshState( texture );
 
 		if( !bWireframe )
 		{
-			glBindTexture( GL_TEXTURE_2D, m_pRenderInfo->pModel->GetTextureId( pSkinRef[ pmesh->skinref ] ) );
+			m_pRenderContext->BindTexture( renderer::GLToTexHandle( m_pRenderInfo->pModel->GetTextureId( pSkinRef[ pmesh->skinref ] ) ) );
 		}
 
 		int i;
@@ -988,7 +1208,7 @@ unsigned int CStudioModelRenderer::DrawMeshes( const bool bWireframe, const Sort
 				{
 					if( texture.flags & STUDIO_NF_CHROME )
 					{
-						glTexCoord2f( m_chrome[ ptricmds[ 1 ] ][ 0 ] * s, m_chrome[ ptricmds[ 1 ] ][ 1 ] * t );
+						glTexCoord2f( m_pchrome[ ptricmds[ 1 ] ][ 0 ] * s, m_pchrome[ ptricmds[ 1 ] ][ 1 ] * t );
 					}
 					else
 					{
@@ -1010,91 +1230,196 @@ unsigned int CStudioModelRenderer::DrawMeshes( const bool bWireframe, const Sort
 			}
 			glEnd();
 		}
-
-		if( texture.flags & STUDIO_NF_MASKED )
-			glDisable( GL_ALPHA_TEST );
 	}
 
+	//Leave alpha testing disabled for other draw calls.
+	m_pRenderContext->SetAlphaTestEnabled( false );
+
 	return uiDrawnPolys;
 }
 
-void CStudioModelRenderer::Lighting( glm::vec3& lv, int bone, int flags, const glm::vec3& normal )
+void CStudioModelRenderer::SetupMeshState( const mstudiotexture_t& texture )
 {
-	const float ambient = std::max( 0.1f, ( float ) m_ambientlight / 255.0f ); // to avoid divison by zero
-	const float shade = m_shadelight / 255.0f;
-	glm::vec3 illum{ ambient };
+	//Meshes are sorted by render mode, so most of these are filtered out by the render context.
+	m_pRenderContext->SetDepthMask( !( texture.flags & STUDIO_NF_ADDITIVE ) );
 
-	if( flags & STUDIO_NF_FULLBRIGHT )
+	if( texture.flags & STUDIO_NF_ADDITIVE )
 	{
-		lv = glm::vec3{ 1, 1, 1 };
-		return;
+		m_pRenderContext->SetBlendEnabled( true );
+		m_pRenderContext->SetBlendFunc( renderer::BlendFactor::SRC_ALPHA, renderer::BlendFactor::ONE );
 	}
-	else if( flags & STUDIO_NF_FLATSHADE )
+	else if( m_pRenderInfo->flTransparency < 1.0f )
 	{
-		VectorMA( illum, 0.8f, glm::vec3{ shade }, illum );
+		m_pRenderContext->SetBlendEnabled( true );
+		m_pRenderContext->SetBlendFunc( renderer::BlendFactor::SRC_ALPHA, renderer::BlendFactor::ONE_MINUS_SRC_ALPHA );
 	}
 	else
-	{
-		auto lightcos = glm::dot( normal, m_blightvec[ bone ] ); // -1 colinear, 1 opposite
+		m_pRenderContext->SetBlendEnabled( false );
 
-		if( lightcos > 1.0f ) lightcos = 1;
+	m_pRenderContext->SetAlphaTestEnabled( ( texture.flags & STUDIO_NF_MASKED ) != 0 );
 
-		illum += m_shadelight / 255.0f;
+	if( texture.flags & STUDIO_NF_MASKED )
+		m_pRenderContext->SetAlphaFunc( renderer::CompareFunc::GREATER, 0.5f );
+}
 
-		auto r = m_flLambert;
-		if( r < 1.0f ) r = 1.0f;
-		lightcos = ( lightcos + ( r - 1.0f ) ) / r; // do modified hemispherical lighting
-		if( lightcos > 0.0f ) VectorMA( illum, -lightcos, glm::vec3{ shade }, illum );
+void CStudioModelRenderer::SetupMeshes( SortedMesh_t* pMeshes, const mstudiotexture_t*& pTextures, const short*& pSkinRef )
+{
+	pTextures = m_pTextureHdr->GetTextures();
 
-		if( illum[ 0 ] <= 0 ) illum[ 0 ] = 0;
-		if( illum[ 1 ] <= 0 ) illum[ 1 ] = 0;
-		if( illum[ 2 ] <= 0 ) illum[ 2 ] = 0;
-	}
+	pSkinRef = m_pTextureHdr->GetSkins();
 
-	float max = VectorMax( illum );
+	if( m_pRenderInfo->iSkin != 0 && m_pRenderInfo->iSkin < m_pTextureHdr->numskinfamilies )
+		pSkinRef += ( m_pRenderInfo->iSkin * m_pTextureHdr->numskinref );
 
-	if( max > 1.0f )
-		lv = illum * ( 1.0f / max );
-	else lv = illum;
+	//
+	// clip and draw all triangles
+	//
 
-	const glm::vec3 lightcolor{ m_lightcolor.GetRed() / 255.0f, m_lightcolor.GetGreen() / 255.0f, m_lightcolor.GetBlue() / 255.0f };
+	SetupVertices( pTextures, pSkinRef, pMeshes );
 
-	lv *= lightcolor;
+	//Sort meshes by render modes so additive meshes are drawn after solid meshes.
+	//Masked meshes are drawn before solid meshes.
+	std::stable_sort( pMeshes, pMeshes + m_pModel->nummesh, CompareSortedMeshes );
 }
 
+unsigned int CStudioModelRenderer::RecordPoints( renderer::CRenderCommandBuffer& commands, const renderer::RenderState_t& baseState, const bool bWireframe )
+{
+	PROF_ZONE( "CStudioModelRenderer::RecordPoints" );
+
+	const mstudiotexture_t* ptexture;
+	const short* pskinref;
+
+	SortedMesh_t meshes[ MAXSTUDIOMESHES ];
+
+	SetupMeshes( meshes, ptexture, pskinref );
 
-void CStudioModelRenderer::Chrome( glm::vec2& chrome, int bone, const glm::vec3& normal )
+	return RecordMeshes( commands, baseState, bWireframe, meshes, ptexture, pskinref );
+}
+
+unsigned int CStudioModelRenderer::RecordMeshes( renderer::CRenderCommandBuffer& commands, const renderer::RenderState_t& baseState, const bool bWireframe,
+												 const SortedMesh_t* pMeshes, const mstudiotexture_t* pTextures, const short* pSkinRef )
 {
-	if( m_chromeage[ bone ] != m_uiModelsDrawnCount )
+	PROF_ZONE( "CStudioModelRenderer::RecordMeshes" );
+
+	const glm::vec4 vecWireframeColor( r_wireframecolor_r.GetFloat() / 255.0f,
+									   r_wireframecolor_g.GetFloat() / 255.0f,
+									   r_wireframecolor_b.GetFloat() / 255.0f,
+									   m_pRenderInfo->flTransparency );
+
+	unsigned int uiDrawnPolys = 0;
+
+	renderer::RenderState_t state = baseState;
+
+	//Polygons may overlap, so make sure they can blend together. - Solokiller
+	state.depthFunc = renderer::CompareFunc::LEQUAL;
+
+	for( int j = 0; j < m_pModel->nummesh; j++ )
 	{
-		// calculate vectors from the viewer to the bone. This roughly adjusts for position
-		// vector pointing at bone in world reference frame
-		auto tmp = m_vecViewerOrigin * -1.0f;
-
-		tmp[ 0 ] += m_bonetransform[ bone ][ 0 ][ 3 ];
-		tmp[ 1 ] += m_bonetransform[ bone ][ 1 ][ 3 ];
-		tmp[ 2 ] += m_bonetransform[ bone ][ 2 ][ 3 ];
-
-		VectorNormalize( tmp );
-		// g_chrome t vector in world reference frame
-		auto chromeupvec = glm::cross( tmp, -m_vecViewerRight );
-		VectorNormalize( chromeupvec );
-		// g_chrome s vector in world reference frame
-		auto chromerightvec = glm::cross( tmp, chromeupvec );
-		VectorNormalize( chromerightvec );
-
-		VectorIRotate( -chromeupvec, m_bonetransform[ bone ], m_chromeup[ bone ] );
-		VectorIRotate( chromerightvec, m_bonetransform[ bone ], m_chromeright[ bone ] );
-
-		m_chromeage[ bone ] = m_uiModelsDrawnCount;
-	}
+		auto pmesh = pMeshes[ j ].pMesh;
+		auto ptricmds = ( short * ) ( ( byte * ) m_pStudioHdr + pmesh->triindex );
+
+		const mstudiotexture_t& texture = pTextures[ pSkinRef[ pmesh->skinref ] ];
+
+		const auto s = 1.0 / ( float ) texture.width;
+		const auto t = 1.0 / ( float ) texture.height;
+
+		//Same state as DrawMeshes sets.
+		state.bDepthMask = !( texture.flags & STUDIO_NF_ADDITIVE );
+
+		if( texture.flags & STUDIO_NF_ADDITIVE )
+		{
+			state.bBlend = true;
+			state.blendSrc = renderer::BlendFactor::SRC_ALPHA;
+			state.blendDst = renderer::BlendFactor::ONE;
+		}
+		else if( m_pRenderInfo->flTransparency < 1.0f )
+		{
+			state.bBlend = true;
+			state.blendSrc = renderer::BlendFactor::SRC_ALPHA;
+			state.blendDst = renderer::BlendFactor::ONE_MINUS_SRC_ALPHA;
+		}
+		else
+			state.bBlend = false;
+
+		state.bAlphaTest = ( texture.flags & STUDIO_NF_MASKED ) != 0;
+
+		if( state.bAlphaTest )
+		{
+			state.alphaFunc = renderer::CompareFunc::GREATER;
+			state.flAlphaRef = 0.5f;
+		}
+
+		if( !bWireframe )
+		{
+			state.hTexture = renderer::GLToTexHandle( m_pRenderInfo->pModel->GetTextureId( pSkinRef[ pmesh->skinref ] ) );
+		}
+
+		renderer::RenderLayer layer;
+
+		if( bWireframe )
+			layer = renderer::RenderLayer::OVERLAY;
+		else if( state.bBlend )
+			layer = renderer::RenderLayer::TRANSLUCENT;
+		else
+			layer = renderer::RenderLayer::SOLID;
+
+		commands.SetState( layer, state );
+
+		int i;
+
+		while( i = *( ptricmds++ ) )
+		{
+			const bool bFan = i < 0;
+
+			if( bFan )
+				i = -i;
+
+			uiDrawnPolys += i - 2;
+
+			m_RecordVertices.clear();
+
+			for( ; i > 0; i--, ptricmds += 4 )
+			{
+				renderer::RenderVertex_t vertex;
+
+				vertex.vecPosition = m_pxformverts[ ptricmds[ 0 ] ];
+
+				if( bWireframe )
+				{
+					vertex.vecTexCoord = glm::vec2();
+					vertex.vecColor = vecWireframeColor;
+				}
+				else
+				{
+					if( texture.flags & STUDIO_NF_CHROME )
+					{
+						vertex.vecTexCoord = glm::vec2( m_pchrome[ ptricmds[ 1 ] ][ 0 ] * s, m_pchrome[ ptricmds[ 1 ] ][ 1 ] * t );
+					}
+					else
+					{
+						vertex.vecTexCoord = glm::vec2( ptricmds[ 2 ] * s, ptricmds[ 3 ] * t );
+					}
+
+					if( texture.flags & STUDIO_NF_ADDITIVE )
+					{
+						vertex.vecColor = glm::vec4( 1.0f, 1.0f, 1.0f, m_pRenderInfo->flTransparency );
+					}
+					else
+					{
+						vertex.vecColor = glm::vec4( m_pvlightvalues[ ptricmds[ 1 ] ], m_pRenderInfo->flTransparency );
+					}
+				}
 
-	// calc s coord
-	auto n = glm::dot( normal, m_chromeright[ bone ] );
-	chrome[ 0 ] = ( n + 1.0 ) * 32;
+				m_RecordVertices.push_back( vertex );
+			}
 
-	// calc t coord
-	n = glm::dot( normal, m_chromeup[ bone ] );
-	chrome[ 1 ] = ( n + 1.0 ) * 32;
+			if( bFan )
+				commands.AddTriangleFan( m_RecordVertices.data(), m_RecordVertices.size() );
+			else
+				commands.AddTriangleStrip( m_RecordVertices.data(), m_RecordVertices.size() );
+		}
+	}
+
+	return uiDrawnPolys;
+}
 }
-}
\ No newline at end of file
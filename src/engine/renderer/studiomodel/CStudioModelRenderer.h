@@ -1,6 +1,8 @@
 #ifndef GAME_STUDIOMODEL_CSTUDIOMODELRENDERER_H
 #define GAME_STUDIOMODEL_CSTUDIOMODELRENDERER_H
 
+#include <vector>
+
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
@@ -11,6 +13,9 @@
 
 #include "shared/studiomodel/studio.h"
 
+#include "shared/renderer/CRenderCommandBuffer.h"
+#include "shared/renderer/IRenderContext.h"
+#include "shared/renderer/studiomodel/CStudioModelPoseCache.h"
 #include "shared/renderer/studiomodel/IStudioModelRenderer.h"
 
 namespace studiomdl
@@ -62,6 +67,11 @@ public:
 
 	unsigned int DrawModel( CModelRenderInfo* const pRenderInfo, const renderer::DrawFlags_t flags ) override final;
 
+	unsigned int DrawModelInstances( CModelRenderInfo* const* ppRenderInfos, const size_t uiCount, const renderer::DrawFlags_t flags ) override final;
+
+	unsigned int RecordModel( CModelRenderInfo* const pRenderInfo, renderer::CRenderCommandBuffer& commands,
+							  const renderer::RenderState_t& baseState, const renderer::DrawFlags_t flags ) override final;
+
 	IStudioModelRendererListener* GetRendererListener() const override final { return m_pListener; }
 
 	void SetRendererListener( IStudioModelRendererListener* pListener ) override final
@@ -74,6 +84,18 @@ public:
 	void DrawSingleAttachment( const int iAttachment ) override final;
 
 private:
+	/**
+	*	@brief Sets the model, headers and pose cache used by the draw and record operations.
+	*	@param pszFunction Name of the calling function, used in error messages.
+	*	@return Whether the model can be drawn.
+	*/
+	bool SetUpRenderInfo( CModelRenderInfo* const pRenderInfo, const char* const pszFunction );
+
+	/**
+	*	@brief Gets the matrix that transforms the model from model space to world space.
+	*/
+	Mat4x4 GetModelMatrix( const renderer::DrawFlags_t flags ) const;
+
 	void DrawBones();
 
 	void DrawAttachments();
@@ -84,30 +106,63 @@ private:
 
 	void DrawNormals();
 
-	void SetUpBones();
-	void CalcRotations( glm::vec3* pos, glm::vec4* q, const mstudioseqdesc_t* const pseqdesc, const mstudioanim_t* panim, const float f );
+	/**
+	*	@brief Sets up the bones and lighting, or restores them from the pose cache if nothing changed since the last draw.
+	*/
+	void SetUpPose();
 
-	void CalcBoneAdj();
-	void CalcBoneQuaternion( const int frame, const float s, const mstudiobone_t* const pbone, const mstudioanim_t* const panim, glm::vec4& q );
-	void CalcBonePosition( const int frame, const float s, const mstudiobone_t* const pbone, const mstudioanim_t* const panim, glm::vec3& pos );
-	void SlerpBones( glm::vec4* q1, glm::vec3* pos1, glm::vec4* q2, glm::vec3* pos2, float s );
+	/**
+	*	@brief Calculates the bone transforms for the current frame. See StudioPose.h
+	*/
+	void SetUpBones();
 
 	/**
 	*	@brief set some global variables based on entity position
 	*/
 	void SetupLighting();
 
+	/**
+	*	@brief Calculates the light vector in each bone's reference frame.
+	*/
+	void SetupBoneLighting();
+
 	/**
 	*	@brief based on the body part, figure out which mesh it should be using
 	*/
 	void SetupModel( int bodypart );
 
+	/**
+	*	@brief Transforms and lights the vertices of the current submodel, or reuses the results cached for it.
+	*	Sets m_pxformverts, m_pvlightvalues and m_pchrome. Chrome is recomputed only if the viewer has moved.
+	*	@param ptexture Textures.
+	*	@param pskinref Skin reference for the current skin.
+	*	@param pMeshes Optional. Receives the submodel's meshes and their flags.
+	*/
+	void SetupVertices( const mstudiotexture_t* ptexture, const short* pskinref, SortedMesh_t* pMeshes );
+
 	unsigned int DrawPoints( const bool bWireframe );
 
 	unsigned int DrawMeshes( const bool bWireframe, const SortedMesh_t* pMeshes, const mstudiotexture_t* pTextures, const short* pSkinRef );
 
-	void Lighting( glm::vec3& lv, int bone, int flags, const glm::vec3& normal );
-	void Chrome( glm::vec2& chrome, int bone, const glm::vec3& normal );
+	/**
+	*	@brief Sets the depth, blend and alpha test state used to draw a mesh with the given texture.
+	*/
+	void SetupMeshState( const mstudiotexture_t& texture );
+
+	/**
+	*	@brief Draws instances that use the same model, skin and body groups, and are all either opaque or translucent.
+	*/
+	unsigned int DrawInstanceGroup( CModelRenderInfo* const* ppRenderInfos, const size_t uiCount, const renderer::DrawFlags_t flags );
+
+	/**
+	*	@brief Sets up the meshes of the current submodel, sorted by render mode.
+	*/
+	void SetupMeshes( SortedMesh_t* pMeshes, const mstudiotexture_t*& pTextures, const short*& pSkinRef );
+
+	unsigned int RecordPoints( renderer::CRenderCommandBuffer& commands, const renderer::RenderState_t& baseState, const bool bWireframe );
+
+	unsigned int RecordMeshes( renderer::CRenderCommandBuffer& commands, const renderer::RenderState_t& baseState, const bool bWireframe,
+							   const SortedMesh_t* pMeshes, const mstudiotexture_t* pTextures, const short* pSkinRef );
 
 private:
 	/**
@@ -117,22 +172,49 @@ private:
 
 	studiomdl::CModelRenderInfo* m_pRenderInfo;
 
+	/**
+	*	Pose cache of the model being drawn. Either the entity's cache or m_LocalPoseCache.
+	*/
+	CStudioModelPoseCache* m_pPoseCache = nullptr;
+
+	/**
+	*	Used for models drawn without a cache. Only shared between the passes of a single DrawModel call.
+	*/
+	CStudioModelPoseCache m_LocalPoseCache;
+
 	studiohdr_t* m_pStudioHdr = nullptr;
 	studiohdr_t* m_pTextureHdr = nullptr;
 
 	mstudiomodel_t* m_pModel = nullptr;
+	int m_iBodyPart = 0;
 
 	IStudioModelRendererListener* m_pListener = nullptr;
 
+	/**
+	*	Context used to set render state.
+	*/
+	renderer::IRenderContext* m_pRenderContext;
+
 	/**
 	*	The number of polygons drawn since the last call to Initialize.
 	*/
 	unsigned int m_uiDrawnPolygonsCount = 0;
 
-	glm::vec3		m_xformverts[ MAXSTUDIOVERTS ];		// transformed vertices
-	glm::vec3		m_lightvalues[ MAXSTUDIOVERTS ];	// light surface normals
-	glm::vec3*		m_pxformverts;
-	glm::vec3*		m_pvlightvalues;
+	/**
+	*	Vertices of the triangle strip or fan being recorded. Kept around to avoid reallocating it.
+	*/
+	std::vector<renderer::RenderVertex_t> m_RecordVertices;
+
+	/**
+	*	Scratch buffers used to draw instances. Kept around to avoid reallocating them.
+	*/
+	std::vector<CModelRenderInfo*> m_Instances;
+	std::vector<renderer::RenderVertex_t> m_InstanceVertices;
+	std::vector<uint32_t> m_InstanceIndices;
+
+	glm::vec3*		m_pxformverts;						// transformed vertices
+	glm::vec3*		m_pvlightvalues;					// light surface normals
+	glm::vec2*		m_pchrome;							// texture coords for surface normals
 
 	glm::mat3x4		m_bonetransform[ MAXSTUDIOBONES ];	// bone transformation matrix
 
@@ -145,8 +227,7 @@ private:
 	Color			m_lightcolor;
 	glm::vec3		m_blightvec[ MAXSTUDIOBONES ];		// light vectors in bone reference frames
 
-	glm::vec2		m_chrome[ MAXSTUDIOVERTS ];			// texture coords for surface normals
-	unsigned int	m_chromeage[ MAXSTUDIOBONES ];		// last time chrome vectors were updated
+	unsigned int	m_uiChromeAge = 0;					// last time chrome vectors were updated
 	glm::vec3		m_chromeup[ MAXSTUDIOBONES ];		// chrome vector "up" in bone reference frames
 	glm::vec3		m_chromeright[ MAXSTUDIOBONES ];	// chrome vector "right" in bone reference frames
 
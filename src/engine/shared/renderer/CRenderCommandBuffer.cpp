@@ -0,0 +1,127 @@
+#include "CRenderCommandBuffer.h"
+
+namespace renderer
+{
+bool RenderState_t::operator==( const RenderState_t& other ) const
+{
+	return bBlend == other.bBlend
+		&& blendSrc == other.blendSrc
+		&& blendDst == other.blendDst
+		&& bDepthTest == other.bDepthTest
+		&& bDepthMask == other.bDepthMask
+		&& depthFunc == other.depthFunc
+		&& bAlphaTest == other.bAlphaTest
+		&& alphaFunc == other.alphaFunc
+		&& flAlphaRef == other.flAlphaRef
+		&& bCullFace == other.bCullFace
+		&& cullFace == other.cullFace
+		&& polygonMode == other.polygonMode
+		&& bTexture2D == other.bTexture2D
+		&& hTexture == other.hTexture;
+}
+
+uint64_t RenderState_t::GetSortKey() const
+{
+	//Fixed function state goes in the upper half so it changes least often, the texture in the lower half.
+	uint32_t uiStateBits = 0;
+
+	uiStateBits |= static_cast<uint32_t>( polygonMode ) << 28;
+	uiStateBits |= static_cast<uint32_t>( bBlend ) << 27;
+	uiStateBits |= static_cast<uint32_t>( blendSrc ) << 23;
+	uiStateBits |= static_cast<uint32_t>( blendDst ) << 19;
+	uiStateBits |= static_cast<uint32_t>( bDepthTest ) << 18;
+	uiStateBits |= static_cast<uint32_t>( bDepthMask ) << 17;
+	uiStateBits |= static_cast<uint32_t>( depthFunc ) << 13;
+	uiStateBits |= static_cast<uint32_t>( bAlphaTest ) << 12;
+	uiStateBits |= static_cast<uint32_t>( alphaFunc ) << 8;
+	uiStateBits |= static_cast<uint32_t>( bCullFace ) << 7;
+	uiStateBits |= static_cast<uint32_t>( cullFace ) << 5;
+	uiStateBits |= static_cast<uint32_t>( bTexture2D ) << 4;
+
+	//The alpha reference value isn't part of the key; states that only differ in it end up next to each other.
+	return ( static_cast<uint64_t>( uiStateBits ) << 32 ) | static_cast<uint32_t>( reinterpret_cast<uintptr_t>( hTexture ) );
+}
+
+void CRenderCommandBuffer::Clear()
+{
+	m_Commands.clear();
+	m_Matrices.clear();
+	m_Vertices.clear();
+
+	m_Layer = RenderLayer::SOLID;
+	m_State = RenderState_t();
+	m_bStateChanged = true;
+}
+
+void CRenderCommandBuffer::SetMatrix( const Mat4x4& matrix )
+{
+	m_Matrices.push_back( matrix );
+	m_bStateChanged = true;
+}
+
+void CRenderCommandBuffer::SetState( const RenderLayer layer, const RenderState_t& state )
+{
+	if( layer == m_Layer && state == m_State )
+		return;
+
+	m_Layer = layer;
+	m_State = state;
+	m_bStateChanged = true;
+}
+
+void CRenderCommandBuffer::AddTriangle( const RenderVertex_t& vertex0, const RenderVertex_t& vertex1, const RenderVertex_t& vertex2 )
+{
+	Command_t& command = GetCurrentCommand();
+
+	m_Vertices.push_back( vertex0 );
+	m_Vertices.push_back( vertex1 );
+	m_Vertices.push_back( vertex2 );
+
+	command.uiNumVertices += 3;
+}
+
+void CRenderCommandBuffer::AddTriangleStrip( const RenderVertex_t* pVertices, const size_t uiNumVertices )
+{
+	for( size_t uiIndex = 2; uiIndex < uiNumVertices; ++uiIndex )
+	{
+		//Every other triangle in a strip has its first two vertices swapped to keep the winding order consistent.
+		if( uiIndex % 2 == 0 )
+			AddTriangle( pVertices[ uiIndex - 2 ], pVertices[ uiIndex - 1 ], pVertices[ uiIndex ] );
+		else
+			AddTriangle( pVertices[ uiIndex - 1 ], pVertices[ uiIndex - 2 ], pVertices[ uiIndex ] );
+	}
+}
+
+void CRenderCommandBuffer::AddTriangleFan( const RenderVertex_t* pVertices, const size_t uiNumVertices )
+{
+	for( size_t uiIndex = 2; uiIndex < uiNumVertices; ++uiIndex )
+	{
+		AddTriangle( pVertices[ 0 ], pVertices[ uiIndex - 1 ], pVertices[ uiIndex ] );
+	}
+}
+
+CRenderCommandBuffer::Command_t& CRenderCommandBuffer::GetCurrentCommand()
+{
+	if( !m_bStateChanged )
+		return m_Commands.back();
+
+	if( m_Matrices.empty() )
+		m_Matrices.push_back( Mat4x4( 1.0f ) );
+
+	//Replace the last command if nothing was added to it.
+	if( m_Commands.empty() || m_Commands.back().uiNumVertices > 0 )
+		m_Commands.emplace_back();
+
+	Command_t& command = m_Commands.back();
+
+	command.layer = m_Layer;
+	command.state = m_State;
+	command.uiMatrix = static_cast<uint32_t>( m_Matrices.size() - 1 );
+	command.uiFirstVertex = static_cast<uint32_t>( m_Vertices.size() );
+	command.uiNumVertices = 0;
+
+	m_bStateChanged = false;
+
+	return command;
+}
+}
@@ -0,0 +1,173 @@
+#ifndef ENGINE_SHARED_RENDERER_CRENDERCOMMANDBUFFER_H
+#define ENGINE_SHARED_RENDERER_CRENDERCOMMANDBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "IRenderContext.h"
+
+namespace renderer
+{
+/**
+*	Render state used by a recorded command.
+*/
+struct RenderState_t
+{
+	bool bBlend = false;
+	BlendFactor blendSrc = BlendFactor::ONE;
+	BlendFactor blendDst = BlendFactor::ZERO;
+
+	bool bDepthTest = true;
+	bool bDepthMask = true;
+	CompareFunc depthFunc = CompareFunc::LEQUAL;
+
+	bool bAlphaTest = false;
+	CompareFunc alphaFunc = CompareFunc::ALWAYS;
+	float flAlphaRef = 0;
+
+	bool bCullFace = true;
+	CullFace cullFace = CullFace::FRONT;
+
+	PolygonMode polygonMode = PolygonMode::FILL;
+
+	bool bTexture2D = false;
+	HTexture_t hTexture = NULL_TEXTURE_HANDLE;
+
+	bool operator==( const RenderState_t& other ) const;
+
+	bool operator!=( const RenderState_t& other ) const
+	{
+		return !( *this == other );
+	}
+
+	/**
+	*	Gets a key that groups states that are expensive to switch between. States that compare equal have the same key.
+	*/
+	uint64_t GetSortKey() const;
+};
+
+/**
+*	Determines the order in which commands are submitted. Earlier layers are submitted first.
+*/
+enum class RenderLayer
+{
+	/**
+	*	Geometry that doesn't depend on what was drawn before it. Sorted by state.
+	*/
+	SOLID = 0,
+
+	/**
+	*	Blended geometry. Submitted in the order it was recorded.
+	*/
+	TRANSLUCENT,
+
+	/**
+	*	Wireframe overlays and other geometry drawn on top of the scene. Submitted in the order it was recorded.
+	*/
+	OVERLAY
+};
+
+/**
+*	Vertex of a recorded triangle.
+*/
+struct RenderVertex_t
+{
+	glm::vec3 vecPosition;
+	glm::vec2 vecTexCoord;
+	glm::vec4 vecColor;
+};
+
+/**
+*	Records draw commands so they can be submitted later, on the thread that owns the render context.
+*	Recording doesn't use the graphics API, so it can be done on any thread. Each thread should record into its own buffer.
+*	Commands draw triangle lists. Consecutive triangles that use the same layer, state and matrix are merged into one command.
+*	@see IRenderContext::SubmitCommands
+*/
+class CRenderCommandBuffer final
+{
+public:
+	struct Command_t
+	{
+		RenderLayer layer;
+
+		RenderState_t state;
+
+		/**
+		*	Index of the model matrix.
+		*/
+		uint32_t uiMatrix;
+
+		uint32_t uiFirstVertex;
+		uint32_t uiNumVertices;
+	};
+
+public:
+	CRenderCommandBuffer() = default;
+
+	/**
+	*	Removes all commands. Keeps the memory around so the buffer can be recorded again without reallocating.
+	*/
+	void Clear();
+
+	bool IsEmpty() const { return m_Commands.empty(); }
+
+	const std::vector<Command_t>& GetCommands() const { return m_Commands; }
+
+	const std::vector<Mat4x4>& GetMatrices() const { return m_Matrices; }
+
+	const std::vector<RenderVertex_t>& GetVertices() const { return m_Vertices; }
+
+	/**
+	*	Sets the model matrix used by commands recorded after this. It is multiplied with the model view matrix when the commands are submitted.
+	*	The identity matrix is used until this is called.
+	*/
+	void SetMatrix( const Mat4x4& matrix );
+
+	/**
+	*	Sets the layer and state used by triangles added after this.
+	*/
+	void SetState( const RenderLayer layer, const RenderState_t& state );
+
+	void AddTriangle( const RenderVertex_t& vertex0, const RenderVertex_t& vertex1, const RenderVertex_t& vertex2 );
+
+	/**
+	*	Adds the triangles of a triangle strip. Triangles keep the winding order they would have when drawn as a strip.
+	*/
+	void AddTriangleStrip( const RenderVertex_t* pVertices, const size_t uiNumVertices );
+
+	/**
+	*	Adds the triangles of a triangle fan.
+	*/
+	void AddTriangleFan( const RenderVertex_t* pVertices, const size_t uiNumVertices );
+
+private:
+	/**
+	*	Gets the command that new triangles are added to, starting a new command if the layer, state or matrix changed.
+	*/
+	Command_t& GetCurrentCommand();
+
+private:
+	std::vector<Command_t> m_Commands;
+	std::vector<Mat4x4> m_Matrices;
+	std::vector<RenderVertex_t> m_Vertices;
+
+	RenderLayer m_Layer = RenderLayer::SOLID;
+	RenderState_t m_State;
+
+	/**
+	*	Whether the layer, state or matrix changed since the last command was started.
+	*/
+	bool m_bStateChanged = true;
+
+private:
+	CRenderCommandBuffer( const CRenderCommandBuffer& ) = delete;
+	CRenderCommandBuffer& operator=( const CRenderCommandBuffer& ) = delete;
+};
+}
+
+#endif //ENGINE_SHARED_RENDERER_CRENDERCOMMANDBUFFER_H
@@ -1,6 +1,8 @@
 #ifndef ENGINE_RENDERER_IRENDERCONTEXT_H
 #define ENGINE_RENDERER_IRENDERCONTEXT_H
 
+#include <cstdint>
+
 #include "lib/LibInterface.h"
 
 #include "core/shared/Const.h"
@@ -77,6 +79,78 @@ enum class CullFace
 	FRONT_AND_BACK
 };
 
+/**
+*	Which winding order is front facing.
+*/
+enum class FrontFace
+{
+	/**
+	*	Clockwise.
+	*/
+	CW,
+
+	/**
+	*	Counter-clockwise.
+	*/
+	CCW
+};
+
+/**
+*	How polygons are rasterized. Applies to both front and back faces.
+*/
+enum class PolygonMode
+{
+	POINT,
+	LINE,
+	FILL
+};
+
+/**
+*	Blend factors.
+*/
+enum class BlendFactor
+{
+	ZERO,
+	ONE,
+	SRC_COLOR,
+	ONE_MINUS_SRC_COLOR,
+	SRC_ALPHA,
+	ONE_MINUS_SRC_ALPHA,
+	DST_ALPHA,
+	ONE_MINUS_DST_ALPHA
+};
+
+/**
+*	Comparison functions used by the depth and alpha tests.
+*/
+enum class CompareFunc
+{
+	NEVER,
+	LESS,
+	EQUAL,
+	LEQUAL,
+	GREATER,
+	NOTEQUAL,
+	GEQUAL,
+	ALWAYS
+};
+
+/**
+*	Number of state changes passed to a render context.
+*/
+struct RenderStateStats_t
+{
+	/**
+	*	Changes that were passed on to the graphics API.
+	*/
+	uint64_t uiIssued = 0;
+
+	/**
+	*	Changes that were dropped because the state already had the requested value.
+	*/
+	uint64_t uiFiltered = 0;
+};
+
 /**
 *	Read buffer.
 */
@@ -135,7 +209,9 @@ typedef void* HTexture_t;
 /**
 *	Null texture handle. This represents "no" texture.
 */
-#define NULL_TEXTURE_HANDLE ( reinterpret_cast<HTexture_t>( 0 ) )
+#define NULL_TEXTURE_HANDLE ( reinterpret_cast<renderer::HTexture_t>( 0 ) )
+
+class CRenderCommandBuffer;
 
 /**
 *	Renderer context. Provides access to a variety of context specific operations.
@@ -254,12 +330,90 @@ public:
 	*/
 	virtual void Clear( const ClearBits_t bits ) = 0;
 
+	//Render state
+	//The context keeps a copy of the state it sets, and drops changes that wouldn't change anything.
+	//Code that changes this state directly through the graphics API must call InvalidateState afterwards.
+
+	/**
+	*	Forgets the cached render state, so the next change to each state is always passed on.
+	*/
+	virtual void InvalidateState() = 0;
+
+	/**
+	*	@return The number of state changes that were issued and filtered since the last call to ResetStateStats.
+	*/
+	virtual RenderStateStats_t GetStateStats() const = 0;
+
+	/**
+	*	Resets the state change counts.
+	*/
+	virtual void ResetStateStats() = 0;
+
+	/**
+	*	Enables or disables blending.
+	*/
+	virtual void SetBlendEnabled( const bool bEnabled ) = 0;
+
+	/**
+	*	Sets the blend function.
+	*	@param src Factor for the incoming color.
+	*	@param dst Factor for the color in the buffer.
+	*/
+	virtual void SetBlendFunc( const BlendFactor src, const BlendFactor dst ) = 0;
+
+	/**
+	*	Enables or disables depth testing.
+	*/
+	virtual void SetDepthTestEnabled( const bool bEnabled ) = 0;
+
+	/**
+	*	Sets whether drawing writes to the depth buffer.
+	*/
+	virtual void SetDepthMask( const bool bWrite ) = 0;
+
+	/**
+	*	Sets the depth test function.
+	*/
+	virtual void SetDepthFunc( const CompareFunc func ) = 0;
+
+	/**
+	*	Enables or disables alpha testing.
+	*/
+	virtual void SetAlphaTestEnabled( const bool bEnabled ) = 0;
+
+	/**
+	*	Sets the alpha test function.
+	*	@param func Function that compares the incoming alpha value with the reference value.
+	*	@param flRef Reference value.
+	*/
+	virtual void SetAlphaFunc( const CompareFunc func, const float flRef ) = 0;
+
+	/**
+	*	Enables or disables face culling.
+	*/
+	virtual void SetCullFaceEnabled( const bool bEnabled ) = 0;
+
 	/**
 	*	Sets the cull face.
 	*	@see CullFace
 	*/
 	virtual void SetCullFace( const CullFace cullFace ) = 0;
 
+	/**
+	*	Sets which winding order is front facing.
+	*/
+	virtual void SetFrontFace( const FrontFace frontFace ) = 0;
+
+	/**
+	*	Sets the polygon mode for front and back faces.
+	*/
+	virtual void SetPolygonMode( const PolygonMode mode ) = 0;
+
+	/**
+	*	Enables or disables 2D texturing.
+	*/
+	virtual void SetTexture2DEnabled( const bool bEnabled ) = 0;
+
 	/**
 	*	@return The current read buffer setting.
 	*	@see SetReadBuffer
@@ -307,6 +461,7 @@ public:
 
 	/**
 	*	Binds the given texture. Can be NULL_TEXTURE_HANDLE, in which case the current texture is unbound.
+	*	Binding the texture that is already bound does nothing.
 	*	TODO texture type
 	*	@see NULL_TEXTURE_HANDLE
 	*/
@@ -318,12 +473,22 @@ public:
 	*	@param mag Magnification filter.
 	*/
 	virtual void SetMinMagFilters( const MinFilter min, const MagFilter mag ) = 0;
+
+	/**
+	*	Draws the commands recorded in the given buffers. Solid commands from all buffers are sorted by state,
+	*	translucent and overlay commands are drawn afterwards in the order they were recorded, buffers in the given order.
+	*	The model view matrix must be the current matrix. Each command's matrix is multiplied with it.
+	*	Render state is left as set by the last command.
+	*	@param ppBuffers Buffers to draw. The buffers are not modified, so they can be drawn more than once.
+	*	@param uiNumBuffers Number of buffers.
+	*/
+	virtual void SubmitCommands( const CRenderCommandBuffer* const* ppBuffers, const size_t uiNumBuffers ) = 0;
 };
 }
 
 /**
 *	Render context interface name.
 */
-#define IRENDERCONTEXT_NAME "IRenderContextV001"
+#define IRENDERCONTEXT_NAME "IRenderContextV002"
 
 #endif //ENGINE_RENDERER_IRENDERCONTEXT_H
\ No newline at end of file
@@ -14,6 +14,7 @@
 namespace studiomdl
 {
 class CStudioModel;
+class CStudioModelPoseCache;
 
 /**
 *	Data structure used to pass model render info into the engine.
@@ -38,6 +39,11 @@ struct CModelRenderInfo
 
 	byte iController[ 4 ];
 	byte iMouth;
+
+	/**
+	*	Optional. If set, the renderer reuses bones, vertices and lighting from the last draw if the pose is unchanged.
+	*/
+	CStudioModelPoseCache* pPoseCache = nullptr;
 };
 }
 
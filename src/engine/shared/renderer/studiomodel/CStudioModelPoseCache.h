@@ -0,0 +1,147 @@
+#ifndef RENDERER_STUDIOMODEL_CSTUDIOMODELPOSECACHE_H
+#define RENDERER_STUDIOMODEL_CSTUDIOMODELPOSECACHE_H
+
+#include <cstring>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/mat3x4.hpp>
+
+#include "shared/studiomodel/studio.h"
+
+#include "CModelRenderInfo.h"
+
+/**
+*	@ingroup StudioModelRenderer
+*
+*	@{
+*/
+
+namespace studiomdl
+{
+/**
+*	Everything that the bone transforms, transformed vertices and lighting of a model depend on.
+*	Chrome also depends on the viewer, so it is cached separately.
+*/
+struct PoseCacheKey_t
+{
+	const CStudioModel* pModel = nullptr;
+
+	int iSequence = -1;
+	float flFrame = 0;
+	int iBodygroup = 0;
+	int iSkin = 0;
+
+	byte iBlender[ STUDIO_MAX_BLENDERS ] = {};
+	byte iController[ STUDIO_MAX_CONTROLLERS ] = {};
+	byte iMouth = 0;
+
+	glm::vec3 vecLightVector;
+	glm::vec3 vecLightColor;
+	float flLambert = 0;
+
+	bool operator==( const PoseCacheKey_t& other ) const
+	{
+		return pModel == other.pModel
+			&& iSequence == other.iSequence
+			&& flFrame == other.flFrame
+			&& iBodygroup == other.iBodygroup
+			&& iSkin == other.iSkin
+			&& !memcmp( iBlender, other.iBlender, sizeof( iBlender ) )
+			&& !memcmp( iController, other.iController, sizeof( iController ) )
+			&& iMouth == other.iMouth
+			&& vecLightVector == other.vecLightVector
+			&& vecLightColor == other.vecLightColor
+			&& flLambert == other.flLambert;
+	}
+
+	bool operator!=( const PoseCacheKey_t& other ) const
+	{
+		return !( *this == other );
+	}
+};
+
+/**
+*	Transformed vertices and lighting of a single body part.
+*/
+struct PoseCacheBodyPart_t
+{
+	/**
+	*	Submodel the data was computed for. Null if nothing is cached.
+	*/
+	const mstudiomodel_t* pModel = nullptr;
+
+	std::vector<glm::vec3> xformVerts;
+
+	/**
+	*	Lighting value for each normal.
+	*/
+	std::vector<glm::vec3> lightValues;
+
+	/**
+	*	Texture flags of each mesh at the time the lighting was computed. Textures can be edited at any time.
+	*/
+	std::vector<int> meshFlags;
+
+	/**
+	*	Chrome texture coordinates for each normal. Only valid if bChromeValid is set.
+	*/
+	std::vector<glm::vec2> chrome;
+
+	bool bChromeValid = false;
+
+	/**
+	*	Viewer that chrome was computed for.
+	*/
+	glm::vec3 vecChromeViewerOrigin;
+	glm::vec3 vecChromeViewerRight;
+};
+
+/**
+*	Per entity cache of the renderer's pose and skinning results.
+*	When an entity is drawn with the same key as the last time, the renderer reuses the cached bones, vertices and lighting.
+*	Chrome is reused as well if the viewer hasn't moved. This covers redraws of an idle view as well as the mirrored,
+*	wireframe overlay, normals and hitbox passes that draw the same entity several times per frame.
+*	Owned by whoever draws the entity and passed to the renderer in CModelRenderInfo; only the renderer reads or writes the data.
+*/
+class CStudioModelPoseCache final
+{
+public:
+	CStudioModelPoseCache() = default;
+	~CStudioModelPoseCache() = default;
+
+	/**
+	*	Forces the next draw to recompute everything. Call when the model changes.
+	*	Buffers are kept for reuse.
+	*/
+	void Invalidate()
+	{
+		bValid = false;
+	}
+
+public:
+	bool bValid = false;
+
+	PoseCacheKey_t key;
+
+	int iNumBones = 0;
+
+	glm::mat3x4 boneTransforms[ MAXSTUDIOBONES ];
+
+	/**
+	*	Light vector in each bone's reference frame.
+	*/
+	glm::vec3 boneLightVectors[ MAXSTUDIOBONES ];
+
+	std::vector<PoseCacheBodyPart_t> bodyParts;
+
+private:
+	CStudioModelPoseCache( const CStudioModelPoseCache& ) = delete;
+	CStudioModelPoseCache& operator=( const CStudioModelPoseCache& ) = delete;
+};
+}
+
+/** @} */
+
+#endif //RENDERER_STUDIOMODEL_CSTUDIOMODELPOSECACHE_H
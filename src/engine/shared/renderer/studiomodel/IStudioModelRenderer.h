@@ -1,6 +1,8 @@
 #ifndef ENGINE_STUDIOMODEL_ISTUDIOMODELRENDERER_H
 #define ENGINE_STUDIOMODEL_ISTUDIOMODELRENDERER_H
 
+#include <cstddef>
+
 #include <glm/vec3.hpp>
 
 #include "lib/LibInterface.h"
@@ -17,6 +19,12 @@
 *	@{
 */
 
+namespace renderer
+{
+class CRenderCommandBuffer;
+struct RenderState_t;
+}
+
 namespace studiomdl
 {
 class CStudioModel;
@@ -102,6 +110,33 @@ public:
 	*/
 	virtual unsigned int DrawModel( CModelRenderInfo* const pRenderInfo, const renderer::DrawFlags_t flags = renderer::DrawFlag::NONE ) = 0;
 
+	/**
+	*	Draws many models at once. Instances that use the same model, skin and body groups are drawn together, with one draw call per mesh.
+	*	Each instance is still posed, skinned and lit on its own, using its pose cache if it has one.
+	*	Models are drawn one by one if the wireframe overlay, debug overlays or a renderer listener are used.
+	*	Instances with an odd number of negative scale values need the opposite cull face, so they should be drawn in a separate call.
+	*	@param ppRenderInfos Render infos that describe the models.
+	*	@param uiCount Number of models.
+	*	@param flags Flags. Used for all models.
+	*	@return Number of polygons that were drawn.
+	*/
+	virtual unsigned int DrawModelInstances( CModelRenderInfo* const* ppRenderInfos, const size_t uiCount,
+											 const renderer::DrawFlags_t flags = renderer::DrawFlag::NONE ) = 0;
+
+	/**
+	*	Records the given model into a command buffer instead of drawing it. Does not use the graphics API, so it can be called on any thread,
+	*	but not while another call to this renderer is in progress. Debug overlays are not recorded and the renderer listener is not called.
+	*	@param pRenderInfo Render info that describes the model.
+	*	@param commands Buffer to record into.
+	*	@param baseState State to draw with. Polygon mode, texturing, culling and depth testing are taken from this;
+	*		the rest is set by the model's textures.
+	*	@param flags Flags.
+	*	@return Number of polygons that were recorded.
+	*	@see renderer::IRenderContext::SubmitCommands
+	*/
+	virtual unsigned int RecordModel( CModelRenderInfo* const pRenderInfo, renderer::CRenderCommandBuffer& commands,
+									  const renderer::RenderState_t& baseState, const renderer::DrawFlags_t flags = renderer::DrawFlag::NONE ) = 0;
+
 	/*
 	*	Tool only operations.
 	*/
@@ -134,7 +169,7 @@ public:
 /**
 *	StudioModel Renderer interface name.
 */
-#define ISTUDIOMODELRENDERER_NAME "IStudioModelRendererV001"
+#define ISTUDIOMODELRENDERER_NAME "IStudioModelRendererV003"
 
 /** @ } */
 
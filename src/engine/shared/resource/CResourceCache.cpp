@@ -0,0 +1,33 @@
+#include <experimental/filesystem>
+
+#include "CResourceCache.h"
+
+namespace fs = std::experimental::filesystem;
+
+namespace resource
+{
+std::string CanonicalizePath( const char* const pszFilename )
+{
+	std::error_code error;
+
+	const fs::path path = fs::canonical( pszFilename, error );
+
+	if( !error )
+		return path.string();
+
+	return fs::absolute( pszFilename ).string();
+}
+
+uint64_t HashDependencies( uint64_t uiHash, const std::vector<std::string>& files )
+{
+	const uint8_t MISSING_FILE = 0xFF;
+
+	for( const auto& szFilename : files )
+	{
+		if( !HashFileContents( szFilename.c_str(), uiHash ) )
+			uiHash = HashFNV1a64( &MISSING_FILE, sizeof( MISSING_FILE ), uiHash );
+	}
+
+	return uiHash;
+}
+}
@@ -0,0 +1,441 @@
+#ifndef ENGINE_SHARED_RESOURCE_CRESOURCECACHE_H
+#define ENGINE_SHARED_RESOURCE_CRESOURCECACHE_H
+
+#include <cassert>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shared/Stats.h"
+
+#include "utility/Hash.h"
+
+/**
+*	@defgroup Resource Resource caching.
+*
+*	@{
+*/
+
+namespace resource
+{
+/**
+*	Converts a filename to the canonical absolute path used to identify a resource.
+*	If the file doesn't exist, the absolute path is returned.
+*/
+std::string CanonicalizePath( const char* const pszFilename );
+
+/**
+*	Continues a hash with the contents of the given files.
+*	Files that can't be read are hashed as a marker, so a file being removed or added changes the hash.
+*/
+uint64_t HashDependencies( uint64_t uiHash, const std::vector<std::string>& files );
+
+/**
+*	Snapshot of a resource cache's state.
+*/
+struct ResourceCacheStats_t
+{
+	uint64_t uiHits = 0;
+	uint64_t uiMisses = 0;
+	uint64_t uiEvictions = 0;
+
+	size_t uiEntries = 0;
+
+	/**
+	*	Entries that have handles. These are never evicted.
+	*/
+	size_t uiReferencedEntries = 0;
+
+	/**
+	*	Memory used by all entries, in bytes.
+	*/
+	size_t uiMemoryUsage = 0;
+
+	size_t uiMemoryBudget = 0;
+};
+
+/**
+*	Cache of resources loaded from files, keyed by canonical path and the hash of the contents of the file and the other files it depends on.
+*	Loading a file that is already cached returns a handle to the cached resource, unless any of its files have changed on disk.
+*	Resources are reference counted: they stay cached after the last handle is released, and are evicted least recently used
+*	first once the memory used by the cache exceeds its budget. Resources that have handles are never evicted.
+*	Not thread safe. Resources that own OpenGL objects must be loaded and released on the thread that owns the context.
+*	The cache must outlive all handles.
+*	@tparam T Resource type.
+*	@tparam TRAITS Type that provides:
+*		static bool Load( const char* const pszFilename, T*& pResource );
+*		static void Free( T* pResource );
+*		static size_t GetMemoryUsage( const T& resource );
+*		static size_t GetMemoryBudget();
+*		static void GetDependencies( const char* const pszFilename, const T& resource, std::vector<std::string>& files );
+*			Gets the files other than pszFilename that the resource was loaded from.
+*/
+template<typename T, typename TRAITS>
+class CResourceCache final
+{
+public:
+	typedef std::shared_ptr<T> Handle_t;
+
+private:
+	struct Entry_t;
+
+	typedef std::list<Entry_t> EntryList_t;
+
+	struct Entry_t
+	{
+		std::string szPath;
+
+		/**
+		*	Hash of the file and its dependencies.
+		*/
+		uint64_t uiHash = 0;
+
+		std::vector<std::string> dependencies;
+
+		T* pResource = nullptr;
+
+		size_t uiMemoryUsage = 0;
+
+		std::weak_ptr<T> handle;
+
+		/**
+		*	Whether this entry can be found by path. Discarded and outdated entries are freed once their last handle is released.
+		*/
+		bool bInLookup = true;
+
+		/**
+		*	Position in the list of unreferenced entries. Only valid if bUnreferenced is set.
+		*/
+		typename std::list<typename EntryList_t::iterator>::iterator lruPos;
+		bool bUnreferenced = false;
+	};
+
+	/**
+	*	Handle deleter. Returns the entry to the cache instead of freeing the resource.
+	*/
+	struct Releaser_t
+	{
+		CResourceCache* pCache;
+		typename EntryList_t::iterator entry;
+
+		void operator()( T* )
+		{
+			pCache->OnReleased( entry );
+		}
+	};
+
+public:
+	/**
+	*	@param pszStatsName Prefix for the names of the cache's stats in the stats registry.
+	*/
+	CResourceCache( const char* const pszStatsName )
+		: m_Hits( stats::Registry().GetCounter( ( std::string( pszStatsName ) + ".cache_hits" ).c_str() ) )
+		, m_Misses( stats::Registry().GetCounter( ( std::string( pszStatsName ) + ".cache_misses" ).c_str() ) )
+		, m_Evictions( stats::Registry().GetCounter( ( std::string( pszStatsName ) + ".cache_evictions" ).c_str() ) )
+		, m_HitRate( stats::Registry().GetGauge( ( std::string( pszStatsName ) + ".cache_hit_rate" ).c_str(), "%" ) )
+		, m_MemoryUsage( stats::Registry().GetGauge( ( std::string( pszStatsName ) + ".cache_memory" ).c_str(), "bytes" ) )
+		, m_NumEntries( stats::Registry().GetGauge( ( std::string( pszStatsName ) + ".cache_entries" ).c_str() ) )
+	{
+	}
+
+	~CResourceCache()
+	{
+		Clear();
+
+		assert( m_Entries.empty() );
+	}
+
+	/**
+	*	Loads a resource, or gets it from the cache.
+	*	@return Handle to the resource, or null if it couldn't be loaded.
+	*/
+	Handle_t Load( const char* const pszFilename )
+	{
+		return Load( pszFilename, &TRAITS::Load );
+	}
+
+	/**
+	*	Loads a resource using a custom loader, or gets it from the cache. The loader is only called if the resource isn't cached.
+	*	If the loader returns a resource that isn't fully loaded yet, call UpdateMemoryUsage once it is.
+	*	@param loader Function with the signature bool( const char* const pszFilename, T*& pResource ).
+	*	@return Handle to the resource, or null if it couldn't be loaded.
+	*/
+	template<typename LOADER>
+	Handle_t Load( const char* const pszFilename, LOADER&& loader )
+	{
+		std::string szPath = CanonicalizePath( pszFilename );
+
+		uint64_t uiHash = 0;
+
+		if( !HashFileContents( szPath.c_str(), uiHash ) )
+		{
+			++m_uiMisses;
+			m_Misses.Add();
+			UpdateStats();
+			return nullptr;
+		}
+
+		auto it = m_Lookup.find( szPath );
+
+		if( it != m_Lookup.end() )
+		{
+			auto entry = it->second;
+
+			if( entry->uiHash == HashDependencies( uiHash, entry->dependencies ) )
+			{
+				++m_uiHits;
+				m_Hits.Add();
+
+				auto handle = Acquire( entry );
+
+				//The budget may have changed.
+				Trim();
+
+				return handle;
+			}
+
+			//The file has changed; drop the old version once it's no longer used.
+			Discard( entry );
+		}
+
+		++m_uiMisses;
+		m_Misses.Add();
+
+		T* pResource = nullptr;
+
+		if( !loader( szPath.c_str(), pResource ) )
+		{
+			UpdateStats();
+			return nullptr;
+		}
+
+		m_Entries.emplace_front();
+
+		auto entry = m_Entries.begin();
+
+		entry->szPath = std::move( szPath );
+
+		TRAITS::GetDependencies( entry->szPath.c_str(), *pResource, entry->dependencies );
+
+		entry->uiHash = HashDependencies( uiHash, entry->dependencies );
+		entry->pResource = pResource;
+		entry->uiMemoryUsage = TRAITS::GetMemoryUsage( *pResource );
+
+		m_Lookup.emplace( entry->szPath, entry );
+
+		m_uiMemoryUsage += entry->uiMemoryUsage;
+
+		auto handle = Acquire( entry );
+
+		Trim();
+
+		return handle;
+	}
+
+	/**
+	*	Removes a resource from the cache, so the next load reads it from disk again. Use this after modifying a resource in memory.
+	*	The resource stays valid until the last handle to it is released.
+	*/
+	void Discard( const Handle_t& handle )
+	{
+		if( !handle )
+			return;
+
+		for( auto entry = m_Entries.begin(); entry != m_Entries.end(); ++entry )
+		{
+			if( entry->pResource == handle.get() )
+			{
+				Discard( entry );
+				return;
+			}
+		}
+	}
+
+	/**
+	*	Recalculates the memory used by a resource. Use this after a resource has finished loading.
+	*/
+	void UpdateMemoryUsage( const Handle_t& handle )
+	{
+		if( !handle )
+			return;
+
+		for( auto& entry : m_Entries )
+		{
+			if( entry.pResource == handle.get() )
+			{
+				m_uiMemoryUsage -= entry.uiMemoryUsage;
+				entry.uiMemoryUsage = TRAITS::GetMemoryUsage( *entry.pResource );
+				m_uiMemoryUsage += entry.uiMemoryUsage;
+
+				Trim();
+				return;
+			}
+		}
+	}
+
+	/**
+	*	Evicts least recently used resources that have no handles until the cache is within its budget.
+	*/
+	void Trim()
+	{
+		const size_t uiBudget = TRAITS::GetMemoryBudget();
+
+		while( m_uiMemoryUsage > uiBudget && !m_Unreferenced.empty() )
+		{
+			auto entry = m_Unreferenced.back();
+
+			Evict( entry );
+		}
+
+		UpdateStats();
+	}
+
+	/**
+	*	Evicts all resources that have no handles.
+	*/
+	void Clear()
+	{
+		while( !m_Unreferenced.empty() )
+		{
+			Evict( m_Unreferenced.back() );
+		}
+
+		UpdateStats();
+	}
+
+	ResourceCacheStats_t GetStats() const
+	{
+		ResourceCacheStats_t stats;
+
+		stats.uiHits = m_uiHits;
+		stats.uiMisses = m_uiMisses;
+		stats.uiEvictions = m_uiEvictions;
+		stats.uiEntries = m_Entries.size();
+		stats.uiReferencedEntries = m_Entries.size() - m_Unreferenced.size();
+		stats.uiMemoryUsage = m_uiMemoryUsage;
+		stats.uiMemoryBudget = TRAITS::GetMemoryBudget();
+
+		return stats;
+	}
+
+private:
+	Handle_t Acquire( const typename EntryList_t::iterator entry )
+	{
+		if( auto handle = entry->handle.lock() )
+			return handle;
+
+		if( entry->bUnreferenced )
+		{
+			m_Unreferenced.erase( entry->lruPos );
+			entry->bUnreferenced = false;
+		}
+
+		Handle_t handle( entry->pResource, Releaser_t{ this, entry } );
+
+		entry->handle = handle;
+
+		return handle;
+	}
+
+	void OnReleased( const typename EntryList_t::iterator entry )
+	{
+		if( !entry->bInLookup )
+		{
+			Free( entry );
+			UpdateStats();
+			return;
+		}
+
+		//Most recently used entries are at the front.
+		m_Unreferenced.push_front( entry );
+		entry->lruPos = m_Unreferenced.begin();
+		entry->bUnreferenced = true;
+
+		Trim();
+	}
+
+	void Discard( const typename EntryList_t::iterator entry )
+	{
+		if( !entry->bInLookup )
+			return;
+
+		m_Lookup.erase( entry->szPath );
+		entry->bInLookup = false;
+
+		if( entry->bUnreferenced )
+		{
+			m_Unreferenced.erase( entry->lruPos );
+			Free( entry );
+		}
+
+		UpdateStats();
+	}
+
+	void Evict( const typename EntryList_t::iterator entry )
+	{
+		assert( entry->bUnreferenced );
+
+		m_Unreferenced.erase( entry->lruPos );
+
+		if( entry->bInLookup )
+			m_Lookup.erase( entry->szPath );
+
+		++m_uiEvictions;
+		m_Evictions.Add();
+
+		Free( entry );
+	}
+
+	void Free( const typename EntryList_t::iterator entry )
+	{
+		TRAITS::Free( entry->pResource );
+
+		m_uiMemoryUsage -= entry->uiMemoryUsage;
+
+		m_Entries.erase( entry );
+	}
+
+	void UpdateStats()
+	{
+		const uint64_t uiLoads = m_uiHits + m_uiMisses;
+
+		m_HitRate.Set( uiLoads > 0 ? ( 100.0 * m_uiHits ) / uiLoads : 0.0 );
+		m_MemoryUsage.Set( static_cast<double>( m_uiMemoryUsage ) );
+		m_NumEntries.Set( static_cast<double>( m_Entries.size() ) );
+	}
+
+private:
+	EntryList_t m_Entries;
+
+	std::unordered_map<std::string, typename EntryList_t::iterator> m_Lookup;
+
+	/**
+	*	Entries without handles, most recently used first.
+	*/
+	std::list<typename EntryList_t::iterator> m_Unreferenced;
+
+	size_t m_uiMemoryUsage = 0;
+
+	uint64_t m_uiHits = 0;
+	uint64_t m_uiMisses = 0;
+	uint64_t m_uiEvictions = 0;
+
+	stats::CCounter& m_Hits;
+	stats::CCounter& m_Misses;
+	stats::CCounter& m_Evictions;
+	stats::CGauge& m_HitRate;
+	stats::CGauge& m_MemoryUsage;
+	stats::CGauge& m_NumEntries;
+
+private:
+	CResourceCache( const CResourceCache& ) = delete;
+	CResourceCache& operator=( const CResourceCache& ) = delete;
+};
+}
+
+/** @} */
+
+#endif //ENGINE_SHARED_RESOURCE_CRESOURCECACHE_H
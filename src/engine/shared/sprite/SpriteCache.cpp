@@ -0,0 +1,65 @@
+#include "cvar/CCVar.h"
+
+#include "CSprite.h"
+
+#include "SpriteCache.h"
+
+namespace sprite
+{
+namespace
+{
+static cvar::CCVar sprite_cache_budget( "sprite_cache_budget",
+	cvar::CCVarArgsBuilder()
+	.Flags( cvar::Flag::ARCHIVE )
+	.FloatValue( 64 )
+	.MinValue( 0 )
+	.HelpInfo( "Memory that unused sprites can keep cached, in MiB" ) );
+
+size_t GetFrameMemoryUsage( const mspriteframe_t& frame )
+{
+	//Uploaded as 32 bit RGBA.
+	return sizeof( mspriteframe_t ) + static_cast<size_t>( frame.width ) * frame.height * 4;
+}
+}
+
+bool SpriteCacheTraits::Load( const char* const pszFilename, msprite_t*& pSprite )
+{
+	return LoadSprite( pszFilename, pSprite );
+}
+
+void SpriteCacheTraits::Free( msprite_t* pSprite )
+{
+	FreeSprite( pSprite );
+}
+
+size_t SpriteCacheTraits::GetMemoryUsage( const msprite_t& sprite )
+{
+	size_t uiSize = sizeof( msprite_t ) + sizeof( mspriteframedesc_t ) * sprite.numframes;
+
+	for( int iFrame = 0; iFrame < sprite.numframes; ++iFrame )
+	{
+		const mspriteframedesc_t& desc = *sprite.GetFrameDescriptor( iFrame );
+
+		if( desc.type == spriteframetype_t::SINGLE )
+		{
+			uiSize += GetFrameMemoryUsage( *desc.GetFrame() );
+		}
+		else
+		{
+			const mspritegroup_t* const pGroup = reinterpret_cast<const mspritegroup_t*>( desc.GetFrame() );
+
+			for( int iGroupFrame = 0; iGroupFrame < pGroup->numframes; ++iGroupFrame )
+			{
+				uiSize += GetFrameMemoryUsage( *pGroup->GetFrame( iGroupFrame ) );
+			}
+		}
+	}
+
+	return uiSize;
+}
+
+size_t SpriteCacheTraits::GetMemoryBudget()
+{
+	return static_cast<size_t>( sprite_cache_budget.GetFloat() * 1024 * 1024 );
+}
+}
@@ -0,0 +1,50 @@
+#ifndef ENGINE_SHARED_SPRITE_SPRITECACHE_H
+#define ENGINE_SHARED_SPRITE_SPRITECACHE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "shared/resource/CResourceCache.h"
+
+#include "sprite.h"
+
+namespace sprite
+{
+/**
+*	Loads and frees sprites for the sprite cache.
+*/
+struct SpriteCacheTraits
+{
+	static bool Load( const char* const pszFilename, msprite_t*& pSprite );
+
+	static void Free( msprite_t* pSprite );
+
+	/**
+	*	@return Memory used by the sprite's frames, in bytes.
+	*/
+	static size_t GetMemoryUsage( const msprite_t& sprite );
+
+	/**
+	*	@return The value of the sprite_cache_budget cvar, in bytes.
+	*/
+	static size_t GetMemoryBudget();
+
+	/**
+	*	Sprites are stored in a single file, so there are no dependencies.
+	*/
+	static void GetDependencies( const char* const, const msprite_t&, std::vector<std::string>& files )
+	{
+		files.clear();
+	}
+};
+
+/**
+*	Cache of sprites.
+*/
+typedef resource::CResourceCache<msprite_t, SpriteCacheTraits> CSpriteCache;
+
+typedef CSpriteCache::Handle_t SpriteHandle_t;
+}
+
+#endif //ENGINE_SHARED_SPRITE_SPRITECACHE_H
@@ -1,10 +1,19 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
 #include <filesystem>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 
 #include "shared/Platform.h"
 #include "shared/Logging.h"
+#include "shared/Profiler.h"
+#include "shared/Stats.h"
 
+#include "utility/ParallelFor.h"
 #include "utility/StringUtils.h"
 
 #include "cvar/CCVar.h"
@@ -12,6 +21,8 @@
 #include "graphics/GraphicsUtils.h"
 #include "graphics/Palette.h"
 
+#include "StudioModelValidation.h"
+
 #include "CStudioModel.h"
 
 namespace studiomdl
@@ -30,8 +41,35 @@ static cvar::CCVar r_powerof2textures( "r_powerof2textures",
 	.MaxValue( 1 )
 	.HelpInfo( "Whether to resize textures to power of 2 dimensions" ) );
 
+stats::CGauge& GetTextureMemoryGauge()
+{
+	static auto& textureMemory = stats::Registry().GetGauge( "studiomodel.texture_memory", "bytes" );
+
+	return textureMemory;
+}
+
+/**
+*	Size in bytes of each texture uploaded by UploadRGBATexture, so the memory gauge can be updated on deletion without asking the driver.
+*	Only used on the thread that owns the OpenGL context.
+*/
+std::unordered_map<GLuint, size_t>& GetTextureSizes()
+{
+	static std::unordered_map<GLuint, size_t> sizes;
+
+	return sizes;
+}
+
 void UploadRGBATexture( const int iWidth, const int iHeight, const byte* pData, GLuint textureId, const bool bFilterTextures )
 {
+	const size_t uiSize = static_cast<size_t>( iWidth ) * iHeight * 4;
+
+	size_t& uiStoredSize = GetTextureSizes()[ textureId ];
+
+	//Uploading to a texture again replaces its storage.
+	GetTextureMemoryGauge().Add( static_cast<double>( uiSize ) - static_cast<double>( uiStoredSize ) );
+
+	uiStoredSize = uiSize;
+
 	glBindTexture( GL_TEXTURE_2D, textureId );
 	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, iWidth, iHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, pData );
 	glTexEnvf( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
@@ -39,6 +77,28 @@ void UploadRGBATexture( const int iWidth, const int iHeight, const byte* pData,
 	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, bFilterTextures ? GL_LINEAR : GL_NEAREST );
 }
 
+/**
+*	Deletes textures uploaded by UploadRGBATexture.
+*/
+void DeleteRGBATextures( const int iCount, const GLuint* pTextures )
+{
+	auto& sizes = GetTextureSizes();
+
+	for( int i = 0; i < iCount; ++i )
+	{
+		auto it = sizes.find( pTextures[ i ] );
+
+		if( it != sizes.end() )
+		{
+			GetTextureMemoryGauge().Add( -static_cast<double>( it->second ) );
+
+			sizes.erase( it );
+		}
+	}
+
+	glDeleteTextures( iCount, pTextures );
+}
+
 //Dol differs only in texture storage
 //Instead of pixels followed by RGB palette, it has a 32 byte texture name (name of file without extension), followed by an RGBA palette and pixels
 void ConvertDolToMdl( byte* pBuffer, const mstudiotexture_t& texture )
@@ -109,12 +169,6 @@ void ConvertDolToMdl( byte* pBuffer, const mstudiotexture_t& texture )
 
 void UploadTexture( const mstudiotexture_t* ptexture, const byte* data, byte* pal, int name, const bool bFilterTextures, const bool bPowerOf2 )
 {
-	// unsigned *in, int inwidth, int inheight, unsigned *out,  int outwidth, int outheight;
-	int		i, j;
-	int		row1[ MAX_TEXTURE_DIMS ], row2[ MAX_TEXTURE_DIMS ], col1[ MAX_TEXTURE_DIMS ], col2[ MAX_TEXTURE_DIMS ];
-	const byte	*pix1, *pix2, *pix3, *pix4;
-	byte	*tex, *out;
-
 	// convert texture to power of 2
 	int outwidth;
 	int outheight;
@@ -136,124 +190,334 @@ void UploadTexture( const mstudiotexture_t* ptexture, const byte* data, byte* pa
 	if( uiSize < 4 )
 		return;
 
-	tex = out = ( byte * ) malloc( uiSize );
-	if( !out )
+	byte* tex = ( byte * ) malloc( uiSize );
+	if( !tex )
 	{
 		return;
 	}
-	/*
-	int k = 0;
-	for (i = 0; i < ptexture->height; i++)
-	{
-	for (j = 0; j < ptexture->width; j++)
+
+	ConvertTextureToRGBA( *ptexture, data, pal, outwidth, outheight, tex );
+
+	UploadRGBATexture( outwidth, outheight, tex, name, bFilterTextures );
+
+	free( tex );
+}
+
+/**
+*	Gets the size of a texture's pixels and palette in the file.
+*/
+size_t GetTextureDataSize( const mstudiotexture_t& texture, const bool bIsDol )
+{
+	const size_t uiPixels = texture.width * texture.height;
+
+	//Dol textures start with a 32 byte name and have an RGBA palette. They're converted to the mdl layout in place when uploaded.
+	return bIsDol ? 32 + PALETTE_ENTRIES * 4 + uiPixels : uiPixels + PALETTE_SIZE;
+}
+
+/**
+*	Checks whether the data of any two textures overlaps.
+*/
+bool HasOverlappingTextureData( const studiohdr_t& textureHdr, const bool bIsDol )
+{
+	std::vector<std::pair<size_t, size_t>> ranges;
+
+	ranges.reserve( textureHdr.numtextures );
+
+	for( int i = 0; i < textureHdr.numtextures; ++i )
 	{
+		const mstudiotexture_t& texture = *textureHdr.GetTexture( i );
 
-	in[k++] = pal[data[i * ptexture->width + j] * 3 + 0];
-	in[k++] = pal[data[i * ptexture->width + j] * 3 + 1];
-	in[k++] = pal[data[i * ptexture->width + j] * 3 + 2];
-	in[k++] = 0xff;;
-	}
+		ranges.emplace_back( texture.index, texture.index + GetTextureDataSize( texture, bIsDol ) );
 	}
 
-	gluScaleImage (GL_RGBA, ptexture->width, ptexture->height, GL_UNSIGNED_BYTE, in, outwidth, outheight, GL_UNSIGNED_BYTE, out);
-	free (in);
-	*/
+	std::sort( ranges.begin(), ranges.end() );
 
-	for( i = 0; i < outwidth; i++ )
+	for( size_t uiIndex = 1; uiIndex < ranges.size(); ++uiIndex )
 	{
-		col1[ i ] = ( int ) ( ( i + 0.25 ) * ( ptexture->width / ( float ) outwidth ) );
-		col2[ i ] = ( int ) ( ( i + 0.75 ) * ( ptexture->width / ( float ) outwidth ) );
+		if( ranges[ uiIndex ].first < ranges[ uiIndex - 1 ].second )
+			return true;
 	}
 
-	for( i = 0; i < outheight; i++ )
+	return false;
+}
+
+bool SupportsPixelUnpackBuffers()
+{
+	return glGenBuffers && glMapBuffer && ( GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object );
+}
+
+/**
+*	Converted textures smaller than this, in bytes, are decoded on the calling thread. Starting threads would take longer.
+*/
+const size_t MIN_PARALLEL_DECODE_SIZE = 256 * 1024;
+
+/**
+*	Where a texture's converted pixels are stored in the staging buffer.
+*/
+struct StagedTexture_t
+{
+	int iWidth = 0;
+	int iHeight = 0;
+
+	size_t uiOffset = 0;
+};
+
+/**
+*	Factor by which the dimensions of preview textures are smaller than those of the full textures.
+*/
+const int PREVIEW_TEXTURE_DOWNSCALE = 4;
+
+/**
+*	Calculates the dimensions of each converted texture, and where it's stored in a staging buffer.
+*	@param iDownscale Factor to divide the dimensions of the textures by. Textures keep at least one pixel in each dimension.
+*	@return Size of the staging buffer, in bytes.
+*/
+size_t LayoutStagedTextures( const studiohdr_t& textureHdr, const bool bPowerOf2, const int iDownscale, std::vector<StagedTexture_t>& staged )
+{
+	//The texture count and data ranges were checked by validation.
+	const mstudiotexture_t* ptexture = textureHdr.GetTextures();
+
+	const int n = textureHdr.numtextures;
+
+	staged.clear();
+	staged.resize( n );
+
+	size_t uiStagingSize = 0;
+
+	for( int i = 0; i < n; ++i )
 	{
-		row1[ i ] = ( int ) ( ( i + 0.25 ) * ( ptexture->height / ( float ) outheight ) ) * ptexture->width;
-		row2[ i ] = ( int ) ( ( i + 0.75 ) * ( ptexture->height / ( float ) outheight ) ) * ptexture->width;
+		StagedTexture_t& stage = staged[ i ];
+
+		// convert texture to power of 2
+		if( bPowerOf2 )
+		{
+			if( !graphics::CalculateImageDimensions( ptexture[ i ].width, ptexture[ i ].height, stage.iWidth, stage.iHeight ) )
+				stage.iWidth = stage.iHeight = 0;
+		}
+		else
+		{
+			stage.iWidth = ptexture[ i ].width;
+			stage.iHeight = ptexture[ i ].height;
+		}
+
+		//Needs at least one pixel. Textures without pixels are not uploaded.
+		if( stage.iWidth <= 0 || stage.iHeight <= 0 )
+		{
+			stage.iWidth = stage.iHeight = 0;
+			continue;
+		}
+
+		if( iDownscale > 1 )
+		{
+			stage.iWidth = std::max( 1, stage.iWidth / iDownscale );
+			stage.iHeight = std::max( 1, stage.iHeight / iDownscale );
+		}
+
+		stage.uiOffset = uiStagingSize;
+
+		uiStagingSize += static_cast<size_t>( stage.iWidth ) * stage.iHeight * 4;
 	}
 
-	const byte* const pAlpha = &pal[ PALETTE_ALPHA_INDEX ];
+	return uiStagingSize;
+}
 
-	//This modifies the model's data. Sets the mask color to black. This is also done by Jed's model viewer. (export texture has black)
-	if( ptexture->flags & STUDIO_NF_MASKED )
+/**
+*	Converts textures to RGBA into a staging buffer. Textures are converted concurrently on worker threads if there is enough work.
+*	Doesn't use OpenGL, so it can be called on any thread.
+*	@param bIsDol Whether the texture data is in the Dol layout. It's converted to the mdl layout in place first.
+*/
+void DecodeStagedTextures( studiohdr_t& textureHdr, const std::vector<StagedTexture_t>& staged, const size_t uiStagingSize, byte* pStaging, const bool bIsDol )
+{
+	PROF_ZONE( "studiomdl::DecodeTextures" );
+
+	mstudiotexture_t* ptexture = textureHdr.GetTextures();
+
+	byte* pIn = reinterpret_cast<byte*>( &textureHdr );
+
+	//Conversion modifies the texture data in place, so textures that share data must be converted one at a time.
+	const unsigned int uiMaxThreads = ( uiStagingSize < MIN_PARALLEL_DECODE_SIZE || HasOverlappingTextureData( textureHdr, bIsDol ) ) ? 1 : 0;
+
+	ParallelFor( staged.size(), [ & ]( const size_t uiIndex )
+	{
+		mstudiotexture_t& texture = ptexture[ uiIndex ];
+
+		if( bIsDol )
+		{
+			ConvertDolToMdl( pIn, texture );
+		}
+
+		const StagedTexture_t& stage = staged[ uiIndex ];
+
+		if( stage.iWidth == 0 )
+			return;
+
+		ConvertTextureToRGBA( texture, pIn + texture.index, pIn + texture.index + texture.width * texture.height,
+							  stage.iWidth, stage.iHeight, pStaging + stage.uiOffset );
+	}, uiMaxThreads );
+}
+
+/**
+*	Uploads converted textures from a staging buffer.
+*	@param pStaging Staging buffer. Null if the staging data is in the bound pixel unpack buffer.
+*/
+void UploadStagedTextures( const std::vector<StagedTexture_t>& staged, const byte* pStaging, const GLuint* pTextures, const bool bFilterTextures )
+{
+	for( size_t uiIndex = 0; uiIndex < staged.size(); ++uiIndex )
 	{
-		pal[ 255 * 3 + 0 ] = pal[ 255 * 3 + 1 ] = pal[ 255 * 3 + 2 ] = 0;
+		const StagedTexture_t& stage = staged[ uiIndex ];
+
+		if( stage.iWidth == 0 )
+			continue;
+
+		//While a pixel unpack buffer is bound, the data pointer is an offset into the buffer.
+		const byte* const pData = pStaging ? pStaging + stage.uiOffset : reinterpret_cast<const byte*>( stage.uiOffset );
+
+		UploadRGBATexture( stage.iWidth, stage.iHeight, pData, pTextures[ uiIndex ], bFilterTextures );
 	}
+}
 
-	// scale down and convert to 32bit RGB
-	for( i = 0; i<outheight; i++ )
+/**
+*	Uploads all textures in a header.
+*	Textures are converted to RGBA concurrently on worker threads. If pixel buffer objects are supported, the pixels are written straight into one,
+*	so the uploads that follow on this thread don't have to copy from client memory and return without waiting for the transfer.
+*/
+size_t UploadTextures( studiohdr_t& textureHdr, GLuint* pTextures, const bool bFilterTextures, const bool bPowerOf2, const bool bIsDol )
+{
+	const int n = textureHdr.numtextures;
+
+	if( n <= 0 )
+		return 0;
+
+	std::vector<StagedTexture_t> staged;
+
+	const size_t uiStagingSize = LayoutStagedTextures( textureHdr, bPowerOf2, 1, staged );
+
+	glBindTexture( GL_TEXTURE_2D, 0 );
+	glGenTextures( n, pTextures );
+
+	GLuint buffer = 0;
+
+	byte* pStaging = nullptr;
+
+	std::unique_ptr<byte[]> clientStaging;
+
+	if( uiStagingSize > 0 && SupportsPixelUnpackBuffers() )
 	{
-		for( j = 0; j<outwidth; j++, out += 4 )
-		{
-			pix1 = &pal[ data[ row1[ i ] + col1[ j ] ] * 3 ];
-			pix2 = &pal[ data[ row1[ i ] + col2[ j ] ] * 3 ];
-			pix3 = &pal[ data[ row2[ i ] + col1[ j ] ] * 3 ];
-			pix4 = &pal[ data[ row2[ i ] + col2[ j ] ] * 3 ];
+		glGenBuffers( 1, &buffer );
+		glBindBuffer( GL_PIXEL_UNPACK_BUFFER, buffer );
+		glBufferData( GL_PIXEL_UNPACK_BUFFER, uiStagingSize, nullptr, GL_STREAM_DRAW );
 
-			out[ 0 ] = ( pix1[ 0 ] + pix2[ 0 ] + pix3[ 0 ] + pix4[ 0 ] ) >> 2;
-			out[ 1 ] = ( pix1[ 1 ] + pix2[ 1 ] + pix3[ 1 ] + pix4[ 1 ] ) >> 2;
-			out[ 2 ] = ( pix1[ 2 ] + pix2[ 2 ] + pix3[ 2 ] + pix4[ 2 ] ) >> 2;
+		pStaging = static_cast<byte*>( glMapBuffer( GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY ) );
 
-			if( ptexture->flags & STUDIO_NF_MASKED && pix1 == pAlpha && pix2 == pAlpha && pix3 == pAlpha && pix4 == pAlpha )
-			{
-				//Set alpha to 0 to enable transparent pixel.
-				out[ 3 ] = 0x00;
-			}
-			else
-			{
-				out[ 3 ] = 0xFF;
-			}
+		if( !pStaging )
+		{
+			glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+			glDeleteBuffers( 1, &buffer );
+			buffer = 0;
 		}
 	}
 
-	UploadRGBATexture( outwidth, outheight, tex, name, bFilterTextures );
+	if( !pStaging )
+	{
+		clientStaging.reset( new byte[ uiStagingSize ] );
+		pStaging = clientStaging.get();
+	}
 
-	free( tex );
+	DecodeStagedTextures( textureHdr, staged, uiStagingSize, pStaging, bIsDol );
+
+	if( buffer != 0 )
+	{
+		glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+
+		UploadStagedTextures( staged, nullptr, pTextures, bFilterTextures );
+
+		glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+
+		//The driver keeps the data alive until the uploads have read it.
+		glDeleteBuffers( 1, &buffer );
+	}
+	else
+	{
+		UploadStagedTextures( staged, pStaging, pTextures, bFilterTextures );
+	}
+
+	return n;
+}
 }
 
-size_t UploadTextures( studiohdr_t& textureHdr, GLuint* pTextures, const bool bFilterTextures, const bool bPowerOf2, const bool bIsDol )
+void ConvertTextureToRGBA( const mstudiotexture_t& texture, const byte* const pPixels, byte* pPalette,
+						   const int iOutWidth, const int iOutHeight, byte* pOutRGBA )
 {
-	size_t uiNumTextures = 0;
+	int		i, j;
+	int		row1[ MAX_TEXTURE_DIMS ], row2[ MAX_TEXTURE_DIMS ], col1[ MAX_TEXTURE_DIMS ], col2[ MAX_TEXTURE_DIMS ];
+	const byte	*pix1, *pix2, *pix3, *pix4;
+
+	byte* out = pOutRGBA;
 
-	if( textureHdr.textureindex > 0 && textureHdr.numtextures <= CStudioModel::MAX_TEXTURES )
+	for( i = 0; i < iOutWidth; i++ )
 	{
-		mstudiotexture_t* ptexture = textureHdr.GetTextures();
+		col1[ i ] = ( int ) ( ( i + 0.25 ) * ( texture.width / ( float ) iOutWidth ) );
+		col2[ i ] = ( int ) ( ( i + 0.75 ) * ( texture.width / ( float ) iOutWidth ) );
+	}
+
+	for( i = 0; i < iOutHeight; i++ )
+	{
+		row1[ i ] = ( int ) ( ( i + 0.25 ) * ( texture.height / ( float ) iOutHeight ) ) * texture.width;
+		row2[ i ] = ( int ) ( ( i + 0.75 ) * ( texture.height / ( float ) iOutHeight ) ) * texture.width;
+	}
 
-		byte* pIn = reinterpret_cast<byte*>( &textureHdr );
+	const byte* const pAlpha = &pPalette[ PALETTE_ALPHA_INDEX ];
 
-		const int n = textureHdr.numtextures;
+	//This modifies the model's data. Sets the mask color to black. This is also done by Jed's model viewer. (export texture has black)
+	if( texture.flags & STUDIO_NF_MASKED )
+	{
+		pPalette[ 255 * 3 + 0 ] = pPalette[ 255 * 3 + 1 ] = pPalette[ 255 * 3 + 2 ] = 0;
+	}
 
-		for( int i = 0; i < n; ++i )
+	// scale down and convert to 32bit RGB
+	for( i = 0; i<iOutHeight; i++ )
+	{
+		for( j = 0; j<iOutWidth; j++, out += 4 )
 		{
-			GLuint name;
+			pix1 = &pPalette[ pPixels[ row1[ i ] + col1[ j ] ] * 3 ];
+			pix2 = &pPalette[ pPixels[ row1[ i ] + col2[ j ] ] * 3 ];
+			pix3 = &pPalette[ pPixels[ row2[ i ] + col1[ j ] ] * 3 ];
+			pix4 = &pPalette[ pPixels[ row2[ i ] + col2[ j ] ] * 3 ];
 
-			glBindTexture( GL_TEXTURE_2D, 0 );
-			glGenTextures( 1, &name );
+			out[ 0 ] = ( pix1[ 0 ] + pix2[ 0 ] + pix3[ 0 ] + pix4[ 0 ] ) >> 2;
+			out[ 1 ] = ( pix1[ 1 ] + pix2[ 1 ] + pix3[ 1 ] + pix4[ 1 ] ) >> 2;
+			out[ 2 ] = ( pix1[ 2 ] + pix2[ 2 ] + pix3[ 2 ] + pix4[ 2 ] ) >> 2;
 
-			if( bIsDol )
+			if( texture.flags & STUDIO_NF_MASKED && pix1 == pAlpha && pix2 == pAlpha && pix3 == pAlpha && pix4 == pAlpha )
 			{
-				ConvertDolToMdl( pIn, ptexture[ i ] );
+				//Set alpha to 0 to enable transparent pixel.
+				out[ 3 ] = 0x00;
+			}
+			else
+			{
+				out[ 3 ] = 0xFF;
 			}
-
-			UploadTexture( &ptexture[ i ], pIn + ptexture[ i ].index, pIn + ptexture[ i ].width * ptexture[ i ].height + ptexture[ i ].index, name, bFilterTextures, bPowerOf2 );
-
-			pTextures[ i ] = name;
 		}
-
-		uiNumTextures = n;
 	}
-
-	return uiNumTextures;
-}
 }
 
 CStudioModel::CStudioModel()
+	: m_pStudioHdr( nullptr )
+	, m_pTextureHdr( nullptr )
+	, m_pSeqHdrs()
+	, m_Textures()
+	, m_bValidated( false )
+	, m_bTexturesLoaded( true )
+	, m_bSeqGroupsLoaded( true )
 {
-	memset( this, 0, sizeof( *this ) );
 }
 
 CStudioModel::CStudioModel( studiohdr_t* pStudioHdr, studiohdr_t* pTextureHdr, studiohdr_t** ppSeqHdrs, const size_t uiNumSeqHdrs, GLuint* pTextures, const size_t uiNumTextures )
 	: m_pStudioHdr( pStudioHdr )
 	, m_pTextureHdr( pTextureHdr )
+	, m_bValidated( false )
+	, m_bTexturesLoaded( true )
+	, m_bSeqGroupsLoaded( true )
 {
 	assert( pStudioHdr );
 	assert( pTextureHdr );
@@ -279,7 +543,15 @@ CStudioModel::~CStudioModel()
 		return;
 
 	// deleting textures
-	glDeleteTextures( m_pTextureHdr->numtextures, m_Textures );
+	//The texture header is missing if loading the texture file failed.
+	if( m_pTextureHdr )
+		DeleteRGBATextures( m_pTextureHdr->numtextures, m_Textures );
+
+	for( const auto& geometry : m_BatchGeometry )
+	{
+		if( geometry.indexBuffer )
+			glDeleteBuffers( 1, &geometry.indexBuffer );
+	}
 
 	for( auto pSeqHdr : m_pSeqHdrs )
 	{
@@ -304,199 +576,1033 @@ mstudioanim_t* CStudioModel::GetAnim( mstudioseqdesc_t* pseqdesc ) const
 		return ( mstudioanim_t * ) ( ( byte * ) m_pStudioHdr + pseqgroup->unused2 + pseqdesc->animindex );
 	}
 
+	if( !m_pSeqHdrs[ pseqdesc->seqgroup ] )
+		return nullptr;
+
 	return ( mstudioanim_t * ) ( ( byte * ) m_pSeqHdrs[ pseqdesc->seqgroup ] + pseqdesc->animindex );
 }
 
-mstudiomodel_t* CStudioModel::GetModelByBodyPart( const int iBody, const int iBodyPart ) const
+const SequenceChannels_t* CStudioModel::GetSequenceChannels( const int iSequence ) const
 {
-	mstudiobodyparts_t* pbodypart = m_pStudioHdr->GetBodypart( iBodyPart );
-
-	int index = iBody / pbodypart->base;
-	index = index % pbodypart->nummodels;
+	if( iSequence < 0 || static_cast<size_t>( iSequence ) >= m_SequenceChannels.size() )
+		return nullptr;
 
-	return ( mstudiomodel_t * ) ( ( byte * ) m_pStudioHdr + pbodypart->modelindex ) + index;
+	return &m_SequenceChannels[ iSequence ];
 }
 
-bool CStudioModel::CalculateBodygroup( const int iGroup, const int iValue, int& iInOutBodygroup ) const
+void CStudioModel::BuildSequenceChannels()
 {
-	if( iGroup > m_pStudioHdr->numbodyparts )
-		return false;
+	PROF_ZONE( "CStudioModel::BuildSequenceChannels" );
 
-	const mstudiobodyparts_t* const pbodypart = m_pStudioHdr->GetBodypart( iGroup );
-
-	int iCurrent = ( iInOutBodygroup / pbodypart->base ) % pbodypart->nummodels;
+	//Offsets in unvalidated models can't be trusted.
+	if( !m_bValidated )
+		return;
 
-	if( iValue >= pbodypart->nummodels )
-		return true;
+	m_SequenceChannels.resize( m_pStudioHdr->numseq );
 
-	iInOutBodygroup = ( iInOutBodygroup - ( iCurrent * pbodypart->base ) + ( iValue * pbodypart->base ) );
+	for( int i = 0; i < m_pStudioHdr->numseq; ++i )
+	{
+		mstudioseqdesc_t* const pseqdesc = m_pStudioHdr->GetSequence( i );
 
-	return true;
+		//Sequence groups that are still loading are analyzed once they're loaded.
+		if( auto panim = GetAnim( pseqdesc ) )
+			studiomdl::BuildSequenceChannels( *m_pStudioHdr, *pseqdesc, panim, m_SequenceChannels[ i ] );
+	}
 }
 
-GLuint CStudioModel::GetTextureId( const int iIndex ) const
+const SequenceEvents_t* CStudioModel::GetSequenceEvents( const int iSequence ) const
 {
-	const studiohdr_t* const pHdr = GetTextureHeader();
+	if( iSequence < 0 || static_cast<size_t>( iSequence ) >= m_SequenceEvents.size() )
+		return nullptr;
 
-	if( !pHdr )
-		return GL_INVALID_TEXTURE_ID;
-
-	if( iIndex < 0 || iIndex >= pHdr->numtextures )
-		return GL_INVALID_TEXTURE_ID;
-
-	return m_Textures[ iIndex ];
+	return &m_SequenceEvents[ iSequence ];
 }
 
-void CStudioModel::ReplaceTexture( mstudiotexture_t* ptexture, byte *data, byte *pal, GLuint textureId )
+void CStudioModel::BuildSequenceEvents()
 {
-	glDeleteTextures( 1, &textureId );
+	PROF_ZONE( "CStudioModel::BuildSequenceEvents" );
 
-	UploadTexture( ptexture, data, pal, textureId, r_filtertextures.GetBool(), r_powerof2textures.GetBool() );
-}
-
-void CStudioModel::ReuploadTexture( mstudiotexture_t* ptexture )
-{
-	assert( ptexture );
+	//Offsets in unvalidated models can't be trusted.
+	if( !m_bValidated )
+		return;
 
-	const int iIndex = ptexture - m_pTextureHdr->GetTextures();
+	m_SequenceEvents.resize( m_pStudioHdr->numseq );
 
-	if( iIndex < 0 || iIndex >= m_pTextureHdr->numtextures )
+	for( int i = 0; i < m_pStudioHdr->numseq; ++i )
 	{
-		Error( "CStudioModel::ReuploadTexture: Invalid texture!" );
-		return;
+		studiomdl::BuildSequenceEvents( *m_pStudioHdr, *m_pStudioHdr->GetSequence( i ), m_SequenceEvents[ i ] );
 	}
+}
 
-	GLuint textureId = m_Textures[ iIndex ];
+CStudioModel::MeshListView_t CStudioModel::GetTextureMeshes( const int iTexture ) const
+{
+	MeshListView_t view;
 
-	glDeleteTextures( 1, &textureId );
+	if( iTexture < 0 || static_cast<size_t>( iTexture ) >= m_TextureMeshMap.size() )
+		return view;
 
-	UploadTexture( ptexture, 
-				   m_pTextureHdr->GetData() + ptexture->index, 
-				   m_pTextureHdr->GetData() + ptexture->index + ptexture->width * ptexture->height, textureId, r_filtertextures.GetBool(), r_powerof2textures.GetBool() );
+	const auto& meshes = m_TextureMeshMap[ iTexture ];
+
+	view.pBegin = meshes.data();
+	view.pEnd = meshes.data() + meshes.size();
+
+	return view;
 }
 
-namespace
+void CStudioModel::BuildTextureMeshMap()
 {
-/**
-*	Loads a single studio header.
-*/
-StudioModelLoadResult LoadStudioHeader( const char* const pszFilename, const bool bAllowSeqGroup, studiohdr_t*& pOutStudioHdr )
-{
-	// load the model
-	FILE* pFile = fopen( pszFilename, "rb" );
+	PROF_ZONE( "CStudioModel::BuildTextureMeshMap" );
 
-	if( !pFile )
-		return StudioModelLoadResult::FAILURE;
+	//Offsets in unvalidated models can't be trusted.
+	if( !m_bValidated )
+		return;
 
-	fseek( pFile, 0, SEEK_END );
-	const size_t size = ftell( pFile );
-	fseek( pFile, 0, SEEK_SET );
+	m_TextureMeshMap.clear();
+	m_TextureMeshMap.resize( m_pTextureHdr->numtextures );
 
-	std::unique_ptr<byte[]> buffer( new byte[ size ] );
+	const short* const pskinref = m_pTextureHdr->GetSkins();
 
-	studiohdr_t* pStudioHdr = reinterpret_cast<studiohdr_t*>( buffer.get() );
+	const byte* const pData = m_pStudioHdr->GetData();
 
-	if( !pStudioHdr )
+	for( int iBodyPart = 0; iBodyPart < m_pStudioHdr->numbodyparts; ++iBodyPart )
 	{
-		fclose( pFile );
-		return StudioModelLoadResult::FAILURE;
-	}
+		const mstudiobodyparts_t* const pbodypart = m_pStudioHdr->GetBodypart( iBodyPart );
 
-	const size_t uiRead = fread( pStudioHdr, size, 1, pFile );
-	fclose( pFile );
+		const mstudiomodel_t* const pModels = reinterpret_cast<const mstudiomodel_t*>( pData + pbodypart->modelindex );
 
-	if( uiRead != 1 )
-		return StudioModelLoadResult::FAILURE;
+		for( int iModel = 0; iModel < pbodypart->nummodels; ++iModel )
+		{
+			const mstudiomodel_t& model = pModels[ iModel ];
+
+			const mstudiomesh_t* const pMeshes = reinterpret_cast<const mstudiomesh_t*>( pData + model.meshindex );
+
+			for( int iMesh = 0; iMesh < model.nummesh; ++iMesh )
+			{
+				const mstudiomesh_t* const pMesh = pMeshes + iMesh;
+
+				const int iTexture = pskinref[ pMesh->skinref ];
+
+				if( iTexture < 0 || iTexture >= m_pTextureHdr->numtextures )
+					continue;
+
+				MeshInfo_t info;
+
+				info.pMesh = pMesh;
+				info.pTriCmds = reinterpret_cast<const short*>( pData + pMesh->triindex );
+
+				//Each command is a vertex count followed by 4 shorts per vertex; negative counts are fans.
+				const short* ptricmds = info.pTriCmds;
+
+				while( const int iCount = *ptricmds++ )
+				{
+					ptricmds += ( iCount < 0 ? -iCount : iCount ) * 4;
+				}
+
+				info.pTriCmdsEnd = ptricmds - 1;
+
+				m_TextureMeshMap[ iTexture ].push_back( info );
+			}
+		}
+	}
+}
+
+CStudioModel::BatchGeometry_t* CStudioModel::GetBatchGeometry( const int iBodyPart, const mstudiomodel_t* pModel )
+{
+	if( iBodyPart < 0 || static_cast<size_t>( iBodyPart ) >= m_BatchGeometryOffsets.size() )
+		return nullptr;
+
+	const mstudiobodyparts_t* const pbodypart = m_pStudioHdr->GetBodypart( iBodyPart );
+
+	const mstudiomodel_t* const pModels = reinterpret_cast<const mstudiomodel_t*>( m_pStudioHdr->GetData() + pbodypart->modelindex );
+
+	const ptrdiff_t iModel = pModel - pModels;
+
+	if( iModel < 0 || iModel >= pbodypart->nummodels )
+		return nullptr;
+
+	return &m_BatchGeometry[ m_BatchGeometryOffsets[ iBodyPart ] + iModel ];
+}
+
+void CStudioModel::BuildBatchGeometry()
+{
+	PROF_ZONE( "CStudioModel::BuildBatchGeometry" );
+
+	//Offsets in unvalidated models can't be trusted.
+	if( !m_bValidated )
+		return;
+
+	for( const auto& geometry : m_BatchGeometry )
+	{
+		if( geometry.indexBuffer )
+			glDeleteBuffers( 1, &geometry.indexBuffer );
+	}
+
+	m_BatchGeometry.clear();
+	m_BatchGeometryOffsets.clear();
+
+	const byte* const pData = m_pStudioHdr->GetData();
+
+	//Maps vertex, normal and texture coordinates to the vertex that uses them.
+	std::unordered_map<uint64_t, uint32_t> vertexLookup;
+
+	for( int iBodyPart = 0; iBodyPart < m_pStudioHdr->numbodyparts; ++iBodyPart )
+	{
+		const mstudiobodyparts_t* const pbodypart = m_pStudioHdr->GetBodypart( iBodyPart );
+
+		const mstudiomodel_t* const pModels = reinterpret_cast<const mstudiomodel_t*>( pData + pbodypart->modelindex );
+
+		m_BatchGeometryOffsets.push_back( m_BatchGeometry.size() );
+
+		for( int iModel = 0; iModel < pbodypart->nummodels; ++iModel )
+		{
+			const mstudiomodel_t& model = pModels[ iModel ];
+
+			m_BatchGeometry.emplace_back();
+
+			auto& geometry = m_BatchGeometry.back();
+
+			const mstudiomesh_t* const pMeshes = reinterpret_cast<const mstudiomesh_t*>( pData + model.meshindex );
+
+			for( int iMesh = 0; iMesh < model.nummesh; ++iMesh )
+			{
+				BatchMesh_t mesh;
+
+				mesh.pMesh = pMeshes + iMesh;
+				mesh.uiFirstVertex = static_cast<uint32_t>( geometry.vertices.size() );
+				mesh.uiFirstIndex = static_cast<uint32_t>( geometry.indices.size() );
+
+				vertexLookup.clear();
+
+				auto addVertex = [ & ]( const short* pCommand )
+				{
+					const uint64_t uiKey =
+						static_cast<uint64_t>( static_cast<uint16_t>( pCommand[ 0 ] ) ) |
+						static_cast<uint64_t>( static_cast<uint16_t>( pCommand[ 1 ] ) ) << 16 |
+						static_cast<uint64_t>( static_cast<uint16_t>( pCommand[ 2 ] ) ) << 32 |
+						static_cast<uint64_t>( static_cast<uint16_t>( pCommand[ 3 ] ) ) << 48;
+
+					auto result = vertexLookup.emplace( uiKey, static_cast<uint32_t>( geometry.vertices.size() ) );
+
+					if( result.second )
+						geometry.vertices.push_back( BatchVertex_t{ pCommand[ 0 ], pCommand[ 1 ], pCommand[ 2 ], pCommand[ 3 ] } );
+
+					return result.first->second;
+				};
+
+				const short* ptricmds = reinterpret_cast<const short*>( pData + mesh.pMesh->triindex );
+
+				//Each command is a vertex count followed by 4 shorts per vertex; negative counts are fans.
+				while( int iCount = *ptricmds++ )
+				{
+					const bool bFan = iCount < 0;
+
+					if( bFan )
+						iCount = -iCount;
+
+					if( iCount < 3 )
+					{
+						ptricmds += iCount * 4;
+						continue;
+					}
+
+					uint32_t uiFirst = addVertex( ptricmds );
+					uint32_t uiPrevious = addVertex( ptricmds + 4 );
+
+					for( int i = 2; i < iCount; ++i )
+					{
+						const uint32_t uiCurrent = addVertex( ptricmds + i * 4 );
+
+						//Same winding as the strips and fans that the triangle commands describe.
+						if( bFan || i % 2 == 0 )
+						{
+							geometry.indices.push_back( uiFirst );
+							geometry.indices.push_back( uiPrevious );
+						}
+						else
+						{
+							geometry.indices.push_back( uiPrevious );
+							geometry.indices.push_back( uiFirst );
+						}
+
+						geometry.indices.push_back( uiCurrent );
+
+						if( !bFan )
+							uiFirst = uiPrevious;
+
+						uiPrevious = uiCurrent;
+					}
+
+					ptricmds += iCount * 4;
+				}
+
+				mesh.uiNumVertices = static_cast<uint32_t>( geometry.vertices.size() ) - mesh.uiFirstVertex;
+				mesh.uiNumIndices = static_cast<uint32_t>( geometry.indices.size() ) - mesh.uiFirstIndex;
+
+				geometry.meshes.push_back( mesh );
+			}
+		}
+	}
+}
+
+mstudiomodel_t* CStudioModel::GetModelByBodyPart( const int iBody, const int iBodyPart ) const
+{
+	mstudiobodyparts_t* pbodypart = m_pStudioHdr->GetBodypart( iBodyPart );
+
+	int index = iBody / pbodypart->base;
+	index = index % pbodypart->nummodels;
+
+	return ( mstudiomodel_t * ) ( ( byte * ) m_pStudioHdr + pbodypart->modelindex ) + index;
+}
+
+bool CStudioModel::CalculateBodygroup( const int iGroup, const int iValue, int& iInOutBodygroup ) const
+{
+	if( iGroup > m_pStudioHdr->numbodyparts )
+		return false;
+
+	const mstudiobodyparts_t* const pbodypart = m_pStudioHdr->GetBodypart( iGroup );
+
+	int iCurrent = ( iInOutBodygroup / pbodypart->base ) % pbodypart->nummodels;
+
+	if( iValue >= pbodypart->nummodels )
+		return true;
+
+	iInOutBodygroup = ( iInOutBodygroup - ( iCurrent * pbodypart->base ) + ( iValue * pbodypart->base ) );
+
+	return true;
+}
+
+GLuint CStudioModel::GetTextureId( const int iIndex ) const
+{
+	const studiohdr_t* const pHdr = GetTextureHeader();
+
+	if( !pHdr )
+		return GL_INVALID_TEXTURE_ID;
+
+	if( iIndex < 0 || iIndex >= pHdr->numtextures )
+		return GL_INVALID_TEXTURE_ID;
+
+	return m_Textures[ iIndex ];
+}
+
+void CStudioModel::ReplaceTexture( mstudiotexture_t* ptexture, byte *data, byte *pal, GLuint textureId )
+{
+	DeleteRGBATextures( 1, &textureId );
+
+	UploadTexture( ptexture, data, pal, textureId, r_filtertextures.GetBool(), r_powerof2textures.GetBool() );
+}
+
+void CStudioModel::ReuploadTexture( mstudiotexture_t* ptexture )
+{
+	assert( ptexture );
+
+	const int iIndex = ptexture - m_pTextureHdr->GetTextures();
+
+	if( iIndex < 0 || iIndex >= m_pTextureHdr->numtextures )
+	{
+		Error( "CStudioModel::ReuploadTexture: Invalid texture!" );
+		return;
+	}
+
+	GLuint textureId = m_Textures[ iIndex ];
+
+	DeleteRGBATextures( 1, &textureId );
+
+	UploadTexture( ptexture, 
+				   m_pTextureHdr->GetData() + ptexture->index, 
+				   m_pTextureHdr->GetData() + ptexture->index + ptexture->width * ptexture->height, textureId, r_filtertextures.GetBool(), r_powerof2textures.GetBool() );
+}
+
+namespace
+{
+/**
+*	Loads a single studio header, and validates it.
+*	@param pszFilename Name of the file to load.
+*	@param bAllowSeqGroup Whether sequence group files are accepted.
+*	@param bIsDol Whether this is a .dol file.
+*	@param pOutStudioHdr If the file was loaded, receives the header.
+*	@param uiOutSize If the file was loaded, receives the size of the file, in bytes.
+*/
+StudioModelLoadResult LoadStudioHeader( const char* const pszFilename, const bool bAllowSeqGroup, const bool bIsDol, studiohdr_t*& pOutStudioHdr, size_t& uiOutSize )
+{
+	// load the model
+	FILE* pFile = fopen( pszFilename, "rb" );
+
+	if( !pFile )
+		return StudioModelLoadResult::FAILURE;
+
+	fseek( pFile, 0, SEEK_END );
+	const size_t size = ftell( pFile );
+	fseek( pFile, 0, SEEK_SET );
+
+	//Padding keeps the renderer's reads past the last animation value span inside the buffer.
+	std::unique_ptr<byte[]> buffer( new byte[ size + STUDIO_FILE_PADDING ] );
+
+	studiohdr_t* pStudioHdr = reinterpret_cast<studiohdr_t*>( buffer.get() );
+
+	if( !pStudioHdr )
+	{
+		fclose( pFile );
+		return StudioModelLoadResult::FAILURE;
+	}
+
+	memset( buffer.get() + size, 0, STUDIO_FILE_PADDING );
+
+	const size_t uiRead = fread( pStudioHdr, size, 1, pFile );
+	fclose( pFile );
+
+	if( uiRead != 1 )
+		return StudioModelLoadResult::FAILURE;
+
+	if( size < sizeof( studioseqhdr_t ) )
+		return StudioModelLoadResult::FAILURE;
 
 	if( strncmp( reinterpret_cast<const char*>( &pStudioHdr->id ), STUDIOMDL_HDR_ID, 4 ) &&
 		strncmp( reinterpret_cast<const char*>( &pStudioHdr->id ), STUDIOMDL_SEQ_ID, 4 ) )
 	{
-		return StudioModelLoadResult::FAILURE;
+		return StudioModelLoadResult::FAILURE;
+	}
+
+	if( !bAllowSeqGroup && !strncmp( reinterpret_cast<const char*>( &pStudioHdr->id ), STUDIOMDL_SEQ_ID, 4 ) )
+	{
+		return StudioModelLoadResult::FAILURE;
+	}
+
+	if( pStudioHdr->version != STUDIO_VERSION )
+	{
+		return StudioModelLoadResult::VERSIONDIFFERS;
+	}
+
+	std::string szError;
+
+	if( !ValidateStudioFile( buffer.get(), size, bIsDol, szError ) )
+	{
+		Error( "Model \"%s\" is invalid: %s\n", pszFilename, szError.c_str() );
+		return StudioModelLoadResult::INVALIDFILE;
+	}
+
+	pOutStudioHdr = pStudioHdr;
+	uiOutSize = size;
+
+	buffer.release();
+
+	return StudioModelLoadResult::SUCCESS;
+}
+
+/**
+*	Creates a texture header for a model whose textures haven't been loaded yet.
+*	Every skin reference maps to a single blank 1x1 texture, so the model can be drawn untextured.
+*	Negative skin references are not accounted for; check the result with ValidateTextureReferences.
+*/
+studiohdr_t* CreatePlaceholderTextureHeader( const studiohdr_t& studioHdr )
+{
+	int iNumSkinRefs = 1;
+
+	const byte* const pData = studioHdr.GetData();
+
+	for( int iBodyPart = 0; iBodyPart < studioHdr.numbodyparts; ++iBodyPart )
+	{
+		const mstudiobodyparts_t* const pbodypart = studioHdr.GetBodypart( iBodyPart );
+
+		const mstudiomodel_t* const pModels = reinterpret_cast<const mstudiomodel_t*>( pData + pbodypart->modelindex );
+
+		for( int iModel = 0; iModel < pbodypart->nummodels; ++iModel )
+		{
+			const mstudiomesh_t* const pMeshes = reinterpret_cast<const mstudiomesh_t*>( pData + pModels[ iModel ].meshindex );
+
+			for( int iMesh = 0; iMesh < pModels[ iModel ].nummesh; ++iMesh )
+			{
+				iNumSkinRefs = std::max( iNumSkinRefs, pMeshes[ iMesh ].skinref + 1 );
+			}
+		}
+	}
+
+	const size_t uiTextureIndex = sizeof( studiohdr_t );
+	const size_t uiSkinIndex = uiTextureIndex + sizeof( mstudiotexture_t );
+	const size_t uiTextureDataIndex = uiSkinIndex + sizeof( short ) * iNumSkinRefs;
+	const size_t uiLength = uiTextureDataIndex + 1 + PALETTE_SIZE;
+
+	std::unique_ptr<byte[]> buffer( new byte[ uiLength ]() );
+
+	studiohdr_t* const pHdr = reinterpret_cast<studiohdr_t*>( buffer.get() );
+
+	pHdr->id = studioHdr.id;
+	pHdr->version = studioHdr.version;
+	pHdr->length = static_cast<int>( uiLength );
+
+	pHdr->numtextures = 1;
+	pHdr->textureindex = static_cast<int>( uiTextureIndex );
+	pHdr->texturedataindex = static_cast<int>( uiTextureDataIndex );
+
+	pHdr->numskinref = iNumSkinRefs;
+	pHdr->numskinfamilies = 1;
+	pHdr->skinindex = static_cast<int>( uiSkinIndex );
+
+	mstudiotexture_t* const pTexture = pHdr->GetTexture( 0 );
+
+	pTexture->width = 1;
+	pTexture->height = 1;
+	pTexture->index = static_cast<int>( uiTextureDataIndex );
+
+	//Skins are all 0, so every skin reference uses the blank texture.
+	return reinterpret_cast<studiohdr_t*>( buffer.release() );
+}
+
+bool IsDolFilename( const char* const pszFilename )
+{
+	return std::experimental::filesystem::path( pszFilename ).extension() == ".dol";
+}
+
+/**
+*	Checks whether two versions of a file have the same layout and differ at most in the pixels and palettes of their textures.
+*/
+bool DiffersOnlyInTextureData( const studiohdr_t& oldHdr, const studiohdr_t& newHdr, const bool bIsDol )
+{
+	if( oldHdr.numtextures == 0 )
+		return false;
+
+	if( oldHdr.length != newHdr.length || oldHdr.numtextures != newHdr.numtextures || oldHdr.textureindex != newHdr.textureindex )
+		return false;
+
+	//The texture data ranges can only be skipped if both versions agree on where they are.
+	if( memcmp( oldHdr.GetTextures(), newHdr.GetTextures(), sizeof( mstudiotexture_t ) * oldHdr.numtextures ) )
+		return false;
+
+	std::vector<std::pair<size_t, size_t>> ranges;
+
+	ranges.reserve( oldHdr.numtextures );
+
+	for( int i = 0; i < oldHdr.numtextures; ++i )
+	{
+		const mstudiotexture_t& texture = *oldHdr.GetTexture( i );
+
+		ranges.emplace_back( texture.index, texture.index + GetTextureDataSize( texture, bIsDol ) );
+	}
+
+	std::sort( ranges.begin(), ranges.end() );
+
+	const size_t uiLength = oldHdr.length;
+
+	size_t uiOffset = 0;
+
+	for( const auto& range : ranges )
+	{
+		const size_t uiStart = std::min( range.first, uiLength );
+
+		if( uiStart > uiOffset && memcmp( oldHdr.GetData() + uiOffset, newHdr.GetData() + uiOffset, uiStart - uiOffset ) )
+			return false;
+
+		uiOffset = std::max( uiOffset, std::min( range.second, uiLength ) );
+	}
+
+	return uiOffset >= uiLength || !memcmp( oldHdr.GetData() + uiOffset, newHdr.GetData() + uiOffset, uiLength - uiOffset );
+}
+
+/**
+*	Copies the texture data of a new version of a file into the loaded one, and reuploads the textures that changed.
+*	The files must have the same layout.
+*	@return Number of textures that changed.
+*/
+int UpdateChangedTextures( studiohdr_t& textureHdr, studiohdr_t& newHdr, GLuint* pTextures, const bool bFilterTextures, const bool bPowerOf2, const bool bIsDol )
+{
+	int iNumChanged = 0;
+
+	byte* const pOldData = textureHdr.GetData();
+	byte* const pNewData = newHdr.GetData();
+
+	for( int i = 0; i < textureHdr.numtextures; ++i )
+	{
+		mstudiotexture_t& texture = *textureHdr.GetTexture( i );
+
+		const size_t uiPixels = texture.width * texture.height;
+
+		//Uploading modified the loaded data; do the same to the new data so unchanged textures compare equal.
+		if( bIsDol )
+		{
+			ConvertDolToMdl( pNewData, texture );
+		}
+
+		if( texture.flags & STUDIO_NF_MASKED )
+		{
+			byte* const pPalette = pNewData + texture.index + uiPixels;
+
+			pPalette[ 255 * 3 + 0 ] = pPalette[ 255 * 3 + 1 ] = pPalette[ 255 * 3 + 2 ] = 0;
+		}
+
+		if( !memcmp( pOldData + texture.index, pNewData + texture.index, uiPixels + PALETTE_SIZE ) )
+			continue;
+
+		memcpy( pOldData + texture.index, pNewData + texture.index, GetTextureDataSize( texture, bIsDol ) );
+
+		DeleteRGBATextures( 1, &pTextures[ i ] );
+
+		UploadTexture( &texture, pOldData + texture.index, pOldData + texture.index + uiPixels, pTextures[ i ], bFilterTextures, bPowerOf2 );
+
+		++iNumChanged;
+	}
+
+	return iNumChanged;
+}
+}
+
+std::string GetTextureFilename( const char* const pszFilename )
+{
+	assert( pszFilename );
+
+	const std::string szFilename( pszFilename );
+
+	//Replaces the extension.
+	return szFilename.substr( 0, szFilename.length() >= 4 ? szFilename.length() - 4 : 0 ) + ( IsDolFilename( pszFilename ) ? "T.dol" : "T.mdl" );
+}
+
+std::string GetSequenceGroupFilename( const char* const pszFilename, const int iGroup )
+{
+	assert( pszFilename );
+
+	const std::string szFilename( pszFilename );
+
+	char szSuffix[ 32 ];
+
+	snprintf( szSuffix, sizeof( szSuffix ), IsDolFilename( pszFilename ) ? "%02d.dol" : "%02d.mdl", iGroup );
+
+	return szFilename.substr( 0, szFilename.length() >= 4 ? szFilename.length() - 4 : 0 ) + szSuffix;
+}
+
+void GetStudioModelFiles( const char* const pszFilename, const CStudioModel& model, std::vector<std::string>& files )
+{
+	assert( pszFilename );
+
+	files.clear();
+
+	files.emplace_back( pszFilename );
+
+	if( model.GetTextureHeader() != model.GetStudioHeader() )
+	{
+		files.emplace_back( GetTextureFilename( pszFilename ) );
+	}
+
+	for( int i = 1; i < model.GetStudioHeader()->numseqgroups; ++i )
+	{
+		files.emplace_back( GetSequenceGroupFilename( pszFilename, i ) );
+	}
+}
+
+StudioModelLoadResult LoadStudioModel( const char* const pszFilename, CStudioModel*& pModel )
+{
+	PROF_ZONE( "studiomdl::LoadStudioModel" );
+
+	static auto& loads = stats::Registry().GetCounter( "studiomodel.loads" );
+	static auto& loadTime = stats::Registry().GetHistogram( "studiomodel.load_time", "ms" );
+
+	const auto start = std::chrono::steady_clock::now();
+
+	const auto bIsDol = IsDolFilename( pszFilename );
+
+	//Takes care of cleanup on failure.
+	std::unique_ptr<CStudioModel> studioModel( new CStudioModel() );
+
+	size_t uiSize;
+
+	std::string szError;
+
+	//Load the model
+	StudioModelLoadResult result = LoadStudioHeader( pszFilename, false, bIsDol, studioModel->m_pStudioHdr, uiSize );
+
+	if( result != StudioModelLoadResult::SUCCESS )
+	{
+		return result;
+	}
+
+	// preload textures
+	if( studioModel->m_pStudioHdr->numtextures == 0 )
+	{
+		const std::string szTextureName = GetTextureFilename( pszFilename );
+
+		result = LoadStudioHeader( szTextureName.c_str(), false, bIsDol, studioModel->m_pTextureHdr, uiSize );
+
+		if( result != StudioModelLoadResult::SUCCESS )
+		{
+			return result;
+		}
+
+		if( !ValidateTextureReferences( *studioModel->m_pStudioHdr, *studioModel->m_pTextureHdr, szError ) )
+		{
+			Error( "Model \"%s\" is invalid: %s\n", szTextureName.c_str(), szError.c_str() );
+			return StudioModelLoadResult::INVALIDFILE;
+		}
+	}
+	else
+	{
+		studioModel->m_pTextureHdr = studioModel->m_pStudioHdr;
 	}
 
-	if( !bAllowSeqGroup && !strncmp( reinterpret_cast<const char*>( &pStudioHdr->id ), STUDIOMDL_SEQ_ID, 4 ) )
+	// preload animations
+	if( studioModel->m_pStudioHdr->numseqgroups > 1 )
 	{
-		return StudioModelLoadResult::FAILURE;
+		for( int i = 1; i < studioModel->m_pStudioHdr->numseqgroups; ++i )
+		{
+			const std::string szSeqGroupName = GetSequenceGroupFilename( pszFilename, i );
+
+			result = LoadStudioHeader( szSeqGroupName.c_str(), true, bIsDol, studioModel->m_pSeqHdrs[ i ], uiSize );
+
+			if( result != StudioModelLoadResult::SUCCESS )
+			{
+				return result;
+			}
+
+			if( !ValidateSequenceGroupFile( *studioModel->m_pStudioHdr, i, reinterpret_cast<const byte*>( studioModel->m_pSeqHdrs[ i ] ), uiSize, szError ) )
+			{
+				Error( "Model \"%s\" is invalid: %s\n", szSeqGroupName.c_str(), szError.c_str() );
+				return StudioModelLoadResult::INVALIDFILE;
+			}
+		}
 	}
 
-	if( pStudioHdr->version != STUDIO_VERSION )
+	studioModel->m_bValidated = true;
+
+	studioModel->BuildSequenceChannels();
+	studioModel->BuildSequenceEvents();
+	studioModel->BuildTextureMeshMap();
+	studioModel->BuildBatchGeometry();
+
 	{
-		return StudioModelLoadResult::VERSIONDIFFERS;
+		PROF_ZONE( "studiomdl::UploadTextures" );
+
+		UploadTextures( *studioModel->m_pTextureHdr, studioModel->m_Textures, r_filtertextures.GetBool(), r_powerof2textures.GetBool(), bIsDol );
 	}
 
-	pOutStudioHdr = pStudioHdr;
+	pModel = studioModel.release();
 
-	buffer.release();
+	loads.Add();
+	loadTime.Record( std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count() );
 
 	return StudioModelLoadResult::SUCCESS;
 }
+
+/**
+*	Converted pixels of a model's textures.
+*/
+struct CStudioModelLoader::DecodedTextures_t
+{
+	std::vector<StagedTexture_t> staged;
+
+	std::unique_ptr<byte[]> pixels;
+};
+
+CStudioModelLoader::CStudioModelLoader()
+{
+}
+
+CStudioModelLoader::~CStudioModelLoader()
+{
+	Cancel();
 }
 
-StudioModelLoadResult LoadStudioModel( const char* const pszFilename, CStudioModel*& pModel )
+StudioModelLoadResult CStudioModelLoader::Start( const char* const pszFilename, CStudioModel*& pModel )
 {
-	const auto bIsDol = std::experimental::filesystem::path( pszFilename ).extension() == ".dol";
+	PROF_ZONE( "studiomdl::CStudioModelLoader::Start" );
+
+	static auto& firstFrameTime = stats::Registry().GetHistogram( "studiomodel.first_frame_time", "ms" );
+
+	assert( pszFilename );
+
+	Cancel();
+
+	m_pModel = nullptr;
+	m_Stage = StudioModelLoadStage::NONE;
+	m_Result = StudioModelLoadResult::SUCCESS;
+	m_PostedStage = StudioModelLoadStage::NONE;
+	m_PostedResult = StudioModelLoadResult::SUCCESS;
+
+	m_StartTime = std::chrono::steady_clock::now();
+
+	m_szFilename = pszFilename;
+	m_bIsDol = IsDolFilename( pszFilename );
+	m_bPowerOf2 = r_powerof2textures.GetBool();
 
 	//Takes care of cleanup on failure.
 	std::unique_ptr<CStudioModel> studioModel( new CStudioModel() );
 
-	//Load the model
-	StudioModelLoadResult result = LoadStudioHeader( pszFilename, false, studioModel->m_pStudioHdr );
+	size_t uiSize;
+
+	const StudioModelLoadResult result = LoadStudioHeader( pszFilename, false, m_bIsDol, studioModel->m_pStudioHdr, uiSize );
 
 	if( result != StudioModelLoadResult::SUCCESS )
-	{
 		return result;
+
+	studiohdr_t* const pStudioHdr = studioModel->m_pStudioHdr;
+
+	if( pStudioHdr->numtextures == 0 )
+	{
+		studioModel->m_pTextureHdr = CreatePlaceholderTextureHeader( *pStudioHdr );
+
+		std::string szError;
+
+		if( !ValidateTextureReferences( *pStudioHdr, *studioModel->m_pTextureHdr, szError ) )
+		{
+			Error( "Model \"%s\" is invalid: %s\n", pszFilename, szError.c_str() );
+			return StudioModelLoadResult::INVALIDFILE;
+		}
+
+		m_pEmbeddedTextureHdr = nullptr;
+	}
+	else
+	{
+		studioModel->m_pTextureHdr = pStudioHdr;
+
+		m_pEmbeddedTextureHdr = pStudioHdr;
 	}
 
-	// preload textures
-	if( studioModel->m_pStudioHdr->numtextures == 0 )
+	//Everything that was loaded so far was validated, and the placeholder textures match the model.
+	studioModel->m_bValidated = true;
+	studioModel->m_bTexturesLoaded = false;
+	studioModel->m_bSeqGroupsLoaded = pStudioHdr->numseqgroups <= 1;
+
+	studioModel->BuildSequenceChannels();
+	studioModel->BuildSequenceEvents();
+	studioModel->BuildTextureMeshMap();
+	studioModel->BuildBatchGeometry();
+
+	m_pStudioHdr = pStudioHdr;
+
+	m_PreviewTextures.reset( new DecodedTextures_t() );
+	m_Textures.reset( new DecodedTextures_t() );
+
+	m_pModel = pModel = studioModel.release();
+
+	m_Stage = StudioModelLoadStage::GEOMETRY;
+
+	firstFrameTime.Record( std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - m_StartTime ).count() );
+
+	m_Worker = std::thread( &CStudioModelLoader::Run, this );
+
+	return StudioModelLoadResult::SUCCESS;
+}
+
+bool CStudioModelLoader::Update()
+{
+	if( !m_Worker.joinable() )
+		return false;
+
+	PROF_ZONE( "studiomdl::CStudioModelLoader::Update" );
+
+	static auto& loads = stats::Registry().GetCounter( "studiomodel.loads" );
+	static auto& loadTime = stats::Registry().GetHistogram( "studiomodel.load_time", "ms" );
+
+	StudioModelLoadStage postedStage;
+	StudioModelLoadResult postedResult;
+
 	{
-		const auto extension = bIsDol ? "T.dol" : "T.mdl";
+		std::lock_guard<std::mutex> lock( m_Mutex );
 
-		char texturename[ MAX_PATH_LENGTH ];
+		postedStage = m_PostedStage;
+		postedResult = m_PostedResult;
+	}
 
-		strcpy( texturename, pszFilename );
-		strcpy( &texturename[ strlen( texturename ) - 4 ], extension );
+	const StudioModelLoadStage oldStage = m_Stage;
 
-		result = LoadStudioHeader( texturename, true, studioModel->m_pTextureHdr );
+	CStudioModel& model = *m_pModel;
 
-		if( result != StudioModelLoadResult::SUCCESS )
+	if( m_Stage < StudioModelLoadStage::PREVIEWTEXTURES && postedStage >= StudioModelLoadStage::PREVIEWTEXTURES )
+	{
+		//Replace the placeholder. Its texture was never uploaded.
+		if( m_pTextureHdr )
 		{
-			return result;
+			delete[] model.m_pTextureHdr;
+
+			model.m_pTextureHdr = m_pTextureHdr;
+			m_pTextureHdr = nullptr;
 		}
+
+		glBindTexture( GL_TEXTURE_2D, 0 );
+		glGenTextures( model.m_pTextureHdr->numtextures, model.m_Textures );
+
+		UploadStagedTextures( m_PreviewTextures->staged, m_PreviewTextures->pixels.get(), model.m_Textures, r_filtertextures.GetBool() );
+
+		m_PreviewTextures.reset();
+
+		model.BuildTextureMeshMap();
+
+		m_Stage = StudioModelLoadStage::PREVIEWTEXTURES;
 	}
-	else
+
+	if( m_Stage < StudioModelLoadStage::TEXTURES && postedStage >= StudioModelLoadStage::TEXTURES )
 	{
-		studioModel->m_pTextureHdr = studioModel->m_pStudioHdr;
+		DeleteRGBATextures( model.m_pTextureHdr->numtextures, model.m_Textures );
+
+		glGenTextures( model.m_pTextureHdr->numtextures, model.m_Textures );
+
+		UploadStagedTextures( m_Textures->staged, m_Textures->pixels.get(), model.m_Textures, r_filtertextures.GetBool() );
+
+		m_Textures.reset();
+
+		model.m_bTexturesLoaded = true;
+
+		m_Stage = StudioModelLoadStage::TEXTURES;
 	}
 
-	// preload animations
-	if( studioModel->m_pStudioHdr->numseqgroups > 1 )
+	if( m_Stage < StudioModelLoadStage::COMPLETE && postedStage >= StudioModelLoadStage::COMPLETE )
 	{
-		char seqgroupname[ MAX_PATH_LENGTH ];
+		for( int i = 1; i < model.m_pStudioHdr->numseqgroups; ++i )
+		{
+			model.m_pSeqHdrs[ i ] = m_pSeqHdrs[ i ];
+			m_pSeqHdrs[ i ] = nullptr;
+		}
 
-		for( int i = 1; i < studioModel->m_pStudioHdr->numseqgroups; ++i )
+		model.m_bSeqGroupsLoaded = true;
+
+		model.BuildSequenceChannels();
+
+		m_Stage = StudioModelLoadStage::COMPLETE;
+	}
+
+	const bool bFailed = postedResult != StudioModelLoadResult::SUCCESS;
+
+	if( m_Stage == StudioModelLoadStage::COMPLETE || bFailed )
+	{
+		m_Worker.join();
+
+		m_Result = postedResult;
+
+		FreeUnappliedData();
+
+		if( !bFailed )
 		{
-			const auto suffix = bIsDol ? "%02d.dol" : "%02d.mdl";
+			loads.Add();
+			loadTime.Record( std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - m_StartTime ).count() );
+		}
+	}
 
-			strcpy( seqgroupname, pszFilename );
+	return m_Stage != oldStage || bFailed;
+}
 
-			if( !PrintfSuccess( snprintf( &seqgroupname[ strlen( seqgroupname ) - 4 ], sizeof( seqgroupname ), suffix, i ), sizeof( seqgroupname ) ) )
-				return StudioModelLoadResult::FAILURE;
+void CStudioModelLoader::Cancel()
+{
+	if( m_Worker.joinable() )
+	{
+		m_bCancel = true;
 
-			result = LoadStudioHeader( seqgroupname, true, studioModel->m_pSeqHdrs[ i ] );
+		m_Worker.join();
 
-			if( result != StudioModelLoadResult::SUCCESS )
-			{
-				return result;
-			}
+		m_bCancel = false;
+	}
+
+	FreeUnappliedData();
+}
+
+void CStudioModelLoader::Run()
+{
+	prof::SetThreadName( "Model loader" );
+
+	PROF_ZONE( "studiomdl::CStudioModelLoader::Run" );
+
+	StudioModelLoadResult result;
+
+	size_t uiSize;
+
+	std::string szError;
+
+	//Textures stored in the main file are decoded in place. Nothing else accesses their data until the textures are loaded.
+	studiohdr_t* pTextureHdr = m_pEmbeddedTextureHdr;
+
+	if( !pTextureHdr )
+	{
+		const std::string szTextureName = GetTextureFilename( m_szFilename.c_str() );
+
+		result = LoadStudioHeader( szTextureName.c_str(), false, m_bIsDol, m_pTextureHdr, uiSize );
+
+		if( result == StudioModelLoadResult::SUCCESS && !ValidateTextureReferences( *m_pStudioHdr, *m_pTextureHdr, szError ) )
+		{
+			Error( "Model \"%s\" is invalid: %s\n", szTextureName.c_str(), szError.c_str() );
+			result = StudioModelLoadResult::INVALIDFILE;
+		}
+
+		if( result != StudioModelLoadResult::SUCCESS )
+		{
+			Fail( result );
+			return;
 		}
+
+		pTextureHdr = m_pTextureHdr;
 	}
 
-	UploadTextures( *studioModel->m_pTextureHdr, studioModel->m_Textures, r_filtertextures.GetBool(), r_powerof2textures.GetBool(), bIsDol );
+	const auto decode = [ & ]( const int iDownscale, const bool bIsDol, DecodedTextures_t& decoded )
+	{
+		const size_t uiStagingSize = LayoutStagedTextures( *pTextureHdr, m_bPowerOf2, iDownscale, decoded.staged );
+
+		decoded.pixels.reset( new byte[ uiStagingSize ] );
 
-	pModel = studioModel.release();
+		DecodeStagedTextures( *pTextureHdr, decoded.staged, uiStagingSize, decoded.pixels.get(), bIsDol );
+	};
 
-	return StudioModelLoadResult::SUCCESS;
+	decode( PREVIEW_TEXTURE_DOWNSCALE, m_bIsDol, *m_PreviewTextures );
+
+	if( !Post( StudioModelLoadStage::PREVIEWTEXTURES ) )
+		return;
+
+	//Dol textures were converted when the previews were decoded.
+	decode( 1, false, *m_Textures );
+
+	if( !Post( StudioModelLoadStage::TEXTURES ) )
+		return;
+
+	for( int i = 1; i < m_pStudioHdr->numseqgroups; ++i )
+	{
+		if( m_bCancel )
+			return;
+
+		const std::string szSeqGroupName = GetSequenceGroupFilename( m_szFilename.c_str(), i );
+
+		result = LoadStudioHeader( szSeqGroupName.c_str(), true, m_bIsDol, m_pSeqHdrs[ i ], uiSize );
+
+		if( result == StudioModelLoadResult::SUCCESS &&
+			!ValidateSequenceGroupFile( *m_pStudioHdr, i, reinterpret_cast<const byte*>( m_pSeqHdrs[ i ] ), uiSize, szError ) )
+		{
+			Error( "Model \"%s\" is invalid: %s\n", szSeqGroupName.c_str(), szError.c_str() );
+			result = StudioModelLoadResult::INVALIDFILE;
+		}
+
+		if( result != StudioModelLoadResult::SUCCESS )
+		{
+			Fail( result );
+			return;
+		}
+	}
+
+	Post( StudioModelLoadStage::COMPLETE );
+}
+
+bool CStudioModelLoader::Post( const StudioModelLoadStage stage )
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	m_PostedStage = stage;
+
+	return !m_bCancel;
+}
+
+void CStudioModelLoader::Fail( const StudioModelLoadResult result )
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	m_PostedResult = result;
+}
+
+void CStudioModelLoader::FreeUnappliedData()
+{
+	delete[] m_pTextureHdr;
+	m_pTextureHdr = nullptr;
+
+	m_PreviewTextures.reset();
+	m_Textures.reset();
+
+	for( auto& pSeqHdr : m_pSeqHdrs )
+	{
+		delete[] pSeqHdr;
+		pSeqHdr = nullptr;
+	}
+
+	m_pStudioHdr = nullptr;
+	m_pEmbeddedTextureHdr = nullptr;
 }
 
 bool SaveStudioModel( const char* const pszFilename, const CStudioModel* const pModel )
@@ -507,6 +1613,10 @@ bool SaveStudioModel( const char* const pszFilename, const CStudioModel* const p
 	if( !pModel )
 		return false;
 
+	//Models that are still loading have placeholder data.
+	if( !pModel->IsLoaded() )
+		return false;
+
 	FILE* pFile = fopen( pszFilename, "wb" );
 
 	if( !pFile )
@@ -577,6 +1687,140 @@ bool SaveStudioModel( const char* const pszFilename, const CStudioModel* const p
 	return true;
 }
 
+StudioModelReloadResult ReloadStudioModelFile( const char* const pszFilename, CStudioModel& model, const char* const pszChangedFilename )
+{
+	PROF_ZONE( "studiomdl::ReloadStudioModelFile" );
+
+	static auto& reloads = stats::Registry().GetCounter( "studiomodel.reloads" );
+	static auto& reloadTime = stats::Registry().GetHistogram( "studiomodel.reload_time", "ms" );
+
+	assert( pszFilename );
+	assert( pszChangedFilename );
+
+	//Unvalidated data can't be compared safely, and models that are still loading don't have all of their data yet.
+	if( !model.m_bValidated || !model.IsLoaded() )
+		return StudioModelReloadResult::NEEDSFULLRELOAD;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	const bool bIsDol = IsDolFilename( pszFilename );
+
+	//Find out which file changed. Group 0 is the model itself.
+	int iSeqGroup = -1;
+	bool bIsTextureFile = false;
+
+	if( !strcmp( pszChangedFilename, pszFilename ) )
+	{
+		iSeqGroup = 0;
+	}
+	else if( model.m_pTextureHdr != model.m_pStudioHdr && GetTextureFilename( pszFilename ) == pszChangedFilename )
+	{
+		bIsTextureFile = true;
+	}
+	else
+	{
+		for( int i = 1; i < model.m_pStudioHdr->numseqgroups; ++i )
+		{
+			if( GetSequenceGroupFilename( pszFilename, i ) == pszChangedFilename )
+			{
+				iSeqGroup = i;
+				break;
+			}
+		}
+
+		if( iSeqGroup == -1 )
+			return StudioModelReloadResult::UNCHANGED;
+	}
+
+	studiohdr_t* pNewHdr;
+	size_t uiSize;
+
+	if( LoadStudioHeader( pszChangedFilename, iSeqGroup > 0, bIsDol, pNewHdr, uiSize ) != StudioModelLoadResult::SUCCESS )
+		return StudioModelReloadResult::FAILURE;
+
+	//Takes care of cleanup if the new data isn't kept.
+	std::unique_ptr<byte[]> newBuffer( pNewHdr->GetData() );
+
+	std::string szError;
+
+	StudioModelReloadResult result;
+
+	if( iSeqGroup > 0 )
+	{
+		studiohdr_t*& pSeqHdr = model.m_pSeqHdrs[ iSeqGroup ];
+
+		if( pSeqHdr->length == pNewHdr->length && !memcmp( pSeqHdr, pNewHdr, pNewHdr->length ) )
+			return StudioModelReloadResult::UNCHANGED;
+
+		if( !ValidateSequenceGroupFile( *model.m_pStudioHdr, iSeqGroup, newBuffer.get(), uiSize, szError ) )
+		{
+			Error( "Model \"%s\" is invalid: %s\n", pszChangedFilename, szError.c_str() );
+			return StudioModelReloadResult::FAILURE;
+		}
+
+		delete[] reinterpret_cast<byte*>( pSeqHdr );
+
+		pSeqHdr = pNewHdr;
+
+		newBuffer.release();
+
+		//The animation data is different.
+		model.BuildSequenceChannels();
+
+		result = StudioModelReloadResult::SEQUENCEGROUP;
+	}
+	else
+	{
+		studiohdr_t& oldHdr = bIsTextureFile ? *model.m_pTextureHdr : *model.m_pStudioHdr;
+
+		if( DiffersOnlyInTextureData( oldHdr, *pNewHdr, bIsDol ) )
+		{
+			if( UpdateChangedTextures( oldHdr, *pNewHdr, model.m_Textures, r_filtertextures.GetBool(), r_powerof2textures.GetBool(), bIsDol ) == 0 )
+				return StudioModelReloadResult::UNCHANGED;
+
+			result = StudioModelReloadResult::TEXTURESUPDATED;
+		}
+		else if( oldHdr.length == pNewHdr->length && !memcmp( &oldHdr, pNewHdr, pNewHdr->length ) )
+		{
+			return StudioModelReloadResult::UNCHANGED;
+		}
+		else if( bIsTextureFile )
+		{
+			if( !ValidateTextureReferences( *model.m_pStudioHdr, *pNewHdr, szError ) )
+			{
+				Error( "Model \"%s\" is invalid: %s\n", pszChangedFilename, szError.c_str() );
+				return StudioModelReloadResult::FAILURE;
+			}
+
+			DeleteRGBATextures( model.m_pTextureHdr->numtextures, model.m_Textures );
+
+			memset( model.m_Textures, 0, sizeof( model.m_Textures ) );
+
+			delete[] reinterpret_cast<byte*>( model.m_pTextureHdr );
+
+			model.m_pTextureHdr = pNewHdr;
+
+			newBuffer.release();
+
+			UploadTextures( *model.m_pTextureHdr, model.m_Textures, r_filtertextures.GetBool(), r_powerof2textures.GetBool(), bIsDol );
+
+			//Skins may refer to different textures now.
+			model.BuildTextureMeshMap();
+
+			result = StudioModelReloadResult::TEXTURESREPLACED;
+		}
+		else
+		{
+			return StudioModelReloadResult::NEEDSFULLRELOAD;
+		}
+	}
+
+	reloads.Add();
+	reloadTime.Record( std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count() );
+
+	return result;
+}
+
 void ScaleMeshes( CStudioModel* pStudioModel, const float flScale )
 {
 	assert( pStudioModel );
@@ -649,6 +1893,9 @@ void ScaleBones( CStudioModel* pStudioModel, const float flScale )
 			pbones[ i ].scale[ j ] *= flScale;
 		}
 	}
+
+	//Static bone positions have changed.
+	pStudioModel->BuildSequenceChannels();
 }
 
 const char* ControlToString( const int iControl )
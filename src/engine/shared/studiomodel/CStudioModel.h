@@ -1,6 +1,13 @@
 #ifndef GAME_STUDIOMODEL_CSTUDIOMODEL_H
 #define GAME_STUDIOMODEL_CSTUDIOMODEL_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include <glm/vec3.hpp>
@@ -13,6 +20,8 @@
 #include "graphics/OpenGL.h"
 
 #include "studio.h"
+#include "StudioPose.h"
+#include "StudioEvents.h"
 
 namespace studiomdl
 {
@@ -21,11 +30,58 @@ enum class StudioModelLoadResult
 	SUCCESS = 0,
 	FAILURE,			//Generic error on load.
 	POSTLOADFAILURE,	//Generic error on post load.
-	VERSIONDIFFERS		//Header version differs from current.
+	VERSIONDIFFERS,		//Header version differs from current.
+	INVALIDFILE			//File contents failed validation. The problem is logged as an error.
+};
+
+/**
+*	Result of reloading one of a studio model's files.
+*/
+enum class StudioModelReloadResult
+{
+	UNCHANGED = 0,		//The file's contents match the loaded data, or the file isn't part of the model.
+	TEXTURESUPDATED,	//Pixels or palettes of existing textures changed. Changed textures were reuploaded.
+	TEXTURESREPLACED,	//The texture file's layout changed. All textures were replaced; names, sizes and skins may differ.
+	SEQUENCEGROUP,		//A sequence group file was replaced.
+	NEEDSFULLRELOAD,	//The model's structure changed. The model must be loaded again.
+	FAILURE				//The file couldn't be loaded or is invalid. The model is unchanged.
+};
+
+/**
+*	Stage of a progressive load. Stages are reached in this order.
+*/
+enum class StudioModelLoadStage
+{
+	NONE = 0,			//Not loading.
+	GEOMETRY,			//The main file was loaded. The model has placeholder textures, and sequences in other groups use the bind pose.
+	PREVIEWTEXTURES,	//Downsampled textures were uploaded. The texture header is the model's own.
+	TEXTURES,			//Full resolution textures were uploaded.
+	COMPLETE			//Sequence groups were loaded. The model is fully loaded.
 };
 
 class CStudioModel;
 
+/**
+*	Gets the name of the file that contains the textures of a model that doesn't have its own.
+*	@param pszFilename Name of the model.
+*/
+std::string GetTextureFilename( const char* const pszFilename );
+
+/**
+*	Gets the name of a sequence group file of a model.
+*	@param pszFilename Name of the model.
+*	@param iGroup Sequence group. Group 0 is stored in the model itself.
+*/
+std::string GetSequenceGroupFilename( const char* const pszFilename, const int iGroup );
+
+/**
+*	Gets the names of all files that a loaded model was loaded from.
+*	@param pszFilename Name of the model.
+*	@param model Model.
+*	@param files Receives the names. Cleared first.
+*/
+void GetStudioModelFiles( const char* const pszFilename, const CStudioModel& model, std::vector<std::string>& files );
+
 /**
 *	Loads a studio model.
 *	@param pszFilename Name of the model to load. This is the entire path, including the extension.
@@ -42,17 +98,106 @@ StudioModelLoadResult LoadStudioModel( const char* const pszFilename, CStudioMod
 */
 bool SaveStudioModel( const char* const pszFilename, const CStudioModel* const pModel );
 
+/**
+*	Reloads one of a model's files after it has changed on disk, updating only what differs.
+*	Texture data is updated in place, and sequence group files are swapped, so pointers to the model stay valid.
+*	Changes to anything else require the model to be loaded again.
+*	An OpenGL context must be current.
+*	@param pszFilename Name of the model, as it was loaded.
+*	@param model Model to update. Models that weren't validated or are still loading always need a full reload.
+*	@param pszChangedFilename Name of the file that changed. Must be named the same way as the names returned by GetStudioModelFiles.
+*	@return What was reloaded.
+*/
+StudioModelReloadResult ReloadStudioModelFile( const char* const pszFilename, CStudioModel& model, const char* const pszChangedFilename );
+
 /**
 *	Container representing a studiomodel and its data.
 */
 class CStudioModel final
 {
-private:
-	typedef std::vector<const mstudiomesh_t*> MeshList_t;
+public:
+	/**
+	*	A mesh and its triangle commands.
+	*/
+	struct MeshInfo_t
+	{
+		const mstudiomesh_t* pMesh;
+
+		/**
+		*	Triangle commands of the mesh. Does not include the terminating 0.
+		*/
+		const short* pTriCmds;
+		const short* pTriCmdsEnd;
+	};
+
+	/**
+	*	Vertex of a submodel, as referenced by its triangle commands.
+	*/
+	struct BatchVertex_t
+	{
+		short iVertex;
+		short iNormal;
+		short s;
+		short t;
+	};
+
+	/**
+	*	A mesh's triangles, as ranges of its submodel's batch vertices and indices.
+	*/
+	struct BatchMesh_t
+	{
+		const mstudiomesh_t* pMesh;
+
+		uint32_t uiFirstVertex;
+		uint32_t uiNumVertices;
+
+		uint32_t uiFirstIndex;
+		uint32_t uiNumIndices;
+	};
+
+	/**
+	*	Triangle lists of a submodel, built from its triangle commands so many instances of it can be drawn at once.
+	*	Vertices are unique within each mesh. Indices refer to the submodel's vertices.
+	*/
+	struct BatchGeometry_t
+	{
+		std::vector<BatchVertex_t> vertices;
+		std::vector<BatchMesh_t> meshes;
+		std::vector<uint32_t> indices;
+
+		/**
+		*	Element buffer that holds the indices repeated for a number of instances, grouped by mesh.
+		*	Created by the renderer when it first draws the submodel, freed with the model.
+		*/
+		GLuint indexBuffer = 0;
+		size_t uiIndexBufferInstances = 0;
+	};
+
+	typedef std::vector<MeshInfo_t> MeshList_t;
 	typedef std::vector<MeshList_t> TextureMeshMap_t;
 
+	/**
+	*	View of the meshes that use a texture.
+	*	Valid until the texture mesh map is rebuilt or the model is freed.
+	*/
+	struct MeshListView_t
+	{
+		const MeshInfo_t* pBegin = nullptr;
+		const MeshInfo_t* pEnd = nullptr;
+
+		const MeshInfo_t* begin() const { return pBegin; }
+		const MeshInfo_t* end() const { return pEnd; }
+
+		size_t size() const { return pEnd - pBegin; }
+		bool empty() const { return pBegin == pEnd; }
+
+		const MeshInfo_t& operator[]( const size_t uiIndex ) const { return pBegin[ uiIndex ]; }
+	};
+
 protected:
 	friend StudioModelLoadResult LoadStudioModel( const char* const pszFilename, CStudioModel*& pModel );
+	friend StudioModelReloadResult ReloadStudioModelFile( const char* const pszFilename, CStudioModel& model, const char* const pszChangedFilename );
+	friend class CStudioModelLoader;
 
 public:
 	static const size_t MAX_SEQGROUPS = 32;
@@ -67,8 +212,85 @@ public:
 	studiohdr_t*	GetTextureHeader() const { return m_pTextureHdr; }
 	studiohdr_t*	GetSeqGroupHeader( const size_t i ) const { return m_pSeqHdrs[ i ]; }
 
+	/**
+	*	Whether all of this model's files passed validation when it was loaded.
+	*	If so, every count, index and offset in the headers refers to valid data, and code that reads them doesn't need to check them again.
+	*	Values provided by the user, like sequence and skin numbers, still need to be checked.
+	*/
+	bool			IsValidated() const { return m_bValidated; }
+
+	/**
+	*	Whether the model's textures have been loaded. Models that are still loading have placeholder textures. See CStudioModelLoader.
+	*/
+	bool			AreTexturesLoaded() const { return m_bTexturesLoaded; }
+
+	/**
+	*	Whether the model's sequence group files have been loaded. See CStudioModelLoader.
+	*/
+	bool			AreSequenceGroupsLoaded() const { return m_bSeqGroupsLoaded; }
+
+	/**
+	*	Whether all of the model's files have been loaded.
+	*/
+	bool			IsLoaded() const { return m_bTexturesLoaded && m_bSeqGroupsLoaded; }
+
+	/**
+	*	Gets the animations of a sequence.
+	*	@return The animations, or null if the sequence is stored in a sequence group that hasn't been loaded yet.
+	*/
 	mstudioanim_t*	GetAnim( mstudioseqdesc_t* pseqdesc ) const;
 
+	/**
+	*	Gets the analysis of which channels of a sequence change.
+	*	@return The analysis, or null if it hasn't been built. Only validated models are analyzed.
+	*/
+	const SequenceChannels_t* GetSequenceChannels( const int iSequence ) const;
+
+	/**
+	*	Analyzes the animated channels of all sequences. Done when the model is loaded.
+	*	Must be called again after editing bones or animations.
+	*/
+	void BuildSequenceChannels();
+
+	/**
+	*	Gets the event index of a sequence.
+	*	@return The index, or null if it hasn't been built. Only validated models are indexed.
+	*/
+	const SequenceEvents_t* GetSequenceEvents( const int iSequence ) const;
+
+	/**
+	*	Indexes the events of all sequences. Done when the model is loaded.
+	*	Must be called again after editing events.
+	*/
+	void BuildSequenceEvents();
+
+	/**
+	*	Gets the meshes that use the given texture, in every body part and submodel. Uses the first skin family.
+	*	@return The meshes, or an empty view if the texture index is invalid or the map hasn't been built.
+	*		Only validated models are mapped.
+	*/
+	MeshListView_t GetTextureMeshes( const int iTexture ) const;
+
+	/**
+	*	Maps textures to the meshes that use them. Done when the model is loaded.
+	*	Must be called again after editing meshes, triangle commands or skin references.
+	*/
+	void BuildTextureMeshMap();
+
+	/**
+	*	Gets the batch geometry of a submodel.
+	*	@param iBodyPart Body part that the submodel belongs to.
+	*	@param pModel Submodel.
+	*	@return The geometry, or null if it hasn't been built. Only validated models have batch geometry.
+	*/
+	BatchGeometry_t* GetBatchGeometry( const int iBodyPart, const mstudiomodel_t* pModel );
+
+	/**
+	*	Builds the batch geometry of all submodels. Done when the model is loaded.
+	*	Must be called again after editing meshes or triangle commands.
+	*/
+	void BuildBatchGeometry();
+
 	mstudiomodel_t* GetModelByBodyPart( const int iBody, const int iBodyPart ) const;
 
 	bool			CalculateBodygroup( const int iGroup, const int iValue, int& iInOutBodygroup ) const;
@@ -91,11 +313,170 @@ private:
 
 	GLuint			m_Textures[ MAXSTUDIOSKINS ];
 
+	bool			m_bValidated;
+
+	bool			m_bTexturesLoaded;
+	bool			m_bSeqGroupsLoaded;
+
+	std::vector<SequenceChannels_t> m_SequenceChannels;
+
+	std::vector<SequenceEvents_t> m_SequenceEvents;
+
+	TextureMeshMap_t m_TextureMeshMap;
+
+	std::vector<BatchGeometry_t> m_BatchGeometry;
+
+	/**
+	*	Index of the first submodel of each body part in m_BatchGeometry.
+	*/
+	std::vector<size_t> m_BatchGeometryOffsets;
+
 private:
 	CStudioModel( const CStudioModel& ) = delete;
 	CStudioModel& operator=( const CStudioModel& ) = delete;
 };
 
+/**
+*	Loads a studio model in stages, so it can be shown before all of its files have been read.
+*	The main file is loaded when the load is started. Texture and sequence group files are read and decoded on a worker thread,
+*	and the model is updated as each stage completes: untextured geometry first, then downsampled textures,
+*	then full resolution textures, and finally sequence groups.
+*	Until its textures are loaded, the model's texture data must not be modified.
+*	The model must not be freed while it is loading; cancel the load first.
+*/
+class CStudioModelLoader final
+{
+private:
+	struct DecodedTextures_t;
+
+public:
+	CStudioModelLoader();
+	~CStudioModelLoader();
+
+	/**
+	*	Gets the last stage that was applied to the model.
+	*/
+	StudioModelLoadStage GetStage() const { return m_Stage; }
+
+	/**
+	*	Whether a load was started, and hasn't completed, failed or been cancelled yet.
+	*/
+	bool IsLoading() const { return m_Worker.joinable(); }
+
+	/**
+	*	Whether the last load failed after it was started. The model is incomplete and should be freed.
+	*/
+	bool HasFailed() const { return m_Result != StudioModelLoadResult::SUCCESS; }
+
+	/**
+	*	Gets the model that is being loaded, or null if no load was started.
+	*/
+	CStudioModel* GetModel() const { return m_pModel; }
+
+	/**
+	*	Loads the main file of a model, and starts loading the rest on a worker thread. Cancels the current load, if any.
+	*	@param pszFilename Name of the model to load. This is the entire path, including the extension.
+	*	@param pModel If the main file was loaded, receives the model. The caller owns it.
+	*	@return StudioModelLoadResult::SUCCESS if the main file was loaded, an error code in all other cases.
+	*/
+	StudioModelLoadResult Start( const char* const pszFilename, CStudioModel*& pModel );
+
+	/**
+	*	Applies the stages that the worker thread completed since the last update.
+	*	Must be called regularly on the thread that owns the OpenGL context that was current when the load was started.
+	*	@return Whether the stage changed or the load failed.
+	*/
+	bool Update();
+
+	/**
+	*	Stops loading and waits for the worker thread. The model keeps the stages that were applied.
+	*/
+	void Cancel();
+
+private:
+	/**
+	*	Loads the texture and sequence group files. Runs on the worker thread.
+	*/
+	void Run();
+
+	/**
+	*	Makes a stage available to Update.
+	*	@return Whether loading should continue.
+	*/
+	bool Post( const StudioModelLoadStage stage );
+
+	/**
+	*	Ends the load with an error.
+	*/
+	void Fail( const StudioModelLoadResult result );
+
+	/**
+	*	Frees everything the worker thread loaded that wasn't applied to the model.
+	*/
+	void FreeUnappliedData();
+
+private:
+	std::thread m_Worker;
+
+	std::atomic<bool> m_bCancel{ false };
+
+	CStudioModel* m_pModel = nullptr;
+
+	StudioModelLoadStage m_Stage = StudioModelLoadStage::NONE;
+	StudioModelLoadResult m_Result = StudioModelLoadResult::SUCCESS;
+
+	std::chrono::steady_clock::time_point m_StartTime;
+
+	/**
+	*	Set before the worker thread starts.
+	*/
+	std::string m_szFilename;
+	bool m_bIsDol = false;
+	bool m_bPowerOf2 = true;
+
+	const studiohdr_t* m_pStudioHdr = nullptr;
+
+	/**
+	*	Texture header, if the model's textures are stored in its main file.
+	*/
+	studiohdr_t* m_pEmbeddedTextureHdr = nullptr;
+
+	std::mutex m_Mutex;
+
+	/**
+	*	Last stage completed by the worker thread, and why it stopped if it failed. Guarded by m_Mutex.
+	*/
+	StudioModelLoadStage m_PostedStage = StudioModelLoadStage::NONE;
+	StudioModelLoadResult m_PostedResult = StudioModelLoadResult::SUCCESS;
+
+	/**
+	*	Produced by the worker thread. Only accessed by the loading thread once the stage that produces them has been posted.
+	*/
+	studiohdr_t* m_pTextureHdr = nullptr;
+
+	std::unique_ptr<DecodedTextures_t> m_PreviewTextures;
+	std::unique_ptr<DecodedTextures_t> m_Textures;
+
+	studiohdr_t* m_pSeqHdrs[ CStudioModel::MAX_SEQGROUPS ] = {};
+
+private:
+	CStudioModelLoader( const CStudioModelLoader& ) = delete;
+	CStudioModelLoader& operator=( const CStudioModelLoader& ) = delete;
+};
+
+/**
+*	Converts an 8 bit paletted studio texture to 32 bit RGBA, resampling it to the given dimensions.
+*	For masked textures, the transparent color in the palette is set to black.
+*	@param texture Texture to convert.
+*	@param pPixels Texture pixels.
+*	@param pPalette Texture palette.
+*	@param iOutWidth Width of the converted texture.
+*	@param iOutHeight Height of the converted texture.
+*	@param pOutRGBA Receives the converted pixels. Must have room for iOutWidth * iOutHeight * 4 bytes.
+*/
+void ConvertTextureToRGBA( const mstudiotexture_t& texture, const byte* const pPixels, byte* pPalette,
+						   const int iOutWidth, const int iOutHeight, byte* pOutRGBA );
+
 void ScaleMeshes( CStudioModel* pStudioModel, const float flScale );
 void ScaleBones( CStudioModel* pStudioModel, const float flScale );
 
@@ -0,0 +1,98 @@
+#include <algorithm>
+
+#include "StudioEvents.h"
+
+namespace studiomdl
+{
+namespace
+{
+bool CompareEntryFrames( const EventIndexEntry_t& lhs, const EventIndexEntry_t& rhs )
+{
+	return lhs.iFrame < rhs.iFrame;
+}
+
+/**
+*	@return The first entry whose frame is not less than flFrame.
+*/
+const EventIndexEntry_t* FindFirstEventAtOrAfter( const EventIndexEntry_t* pBegin, const EventIndexEntry_t* pEnd, const float flFrame )
+{
+	return std::lower_bound( pBegin, pEnd, flFrame,
+		[]( const EventIndexEntry_t& entry, const float flValue )
+		{
+			return entry.iFrame < flValue;
+		}
+	);
+}
+}
+
+void BuildSequenceEvents( const studiohdr_t& header, const mstudioseqdesc_t& seqdesc, SequenceEvents_t& events )
+{
+	const auto pevent = ( const mstudioevent_t* ) ( header.GetData() + seqdesc.eventindex );
+
+	events.allEvents.clear();
+	events.serverEvents.clear();
+
+	events.allEvents.reserve( seqdesc.numevents );
+
+	for( int i = 0; i < seqdesc.numevents; ++i )
+	{
+		const EventIndexEntry_t entry{ pevent[ i ].frame, i };
+
+		events.allEvents.push_back( entry );
+
+		// Don't send client-side events to the server AI
+		if( pevent[ i ].event < STUDIO_FIRST_CLIENT_EVENT )
+			events.serverEvents.push_back( entry );
+	}
+
+	std::stable_sort( events.allEvents.begin(), events.allEvents.end(), CompareEntryFrames );
+	std::stable_sort( events.serverEvents.begin(), events.serverEvents.end(), CompareEntryFrames );
+}
+
+int FindSequenceEvents( const mstudioseqdesc_t& seqdesc, const SequenceEvents_t& events, const bool bAllowClientEvents,
+						float flStart, float flEnd, EventRange_t ( &ranges )[ 2 ] )
+{
+	const auto& entries = events.GetEvents( bAllowClientEvents );
+
+	if( entries.empty() )
+		return 0;
+
+	if( seqdesc.numframes <= 1 )
+	{
+		flStart = 0;
+		flEnd = 1.0;
+	}
+
+	const EventIndexEntry_t* const pBegin = entries.data();
+	const EventIndexEntry_t* const pEnd = pBegin + entries.size();
+
+	const EventIndexEntry_t* const pFirst = FindFirstEventAtOrAfter( pBegin, pEnd, flStart );
+	const EventIndexEntry_t* const pLast = FindFirstEventAtOrAfter( pFirst, pEnd, flEnd );
+
+	int iCount = 0;
+
+	if( ( seqdesc.flags & STUDIO_LOOPING ) && flEnd >= seqdesc.numframes - 1 )
+	{
+		const EventIndexEntry_t* const pWrapEnd = FindFirstEventAtOrAfter( pBegin, pEnd, flEnd - seqdesc.numframes + 1 );
+
+		if( pFirst != pLast && pWrapEnd >= pFirst )
+		{
+			//The wrapped events overlap the range, merge them.
+			ranges[ iCount++ ] = { pBegin, std::max( pLast, pWrapEnd ) };
+			return iCount;
+		}
+
+		if( pFirst != pLast )
+			ranges[ iCount++ ] = { pFirst, pLast };
+
+		if( pBegin != pWrapEnd )
+			ranges[ iCount++ ] = { pBegin, pWrapEnd };
+	}
+	else if( pFirst != pLast )
+	{
+		ranges[ iCount++ ] = { pFirst, pLast };
+	}
+
+	return iCount;
+}
+}
@@ -0,0 +1,91 @@
+#ifndef GAME_STUDIOMODEL_STUDIOEVENTS_H
+#define GAME_STUDIOMODEL_STUDIOEVENTS_H
+
+#include <vector>
+
+#include "studio.h"
+
+/**
+*	@file
+*
+*	Per sequence index of animation events, sorted by frame so the events in a range of frames can be found with a binary search.
+*/
+
+namespace studiomdl
+{
+/**
+*	Events with this number or higher are client side events. Matches EVENT_CLIENT in game/Events.h.
+*/
+const int STUDIO_FIRST_CLIENT_EVENT = 5000;
+
+/**
+*	An event in a sequence's event index.
+*/
+struct EventIndexEntry_t
+{
+	int iFrame;
+
+	/**
+	*	Index of the event in the sequence's event list.
+	*/
+	int iEvent;
+};
+
+/**
+*	Events of a sequence sorted by frame. Events on the same frame keep the order they have in the sequence.
+*/
+struct SequenceEvents_t
+{
+	/**
+	*	All events.
+	*/
+	std::vector<EventIndexEntry_t> allEvents;
+
+	/**
+	*	Events that are not client side events.
+	*/
+	std::vector<EventIndexEntry_t> serverEvents;
+
+	const std::vector<EventIndexEntry_t>& GetEvents( const bool bAllowClientEvents ) const
+	{
+		return bAllowClientEvents ? allEvents : serverEvents;
+	}
+};
+
+/**
+*	A range of entries in a sequence's event index.
+*/
+struct EventRange_t
+{
+	const EventIndexEntry_t* pBegin = nullptr;
+	const EventIndexEntry_t* pEnd = nullptr;
+};
+
+/**
+*	Builds the event index of a sequence.
+*	Must be rebuilt if the sequence's events are modified.
+*	@param header Studio header.
+*	@param seqdesc Sequence.
+*	@param events Receives the index.
+*/
+void BuildSequenceEvents( const studiohdr_t& header, const mstudioseqdesc_t& seqdesc, SequenceEvents_t& events );
+
+/**
+*	Finds the events that occur in a range of frames.
+*	An event matches if its frame is in [flStart, flEnd). If the sequence loops and the range reaches the last frame,
+*	events at the start of the sequence up to flEnd - ( numframes - 1 ) also match.
+*	Sequences with a single frame always match all events.
+*	@param seqdesc Sequence.
+*	@param events Event index of the sequence.
+*	@param bAllowClientEvents Whether to include client side events.
+*	@param flStart Start of the range of frames to check.
+*	@param flEnd End of the range of frames to check.
+*	@param ranges Receives the matching events, in frame order. Events matched by wrapping around come after the other events,
+*		unless the range covers the entire loop, in which case a single range is returned.
+*	@return Number of ranges that were written. No event is in more than one range.
+*/
+int FindSequenceEvents( const mstudioseqdesc_t& seqdesc, const SequenceEvents_t& events, const bool bAllowClientEvents,
+						float flStart, float flEnd, EventRange_t ( &ranges )[ 2 ] );
+}
+
+#endif //GAME_STUDIOMODEL_STUDIOEVENTS_H
@@ -0,0 +1,66 @@
+#include "cvar/CCVar.h"
+
+#include "StudioModelCache.h"
+
+namespace studiomdl
+{
+namespace
+{
+static cvar::CCVar studiomodel_cache_budget( "studiomodel_cache_budget",
+	cvar::CCVarArgsBuilder()
+	.Flags( cvar::Flag::ARCHIVE )
+	.FloatValue( 256 )
+	.MinValue( 0 )
+	.HelpInfo( "Memory that unused studio models can keep cached, in MiB" ) );
+}
+
+bool StudioModelCacheTraits::Load( const char* const pszFilename, CStudioModel*& pModel )
+{
+	return LoadStudioModel( pszFilename, pModel ) == StudioModelLoadResult::SUCCESS;
+}
+
+void StudioModelCacheTraits::Free( CStudioModel* pModel )
+{
+	delete pModel;
+}
+
+size_t StudioModelCacheTraits::GetMemoryUsage( const CStudioModel& model )
+{
+	const studiohdr_t* const pStudioHdr = model.GetStudioHeader();
+	const studiohdr_t* const pTextureHdr = model.GetTextureHeader();
+
+	size_t uiSize = pStudioHdr->length;
+
+	if( pTextureHdr != pStudioHdr )
+		uiSize += pTextureHdr->length;
+
+	for( int i = 1; i < pStudioHdr->numseqgroups; ++i )
+	{
+		if( const auto pSeqHdr = model.GetSeqGroupHeader( i ) )
+			uiSize += pSeqHdr->length;
+	}
+
+	//Uploaded as 32 bit RGBA.
+	for( int i = 0; i < pTextureHdr->numtextures; ++i )
+	{
+		const mstudiotexture_t* const pTexture = pTextureHdr->GetTexture( i );
+
+		uiSize += static_cast<size_t>( pTexture->width ) * pTexture->height * 4;
+	}
+
+	return uiSize;
+}
+
+size_t StudioModelCacheTraits::GetMemoryBudget()
+{
+	return static_cast<size_t>( studiomodel_cache_budget.GetFloat() * 1024 * 1024 );
+}
+
+void StudioModelCacheTraits::GetDependencies( const char* const pszFilename, const CStudioModel& model, std::vector<std::string>& files )
+{
+	GetStudioModelFiles( pszFilename, model, files );
+
+	//The first file is the model itself.
+	files.erase( files.begin() );
+}
+}
@@ -0,0 +1,48 @@
+#ifndef GAME_STUDIOMODEL_STUDIOMODELCACHE_H
+#define GAME_STUDIOMODEL_STUDIOMODELCACHE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "shared/resource/CResourceCache.h"
+
+#include "CStudioModel.h"
+
+namespace studiomdl
+{
+/**
+*	Loads and frees studio models for the studio model cache.
+*/
+struct StudioModelCacheTraits
+{
+	static bool Load( const char* const pszFilename, CStudioModel*& pModel );
+
+	static void Free( CStudioModel* pModel );
+
+	/**
+	*	@return Memory used by the model's files and textures, in bytes.
+	*/
+	static size_t GetMemoryUsage( const CStudioModel& model );
+
+	/**
+	*	@return The value of the studiomodel_cache_budget cvar, in bytes.
+	*/
+	static size_t GetMemoryBudget();
+
+	/**
+	*	Gets the texture and sequence group files used by the model.
+	*/
+	static void GetDependencies( const char* const pszFilename, const CStudioModel& model, std::vector<std::string>& files );
+};
+
+/**
+*	Cache of studio models. Models share their textures, so a model that is edited in memory must be discarded from the cache.
+*	Changes to the model's texture and sequence group files are detected along with changes to the main model file.
+*/
+typedef resource::CResourceCache<CStudioModel, StudioModelCacheTraits> CStudioModelCache;
+
+typedef CStudioModelCache::Handle_t StudioModelHandle_t;
+}
+
+#endif //GAME_STUDIOMODEL_STUDIOMODELCACHE_H
@@ -0,0 +1,553 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "graphics/Palette.h"
+
+#include "StudioModelValidation.h"
+
+namespace studiomdl
+{
+namespace
+{
+/**
+*	Performs range checks against a single file, and records the first error that was found.
+*/
+class CStudioFileValidator final
+{
+public:
+	CStudioFileValidator( const byte* const pData, const size_t uiSize, std::string& szError )
+		: m_pData( pData )
+		, m_uiSize( uiSize )
+		, m_szError( szError )
+	{
+	}
+
+	bool Fail( const std::string& szError )
+	{
+		m_szError = szError;
+		return false;
+	}
+
+	/**
+	*	Checks that a count is within [0, iMax].
+	*/
+	bool CheckCount( const int iCount, const int iMax, const char* const pszName )
+	{
+		if( iCount < 0 || iCount > iMax )
+			return Fail( std::string( pszName ) + " count " + std::to_string( iCount ) + " is out of range [0, " + std::to_string( iMax ) + "]" );
+
+		return true;
+	}
+
+	/**
+	*	Checks that iCount elements of size uiElementSize starting at iOffset are inside the file.
+	*	Nothing is checked if the count is 0, since unused tables often have garbage offsets.
+	*/
+	bool CheckRange( const int64_t iOffset, const int64_t iCount, const size_t uiElementSize, const char* const pszName )
+	{
+		if( iCount < 0 )
+			return Fail( std::string( pszName ) + " count " + std::to_string( iCount ) + " is negative" );
+
+		if( iCount == 0 )
+			return true;
+
+		//All values are at most 32 bit, so this can't overflow.
+		const int64_t iEnd = iOffset + iCount * static_cast<int64_t>( uiElementSize );
+
+		if( iOffset < 0 || iEnd > static_cast<int64_t>( m_uiSize ) )
+		{
+			return Fail( std::string( pszName ) + " (offset " + std::to_string( iOffset ) + ", " + std::to_string( iCount ) +
+						 " elements) extends past the end of the file (" + std::to_string( m_uiSize ) + " bytes)" );
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	const T* Get( const int64_t iOffset ) const
+	{
+		return reinterpret_cast<const T*>( m_pData + iOffset );
+	}
+
+	/**
+	*	Walks a triangle command stream, checking that every command and its vertices are inside the file,
+	*	and that every vertex refers to an existing vertex and normal.
+	*/
+	bool CheckTriangleCommands( const int iOffset, const int iNumVerts, const int iNumNorms, const char* const pszName )
+	{
+		int64_t iPos = iOffset;
+
+		for( ;; )
+		{
+			if( !CheckRange( iPos, 1, sizeof( short ), pszName ) )
+				return false;
+
+			const int iCount = *Get<short>( iPos );
+
+			iPos += sizeof( short );
+
+			if( iCount == 0 )
+				break;
+
+			//Each vertex is a vertex index, normal index, s and t.
+			const int64_t iNumShorts = static_cast<int64_t>( iCount < 0 ? -iCount : iCount ) * 4;
+
+			if( !CheckRange( iPos, iNumShorts, sizeof( short ), pszName ) )
+				return false;
+
+			const auto pVerts = Get<short>( iPos );
+
+			for( int64_t iVert = 0; iVert < iNumShorts; iVert += 4 )
+			{
+				if( pVerts[ iVert ] < 0 || pVerts[ iVert ] >= iNumVerts ||
+					pVerts[ iVert + 1 ] < 0 || pVerts[ iVert + 1 ] >= iNumNorms )
+				{
+					return Fail( std::string( pszName ) + " at offset " + std::to_string( iPos ) + " refer to invalid vertex " +
+								 std::to_string( pVerts[ iVert ] ) + " or normal " + std::to_string( pVerts[ iVert + 1 ] ) );
+				}
+			}
+
+			iPos += iNumShorts * sizeof( short );
+		}
+
+		return true;
+	}
+
+	bool ValidateModel( const mstudiomodel_t& model, const int iNumBones )
+	{
+		if( !CheckRange( model.meshindex, model.nummesh, sizeof( mstudiomesh_t ), "Meshes" ) ||
+			!CheckRange( model.vertinfoindex, model.numverts, sizeof( byte ), "Vertex bone info" ) ||
+			!CheckRange( model.vertindex, model.numverts, sizeof( glm::vec3 ), "Vertices" ) ||
+			!CheckRange( model.norminfoindex, model.numnorms, sizeof( byte ), "Normal bone info" ) ||
+			!CheckRange( model.normindex, model.numnorms, sizeof( glm::vec3 ), "Normals" ) )
+		{
+			return false;
+		}
+
+		//The renderer transforms vertices and lights normals into fixed size arrays.
+		if( !CheckCount( model.nummesh, MAXSTUDIOMESHES, "Mesh" ) ||
+			!CheckCount( model.numverts, MAXSTUDIOVERTS, "Vertex" ) ||
+			!CheckCount( model.numnorms, MAXSTUDIOVERTS, "Normal" ) )
+		{
+			return false;
+		}
+
+		if( !CheckBoneIndices( Get<byte>( model.vertinfoindex ), model.numverts, iNumBones, "Vertex" ) ||
+			!CheckBoneIndices( Get<byte>( model.norminfoindex ), model.numnorms, iNumBones, "Normal" ) )
+		{
+			return false;
+		}
+
+		const auto pMeshes = Get<mstudiomesh_t>( model.meshindex );
+
+		//Normals are consumed sequentially by each mesh in turn.
+		int64_t iTotalNorms = 0;
+
+		for( int iMesh = 0; iMesh < model.nummesh; ++iMesh )
+		{
+			const auto& mesh = pMeshes[ iMesh ];
+
+			if( mesh.numnorms < 0 )
+				return Fail( "Mesh " + std::to_string( iMesh ) + " has a negative normal count" );
+
+			iTotalNorms += mesh.numnorms;
+
+			if( !CheckTriangleCommands( mesh.triindex, model.numverts, model.numnorms, "Triangle commands" ) )
+				return false;
+		}
+
+		if( iTotalNorms > model.numnorms )
+		{
+			return Fail( "Meshes use " + std::to_string( iTotalNorms ) + " normals, but the model only has " + std::to_string( model.numnorms ) );
+		}
+
+		return true;
+	}
+
+	/**
+	*	Checks that per vertex or per normal bone indices refer to existing bones.
+	*/
+	bool CheckBoneIndices( const byte* const pBones, const int iCount, const int iNumBones, const char* const pszName )
+	{
+		for( int i = 0; i < iCount; ++i )
+		{
+			if( pBones[ i ] >= iNumBones )
+			{
+				return Fail( std::string( pszName ) + " " + std::to_string( i ) + " refers to invalid bone " + std::to_string( pBones[ i ] ) );
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	*	Checks that every mesh uses a valid skin reference, and that every skin refers to an existing texture.
+	*	@param header Header that contains the models.
+	*	@param textureHeader Header that contains the textures. This is the same header, unless textures are stored in a T.mdl.
+	*/
+	bool ValidateTextureReferences( const studiohdr_t& header, const studiohdr_t& textureHeader )
+	{
+		const auto pBodyparts = Get<mstudiobodyparts_t>( header.bodypartindex );
+
+		for( int iBodypart = 0; iBodypart < header.numbodyparts; ++iBodypart )
+		{
+			const auto& bodypart = pBodyparts[ iBodypart ];
+
+			const auto pModels = Get<mstudiomodel_t>( bodypart.modelindex );
+
+			for( int iModel = 0; iModel < bodypart.nummodels; ++iModel )
+			{
+				const auto& model = pModels[ iModel ];
+
+				const auto pMeshes = Get<mstudiomesh_t>( model.meshindex );
+
+				for( int iMesh = 0; iMesh < model.nummesh; ++iMesh )
+				{
+					if( pMeshes[ iMesh ].skinref < 0 || pMeshes[ iMesh ].skinref >= textureHeader.numskinref )
+					{
+						return Fail( "Mesh " + std::to_string( iMesh ) + " of model \"" + model.name + "\" refers to invalid skin reference " +
+									 std::to_string( pMeshes[ iMesh ].skinref ) );
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	*	Walks the run length encoded values of a single animation channel.
+	*	Each span has a header that stores how many values follow it (valid) and how many frames it covers (total).
+	*	The spans must cover every frame in the sequence.
+	*	@param iOffset Offset of the first span.
+	*	@param iNumFrames Number of frames in the sequence.
+	*/
+	bool CheckAnimationValues( const int64_t iOffset, const int iNumFrames )
+	{
+		int64_t iPos = iOffset;
+
+		//Frame 0 is always evaluated, even for sequences without frames.
+		const int iFramesToCover = iNumFrames > 0 ? iNumFrames : 1;
+
+		for( int iFrame = 0; iFrame < iFramesToCover; )
+		{
+			if( !CheckRange( iPos, 1, sizeof( mstudioanimvalue_t ), "Animation values" ) )
+				return false;
+
+			const auto& span = *Get<mstudioanimvalue_t>( iPos );
+
+			//A span that covers no frames makes the renderer loop forever.
+			if( span.num.total == 0 )
+				return Fail( "Animation value span at offset " + std::to_string( iPos ) + " covers no frames" );
+
+			if( !CheckRange( iPos, span.num.valid + 1, sizeof( mstudioanimvalue_t ), "Animation values" ) )
+				return false;
+
+			iFrame += span.num.total;
+			iPos += ( span.num.valid + 1 ) * sizeof( mstudioanimvalue_t );
+		}
+
+		return true;
+	}
+
+	/**
+	*	Validates the animations of a sequence. The animations are stored in this file.
+	*	@param sequence Sequence whose animations should be validated.
+	*	@param iSequence Index of the sequence, used in error messages.
+	*	@param iNumBones Number of bones in the model.
+	*	@param iAnimOffset Offset of the animations in this file.
+	*/
+	bool ValidateAnimations( const mstudioseqdesc_t& sequence, const int iSequence, const int iNumBones, const int64_t iAnimOffset )
+	{
+		const int64_t iNumAnims = static_cast<int64_t>( sequence.numblends ) * iNumBones;
+
+		if( !CheckRange( iAnimOffset, iNumAnims, sizeof( mstudioanim_t ), "Animations" ) )
+			return false;
+
+		for( int64_t iAnim = 0; iAnim < iNumAnims; ++iAnim )
+		{
+			const int64_t iOffset = iAnimOffset + iAnim * sizeof( mstudioanim_t );
+
+			const auto& anim = *Get<mstudioanim_t>( iOffset );
+
+			for( int iChannel = 0; iChannel < 6; ++iChannel )
+			{
+				//Offsets are relative to the anim itself; 0 means the channel is not animated.
+				if( anim.offset[ iChannel ] != 0 && !CheckAnimationValues( iOffset + anim.offset[ iChannel ], sequence.numframes ) )
+				{
+					m_szError = "Sequence " + std::to_string( iSequence ) + " \"" + sequence.label + "\": " + m_szError;
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool ValidateStudioHeader( const bool bIsDol )
+	{
+		const auto& header = *Get<studiohdr_t>( 0 );
+
+		if( header.length < 0 || static_cast<size_t>( header.length ) > m_uiSize )
+			return Fail( "Header length " + std::to_string( header.length ) + " is larger than the file (" + std::to_string( m_uiSize ) + " bytes)" );
+
+		if( !CheckCount( header.numbones, MAXSTUDIOBONES, "Bone" ) ||
+			!CheckCount( header.numbonecontrollers, MAXSTUDIOCONTROLLERS, "Bone controller" ) ||
+			!CheckCount( header.numseq, MAXSTUDIOSEQUENCES, "Sequence" ) ||
+			!CheckCount( header.numseqgroups, MAXSTUDIOGROUPS * 2, "Sequence group" ) ||
+			!CheckCount( header.numtextures, MAXSTUDIOSKINS, "Texture" ) ||
+			!CheckCount( header.numbodyparts, MAXSTUDIOBODYPARTS, "Body part" ) )
+		{
+			return false;
+		}
+
+		if( !CheckRange( header.boneindex, header.numbones, sizeof( mstudiobone_t ), "Bones" ) ||
+			!CheckRange( header.bonecontrollerindex, header.numbonecontrollers, sizeof( mstudiobonecontroller_t ), "Bone controllers" ) ||
+			!CheckRange( header.hitboxindex, header.numhitboxes, sizeof( mstudiobbox_t ), "Hitboxes" ) ||
+			!CheckRange( header.seqindex, header.numseq, sizeof( mstudioseqdesc_t ), "Sequences" ) ||
+			!CheckRange( header.seqgroupindex, header.numseqgroups, sizeof( mstudioseqgroup_t ), "Sequence groups" ) ||
+			!CheckRange( header.textureindex, header.numtextures, sizeof( mstudiotexture_t ), "Textures" ) ||
+			!CheckRange( header.bodypartindex, header.numbodyparts, sizeof( mstudiobodyparts_t ), "Body parts" ) ||
+			!CheckRange( header.attachmentindex, header.numattachments, sizeof( mstudioattachment_t ), "Attachments" ) ||
+			!CheckRange( header.transitionindex, static_cast<int64_t>( header.numtransitions ) * header.numtransitions, sizeof( byte ), "Transitions" ) )
+		{
+			return false;
+		}
+
+		if( header.numskinref < 0 || header.numskinfamilies < 0 )
+			return Fail( "Skin table dimensions are negative" );
+
+		if( !CheckRange( header.skinindex, static_cast<int64_t>( header.numskinref ) * header.numskinfamilies, sizeof( short ), "Skins" ) )
+			return false;
+
+		const auto pBones = Get<mstudiobone_t>( header.boneindex );
+
+		for( int iBone = 0; iBone < header.numbones; ++iBone )
+		{
+			const auto& bone = pBones[ iBone ];
+
+			//Parents must come before their children, bones are set up in order.
+			if( bone.parent < -1 || bone.parent >= iBone )
+				return Fail( "Bone " + std::to_string( iBone ) + " \"" + bone.name + "\" has invalid parent " + std::to_string( bone.parent ) );
+
+			for( int iController = 0; iController < STUDIO_MAX_PER_BONE_CONTROLLERS; ++iController )
+			{
+				if( bone.bonecontroller[ iController ] < -1 || bone.bonecontroller[ iController ] >= header.numbonecontrollers )
+				{
+					return Fail( "Bone " + std::to_string( iBone ) + " \"" + bone.name + "\" refers to invalid bone controller " +
+								 std::to_string( bone.bonecontroller[ iController ] ) );
+				}
+			}
+		}
+
+		const auto pBoneControllers = Get<mstudiobonecontroller_t>( header.bonecontrollerindex );
+
+		for( int iController = 0; iController < header.numbonecontrollers; ++iController )
+		{
+			const auto& controller = pBoneControllers[ iController ];
+
+			if( controller.bone < -1 || controller.bone >= header.numbones )
+				return Fail( "Bone controller " + std::to_string( iController ) + " refers to invalid bone " + std::to_string( controller.bone ) );
+
+			if( controller.index < 0 || controller.index > STUDIO_MOUTH_CONTROLLER )
+				return Fail( "Bone controller " + std::to_string( iController ) + " has invalid index " + std::to_string( controller.index ) );
+		}
+
+		const auto pHitboxes = Get<mstudiobbox_t>( header.hitboxindex );
+
+		for( int iHitbox = 0; iHitbox < header.numhitboxes; ++iHitbox )
+		{
+			if( pHitboxes[ iHitbox ].bone < 0 || pHitboxes[ iHitbox ].bone >= header.numbones )
+				return Fail( "Hitbox " + std::to_string( iHitbox ) + " refers to invalid bone " + std::to_string( pHitboxes[ iHitbox ].bone ) );
+		}
+
+		const auto pAttachments = Get<mstudioattachment_t>( header.attachmentindex );
+
+		for( int iAttachment = 0; iAttachment < header.numattachments; ++iAttachment )
+		{
+			if( pAttachments[ iAttachment ].bone < 0 || pAttachments[ iAttachment ].bone >= header.numbones )
+				return Fail( "Attachment " + std::to_string( iAttachment ) + " refers to invalid bone " + std::to_string( pAttachments[ iAttachment ].bone ) );
+		}
+
+		//Sequence group 0 is stored in this file.
+		const int64_t iGroup0Offset = header.numseqgroups > 0 ? Get<mstudioseqgroup_t>( header.seqgroupindex )->unused2 : 0;
+
+		for( int iSequence = 0; iSequence < header.numseq; ++iSequence )
+		{
+			const auto& sequence = Get<mstudioseqdesc_t>( header.seqindex )[ iSequence ];
+
+			if( sequence.numframes < 0 )
+				return Fail( "Sequence " + std::to_string( iSequence ) + " has a negative frame count" );
+
+			if( sequence.numblends < 1 )
+				return Fail( "Sequence " + std::to_string( iSequence ) + " has no blends" );
+
+			if( sequence.seqgroup < 0 || sequence.seqgroup >= header.numseqgroups )
+				return Fail( "Sequence " + std::to_string( iSequence ) + " refers to invalid sequence group " + std::to_string( sequence.seqgroup ) );
+
+			if( !CheckRange( sequence.eventindex, sequence.numevents, sizeof( mstudioevent_t ), "Events" ) ||
+				!CheckRange( sequence.pivotindex, sequence.numpivots, sizeof( mstudiopivot_t ), "Pivots" ) )
+			{
+				return false;
+			}
+
+			if( ( sequence.motiontype & ( STUDIO_X | STUDIO_Y | STUDIO_Z ) ) &&
+				( sequence.motionbone < 0 || sequence.motionbone >= header.numbones ) )
+			{
+				return Fail( "Sequence " + std::to_string( iSequence ) + " has invalid motion bone " + std::to_string( sequence.motionbone ) );
+			}
+
+			if( sequence.seqgroup == 0 && !ValidateAnimations( sequence, iSequence, header.numbones, iGroup0Offset + sequence.animindex ) )
+				return false;
+		}
+
+		const auto pTextures = Get<mstudiotexture_t>( header.textureindex );
+
+		for( int iTexture = 0; iTexture < header.numtextures; ++iTexture )
+		{
+			const auto& texture = pTextures[ iTexture ];
+
+			if( texture.width <= 0 || texture.height <= 0 || texture.width > MAX_TEXTURE_DIMS || texture.height > MAX_TEXTURE_DIMS )
+			{
+				return Fail( "Texture " + std::to_string( iTexture ) + " has invalid dimensions " +
+							 std::to_string( texture.width ) + "x" + std::to_string( texture.height ) );
+			}
+
+			//Dol files have a 32 byte name and an RGBA palette before the pixels; mdl files have an RGB palette after them.
+			const int64_t iTextureSize = static_cast<int64_t>( texture.width ) * texture.height +
+				static_cast<int64_t>( bIsDol ? 32 + PALETTE_ENTRIES * 4 : PALETTE_SIZE );
+
+			if( !CheckRange( texture.index, iTextureSize, sizeof( byte ), "Texture data" ) )
+				return false;
+		}
+
+		//The skin table is only used if this file contains the textures.
+		if( header.numtextures > 0 )
+		{
+			const auto pSkins = Get<short>( header.skinindex );
+
+			const int64_t iNumSkins = static_cast<int64_t>( header.numskinref ) * header.numskinfamilies;
+
+			for( int64_t iSkin = 0; iSkin < iNumSkins; ++iSkin )
+			{
+				if( pSkins[ iSkin ] < 0 || pSkins[ iSkin ] >= header.numtextures )
+					return Fail( "Skin " + std::to_string( iSkin ) + " refers to invalid texture " + std::to_string( pSkins[ iSkin ] ) );
+			}
+		}
+
+		const auto pBodyparts = Get<mstudiobodyparts_t>( header.bodypartindex );
+
+		for( int iBodypart = 0; iBodypart < header.numbodyparts; ++iBodypart )
+		{
+			const auto& bodypart = pBodyparts[ iBodypart ];
+
+			if( bodypart.nummodels <= 0 || bodypart.nummodels > MAXSTUDIOMODELS )
+				return Fail( "Body part " + std::to_string( iBodypart ) + " has an invalid model count " + std::to_string( bodypart.nummodels ) );
+
+			//Used as a divisor when selecting the submodel.
+			if( bodypart.base <= 0 )
+				return Fail( "Body part " + std::to_string( iBodypart ) + " has an invalid base " + std::to_string( bodypart.base ) );
+
+			if( !CheckRange( bodypart.modelindex, bodypart.nummodels, sizeof( mstudiomodel_t ), "Models" ) )
+				return false;
+
+			const auto pModels = Get<mstudiomodel_t>( bodypart.modelindex );
+
+			for( int iModel = 0; iModel < bodypart.nummodels; ++iModel )
+			{
+				if( !ValidateModel( pModels[ iModel ], header.numbones ) )
+					return false;
+			}
+		}
+
+		//Models that use a T.mdl are checked against it when it is loaded.
+		if( header.numtextures > 0 && !ValidateTextureReferences( header, header ) )
+			return false;
+
+		return true;
+	}
+
+private:
+	const byte* const m_pData;
+	const size_t m_uiSize;
+
+	std::string& m_szError;
+
+private:
+	CStudioFileValidator( const CStudioFileValidator& ) = delete;
+	CStudioFileValidator& operator=( const CStudioFileValidator& ) = delete;
+};
+}
+
+bool ValidateStudioFile( const byte* const pData, const size_t uiSize, const bool bIsDol, std::string& szError )
+{
+	if( !pData || uiSize < sizeof( studioseqhdr_t ) )
+	{
+		szError = "File is too small to be a studio model";
+		return false;
+	}
+
+	const bool bIsSeqGroup = !strncmp( reinterpret_cast<const char*>( pData ), STUDIOMDL_SEQ_ID, 4 );
+
+	if( !bIsSeqGroup && strncmp( reinterpret_cast<const char*>( pData ), STUDIOMDL_HDR_ID, 4 ) )
+	{
+		szError = "File is not a studio model";
+		return false;
+	}
+
+	const auto& seqHeader = *reinterpret_cast<const studioseqhdr_t*>( pData );
+
+	if( seqHeader.version != STUDIO_VERSION )
+	{
+		szError = "Unsupported version " + std::to_string( seqHeader.version ) + ", expected " + std::to_string( STUDIO_VERSION );
+		return false;
+	}
+
+	if( bIsSeqGroup )
+	{
+		if( seqHeader.length < 0 || static_cast<size_t>( seqHeader.length ) > uiSize )
+		{
+			szError = "Header length " + std::to_string( seqHeader.length ) + " is larger than the file (" + std::to_string( uiSize ) + " bytes)";
+			return false;
+		}
+
+		return true;
+	}
+
+	if( uiSize < sizeof( studiohdr_t ) )
+	{
+		szError = "File is too small to contain a studio header";
+		return false;
+	}
+
+	CStudioFileValidator validator( pData, uiSize, szError );
+
+	return validator.ValidateStudioHeader( bIsDol );
+}
+
+bool ValidateSequenceGroupFile( const studiohdr_t& studioHdr, const int iGroup, const byte* const pData, const size_t uiSize, std::string& szError )
+{
+	assert( iGroup > 0 && iGroup < studioHdr.numseqgroups );
+
+	CStudioFileValidator validator( pData, uiSize, szError );
+
+	for( int iSequence = 0; iSequence < studioHdr.numseq; ++iSequence )
+	{
+		const auto& sequence = *studioHdr.GetSequence( iSequence );
+
+		//Offsets are relative to the start of the sequence group file.
+		if( sequence.seqgroup == iGroup && !validator.ValidateAnimations( sequence, iSequence, studioHdr.numbones, sequence.animindex ) )
+			return false;
+	}
+
+	return true;
+}
+
+bool ValidateTextureReferences( const studiohdr_t& studioHdr, const studiohdr_t& textureHdr, std::string& szError )
+{
+	CStudioFileValidator validator( reinterpret_cast<const byte*>( &studioHdr ), studioHdr.length, szError );
+
+	return validator.ValidateTextureReferences( studioHdr, textureHdr );
+}
+}
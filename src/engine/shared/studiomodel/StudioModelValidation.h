@@ -0,0 +1,58 @@
+#ifndef GAME_STUDIOMODEL_STUDIOMODELVALIDATION_H
+#define GAME_STUDIOMODEL_STUDIOMODELVALIDATION_H
+
+#include <cstddef>
+#include <string>
+
+#include "studio.h"
+
+namespace studiomdl
+{
+/**
+*	Number of zero bytes that must follow the file contents when a studio model is loaded for rendering.
+*	When interpolating the last frame of an animation value span, the renderer reads up to 2 values past the span,
+*	which can be past the end of the file for the last span in it.
+*/
+const size_t STUDIO_FILE_PADDING = 2 * sizeof( mstudioanimvalue_t );
+
+/**
+*	Checks that all counts, indices and offsets in a studio model file refer to data inside the file.
+*	This covers the header's tables, the tables they point to (models, meshes, vertices, normals, events, pivots, animations),
+*	bone, bone controller, vertex, normal, skin and texture indices, texture pixel data, the triangle command streams of every mesh
+*	and the run length encoded animation values of sequences stored in this file.
+*	Sequence group files (IDSQ) are only checked for a valid header, since their animations are described by the main model.
+*	See ValidateSequenceGroupFile.
+*	Does not require OpenGL, and never reads outside of the given buffer.
+*	@param pData File contents.
+*	@param uiSize Size of the file, in bytes.
+*	@param bIsDol Whether this is a .dol file, which stores textures differently.
+*	@param szError If validation fails, receives a description of the problem.
+*	@return true if the file is valid, false otherwise.
+*/
+bool ValidateStudioFile( const byte* const pData, const size_t uiSize, const bool bIsDol, std::string& szError );
+
+/**
+*	Checks the animations of all sequences that are stored in a sequence group file.
+*	Both files must have been validated with ValidateStudioFile first.
+*	@param studioHdr Main model header.
+*	@param iGroup Index of the sequence group. Must be larger than 0.
+*	@param pData Sequence group file contents.
+*	@param uiSize Size of the sequence group file, in bytes.
+*	@param szError If validation fails, receives a description of the problem.
+*	@return true if the animations are valid, false otherwise.
+*/
+bool ValidateSequenceGroupFile( const studiohdr_t& studioHdr, const int iGroup, const byte* const pData, const size_t uiSize, std::string& szError );
+
+/**
+*	Checks that the meshes of a model only use skin references that exist in the header that provides its textures.
+*	Both headers must have been validated with ValidateStudioFile first.
+*	ValidateStudioFile already performs this check for models that contain their own textures.
+*	@param studioHdr Main model header.
+*	@param textureHdr Header that contains the textures, loaded from a T.mdl file.
+*	@param szError If validation fails, receives a description of the problem.
+*	@return true if all references are valid, false otherwise.
+*/
+bool ValidateTextureReferences( const studiohdr_t& studioHdr, const studiohdr_t& textureHdr, std::string& szError );
+}
+
+#endif //GAME_STUDIOMODEL_STUDIOMODELVALIDATION_H
@@ -0,0 +1,550 @@
+#include <algorithm>
+#include <cstring>
+
+#include "StudioSkinning.h"
+
+#include "StudioPose.h"
+
+//Double to float conversion
+#pragma warning( disable: 4244 )
+
+namespace studiomdl
+{
+namespace
+{
+void CalcBoneQuaternion( const int frame, const float s, const mstudiobone_t* const pbone, const mstudioanim_t* const panim, const vec_t* const pAdj, glm::vec4& q )
+{
+	glm::vec3			angle1, angle2;
+
+	for( int j = 0; j < 3; j++ )
+	{
+		if( panim->offset[ j + 3 ] == 0 )
+		{
+			angle2[ j ] = angle1[ j ] = pbone->value[ j + 3 ]; // default;
+		}
+		else
+		{
+			auto panimvalue = ( const mstudioanimvalue_t* ) ( ( const byte* ) panim + panim->offset[ j + 3 ] );
+			auto k = frame;
+			while( panimvalue->num.total <= k )
+			{
+				k -= panimvalue->num.total;
+				panimvalue += panimvalue->num.valid + 1;
+			}
+			// Bah, missing blend!
+			if( panimvalue->num.valid > k )
+			{
+				angle1[ j ] = panimvalue[ k + 1 ].value;
+
+				if( panimvalue->num.valid > k + 1 )
+				{
+					angle2[ j ] = panimvalue[ k + 2 ].value;
+				}
+				else
+				{
+					if( panimvalue->num.total > k + 1 )
+						angle2[ j ] = angle1[ j ];
+					else
+						angle2[ j ] = panimvalue[ panimvalue->num.valid + 2 ].value;
+				}
+			}
+			else
+			{
+				angle1[ j ] = panimvalue[ panimvalue->num.valid ].value;
+				if( panimvalue->num.total > k + 1 )
+				{
+					angle2[ j ] = angle1[ j ];
+				}
+				else
+				{
+					angle2[ j ] = panimvalue[ panimvalue->num.valid + 2 ].value;
+				}
+			}
+			angle1[ j ] = pbone->value[ j + 3 ] + angle1[ j ] * pbone->scale[ j + 3 ];
+			angle2[ j ] = pbone->value[ j + 3 ] + angle2[ j ] * pbone->scale[ j + 3 ];
+		}
+
+		if( pbone->bonecontroller[ j + 3 ] != -1 )
+		{
+			angle1[ j ] += pAdj[ pbone->bonecontroller[ j + 3 ] ];
+			angle2[ j ] += pAdj[ pbone->bonecontroller[ j + 3 ] ];
+		}
+	}
+
+	if( !VectorCompare( angle1, angle2 ) )
+	{
+		glm::vec4 q1, q2;
+
+		AngleQuaternion( angle1, q1 );
+		AngleQuaternion( angle2, q2 );
+		QuaternionSlerp( q1, q2, s, q );
+	}
+	else
+	{
+		AngleQuaternion( angle1, q );
+	}
+}
+
+/**
+*	Converts a bone's rotation and position to a matrix relative to its parent.
+*/
+void BoneMatrix( const glm::vec4& q, const glm::vec3& pos, glm::mat3x4& bonematrix )
+{
+	QuaternionMatrix( q, bonematrix );
+
+	bonematrix[ 0 ][ 3 ] = pos[ 0 ];
+	bonematrix[ 1 ][ 3 ] = pos[ 1 ];
+	bonematrix[ 2 ][ 3 ] = pos[ 2 ];
+}
+
+void CalcBonePosition( const int frame, const float s, const mstudiobone_t* const pbone, const mstudioanim_t* const panim, const vec_t* const pAdj, glm::vec3& pos )
+{
+	for( int j = 0; j < 3; j++ )
+	{
+		pos[ j ] = pbone->value[ j ]; // default;
+		if( panim->offset[ j ] != 0 )
+		{
+			auto panimvalue = ( const mstudioanimvalue_t* ) ( ( const byte* ) panim + panim->offset[ j ] );
+
+			auto k = frame;
+			// find span of values that includes the frame we want
+			while( panimvalue->num.total <= k )
+			{
+				k -= panimvalue->num.total;
+				panimvalue += panimvalue->num.valid + 1;
+			}
+			// if we're inside the span
+			if( panimvalue->num.valid > k )
+			{
+				// and there's more data in the span
+				if( panimvalue->num.valid > k + 1 )
+				{
+					pos[ j ] += ( panimvalue[ k + 1 ].value * ( 1.0 - s ) + s * panimvalue[ k + 2 ].value ) * pbone->scale[ j ];
+				}
+				else
+				{
+					pos[ j ] += panimvalue[ k + 1 ].value * pbone->scale[ j ];
+				}
+			}
+			else
+			{
+				// are we at the end of the repeating values section and there's another section with data?
+				if( panimvalue->num.total <= k + 1 )
+				{
+					pos[ j ] += ( panimvalue[ panimvalue->num.valid ].value * ( 1.0 - s ) + s * panimvalue[ panimvalue->num.valid + 2 ].value ) * pbone->scale[ j ];
+				}
+				else
+				{
+					pos[ j ] += panimvalue[ panimvalue->num.valid ].value * pbone->scale[ j ];
+				}
+			}
+		}
+		if( pbone->bonecontroller[ j ] != -1 )
+		{
+			pos[ j ] += pAdj[ pbone->bonecontroller[ j ] ];
+		}
+	}
+}
+
+/**
+*	Applies the sequence's motion type, which zeroes out movement of the motion bone.
+*/
+void ApplyMotionType( const mstudioseqdesc_t& seqdesc, glm::vec3* pos )
+{
+	if( seqdesc.motiontype & STUDIO_X )
+		pos[ seqdesc.motionbone ][ 0 ] = 0.0;
+	if( seqdesc.motiontype & STUDIO_Y )
+		pos[ seqdesc.motionbone ][ 1 ] = 0.0;
+	if( seqdesc.motiontype & STUDIO_Z )
+		pos[ seqdesc.motionbone ][ 2 ] = 0.0;
+}
+
+/**
+*	Like CalcRotations, but only evaluates the channels that change. Everything else comes from the first frame.
+*/
+void CalcAnimatedRotations( const studiohdr_t& header, const vec_t* const pAdj,
+							const mstudioseqdesc_t& seqdesc, const BlendChannels_t& channels, const mstudioanim_t* panim, const float flFrame,
+							glm::vec3* pos, glm::vec4* q )
+{
+	const int frame = ( int ) flFrame;
+	const float s = ( flFrame - frame );
+
+	const auto pbones = header.GetBones();
+
+	memcpy( pos, channels.pos.data(), sizeof( glm::vec3 ) * header.numbones );
+	memcpy( q, channels.q.data(), sizeof( glm::vec4 ) * header.numbones );
+
+	for( const auto bone : channels.animatedBones )
+	{
+		const byte mask = channels.channelMasks[ bone ];
+
+		if( mask & STUDIO_ROTATION_CHANNELS )
+			CalcBoneQuaternion( frame, s, &pbones[ bone ], &panim[ bone ], pAdj, q[ bone ] );
+
+		if( mask & STUDIO_POSITION_CHANNELS )
+			CalcBonePosition( frame, s, &pbones[ bone ], &panim[ bone ], pAdj, pos[ bone ] );
+	}
+
+	ApplyMotionType( seqdesc, pos );
+}
+
+/**
+*	Like SlerpBones, but only for the given bones.
+*/
+void SlerpDynamicBones( const std::vector<byte>& bones, glm::vec4* q1, glm::vec3* pos1, glm::vec4* q2, glm::vec3* pos2, float s )
+{
+	glm::vec4 q3;
+
+	if( s < 0 ) s = 0;
+	else if( s > 1.0 ) s = 1.0;
+
+	const float s1 = 1.0 - s;
+
+	for( const auto i : bones )
+	{
+		QuaternionSlerp( q1[ i ], q2[ i ], s, q3 );
+		q1[ i ] = q3;
+
+		pos1[ i ] = pos1[ i ] * s1 + pos2[ i ] * s;
+	}
+}
+}
+
+void BuildSequenceChannels( const studiohdr_t& header, const mstudioseqdesc_t& seqdesc, const mstudioanim_t* panim, SequenceChannels_t& channels )
+{
+	const int iNumBones = header.numbones;
+	const auto pbones = header.GetBones();
+
+	//Static channels don't have bone controllers, so the adjustments are never used.
+	const vec_t adj[ MAXSTUDIOCONTROLLERS ] = {};
+
+	channels.blends.resize( std::max( 1, seqdesc.numblends ) );
+
+	for( auto& blend : channels.blends )
+	{
+		blend.animatedBones.clear();
+		blend.channelMasks.resize( iNumBones );
+		blend.pos.resize( iNumBones );
+		blend.q.resize( iNumBones );
+
+		CalcRotations( header, adj, seqdesc, panim, 0, blend.pos.data(), blend.q.data() );
+
+		for( int i = 0; i < iNumBones; ++i )
+		{
+			byte mask = 0;
+
+			for( int j = 0; j < STUDIO_NUM_BONE_CHANNELS; ++j )
+			{
+				if( panim[ i ].offset[ j ] != 0 || pbones[ i ].bonecontroller[ j ] != -1 )
+					mask |= 1 << j;
+			}
+
+			blend.channelMasks[ i ] = mask;
+
+			if( mask )
+				blend.animatedBones.push_back( static_cast<byte>( i ) );
+		}
+
+		panim += iNumBones;
+	}
+
+	channels.dynamicBones.clear();
+	channels.staticTransforms.resize( iNumBones );
+
+	std::vector<bool> staticBones( iNumBones );
+
+	const auto& first = channels.blends.front();
+
+	for( int i = 0; i < iNumBones; ++i )
+	{
+		const int iParent = pbones[ i ].parent;
+
+		bool bStatic = iParent == -1 || staticBones[ iParent ];
+
+		for( const auto& blend : channels.blends )
+		{
+			if( !bStatic )
+				break;
+
+			bStatic = blend.channelMasks[ i ] == 0 && blend.pos[ i ] == first.pos[ i ] && blend.q[ i ] == first.q[ i ];
+		}
+
+		staticBones[ i ] = bStatic;
+
+		if( !bStatic )
+		{
+			channels.dynamicBones.push_back( static_cast<byte>( i ) );
+			continue;
+		}
+
+		glm::mat3x4 bonematrix;
+
+		BoneMatrix( first.q[ i ], first.pos[ i ], bonematrix );
+
+		if( iParent == -1 )
+		{
+			channels.staticTransforms[ i ] = bonematrix;
+		}
+		else
+		{
+			R_ConcatTransforms( channels.staticTransforms[ iParent ], bonematrix, channels.staticTransforms[ i ] );
+		}
+	}
+}
+
+void CalcBoneAdj( const studiohdr_t& header, const byte* const pController, const byte uiMouth, vec_t* pAdj )
+{
+	const auto* const pbonecontroller = header.GetBoneControllers();
+
+	for( int j = 0; j < header.numbonecontrollers; j++ )
+	{
+		const auto i = pbonecontroller[ j ].index;
+
+		float value;
+
+		if( i <= 3 )
+		{
+			// check for 360% wrapping
+			if( pbonecontroller[ j ].type & STUDIO_RLOOP )
+			{
+				value = pController[ i ] * ( 360.0 / 256.0 ) + pbonecontroller[ j ].start;
+			}
+			else
+			{
+				value = pController[ i ] / 255.0;
+				if( value < 0 ) value = 0;
+				if( value > 1.0 ) value = 1.0;
+				value = ( 1.0 - value ) * pbonecontroller[ j ].start + value * pbonecontroller[ j ].end;
+			}
+			// Con_DPrintf( "%d %d %f : %f\n", m_controller[j], m_prevcontroller[j], value, dadt );
+		}
+		else
+		{
+			value = uiMouth / 64.0;
+			if( value > 1.0 ) value = 1.0;
+			value = ( 1.0 - value ) * pbonecontroller[ j ].start + value * pbonecontroller[ j ].end;
+			// Con_DPrintf("%d %f\n", mouthopen, value );
+		}
+		switch( pbonecontroller[ j ].type & STUDIO_TYPES )
+		{
+		case STUDIO_XR:
+		case STUDIO_YR:
+		case STUDIO_ZR:
+			pAdj[ j ] = value * ( Q_PI / 180.0 );
+			break;
+		case STUDIO_X:
+		case STUDIO_Y:
+		case STUDIO_Z:
+			pAdj[ j ] = value;
+			break;
+		}
+	}
+}
+
+void CalcRotations( const studiohdr_t& header, const vec_t* const pAdj,
+					const mstudioseqdesc_t& seqdesc, const mstudioanim_t* panim, const float flFrame,
+					glm::vec3* pos, glm::vec4* q )
+{
+	const int frame = ( int ) flFrame;
+	const float s = ( flFrame - frame );
+
+	auto pbone = header.GetBones();
+
+	for( int i = 0; i < header.numbones; i++, pbone++, panim++ )
+	{
+		CalcBoneQuaternion( frame, s, pbone, panim, pAdj, q[ i ] );
+		CalcBonePosition( frame, s, pbone, panim, pAdj, pos[ i ] );
+	}
+
+	ApplyMotionType( seqdesc, pos );
+}
+
+void SlerpBones( const int iNumBones, glm::vec4* q1, glm::vec3* pos1, glm::vec4* q2, glm::vec3* pos2, float s )
+{
+	glm::vec4 q3;
+
+	if( s < 0 ) s = 0;
+	else if( s > 1.0 ) s = 1.0;
+
+	const float s1 = 1.0 - s;
+
+	for( int i = 0; i < iNumBones; i++ )
+	{
+		QuaternionSlerp( q1[ i ], q2[ i ], s, q3 );
+		q1[ i ] = q3;
+
+		pos1[ i ] = pos1[ i ] * s1 + pos2[ i ] * s;
+	}
+}
+
+void SetUpBoneTransforms( const studiohdr_t& header, const mstudioseqdesc_t& seqdesc, const mstudioanim_t* panim, const float flFrame,
+						  const byte* const pBlender, const vec_t* const pAdj, glm::mat3x4* pBoneTransforms )
+{
+	//Kept on the stack so poses can be calculated on multiple threads.
+	glm::vec3 pos[ MAXSTUDIOBONES ];
+	glm::vec4 q[ MAXSTUDIOBONES ];
+
+	glm::vec3 pos2[ MAXSTUDIOBONES ];
+	glm::vec4 q2[ MAXSTUDIOBONES ];
+	glm::vec3 pos3[ MAXSTUDIOBONES ];
+	glm::vec4 q3[ MAXSTUDIOBONES ];
+	glm::vec3 pos4[ MAXSTUDIOBONES ];
+	glm::vec4 q4[ MAXSTUDIOBONES ];
+
+	CalcRotations( header, pAdj, seqdesc, panim, flFrame, pos, q );
+
+	if( seqdesc.numblends > 1 )
+	{
+		panim += header.numbones;
+		CalcRotations( header, pAdj, seqdesc, panim, flFrame, pos2, q2 );
+		float s = pBlender[ 0 ] / 255.0;
+
+		SlerpBones( header.numbones, q, pos, q2, pos2, s );
+
+		if( seqdesc.numblends == 4 )
+		{
+			panim += header.numbones;
+			CalcRotations( header, pAdj, seqdesc, panim, flFrame, pos3, q3 );
+
+			panim += header.numbones;
+			CalcRotations( header, pAdj, seqdesc, panim, flFrame, pos4, q4 );
+
+			s = pBlender[ 0 ] / 255.0;
+			SlerpBones( header.numbones, q3, pos3, q4, pos4, s );
+
+			s = pBlender[ 1 ] / 255.0;
+			SlerpBones( header.numbones, q, pos, q3, pos3, s );
+		}
+	}
+
+	const mstudiobone_t* const pbones = header.GetBones();
+
+	glm::mat3x4 bonematrix;
+
+	for( int i = 0; i < header.numbones; i++ )
+	{
+		BoneMatrix( q[ i ], pos[ i ], bonematrix );
+
+		if( pbones[ i ].parent == -1 )
+		{
+			pBoneTransforms[ i ] = bonematrix;
+		}
+		else
+		{
+			R_ConcatTransforms( pBoneTransforms[ pbones[ i ].parent ], bonematrix, pBoneTransforms[ i ] );
+		}
+	}
+}
+
+void SetUpBoneTransforms( const studiohdr_t& header, const mstudioseqdesc_t& seqdesc, const mstudioanim_t* panim, const float flFrame,
+						  const byte* const pBlender, const vec_t* const pAdj, const SequenceChannels_t& channels, glm::mat3x4* pBoneTransforms )
+{
+	//Kept on the stack so poses can be calculated on multiple threads.
+	glm::vec3 pos[ MAXSTUDIOBONES ];
+	glm::vec4 q[ MAXSTUDIOBONES ];
+
+	glm::vec3 pos2[ MAXSTUDIOBONES ];
+	glm::vec4 q2[ MAXSTUDIOBONES ];
+	glm::vec3 pos3[ MAXSTUDIOBONES ];
+	glm::vec4 q3[ MAXSTUDIOBONES ];
+	glm::vec3 pos4[ MAXSTUDIOBONES ];
+	glm::vec4 q4[ MAXSTUDIOBONES ];
+
+	const auto& blends = channels.blends;
+
+	CalcAnimatedRotations( header, pAdj, seqdesc, blends[ 0 ], panim, flFrame, pos, q );
+
+	//Static bones are the same in all blends, so only dynamic bones need blending.
+	if( blends.size() > 1 )
+	{
+		panim += header.numbones;
+		CalcAnimatedRotations( header, pAdj, seqdesc, blends[ 1 ], panim, flFrame, pos2, q2 );
+		float s = pBlender[ 0 ] / 255.0;
+
+		SlerpDynamicBones( channels.dynamicBones, q, pos, q2, pos2, s );
+
+		if( blends.size() == 4 )
+		{
+			panim += header.numbones;
+			CalcAnimatedRotations( header, pAdj, seqdesc, blends[ 2 ], panim, flFrame, pos3, q3 );
+
+			panim += header.numbones;
+			CalcAnimatedRotations( header, pAdj, seqdesc, blends[ 3 ], panim, flFrame, pos4, q4 );
+
+			s = pBlender[ 0 ] / 255.0;
+			SlerpDynamicBones( channels.dynamicBones, q3, pos3, q4, pos4, s );
+
+			s = pBlender[ 1 ] / 255.0;
+			SlerpDynamicBones( channels.dynamicBones, q, pos, q3, pos3, s );
+		}
+	}
+
+	const mstudiobone_t* const pbones = header.GetBones();
+
+	memcpy( pBoneTransforms, channels.staticTransforms.data(), sizeof( glm::mat3x4 ) * header.numbones );
+
+	glm::mat3x4 bonematrix;
+
+	for( const auto i : channels.dynamicBones )
+	{
+		BoneMatrix( q[ i ], pos[ i ], bonematrix );
+
+		if( pbones[ i ].parent == -1 )
+		{
+			pBoneTransforms[ i ] = bonematrix;
+		}
+		else
+		{
+			R_ConcatTransforms( pBoneTransforms[ pbones[ i ].parent ], bonematrix, pBoneTransforms[ i ] );
+		}
+	}
+}
+
+void SetUpBindPoseTransforms( const studiohdr_t& header, const vec_t* const pAdj, glm::mat3x4* pBoneTransforms )
+{
+	const mstudiobone_t* const pbones = header.GetBones();
+
+	glm::mat3x4 bonematrix;
+
+	for( int i = 0; i < header.numbones; i++ )
+	{
+		const mstudiobone_t& bone = pbones[ i ];
+
+		glm::vec3 pos;
+		glm::vec3 angles;
+
+		for( int j = 0; j < 3; j++ )
+		{
+			pos[ j ] = bone.value[ j ];
+			angles[ j ] = bone.value[ j + 3 ];
+
+			if( bone.bonecontroller[ j ] != -1 )
+				pos[ j ] += pAdj[ bone.bonecontroller[ j ] ];
+
+			if( bone.bonecontroller[ j + 3 ] != -1 )
+				angles[ j ] += pAdj[ bone.bonecontroller[ j + 3 ] ];
+		}
+
+		glm::vec4 q;
+
+		AngleQuaternion( angles, q );
+
+		BoneMatrix( q, pos, bonematrix );
+
+		if( bone.parent == -1 )
+		{
+			pBoneTransforms[ i ] = bonematrix;
+		}
+		else
+		{
+			R_ConcatTransforms( pBoneTransforms[ bone.parent ], bonematrix, pBoneTransforms[ i ] );
+		}
+	}
+}
+
+void TransformVertices( const glm::vec3* pVerts, const byte* pVertBones, const int iNumVerts,
+						const glm::mat3x4* const pBoneTransforms, glm::vec3* pOutVerts )
+{
+	TransformVertices( GetBestSkinningKernel(), pVerts, pVertBones, iNumVerts, pBoneTransforms, pOutVerts );
+}
+}
@@ -0,0 +1,161 @@
+#ifndef GAME_STUDIOMODEL_STUDIOPOSE_H
+#define GAME_STUDIOMODEL_STUDIOPOSE_H
+
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat3x4.hpp>
+
+#include "utility/mathlib.h"
+
+#include "studio.h"
+
+/**
+*	@file
+*
+*	Calculates bone poses and transforms vertices for studio models.
+*	These functions only depend on model data, so they can be used without a renderer or OpenGL context.
+*/
+
+namespace studiomdl
+{
+/**
+*	Number of channels of a bone: X, Y, Z, XR, YR, ZR. Same order as mstudiobone_t::value and mstudioanim_t::offset.
+*/
+const int STUDIO_NUM_BONE_CHANNELS = 6;
+
+/**
+*	Channel masks for BlendChannels_t::channelMasks.
+*/
+const byte STUDIO_POSITION_CHANNELS = 0x07;
+const byte STUDIO_ROTATION_CHANNELS = 0x38;
+
+/**
+*	Which channels change in a single blend of a sequence.
+*/
+struct BlendChannels_t
+{
+	/**
+	*	Bones with at least one channel that changes, in bone order.
+	*/
+	std::vector<byte> animatedBones;
+
+	/**
+	*	For each bone, the channels that change: bit n is set if channel n has animation data or is adjusted by a bone controller.
+	*/
+	std::vector<byte> channelMasks;
+
+	/**
+	*	Position and rotation of each bone on the first frame. Channels that don't change have these values on every frame.
+	*/
+	std::vector<glm::vec3> pos;
+	std::vector<glm::vec4> q;
+};
+
+/**
+*	Load time analysis of a sequence, used to evaluate only the parts of the skeleton that actually move.
+*/
+struct SequenceChannels_t
+{
+	/**
+	*	One for each blend.
+	*/
+	std::vector<BlendChannels_t> blends;
+
+	/**
+	*	Bones whose transformation matrix changes during the sequence, in bone order.
+	*/
+	std::vector<byte> dynamicBones;
+
+	/**
+	*	Transformation matrix of each bone that is not in dynamicBones.
+	*	A bone is static if none of its channels change in any blend, its pose is the same in all blends, and its parent is static.
+	*/
+	std::vector<glm::mat3x4> staticTransforms;
+};
+
+/**
+*	Analyzes which channels of a sequence change and precomputes the static bones.
+*	Must be rebuilt if the bones or animations are modified.
+*	@param header Studio header.
+*	@param seqdesc Sequence to analyze.
+*	@param panim Animations of the sequence, for all blends.
+*	@param channels Receives the result.
+*/
+void BuildSequenceChannels( const studiohdr_t& header, const mstudioseqdesc_t& seqdesc, const mstudioanim_t* panim, SequenceChannels_t& channels );
+
+/**
+*	Calculates the adjustments made by bone controllers.
+*	@param header Studio header.
+*	@param pController Values of the 4 user controllers.
+*	@param uiMouth Value of the mouth controller.
+*	@param pAdj Receives an adjustment for each bone controller. Must have room for MAXSTUDIOCONTROLLERS values.
+*/
+void CalcBoneAdj( const studiohdr_t& header, const byte* const pController, const byte uiMouth, vec_t* pAdj );
+
+/**
+*	Calculates the rotation and position of every bone for a single frame of an animation.
+*	@param header Studio header.
+*	@param pAdj Bone controller adjustments, as calculated by CalcBoneAdj.
+*	@param seqdesc Sequence being played.
+*	@param panim Animation of the first bone for the blend being calculated.
+*	@param flFrame Frame to calculate. The fraction is used to interpolate to the next frame.
+*	@param pos Receives the position of each bone.
+*	@param q Receives the rotation of each bone.
+*/
+void CalcRotations( const studiohdr_t& header, const vec_t* const pAdj,
+					const mstudioseqdesc_t& seqdesc, const mstudioanim_t* panim, const float flFrame,
+					glm::vec3* pos, glm::vec4* q );
+
+/**
+*	Interpolates between 2 sets of bone rotations and positions. The result is stored in the first set.
+*	@param iNumBones Number of bones.
+*	@param s Interpolation fraction. Clamped to [0, 1].
+*/
+void SlerpBones( const int iNumBones, glm::vec4* q1, glm::vec3* pos1, glm::vec4* q2, glm::vec3* pos2, float s );
+
+/**
+*	Calculates the transformation matrices of every bone, including blending.
+*	@param header Studio header.
+*	@param seqdesc Sequence being played.
+*	@param panim Animations of the sequence, for all blends.
+*	@param flFrame Frame to calculate.
+*	@param pBlender Values of the 2 blenders.
+*	@param pAdj Bone controller adjustments, as calculated by CalcBoneAdj.
+*	@param pBoneTransforms Receives the transformation matrix of each bone. Must have room for header.numbones matrices.
+*/
+void SetUpBoneTransforms( const studiohdr_t& header, const mstudioseqdesc_t& seqdesc, const mstudioanim_t* panim, const float flFrame,
+						  const byte* const pBlender, const vec_t* const pAdj, glm::mat3x4* pBoneTransforms );
+
+/**
+*	Calculates the transformation matrices of every bone, including blending.
+*	Only the channels and bones that change during the sequence are evaluated, the rest comes from channels.
+*	@param channels Analysis of the sequence, as built by BuildSequenceChannels.
+*	@see SetUpBoneTransforms
+*/
+void SetUpBoneTransforms( const studiohdr_t& header, const mstudioseqdesc_t& seqdesc, const mstudioanim_t* panim, const float flFrame,
+						  const byte* const pBlender, const vec_t* const pAdj, const SequenceChannels_t& channels, glm::mat3x4* pBoneTransforms );
+
+/**
+*	Calculates the transformation matrices of every bone in its default position, without any animation.
+*	Used for sequences whose animations haven't been loaded yet.
+*	@param header Studio header.
+*	@param pAdj Bone controller adjustments, as calculated by CalcBoneAdj.
+*	@param pBoneTransforms Receives the transformation matrix of each bone. Must have room for header.numbones matrices.
+*/
+void SetUpBindPoseTransforms( const studiohdr_t& header, const vec_t* const pAdj, glm::mat3x4* pBoneTransforms );
+
+/**
+*	Transforms vertices by the bones they are attached to, using the fastest kernel this CPU supports. See StudioSkinning.h
+*	@param pVerts Vertices to transform.
+*	@param pVertBones Index of the bone for each vertex.
+*	@param iNumVerts Number of vertices.
+*	@param pBoneTransforms Bone transformation matrices.
+*	@param pOutVerts Receives the transformed vertices. Must not overlap pVerts.
+*/
+void TransformVertices( const glm::vec3* pVerts, const byte* pVertBones, const int iNumVerts,
+						const glm::mat3x4* const pBoneTransforms, glm::vec3* pOutVerts );
+}
+
+#endif //GAME_STUDIOMODEL_STUDIOPOSE_H
@@ -0,0 +1,615 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include <glm/geometric.hpp>
+
+#include "utility/mathlib.h"
+
+#include "StudioSkinning.h"
+
+#if defined( __x86_64__ ) || defined( _M_X64 ) || defined( __SSE2__ ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define STUDIO_SKINNING_SSE 1
+#else
+#define STUDIO_SKINNING_SSE 0
+
+//Without SSE2 vertex transforms, lighting and chrome all fall back to the scalar kernels.
+#if defined( __i386__ ) || defined( _M_IX86 )
+#ifdef _MSC_VER
+#pragma message( "SSE2 is not enabled, studio model skinning, lighting and chrome will use the scalar kernels" )
+#else
+#warning "SSE2 is not enabled, studio model skinning, lighting and chrome will use the scalar kernels"
+#endif
+#endif
+#endif
+
+#if STUDIO_SKINNING_SSE && ( defined( __GNUC__ ) || defined( _MSC_VER ) )
+#define STUDIO_SKINNING_AVX2 1
+#else
+#define STUDIO_SKINNING_AVX2 0
+#endif
+
+#if STUDIO_SKINNING_SSE
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+//MSVC allows AVX2 intrinsics anywhere, GCC and Clang need them enabled per function.
+#if defined( __GNUC__ )
+#define STUDIO_TARGET_AVX2 __attribute__( ( target( "avx2,fma" ) ) )
+#else
+#define STUDIO_TARGET_AVX2
+#endif
+
+namespace studiomdl
+{
+static_assert( sizeof( glm::vec3 ) == sizeof( float ) * 3, "Skinning kernels require tightly packed vectors" );
+static_assert( sizeof( glm::vec2 ) == sizeof( float ) * 2, "Chrome kernels require tightly packed vectors" );
+static_assert( sizeof( glm::mat3x4 ) == sizeof( float ) * 12, "Skinning kernels require tightly packed matrices" );
+
+namespace
+{
+/**
+*	@return Index of the first vertex after iStart that is not attached to the same bone.
+*/
+inline int FindEndOfRun( const byte* pVertBones, const int iStart, const int iNumVerts )
+{
+	const byte bone = pVertBones[ iStart ];
+
+	int iEnd = iStart + 1;
+
+	while( iEnd < iNumVerts && pVertBones[ iEnd ] == bone )
+		++iEnd;
+
+	return iEnd;
+}
+
+void TransformVerticesScalar( const glm::vec3* pVerts, const byte* pVertBones, const int iNumVerts,
+							  const glm::mat3x4* const pBoneTransforms, glm::vec3* pOutVerts )
+{
+	for( int i = 0; i < iNumVerts; i++ )
+	{
+		VectorTransform( pVerts[ i ], pBoneTransforms[ pVertBones[ i ] ], pOutVerts[ i ] );
+	}
+}
+
+#if STUDIO_SKINNING_SSE
+/**
+*	Loads a bone matrix as 4 columns: 3 rotation columns and the translation. The last lane of each is 0.
+*/
+inline void LoadBoneColumns( const glm::mat3x4& matrix, __m128& col0, __m128& col1, __m128& col2, __m128& col3 )
+{
+	col0 = _mm_loadu_ps( &matrix[ 0 ][ 0 ] );
+	col1 = _mm_loadu_ps( &matrix[ 1 ][ 0 ] );
+	col2 = _mm_loadu_ps( &matrix[ 2 ][ 0 ] );
+	col3 = _mm_setzero_ps();
+
+	_MM_TRANSPOSE4_PS( col0, col1, col2, col3 );
+}
+
+/**
+*	Loads a vector into the first 3 lanes without reading past its end.
+*/
+inline __m128 LoadVec3( const glm::vec3& vec )
+{
+	const __m128 xy = _mm_castsi128_ps( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( &vec[ 0 ] ) ) );
+	const __m128 z = _mm_load_ss( &vec[ 2 ] );
+
+	return _mm_movelh_ps( xy, z );
+}
+
+/**
+*	Stores the first 3 lanes without writing past the end of the vector.
+*/
+inline void StoreVec3( glm::vec3& vec, const __m128 value )
+{
+	_mm_storel_epi64( reinterpret_cast<__m128i*>( &vec[ 0 ] ), _mm_castps_si128( value ) );
+	_mm_store_ss( &vec[ 2 ], _mm_movehl_ps( value, value ) );
+}
+
+void TransformVerticesSSE( const glm::vec3* pVerts, const byte* pVertBones, const int iNumVerts,
+						   const glm::mat3x4* const pBoneTransforms, glm::vec3* pOutVerts )
+{
+	__m128 col0, col1, col2, col3;
+
+	for( int i = 0; i < iNumVerts; )
+	{
+		LoadBoneColumns( pBoneTransforms[ pVertBones[ i ] ], col0, col1, col2, col3 );
+
+		const int iEnd = FindEndOfRun( pVertBones, i, iNumVerts );
+
+		for( ; i < iEnd; ++i )
+		{
+			const __m128 vert = LoadVec3( pVerts[ i ] );
+
+			const __m128 x = _mm_shuffle_ps( vert, vert, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+			const __m128 y = _mm_shuffle_ps( vert, vert, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+			const __m128 z = _mm_shuffle_ps( vert, vert, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+
+			//Same order of operations as VectorTransform, so the results are identical.
+			__m128 result = _mm_mul_ps( x, col0 );
+			result = _mm_add_ps( result, _mm_mul_ps( y, col1 ) );
+			result = _mm_add_ps( result, _mm_mul_ps( z, col2 ) );
+			result = _mm_add_ps( result, col3 );
+
+			StoreVec3( pOutVerts[ i ], result );
+		}
+	}
+}
+#endif
+
+/**
+*	Computes the brightness of a normal using pseudo-hemispherical lighting.
+*/
+inline float LightNormal( const LightingParams_t& params, const glm::vec3& normal, const glm::vec3& lightVector )
+{
+	float lightcos = normal[ 0 ] * lightVector[ 0 ] + normal[ 1 ] * lightVector[ 1 ] + normal[ 2 ] * lightVector[ 2 ]; // -1 colinear, 1 opposite
+
+	if( lightcos > 1.0f ) lightcos = 1;
+
+	float illum = params.flAmbient + params.flShade;
+
+	lightcos = ( lightcos + ( params.flLambert - 1.0f ) ) / params.flLambert; // do modified hemispherical lighting
+	if( lightcos > 0.0f ) illum -= lightcos * params.flShade;
+
+	if( illum <= 0 ) illum = 0;
+
+	if( illum > 1.0f )
+		illum *= 1.0f / illum;
+
+	return illum;
+}
+
+void LightNormalsScalar( const LightingParams_t& params, const glm::vec3* pNorms, const byte* pNormBones, const int iNumNorms,
+						 const glm::vec3* const pBoneLightVectors, glm::vec3* pOutLight )
+{
+	for( int i = 0; i < iNumNorms; ++i )
+	{
+		pOutLight[ i ] = params.vecLightColor * LightNormal( params, pNorms[ i ], pBoneLightVectors[ pNormBones[ i ] ] );
+	}
+}
+
+inline glm::vec2 ChromeNormal( const glm::vec3& normal, const glm::vec3& chromeUp, const glm::vec3& chromeRight )
+{
+	// calc s coord
+	const float s = normal[ 0 ] * chromeRight[ 0 ] + normal[ 1 ] * chromeRight[ 1 ] + normal[ 2 ] * chromeRight[ 2 ];
+
+	// calc t coord
+	const float t = normal[ 0 ] * chromeUp[ 0 ] + normal[ 1 ] * chromeUp[ 1 ] + normal[ 2 ] * chromeUp[ 2 ];
+
+	return glm::vec2( ( s + 1.0f ) * 32, ( t + 1.0f ) * 32 );
+}
+
+void ComputeChromeScalar( const glm::vec3* pNorms, const byte* pNormBones, const int iNumNorms,
+						  const glm::vec3* const pChromeUp, const glm::vec3* const pChromeRight, glm::vec2* pOutChrome )
+{
+	for( int i = 0; i < iNumNorms; ++i )
+	{
+		pOutChrome[ i ] = ChromeNormal( pNorms[ i ], pChromeUp[ pNormBones[ i ] ], pChromeRight[ pNormBones[ i ] ] );
+	}
+}
+
+#if STUDIO_SKINNING_SSE
+/**
+*	Loads 4 consecutive vectors as separate x, y and z registers.
+*/
+inline void LoadVec3x4( const glm::vec3* pVecs, __m128& x, __m128& y, __m128& z )
+{
+	const float* pData = &pVecs[ 0 ][ 0 ];
+
+	//x0y0z0x1 y1z1x2y2 z2x3y3z3
+	const __m128 a = _mm_loadu_ps( pData );
+	const __m128 b = _mm_loadu_ps( pData + 4 );
+	const __m128 c = _mm_loadu_ps( pData + 8 );
+
+	x = _mm_shuffle_ps( a, _mm_shuffle_ps( b, c, _MM_SHUFFLE( 1, 1, 2, 2 ) ), _MM_SHUFFLE( 2, 0, 3, 0 ) );
+	y = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 0, 0, 1, 1 ) ), _mm_shuffle_ps( b, c, _MM_SHUFFLE( 2, 2, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+	z = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 1, 1, 2, 2 ) ), c, _MM_SHUFFLE( 3, 0, 2, 0 ) );
+}
+
+/**
+*	Loads the vectors of 4 bones as separate x, y and z registers.
+*	Normals are usually sorted by bone, so all 4 bones are often the same.
+*/
+inline void GatherVec3x4( const glm::vec3* const pVecs, const byte* pBones, __m128& x, __m128& y, __m128& z )
+{
+	uint32_t bones;
+
+	memcpy( &bones, pBones, sizeof( bones ) );
+
+	if( bones == pBones[ 0 ] * 0x01010101u )
+	{
+		const glm::vec3& vec = pVecs[ pBones[ 0 ] ];
+
+		x = _mm_set1_ps( vec[ 0 ] );
+		y = _mm_set1_ps( vec[ 1 ] );
+		z = _mm_set1_ps( vec[ 2 ] );
+
+		return;
+	}
+
+	__m128 v0 = LoadVec3( pVecs[ pBones[ 0 ] ] );
+	__m128 v1 = LoadVec3( pVecs[ pBones[ 1 ] ] );
+	__m128 v2 = LoadVec3( pVecs[ pBones[ 2 ] ] );
+	__m128 v3 = LoadVec3( pVecs[ pBones[ 3 ] ] );
+
+	_MM_TRANSPOSE4_PS( v0, v1, v2, v3 );
+
+	x = v0;
+	y = v1;
+	z = v2;
+}
+
+/**
+*	4 dot products, in the same order of operations as the scalar code.
+*/
+inline __m128 DotProduct3x4( const __m128 ax, const __m128 ay, const __m128 az, const __m128 bx, const __m128 by, const __m128 bz )
+{
+	return _mm_add_ps( _mm_add_ps( _mm_mul_ps( ax, bx ), _mm_mul_ps( ay, by ) ), _mm_mul_ps( az, bz ) );
+}
+
+void LightNormalsSSE( const LightingParams_t& params, const glm::vec3* pNorms, const byte* pNormBones, const int iNumNorms,
+					  const glm::vec3* const pBoneLightVectors, glm::vec3* pOutLight )
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 illumBase = _mm_set1_ps( params.flAmbient + params.flShade );
+	const __m128 shade = _mm_set1_ps( params.flShade );
+	const __m128 lambert = _mm_set1_ps( params.flLambert );
+	const __m128 lambertBias = _mm_set1_ps( params.flLambert - 1.0f );
+
+	//The light color lined up with 4 consecutive output vectors.
+	const glm::vec3& color = params.vecLightColor;
+
+	const __m128 colorRGBR = _mm_setr_ps( color[ 0 ], color[ 1 ], color[ 2 ], color[ 0 ] );
+	const __m128 colorGBRG = _mm_setr_ps( color[ 1 ], color[ 2 ], color[ 0 ], color[ 1 ] );
+	const __m128 colorBRGB = _mm_setr_ps( color[ 2 ], color[ 0 ], color[ 1 ], color[ 2 ] );
+
+	int i = 0;
+
+	for( ; i + 4 <= iNumNorms; i += 4 )
+	{
+		__m128 nx, ny, nz;
+		__m128 lx, ly, lz;
+
+		LoadVec3x4( pNorms + i, nx, ny, nz );
+		GatherVec3x4( pBoneLightVectors, pNormBones + i, lx, ly, lz );
+
+		//Same operations as LightNormal.
+		__m128 lightcos = _mm_min_ps( DotProduct3x4( nx, ny, nz, lx, ly, lz ), one );
+
+		lightcos = _mm_div_ps( _mm_add_ps( lightcos, lambertBias ), lambert );
+
+		const __m128 direct = _mm_and_ps( _mm_cmpgt_ps( lightcos, zero ), _mm_mul_ps( lightcos, shade ) );
+
+		__m128 illum = _mm_max_ps( _mm_sub_ps( illumBase, direct ), zero );
+
+		const __m128 overbright = _mm_cmpgt_ps( illum, one );
+
+		illum = _mm_or_ps(
+			_mm_and_ps( overbright, _mm_mul_ps( illum, _mm_div_ps( one, illum ) ) ),
+			_mm_andnot_ps( overbright, illum ) );
+
+		float* pOut = &pOutLight[ i ][ 0 ];
+
+		_mm_storeu_ps( pOut, _mm_mul_ps( colorRGBR, _mm_shuffle_ps( illum, illum, _MM_SHUFFLE( 1, 0, 0, 0 ) ) ) );
+		_mm_storeu_ps( pOut + 4, _mm_mul_ps( colorGBRG, _mm_shuffle_ps( illum, illum, _MM_SHUFFLE( 2, 2, 1, 1 ) ) ) );
+		_mm_storeu_ps( pOut + 8, _mm_mul_ps( colorBRGB, _mm_shuffle_ps( illum, illum, _MM_SHUFFLE( 3, 3, 3, 2 ) ) ) );
+	}
+
+	LightNormalsScalar( params, pNorms + i, pNormBones + i, iNumNorms - i, pBoneLightVectors, pOutLight + i );
+}
+
+void ComputeChromeSSE( const glm::vec3* pNorms, const byte* pNormBones, const int iNumNorms,
+					   const glm::vec3* const pChromeUp, const glm::vec3* const pChromeRight, glm::vec2* pOutChrome )
+{
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 scale = _mm_set1_ps( 32.0f );
+
+	int i = 0;
+
+	for( ; i + 4 <= iNumNorms; i += 4 )
+	{
+		__m128 nx, ny, nz;
+		__m128 rx, ry, rz;
+		__m128 ux, uy, uz;
+
+		LoadVec3x4( pNorms + i, nx, ny, nz );
+		GatherVec3x4( pChromeRight, pNormBones + i, rx, ry, rz );
+		GatherVec3x4( pChromeUp, pNormBones + i, ux, uy, uz );
+
+		const __m128 s = _mm_mul_ps( _mm_add_ps( DotProduct3x4( nx, ny, nz, rx, ry, rz ), one ), scale );
+		const __m128 t = _mm_mul_ps( _mm_add_ps( DotProduct3x4( nx, ny, nz, ux, uy, uz ), one ), scale );
+
+		float* pOut = &pOutChrome[ i ][ 0 ];
+
+		_mm_storeu_ps( pOut, _mm_unpacklo_ps( s, t ) );
+		_mm_storeu_ps( pOut + 4, _mm_unpackhi_ps( s, t ) );
+	}
+
+	ComputeChromeScalar( pNorms + i, pNormBones + i, iNumNorms - i, pChromeUp, pChromeRight, pOutChrome + i );
+}
+#endif
+
+#if STUDIO_SKINNING_AVX2
+/**
+*	Transforms 8 vertices at a time. Runs of vertices are converted from xyz triplets to separate x, y and z registers,
+*	transformed, and converted back. Vertices left over at the end of a run are transformed one at a time.
+*/
+STUDIO_TARGET_AVX2 void TransformVerticesAVX2( const glm::vec3* pVerts, const byte* pVertBones, const int iNumVerts,
+											   const glm::mat3x4* const pBoneTransforms, glm::vec3* pOutVerts )
+{
+	__m128 col0, col1, col2, col3;
+
+	for( int i = 0; i < iNumVerts; )
+	{
+		const glm::mat3x4& matrix = pBoneTransforms[ pVertBones[ i ] ];
+
+		const int iEnd = FindEndOfRun( pVertBones, i, iNumVerts );
+
+		if( i + 8 <= iEnd )
+		{
+			__m256 elements[ 3 ][ 4 ];
+
+			for( int iRow = 0; iRow < 3; ++iRow )
+			{
+				for( int iColumn = 0; iColumn < 4; ++iColumn )
+				{
+					elements[ iRow ][ iColumn ] = _mm256_broadcast_ss( &matrix[ iRow ][ iColumn ] );
+				}
+			}
+
+			for( ; i + 8 <= iEnd; i += 8 )
+			{
+				const float* pIn = &pVerts[ i ][ 0 ];
+
+				//Load as x0y0z0x1 y1z1x2y2 z2x3y3z3 | x4y4z4x5 y5z5x6y6 z6x7y7z7
+				const __m256 m03 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( pIn ) ), _mm_loadu_ps( pIn + 12 ), 1 );
+				const __m256 m14 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( pIn + 4 ) ), _mm_loadu_ps( pIn + 16 ), 1 );
+				const __m256 m25 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( pIn + 8 ) ), _mm_loadu_ps( pIn + 20 ), 1 );
+
+				const __m256 xy = _mm256_shuffle_ps( m14, m25, _MM_SHUFFLE( 2, 1, 3, 2 ) );
+				const __m256 yz = _mm256_shuffle_ps( m03, m14, _MM_SHUFFLE( 1, 0, 2, 1 ) );
+
+				const __m256 x = _mm256_shuffle_ps( m03, xy, _MM_SHUFFLE( 2, 0, 3, 0 ) );
+				const __m256 y = _mm256_shuffle_ps( yz, xy, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+				const __m256 z = _mm256_shuffle_ps( yz, m25, _MM_SHUFFLE( 3, 0, 3, 1 ) );
+
+				__m256 out[ 3 ];
+
+				for( int iRow = 0; iRow < 3; ++iRow )
+				{
+					__m256 result = _mm256_mul_ps( x, elements[ iRow ][ 0 ] );
+					result = _mm256_fmadd_ps( y, elements[ iRow ][ 1 ], result );
+					result = _mm256_fmadd_ps( z, elements[ iRow ][ 2 ], result );
+					out[ iRow ] = _mm256_add_ps( result, elements[ iRow ][ 3 ] );
+				}
+
+				//Back to triplets.
+				const __m256 rxy = _mm256_shuffle_ps( out[ 0 ], out[ 1 ], _MM_SHUFFLE( 2, 0, 2, 0 ) );
+				const __m256 ryz = _mm256_shuffle_ps( out[ 1 ], out[ 2 ], _MM_SHUFFLE( 3, 1, 3, 1 ) );
+				const __m256 rzx = _mm256_shuffle_ps( out[ 2 ], out[ 0 ], _MM_SHUFFLE( 3, 1, 2, 0 ) );
+
+				const __m256 r03 = _mm256_shuffle_ps( rxy, rzx, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+				const __m256 r14 = _mm256_shuffle_ps( ryz, rxy, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+				const __m256 r25 = _mm256_shuffle_ps( rzx, ryz, _MM_SHUFFLE( 3, 1, 3, 1 ) );
+
+				float* pOut = &pOutVerts[ i ][ 0 ];
+
+				_mm_storeu_ps( pOut, _mm256_castps256_ps128( r03 ) );
+				_mm_storeu_ps( pOut + 4, _mm256_castps256_ps128( r14 ) );
+				_mm_storeu_ps( pOut + 8, _mm256_castps256_ps128( r25 ) );
+				_mm_storeu_ps( pOut + 12, _mm256_extractf128_ps( r03, 1 ) );
+				_mm_storeu_ps( pOut + 16, _mm256_extractf128_ps( r14, 1 ) );
+				_mm_storeu_ps( pOut + 20, _mm256_extractf128_ps( r25, 1 ) );
+			}
+		}
+
+		if( i < iEnd )
+		{
+			LoadBoneColumns( matrix, col0, col1, col2, col3 );
+
+			for( ; i < iEnd; ++i )
+			{
+				const __m128 vert = LoadVec3( pVerts[ i ] );
+
+				__m128 result = _mm_mul_ps( _mm_permute_ps( vert, _MM_SHUFFLE( 0, 0, 0, 0 ) ), col0 );
+				result = _mm_fmadd_ps( _mm_permute_ps( vert, _MM_SHUFFLE( 1, 1, 1, 1 ) ), col1, result );
+				result = _mm_fmadd_ps( _mm_permute_ps( vert, _MM_SHUFFLE( 2, 2, 2, 2 ) ), col2, result );
+				result = _mm_add_ps( result, col3 );
+
+				StoreVec3( pOutVerts[ i ], result );
+			}
+		}
+	}
+}
+
+bool CPUSupportsAVX2()
+{
+#ifdef _MSC_VER
+	int info[ 4 ];
+
+	__cpuid( info, 0 );
+
+	if( info[ 0 ] < 7 )
+		return false;
+
+	__cpuid( info, 1 );
+
+	const bool bOSXSave = ( info[ 2 ] & ( 1 << 27 ) ) != 0;
+	const bool bFMA = ( info[ 2 ] & ( 1 << 12 ) ) != 0;
+
+	//The OS must save the AVX registers on context switches.
+	if( !bOSXSave || !bFMA || ( _xgetbv( 0 ) & 6 ) != 6 )
+		return false;
+
+	__cpuidex( info, 7, 0 );
+
+	return ( info[ 1 ] & ( 1 << 5 ) ) != 0;
+#else
+	__builtin_cpu_init();
+
+	return __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" );
+#endif
+}
+#endif
+}
+
+const char* SkinningKernelToString( const SkinningKernel kernel )
+{
+	switch( kernel )
+	{
+	case SkinningKernel::SCALAR:	return "scalar";
+	case SkinningKernel::SSE:		return "sse";
+	case SkinningKernel::AVX2:		return "avx2";
+
+	default: return "unknown";
+	}
+}
+
+bool IsSkinningKernelSupported( const SkinningKernel kernel )
+{
+	switch( kernel )
+	{
+	case SkinningKernel::SCALAR:	return true;
+	case SkinningKernel::SSE:		return STUDIO_SKINNING_SSE != 0;
+
+	case SkinningKernel::AVX2:
+		{
+#if STUDIO_SKINNING_AVX2
+			static const bool bSupported = CPUSupportsAVX2();
+
+			return bSupported;
+#else
+			return false;
+#endif
+		}
+
+	default: return false;
+	}
+}
+
+SkinningKernel GetBestSkinningKernel()
+{
+	static const SkinningKernel kernel =
+		IsSkinningKernelSupported( SkinningKernel::AVX2 ) ? SkinningKernel::AVX2 :
+		IsSkinningKernelSupported( SkinningKernel::SSE ) ? SkinningKernel::SSE :
+		SkinningKernel::SCALAR;
+
+	return kernel;
+}
+
+void TransformVertices( const SkinningKernel kernel, const glm::vec3* pVerts, const byte* pVertBones, const int iNumVerts,
+						const glm::mat3x4* const pBoneTransforms, glm::vec3* pOutVerts )
+{
+	assert( IsSkinningKernelSupported( kernel ) );
+
+	switch( kernel )
+	{
+#if STUDIO_SKINNING_SSE
+	case SkinningKernel::SSE:
+		TransformVerticesSSE( pVerts, pVertBones, iNumVerts, pBoneTransforms, pOutVerts );
+		break;
+#endif
+
+#if STUDIO_SKINNING_AVX2
+	case SkinningKernel::AVX2:
+		TransformVerticesAVX2( pVerts, pVertBones, iNumVerts, pBoneTransforms, pOutVerts );
+		break;
+#endif
+
+	default:
+		TransformVerticesScalar( pVerts, pVertBones, iNumVerts, pBoneTransforms, pOutVerts );
+		break;
+	}
+}
+
+void LightNormals( const SkinningKernel kernel, const LightingParams_t& params,
+				   const glm::vec3* pNorms, const byte* pNormBones, const int iNumNorms,
+				   const glm::vec3* const pBoneLightVectors, glm::vec3* pOutLight )
+{
+	assert( IsSkinningKernelSupported( kernel ) );
+
+	switch( kernel )
+	{
+#if STUDIO_SKINNING_SSE
+	case SkinningKernel::SSE:
+	case SkinningKernel::AVX2:
+		LightNormalsSSE( params, pNorms, pNormBones, iNumNorms, pBoneLightVectors, pOutLight );
+		break;
+#endif
+
+	default:
+		LightNormalsScalar( params, pNorms, pNormBones, iNumNorms, pBoneLightVectors, pOutLight );
+		break;
+	}
+}
+
+void LightNormalsFlat( const LightingParams_t& params, const int iNumNorms, glm::vec3* pOutLight )
+{
+	float illum = params.flAmbient + 0.8f * params.flShade;
+
+	if( illum > 1.0f )
+		illum *= 1.0f / illum;
+
+	std::fill_n( pOutLight, iNumNorms, params.vecLightColor * illum );
+}
+
+void LightNormalsFullbright( const int iNumNorms, glm::vec3* pOutLight )
+{
+	std::fill_n( pOutLight, iNumNorms, glm::vec3( 1, 1, 1 ) );
+}
+
+void SetupChromeVectors( const int iNumBones, const glm::mat3x4* const pBoneTransforms,
+						 const glm::vec3& vecViewerOrigin, const glm::vec3& vecViewerRight,
+						 glm::vec3* pOutChromeUp, glm::vec3* pOutChromeRight )
+{
+	for( int i = 0; i < iNumBones; ++i )
+	{
+		const glm::mat3x4& bone = pBoneTransforms[ i ];
+
+		// calculate vectors from the viewer to the bone. This roughly adjusts for position
+		// vector pointing at bone in world reference frame
+		glm::vec3 tmp = vecViewerOrigin * -1.0f;
+
+		tmp[ 0 ] += bone[ 0 ][ 3 ];
+		tmp[ 1 ] += bone[ 1 ][ 3 ];
+		tmp[ 2 ] += bone[ 2 ][ 3 ];
+
+		VectorNormalize( tmp );
+		// g_chrome t vector in world reference frame
+		glm::vec3 chromeupvec = glm::cross( tmp, -vecViewerRight );
+		VectorNormalize( chromeupvec );
+		// g_chrome s vector in world reference frame
+		glm::vec3 chromerightvec = glm::cross( tmp, chromeupvec );
+		VectorNormalize( chromerightvec );
+
+		VectorIRotate( -chromeupvec, bone, pOutChromeUp[ i ] );
+		VectorIRotate( chromerightvec, bone, pOutChromeRight[ i ] );
+	}
+}
+
+void ComputeChrome( const SkinningKernel kernel, const glm::vec3* pNorms, const byte* pNormBones, const int iNumNorms,
+					const glm::vec3* const pChromeUp, const glm::vec3* const pChromeRight, glm::vec2* pOutChrome )
+{
+	assert( IsSkinningKernelSupported( kernel ) );
+
+	switch( kernel )
+	{
+#if STUDIO_SKINNING_SSE
+	case SkinningKernel::SSE:
+	case SkinningKernel::AVX2:
+		ComputeChromeSSE( pNorms, pNormBones, iNumNorms, pChromeUp, pChromeRight, pOutChrome );
+		break;
+#endif
+
+	default:
+		ComputeChromeScalar( pNorms, pNormBones, iNumNorms, pChromeUp, pChromeRight, pOutChrome );
+		break;
+	}
+}
+}
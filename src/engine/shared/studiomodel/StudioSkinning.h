@@ -0,0 +1,135 @@
+#ifndef GAME_STUDIOMODEL_STUDIOSKINNING_H
+#define GAME_STUDIOMODEL_STUDIOSKINNING_H
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/mat3x4.hpp>
+
+#include "shared/Const.h"
+
+/**
+*	@file
+*
+*	Vertex skinning and lighting kernels. Vertices in studio models are attached to a single bone and are stored sorted by bone,
+*	so the kernels walk runs of vertices that share a bone and load its matrix once per run.
+*	The SSE kernel produces exactly the same results as the scalar kernel. The AVX2 kernel uses fused multiply-add,
+*	so results can differ from the scalar kernel in the last bits.
+*
+*	Normals are lit and chrome mapped 4 at a time by the SSE kernel. The AVX2 kernel uses the SSE code for those,
+*	so lighting and chrome results are identical for all kernels.
+*/
+
+namespace studiomdl
+{
+enum class SkinningKernel
+{
+	SCALAR = 0,
+	SSE,
+	AVX2,
+
+	COUNT
+};
+
+const char* SkinningKernelToString( const SkinningKernel kernel );
+
+/**
+*	@return Whether the kernel was compiled in and is supported by this CPU.
+*/
+bool IsSkinningKernelSupported( const SkinningKernel kernel );
+
+/**
+*	@return The fastest kernel supported by this CPU.
+*/
+SkinningKernel GetBestSkinningKernel();
+
+/**
+*	Transforms vertices by the bones they are attached to using the given kernel.
+*	@param kernel Kernel to use. Must be supported.
+*	@param pVerts Vertices to transform.
+*	@param pVertBones Index of the bone for each vertex.
+*	@param iNumVerts Number of vertices.
+*	@param pBoneTransforms Bone transformation matrices.
+*	@param pOutVerts Receives the transformed vertices. Must not overlap pVerts.
+*/
+void TransformVertices( const SkinningKernel kernel, const glm::vec3* pVerts, const byte* pVertBones, const int iNumVerts,
+						const glm::mat3x4* const pBoneTransforms, glm::vec3* pOutVerts );
+
+/**
+*	Lighting constants shared by all normals of a model.
+*/
+struct LightingParams_t
+{
+	/**
+	*	Ambient light, in the range [0.1, 1].
+	*/
+	float flAmbient = 0.1f;
+
+	/**
+	*	Direct light, in the range [0, 1].
+	*/
+	float flShade = 0;
+
+	/**
+	*	Modifier for pseudo-hemispherical lighting. At least 1.
+	*/
+	float flLambert = 1;
+
+	/**
+	*	Color of the light, each component in the range [0, 1].
+	*/
+	glm::vec3 vecLightColor{ 1, 1, 1 };
+};
+
+/**
+*	Lights the normals of a mesh that has no shading flags, using pseudo-hemispherical lighting.
+*	@param kernel Kernel to use. Must be supported.
+*	@param params Lighting constants.
+*	@param pNorms Normals to light.
+*	@param pNormBones Index of the bone for each normal.
+*	@param iNumNorms Number of normals.
+*	@param pBoneLightVectors Light vector in each bone's reference frame.
+*	@param pOutLight Receives the light value for each normal.
+*/
+void LightNormals( const SkinningKernel kernel, const LightingParams_t& params,
+				   const glm::vec3* pNorms, const byte* pNormBones, const int iNumNorms,
+				   const glm::vec3* const pBoneLightVectors, glm::vec3* pOutLight );
+
+/**
+*	Lights the normals of a mesh with the STUDIO_NF_FLATSHADE flag. The result does not depend on the normals.
+*/
+void LightNormalsFlat( const LightingParams_t& params, const int iNumNorms, glm::vec3* pOutLight );
+
+/**
+*	Lights the normals of a mesh with the STUDIO_NF_FULLBRIGHT flag. The result does not depend on the normals.
+*/
+void LightNormalsFullbright( const int iNumNorms, glm::vec3* pOutLight );
+
+/**
+*	Computes the chrome basis of each bone in that bone's reference frame.
+*	@param iNumBones Number of bones.
+*	@param pBoneTransforms Bone transformation matrices.
+*	@param vecViewerOrigin Origin of the viewer.
+*	@param vecViewerRight Right vector of the viewer.
+*	@param pOutChromeUp Receives the chrome "up" vector of each bone.
+*	@param pOutChromeRight Receives the chrome "right" vector of each bone.
+*/
+void SetupChromeVectors( const int iNumBones, const glm::mat3x4* const pBoneTransforms,
+						 const glm::vec3& vecViewerOrigin, const glm::vec3& vecViewerRight,
+						 glm::vec3* pOutChromeUp, glm::vec3* pOutChromeRight );
+
+/**
+*	Computes chrome texture coordinates for the normals of a mesh with the STUDIO_NF_CHROME flag.
+*	The coordinates are in the range [0, 64] and must be scaled by the texture size.
+*	@param kernel Kernel to use. Must be supported.
+*	@param pNorms Normals.
+*	@param pNormBones Index of the bone for each normal.
+*	@param iNumNorms Number of normals.
+*	@param pChromeUp Chrome "up" vector of each bone.
+*	@param pChromeRight Chrome "right" vector of each bone.
+*	@param pOutChrome Receives the texture coordinates for each normal.
+*/
+void ComputeChrome( const SkinningKernel kernel, const glm::vec3* pNorms, const byte* pNormBones, const int iNumNorms,
+					const glm::vec3* const pChromeUp, const glm::vec3* const pChromeRight, glm::vec2* pOutChrome );
+}
+
+#endif //GAME_STUDIOMODEL_STUDIOSKINNING_H
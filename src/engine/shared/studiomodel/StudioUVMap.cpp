@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "StudioUVMap.h"
+
+namespace studiomdl
+{
+namespace
+{
+void AddEdge( const short* pVert0, const short* pVert1, std::vector<UVEdge_t>& edges )
+{
+	//Vertex data is vertex index, normal index, s and t.
+	UVEdge_t edge{ pVert0[ 2 ], pVert0[ 3 ], pVert1[ 2 ], pVert1[ 3 ] };
+
+	if( edge.s0 == edge.s1 && edge.t0 == edge.t1 )
+		return;
+
+	if( edge.s1 < edge.s0 || ( edge.s1 == edge.s0 && edge.t1 < edge.t0 ) )
+	{
+		std::swap( edge.s0, edge.s1 );
+		std::swap( edge.t0, edge.t1 );
+	}
+
+	edges.push_back( edge );
+}
+
+void PlotPixel( const int x, const int y, const int iWidth, const int iHeight, uint8_t* pPixels, const uint8_t ( &color )[ 3 ] )
+{
+	if( x < 0 || y < 0 || x >= iWidth || y >= iHeight )
+		return;
+
+	uint8_t* const pPixel = pPixels + ( static_cast<size_t>( y ) * iWidth + x ) * 3;
+
+	pPixel[ 0 ] = color[ 0 ];
+	pPixel[ 1 ] = color[ 1 ];
+	pPixel[ 2 ] = color[ 2 ];
+}
+}
+
+void AppendUVEdges( const short* pTriCmds, std::vector<UVEdge_t>& edges )
+{
+	int i;
+
+	while( ( i = *( pTriCmds++ ) ) != 0 )
+	{
+		const bool bIsFan = i < 0;
+
+		if( bIsFan )
+			i = -i;
+
+		const short* const pVerts = pTriCmds;
+
+		//Strip triangles are ( n, n + 1, n + 2 ), fan triangles are ( 0, n + 1, n + 2 ).
+		for( int iVert = 1; iVert < i; ++iVert )
+		{
+			AddEdge( pVerts + ( iVert - 1 ) * 4, pVerts + iVert * 4, edges );
+
+			if( iVert >= 2 )
+				AddEdge( pVerts + ( bIsFan ? 0 : ( iVert - 2 ) * 4 ), pVerts + iVert * 4, edges );
+		}
+
+		pTriCmds += i * 4;
+	}
+}
+
+void RemoveDuplicateUVEdges( std::vector<UVEdge_t>& edges )
+{
+	std::sort( edges.begin(), edges.end() );
+	edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+}
+
+void ExtractTextureUVEdges( const studiohdr_t& header, const studiohdr_t& textureHeader, const int iTexture, std::vector<UVEdge_t>& edges )
+{
+	edges.clear();
+
+	const short* const pskinref = textureHeader.GetSkins();
+
+	const byte* const pData = header.GetData();
+
+	for( int iBodyPart = 0; iBodyPart < header.numbodyparts; ++iBodyPart )
+	{
+		const mstudiobodyparts_t* const pbodypart = header.GetBodypart( iBodyPart );
+
+		const mstudiomodel_t* const pModels = reinterpret_cast<const mstudiomodel_t*>( pData + pbodypart->modelindex );
+
+		for( int iModel = 0; iModel < pbodypart->nummodels; ++iModel )
+		{
+			const mstudiomodel_t& model = pModels[ iModel ];
+
+			const mstudiomesh_t* const pMeshes = reinterpret_cast<const mstudiomesh_t*>( pData + model.meshindex );
+
+			for( int iMesh = 0; iMesh < model.nummesh; ++iMesh )
+			{
+				if( pskinref[ pMeshes[ iMesh ].skinref ] == iTexture )
+					AppendUVEdges( reinterpret_cast<const short*>( pData + pMeshes[ iMesh ].triindex ), edges );
+			}
+		}
+	}
+
+	RemoveDuplicateUVEdges( edges );
+}
+
+void RasterizeUVEdges( const UVEdge_t* pEdges, const size_t uiNumEdges, const int iWidth, const int iHeight, uint8_t* pPixels,
+					   const uint8_t ( &color )[ 3 ] )
+{
+	for( size_t uiIndex = 0; uiIndex < uiNumEdges; ++uiIndex )
+	{
+		const UVEdge_t& edge = pEdges[ uiIndex ];
+
+		//Edges entirely outside the image can be skipped.
+		if( std::max( edge.s0, edge.s1 ) < 0 || std::min( edge.s0, edge.s1 ) >= iWidth ||
+			std::max( edge.t0, edge.t1 ) < 0 || std::min( edge.t0, edge.t1 ) >= iHeight )
+			continue;
+
+		//Bresenham.
+		int x = edge.s0;
+		int y = edge.t0;
+
+		const int dx = abs( edge.s1 - edge.s0 );
+		const int dy = -abs( edge.t1 - edge.t0 );
+		const int sx = edge.s0 < edge.s1 ? 1 : -1;
+		const int sy = edge.t0 < edge.t1 ? 1 : -1;
+
+		int iError = dx + dy;
+
+		for( ;; )
+		{
+			PlotPixel( x, y, iWidth, iHeight, pPixels, color );
+
+			if( x == edge.s1 && y == edge.t1 )
+				break;
+
+			const int iError2 = 2 * iError;
+
+			if( iError2 >= dy )
+			{
+				iError += dy;
+				x += sx;
+			}
+
+			if( iError2 <= dx )
+			{
+				iError += dx;
+				y += sy;
+			}
+		}
+	}
+}
+}
@@ -0,0 +1,75 @@
+#ifndef GAME_STUDIOMODEL_STUDIOUVMAP_H
+#define GAME_STUDIOMODEL_STUDIOUVMAP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "studio.h"
+
+/**
+*	@file
+*
+*	UV map extraction and rasterization. Does not require OpenGL, so UV maps can be exported by command line tools.
+*/
+
+namespace studiomdl
+{
+/**
+*	A triangle edge in texture space. Coordinates are in texels.
+*/
+struct UVEdge_t
+{
+	short s0, t0;
+	short s1, t1;
+
+	bool operator==( const UVEdge_t& other ) const
+	{
+		return s0 == other.s0 && t0 == other.t0 && s1 == other.s1 && t1 == other.t1;
+	}
+
+	bool operator<( const UVEdge_t& other ) const
+	{
+		if( s0 != other.s0 ) return s0 < other.s0;
+		if( t0 != other.t0 ) return t0 < other.t0;
+		if( s1 != other.s1 ) return s1 < other.s1;
+		return t1 < other.t1;
+	}
+};
+
+/**
+*	Appends the edges of all triangles in a mesh's triangle commands.
+*	Edges are stored with the smaller endpoint first so shared edges compare equal. Degenerate edges are skipped.
+*	@param pTriCmds Triangle commands, terminated by a 0.
+*	@param edges Receives the edges.
+*/
+void AppendUVEdges( const short* pTriCmds, std::vector<UVEdge_t>& edges );
+
+/**
+*	Sorts edges and removes duplicates. Triangles in strips and fans share most of their edges with their neighbors.
+*/
+void RemoveDuplicateUVEdges( std::vector<UVEdge_t>& edges );
+
+/**
+*	Extracts the unique edges of all meshes that use a texture, in every body part and submodel. Uses the first skin family.
+*	Both headers must have been validated.
+*	@param header Main model header.
+*	@param textureHeader Header that contains the textures. Same as header if the model has its own textures.
+*	@param iTexture Index of the texture.
+*	@param edges Receives the edges. Cleared first.
+*/
+void ExtractTextureUVEdges( const studiohdr_t& header, const studiohdr_t& textureHeader, const int iTexture, std::vector<UVEdge_t>& edges );
+
+/**
+*	Draws edges into a 24 bit RGB image. Rows are stored top to bottom. Parts of edges outside the image are clipped.
+*	@param pEdges Edges to draw.
+*	@param uiNumEdges Number of edges.
+*	@param iWidth Width of the image.
+*	@param iHeight Height of the image.
+*	@param pPixels Image. Must be iWidth * iHeight * 3 bytes in size.
+*	@param color Color of the lines, as R, G and B.
+*/
+void RasterizeUVEdges( const UVEdge_t* pEdges, const size_t uiNumEdges, const int iWidth, const int iHeight, uint8_t* pPixels,
+					   const uint8_t ( &color )[ 3 ] );
+}
+
+#endif //GAME_STUDIOMODEL_STUDIOUVMAP_H
@@ -1,4 +1,5 @@
 #include "shared/CWorldTime.h"
+#include "shared/Profiler.h"
 
 #include "CBaseEntity.h"
 #include "CBaseEntityList.h"
@@ -52,6 +53,8 @@ void CEntityManager::OnMapEnd()
 
 void CEntityManager::RunFrame()
 {
+	PROF_ZONE( "CEntityManager::RunFrame" );
+
 	for( EHandle entity = GetEntityList().GetFirstEntity(); entity; entity = GetEntityList().GetNextEntity( entity ) )
 	{
 		CBaseEntity* pEntity = entity;
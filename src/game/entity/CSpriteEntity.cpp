@@ -14,7 +14,8 @@ LINK_ENTITY_TO_CLASS( sprite, CSpriteEntity );
 
 void CSpriteEntity::OnDestroy()
 {
-	sprite::FreeSprite( m_pSprite );
+	m_SpriteHandle.reset();
+	m_pSprite = nullptr;
 
 	BaseClass::OnDestroy();
 }
@@ -53,8 +54,8 @@ void CSpriteEntity::AnimThink()
 		m_flFrame = 0;
 }
 
-void CSpriteEntity::SetSprite( sprite::msprite_t* pSprite )
+void CSpriteEntity::SetSprite( const sprite::SpriteHandle_t& sprite )
 {
-	//TODO: release old sprite
-	m_pSprite = pSprite;
+	m_SpriteHandle = sprite;
+	m_pSprite = sprite.get();
 }
\ No newline at end of file
@@ -1,12 +1,9 @@
 #ifndef GAME_ENTITY_CSPRITEENTITY_H
 #define GAME_ENTITY_CSPRITEENTITY_H
 
-#include "CBaseAnimating.h"
+#include "shared/sprite/SpriteCache.h"
 
-namespace sprite
-{
-struct msprite_t;
-}
+#include "CBaseAnimating.h"
 
 class CSpriteEntity : public CBaseAnimating
 {
@@ -23,9 +20,15 @@ public:
 
 	sprite::msprite_t* GetSprite() const { return m_pSprite; }
 
-	void SetSprite( sprite::msprite_t* pSprite );
+	const sprite::SpriteHandle_t& GetSpriteHandle() const { return m_SpriteHandle; }
+
+	/**
+	*	Sets the sprite. The entity keeps the sprite loaded until it's destroyed or another sprite is set.
+	*/
+	void SetSprite( const sprite::SpriteHandle_t& sprite );
 
 private:
+	sprite::SpriteHandle_t m_SpriteHandle;
 	sprite::msprite_t* m_pSprite = nullptr;
 };
 
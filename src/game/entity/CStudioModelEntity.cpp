@@ -7,6 +7,8 @@
 
 #include "shared/renderer/studiomodel/IStudioModelRenderer.h"
 
+#include "CBaseEntityList.h"
+
 #include "CStudioModelEntity.h"
 
 //TODO: remove
@@ -14,8 +16,8 @@ extern studiomdl::IStudioModelRenderer* g_pStudioMdlRenderer;
 
 void CStudioModelEntity::OnDestroy()
 {
-	//TODO: once models are managed by a cache, don't do this
-	delete m_pModel;
+	m_ModelHandle.reset();
+	m_pModel = nullptr;
 
 	BaseClass::OnDestroy();
 }
@@ -43,6 +45,27 @@ void CStudioModelEntity::Draw( renderer::DrawFlags_t flags )
 {
 	studiomdl::CModelRenderInfo renderInfo;
 
+	GetRenderInfo( renderInfo );
+
+	g_pStudioMdlRenderer->DrawModel( &renderInfo, flags );
+}
+
+void CStudioModelEntity::DrawInstances( CStudioModelEntity* const* ppEntities, const size_t uiCount, renderer::DrawFlags_t flags )
+{
+	std::vector<studiomdl::CModelRenderInfo> renderInfos( uiCount );
+	std::vector<studiomdl::CModelRenderInfo*> renderInfoPtrs( uiCount );
+
+	for( size_t uiIndex = 0; uiIndex < uiCount; ++uiIndex )
+	{
+		ppEntities[ uiIndex ]->GetRenderInfo( renderInfos[ uiIndex ] );
+		renderInfoPtrs[ uiIndex ] = &renderInfos[ uiIndex ];
+	}
+
+	g_pStudioMdlRenderer->DrawModelInstances( renderInfoPtrs.data(), uiCount, flags );
+}
+
+void CStudioModelEntity::GetRenderInfo( studiomdl::CModelRenderInfo& renderInfo )
+{
 	renderInfo.vecOrigin = GetOrigin();
 	renderInfo.vecAngles = GetAngles();
 	renderInfo.vecScale = GetScale();
@@ -67,7 +90,7 @@ void CStudioModelEntity::Draw( renderer::DrawFlags_t flags )
 
 	renderInfo.iMouth = GetMouth();
 
-	g_pStudioMdlRenderer->DrawModel( &renderInfo, flags );
+	renderInfo.pPoseCache = &m_PoseCache;
 }
 
 float CStudioModelEntity::AdvanceFrame( float dt, const float flMax )
@@ -125,7 +148,9 @@ float CStudioModelEntity::AdvanceFrame( float dt, const float flMax )
 	return dt;
 }
 
-int CStudioModelEntity::GetAnimationEvent( CAnimEvent& event, float flStart, float flEnd, int index, const bool bAllowClientEvents )
+static_assert( EVENT_CLIENT == studiomdl::STUDIO_FIRST_CLIENT_EVENT, "The event index must filter client events using EVENT_CLIENT" );
+
+int CStudioModelEntity::FindAnimationEvents( float flStart, float flEnd, const bool bAllowClientEvents, studiomdl::EventRange_t ( &ranges )[ 2 ] ) const
 {
 	if( !m_pModel )
 		return 0;
@@ -135,38 +160,47 @@ int CStudioModelEntity::GetAnimationEvent( CAnimEvent& event, float flStart, flo
 	if( m_iSequence >= pStudioHdr->numseq )
 		return 0;
 
-	int events = 0;
+	const auto pEvents = m_pModel->GetSequenceEvents( m_iSequence );
+
+	if( !pEvents )
+		return 0;
+
+	return studiomdl::FindSequenceEvents( *pStudioHdr->GetSequence( m_iSequence ), *pEvents, bAllowClientEvents, flStart, flEnd, ranges );
+}
+
+void CStudioModelEntity::GetEventData( const studiomdl::EventIndexEntry_t& entry, CAnimEvent& event ) const
+{
+	const studiohdr_t* pStudioHdr = m_pModel->GetStudioHeader();
 
 	const mstudioseqdesc_t* pseqdesc = pStudioHdr->GetSequence( m_iSequence );
 	const mstudioevent_t* pevent = ( const mstudioevent_t * ) ( ( const byte * ) pStudioHdr + pseqdesc->eventindex );
 
-	if( pseqdesc->numevents == 0 || index > pseqdesc->numevents )
+	event.iEvent = pevent[ entry.iEvent ].event;
+	event.pszOptions = pevent[ entry.iEvent ].options;
+}
+
+int CStudioModelEntity::GetAnimationEvent( CAnimEvent& event, float flStart, float flEnd, int index, const bool bAllowClientEvents )
+{
+	if( index < 0 )
 		return 0;
 
-	if( pseqdesc->numframes <= 1 )
-	{
-		flStart = 0;
-		flEnd = 1.0;
-	}
+	studiomdl::EventRange_t ranges[ 2 ];
 
-	for( ; index < pseqdesc->numevents; index++ )
+	const int iNumRanges = FindAnimationEvents( flStart, flEnd, bAllowClientEvents, ranges );
+
+	for( int iRange = 0; iRange < iNumRanges; ++iRange )
 	{
-		//TODO: maybe leave it up to the listener to filter these out?
-		if( !bAllowClientEvents )
-		{
-			// Don't send client-side events to the server AI
-			if( pevent[ index ].event >= EVENT_CLIENT )
-				continue;
-		}
+		const int iCount = static_cast<int>( ranges[ iRange ].pEnd - ranges[ iRange ].pBegin );
 
-		if( ( pevent[ index ].frame >= flStart && pevent[ index ].frame < flEnd ) ||
-			( ( pseqdesc->flags & STUDIO_LOOPING ) && flEnd >= pseqdesc->numframes - 1 && pevent[ index ].frame < flEnd - pseqdesc->numframes + 1 ) )
+		if( index < iCount )
 		{
-			event.iEvent = pevent[ index ].event;
-			event.pszOptions = pevent[ index ].options;
+			GetEventData( ranges[ iRange ].pBegin[ index ], event );
 			return index + 1;
 		}
+
+		index -= iCount;
 	}
+
 	return 0;
 }
 
@@ -178,10 +212,6 @@ void CStudioModelEntity::DispatchAnimEvents( const bool bAllowClientEvents )
 		return;
 	}
 
-	const studiohdr_t* pStudioHdr = m_pModel->GetStudioHeader();
-
-	const mstudioseqdesc_t* pseqdesc = pStudioHdr->GetSequence( m_iSequence );
-
 	//This is based on Source's DispatchAnimEvents. It fixes the bug where events don't get triggered, and get triggered multiple times due to the workaround.
 	//Plays from previous frame to current. This differs from GoldSource in that GoldSource plays from current to predicted future frame.
 	//This is more accurate, since it's based on actual frame data, rather than predicted frames, but results in events firing later than before.
@@ -190,13 +220,19 @@ void CStudioModelEntity::DispatchAnimEvents( const bool bAllowClientEvents )
 	float flEnd = m_flFrame;
 	m_flLastEventCheck = m_flFrame;
 
-	CAnimEvent event;
+	studiomdl::EventRange_t ranges[ 2 ];
+
+	const int iNumRanges = FindAnimationEvents( flStart, flEnd, bAllowClientEvents, ranges );
 
-	int index = 0;
+	CAnimEvent event;
 
-	while( ( index = GetAnimationEvent( event, flStart, flEnd, index, bAllowClientEvents ) ) != 0 )
+	for( int iRange = 0; iRange < iNumRanges; ++iRange )
 	{
-		HandleAnimEvent( event );
+		for( auto pEntry = ranges[ iRange ].pBegin; pEntry != ranges[ iRange ].pEnd; ++pEntry )
+		{
+			GetEventData( *pEntry, event );
+			HandleAnimEvent( event );
+		}
 	}
 }
 
@@ -231,14 +267,32 @@ int CStudioModelEntity::SetFrame( const int iFrame )
 	return static_cast<int>( m_flFrame );
 }
 
-void CStudioModelEntity::SetModel( studiomdl::CStudioModel* pModel )
+void CStudioModelEntity::SetModel( const studiomdl::StudioModelHandle_t& model )
 {
-	//TODO: release old model.
-	m_pModel = pModel;
+	m_ModelHandle = model;
+	m_pModel = model.get();
+
+	m_PoseCache.Invalidate();
 
 	//TODO: reinit entity settings
 }
 
+void CStudioModelEntity::ModelDataChanged()
+{
+	m_PoseCache.Invalidate();
+}
+
+void CStudioModelEntity::ModelDataChanged( const studiomdl::CStudioModel* pModel )
+{
+	for( EHandle entity = GetEntityList().GetFirstEntity(); entity; entity = GetEntityList().GetNextEntity( entity ) )
+	{
+		auto pEntity = dynamic_cast<CStudioModelEntity*>( static_cast<CBaseEntity*>( entity ) );
+
+		if( pEntity && pEntity->GetModel() == pModel )
+			pEntity->ModelDataChanged();
+	}
+}
+
 int CStudioModelEntity::GetNumFrames() const
 {
 	const mstudioseqdesc_t* const pseqdesc = m_pModel->GetStudioHeader()->GetSequence( m_iSequence );
@@ -532,35 +586,5 @@ CStudioModelEntity::MeshList_t CStudioModelEntity::ComputeMeshList( const int iT
 
 	assert( pStudioModel );
 
-	MeshList_t meshes;
-
-	const auto pStudioHdr = pStudioModel->GetStudioHeader();
-
-	const short* const pskinref = pStudioModel->GetTextureHeader()->GetSkins();
-
-	int iBodygroup = 0;
-
-	for( int iBodyPart = 0; iBodyPart < pStudioHdr->numbodyparts; ++iBodyPart )
-	{
-		mstudiobodyparts_t *pbodypart = pStudioHdr->GetBodypart( iBodyPart );
-
-		for( int iModel = 0; iModel < pbodypart->nummodels; ++iModel )
-		{
-			pStudioModel->CalculateBodygroup( iBodyPart, iModel, iBodygroup );
-
-			mstudiomodel_t* pModel = pStudioModel->GetModelByBodyPart( iBodygroup, iBodyPart );
-
-			for( int iMesh = 0; iMesh < pModel->nummesh; ++iMesh )
-			{
-				const mstudiomesh_t* pMesh = ( ( const mstudiomesh_t* ) ( ( const byte* ) pStudioModel->GetStudioHeader() + pModel->meshindex ) ) + iMesh;
-
-				if( pskinref[ pMesh->skinref ] == iTexture )
-				{
-					meshes.push_back( pMesh );
-				}
-			}
-		}
-	}
-
-	return meshes;
+	return pStudioModel->GetTextureMeshes( iTexture );
 }
\ No newline at end of file
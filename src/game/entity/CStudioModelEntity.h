@@ -1,15 +1,24 @@
 #ifndef GAME_CSTUDIOMODELENTITY_H
 #define GAME_CSTUDIOMODELENTITY_H
 
+#include <cstddef>
 #include <vector>
 
 #include "shared/studiomodel/CStudioModel.h"
+#include "shared/studiomodel/StudioModelCache.h"
+
+#include "shared/renderer/studiomodel/CStudioModelPoseCache.h"
 
 #include "game/CAnimEvent.h"
 #include "game/Events.h"
 
 #include "CBaseAnimating.h"
 
+namespace studiomdl
+{
+struct CModelRenderInfo;
+}
+
 /**
 *	Studio model entity.
 */
@@ -19,7 +28,7 @@ public:
 	DECLARE_CLASS( CStudioModelEntity, CBaseAnimating );
 
 public:
-	typedef std::vector<const mstudiomesh_t*> MeshList_t;
+	typedef studiomdl::CStudioModel::MeshListView_t MeshList_t;
 
 public:
 	virtual void OnDestroy() override;
@@ -28,6 +37,20 @@ public:
 
 	virtual void Draw( renderer::DrawFlags_t flags ) override;
 
+	/**
+	*	Draws many studio model entities at once. Entities that share a model, skin and body groups are drawn together.
+	*	@param ppEntities Entities to draw.
+	*	@param uiCount Number of entities.
+	*	@param flags Flags. Used for all entities.
+	*	@see studiomdl::IStudioModelRenderer::DrawModelInstances
+	*/
+	static void DrawInstances( CStudioModelEntity* const* ppEntities, const size_t uiCount, renderer::DrawFlags_t flags );
+
+	/**
+	*	Gets the render info used to draw this entity.
+	*/
+	void GetRenderInfo( studiomdl::CModelRenderInfo& renderInfo );
+
 	/**
 	*	Advances the frame. If dt is 0, advances to current time, otherwise, advances by the given amount of time.
 	*	TODO: clamp dt to positive?
@@ -39,10 +62,11 @@ public:
 
 	/**
 	*	Gets an animation event for the current sequence for the given time range.
+	*	Events are returned in frame order, events matched by wrapping around a looping sequence last.
 	*	@param event Output. Event data.
 	*	@param flStart Start of the range of frames to check.
 	*	@param flEnd End of the range of frames to check.
-	*	@param index Event index to start checking at.
+	*	@param index Number of matching events to skip. Start at 0.
 	*	@param bAllowClientEvents Whether to process client events or not.
 	*	@return Next event index to use as the index parameter. If 0, no more events are left.
 	*/
@@ -59,6 +83,15 @@ public:
 	*/
 	virtual void HandleAnimEvent( const CAnimEvent& event );
 
+private:
+	/**
+	*	Finds the events of the current sequence in the given range of frames using the model's event index.
+	*	@return Number of ranges that were written.
+	*/
+	int		FindAnimationEvents( float flStart, float flEnd, const bool bAllowClientEvents, studiomdl::EventRange_t ( &ranges )[ 2 ] ) const;
+
+	void	GetEventData( const studiomdl::EventIndexEntry_t& entry, CAnimEvent& event ) const;
+
 public:
 	/**
 	*	Sets the frame for this model.
@@ -68,6 +101,7 @@ public:
 	int SetFrame( const int iFrame );
 
 private:
+	studiomdl::StudioModelHandle_t m_ModelHandle;
 	studiomdl::CStudioModel* m_pModel = nullptr;
 
 	int		m_iSequence			= 0;				// sequence index
@@ -80,6 +114,8 @@ private:
 	float	m_flLastEventCheck	= 0;				//Last time we checked for animation events.
 	float	m_flAnimTime		= 0;				//Time when the frame was set.
 
+	studiomdl::CStudioModelPoseCache m_PoseCache;	//Renderer results from the last draw.
+
 public:
 	/**
 	*	Gets the model.
@@ -87,9 +123,24 @@ public:
 	studiomdl::CStudioModel* GetModel() const { return m_pModel; }
 
 	/**
-	*	Sets the model.
+	*	Gets the handle that keeps the model loaded.
+	*/
+	const studiomdl::StudioModelHandle_t& GetModelHandle() const { return m_ModelHandle; }
+
+	/**
+	*	Sets the model. The entity keeps the model loaded until it's destroyed or another model is set.
+	*/
+	void SetModel( const studiomdl::StudioModelHandle_t& model );
+
+	/**
+	*	Must be called after the model's data is changed in place, so results computed from the old data aren't reused.
+	*/
+	void ModelDataChanged();
+
+	/**
+	*	Calls ModelDataChanged on every studio model entity that uses the given model.
 	*/
-	void SetModel( studiomdl::CStudioModel* pModel );
+	static void ModelDataChanged( const studiomdl::CStudioModel* pModel );
 
 	/**
 	*	Gets the number of frames that the current sequence has.
@@ -213,7 +264,7 @@ public:
 	mstudiomodel_t* GetModelByBodyPart( const int iBodyPart ) const;
 
 	/**
-	*	Computes a list of meshes that use the given texture.
+	*	Gets the list of meshes that use the given texture. The list is owned by the model and built when it is loaded.
 	*/
 	MeshList_t ComputeMeshList( const int iTexture ) const;
 };
@@ -6,11 +6,13 @@
 
 #include "utility/Color.h"
 
+#include "shared/renderer/IRenderContext.h"
 #include "shared/renderer/studiomodel/IStudioModelRenderer.h"
 
 #include "GraphicsHelpers.h"
 
 //TODO: remove
+extern renderer::IRenderContext* g_pRenderContext;
 extern studiomdl::IStudioModelRenderer* g_pStudioMdlRenderer;
 
 namespace graphics
@@ -26,10 +28,10 @@ void SetupRenderMode( RenderMode renderMode, const bool bBackfaceCulling )
 	{
 	case RenderMode::WIREFRAME:
 		{
-			glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
-			glDisable( GL_TEXTURE_2D );
-			glDisable( GL_CULL_FACE );
-			glEnable( GL_DEPTH_TEST );
+			g_pRenderContext->SetPolygonMode( renderer::PolygonMode::LINE );
+			g_pRenderContext->SetTexture2DEnabled( false );
+			g_pRenderContext->SetCullFaceEnabled( false );
+			g_pRenderContext->SetDepthTestEnabled( true );
 
 			break;
 		}
@@ -37,19 +39,10 @@ void SetupRenderMode( RenderMode renderMode, const bool bBackfaceCulling )
 	case RenderMode::FLAT_SHADED:
 	case RenderMode::SMOOTH_SHADED:
 		{
-			glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
-			glDisable( GL_TEXTURE_2D );
-
-			if( bBackfaceCulling )
-			{
-				glEnable( GL_CULL_FACE );
-			}
-			else
-			{
-				glDisable( GL_CULL_FACE );
-			}
-
-			glEnable( GL_DEPTH_TEST );
+			g_pRenderContext->SetPolygonMode( renderer::PolygonMode::FILL );
+			g_pRenderContext->SetTexture2DEnabled( false );
+			g_pRenderContext->SetCullFaceEnabled( bBackfaceCulling );
+			g_pRenderContext->SetDepthTestEnabled( true );
 
 			if( renderMode == RenderMode::FLAT_SHADED )
 				glShadeModel( GL_FLAT );
@@ -61,19 +54,10 @@ void SetupRenderMode( RenderMode renderMode, const bool bBackfaceCulling )
 
 	case RenderMode::TEXTURE_SHADED:
 		{
-			glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
-			glEnable( GL_TEXTURE_2D );
-
-			if( bBackfaceCulling )
-			{
-				glEnable( GL_CULL_FACE );
-			}
-			else
-			{
-				glDisable( GL_CULL_FACE );
-			}
-
-			glEnable( GL_DEPTH_TEST );
+			g_pRenderContext->SetPolygonMode( renderer::PolygonMode::FILL );
+			g_pRenderContext->SetTexture2DEnabled( true );
+			g_pRenderContext->SetCullFaceEnabled( bBackfaceCulling );
+			g_pRenderContext->SetDepthTestEnabled( true );
 			glShadeModel( GL_SMOOTH );
 
 			break;
@@ -87,6 +71,49 @@ void SetupRenderMode( RenderMode renderMode, const bool bBackfaceCulling )
 	}
 }
 
+renderer::RenderState_t GetRenderModeState( RenderMode renderMode, const bool bBackfaceCulling )
+{
+	renderer::RenderState_t state;
+
+	state.bDepthTest = true;
+
+	switch( renderMode )
+	{
+	case RenderMode::WIREFRAME:
+		{
+			state.polygonMode = renderer::PolygonMode::LINE;
+			state.bTexture2D = false;
+			state.bCullFace = false;
+			break;
+		}
+
+	case RenderMode::FLAT_SHADED:
+	case RenderMode::SMOOTH_SHADED:
+		{
+			state.polygonMode = renderer::PolygonMode::FILL;
+			state.bTexture2D = false;
+			state.bCullFace = bBackfaceCulling;
+			break;
+		}
+
+	case RenderMode::TEXTURE_SHADED:
+		{
+			state.polygonMode = renderer::PolygonMode::FILL;
+			state.bTexture2D = true;
+			state.bCullFace = bBackfaceCulling;
+			break;
+		}
+
+	default:
+		{
+			Warning( "graphics::helpers::GetRenderModeState: Invalid render mode %d\n", static_cast<int>( renderMode ) );
+			break;
+		}
+	}
+
+	return state;
+}
+
 void DrawFloorQuad( float flSideLength )
 {
 	flSideLength = std::abs( flSideLength );
@@ -109,54 +136,52 @@ void DrawFloorQuad( float flSideLength )
 
 void DrawFloor( float flSideLength, GLuint groundTexture, const Color& groundColor, const bool bMirror )
 {
-	glCullFace( GL_FRONT );
+	g_pRenderContext->SetCullFace( renderer::CullFace::FRONT );
 
-	glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
-	glEnable( GL_DEPTH_TEST );
-	glEnable( GL_CULL_FACE );
+	g_pRenderContext->SetPolygonMode( renderer::PolygonMode::FILL );
+	g_pRenderContext->SetDepthTestEnabled( true );
+	g_pRenderContext->SetCullFaceEnabled( bMirror );
 
 	if( bMirror )
-		glFrontFace( GL_CW );
-	else
-		glDisable( GL_CULL_FACE );
+		g_pRenderContext->SetFrontFace( renderer::FrontFace::CW );
 
-	glEnable( GL_BLEND );
+	g_pRenderContext->SetBlendEnabled( true );
 	if( groundTexture == GL_INVALID_TEXTURE_ID )
 	{
-		glDisable( GL_TEXTURE_2D );
+		g_pRenderContext->SetTexture2DEnabled( false );
 		glColor4f( groundColor[ 0 ] / 255.0f, groundColor[ 1 ] / 255.0f, groundColor[ 2 ] / 255.0f, 0.7f );
-		glBindTexture( GL_TEXTURE_2D, 0 );
+		g_pRenderContext->BindTexture( NULL_TEXTURE_HANDLE );
 	}
 	else
 	{
-		glEnable( GL_TEXTURE_2D );
+		g_pRenderContext->SetTexture2DEnabled( true );
 		glColor4f( 1.0f, 1.0f, 1.0f, 0.6f );
-		glBindTexture( GL_TEXTURE_2D, groundTexture );
+		g_pRenderContext->BindTexture( reinterpret_cast<renderer::HTexture_t>( groundTexture ) );
 	}
 
-	glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	g_pRenderContext->SetBlendFunc( renderer::BlendFactor::SRC_ALPHA, renderer::BlendFactor::ONE_MINUS_SRC_ALPHA );
 
 	graphics::helpers::DrawFloorQuad( flSideLength );
 
-	glDisable( GL_BLEND );
+	g_pRenderContext->SetBlendEnabled( false );
 
 	if( bMirror )
 	{
-		glCullFace( GL_BACK );
+		g_pRenderContext->SetCullFace( renderer::CullFace::BACK );
 		glColor4f( 0.1f, 0.1f, 0.1f, 1.0f );
-		glBindTexture( GL_TEXTURE_2D, 0 );
+		g_pRenderContext->BindTexture( NULL_TEXTURE_HANDLE );
 		graphics::helpers::DrawFloorQuad( flSideLength );
 
-		glFrontFace( GL_CCW );
+		g_pRenderContext->SetFrontFace( renderer::FrontFace::CCW );
 	}
 	else
-		glEnable( GL_CULL_FACE );
+		g_pRenderContext->SetCullFaceEnabled( true );
 }
 
 unsigned int DrawMirroredModel( CStudioModelEntity* pEntity, const RenderMode renderMode, const bool bWireframeOverlay, const float flSideLength, const bool bBackfaceCulling )
 {
 	/* Don't update color or depth. */
-	glDisable( GL_DEPTH_TEST );
+	g_pRenderContext->SetDepthTestEnabled( false );
 	glColorMask( GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE );
 
 	/* Draw 1 into the stencil buffer. */
@@ -169,7 +194,7 @@ unsigned int DrawMirroredModel( CStudioModelEntity* pEntity, const RenderMode re
 
 	/* Re-enable update of color and depth. */
 	glColorMask( GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE );
-	glEnable( GL_DEPTH_TEST );
+	g_pRenderContext->SetDepthTestEnabled( true );
 
 	/* Now, only render where stencil is set to 1. */
 	glStencilFunc( GL_EQUAL, 1, 0xffffffff );  /* draw if ==1 */
@@ -179,7 +204,7 @@ unsigned int DrawMirroredModel( CStudioModelEntity* pEntity, const RenderMode re
 
 	glPushMatrix();
 	glScalef( 1, 1, -1 );
-	glCullFace( GL_BACK );
+	g_pRenderContext->SetCullFace( renderer::CullFace::BACK );
 	SetupRenderMode( renderMode, bBackfaceCulling );
 
 	glEnable( GL_CLIP_PLANE0 );
@@ -202,7 +227,7 @@ unsigned int DrawMirroredModel( CStudioModelEntity* pEntity, const RenderMode re
 	//Determine if an odd number of scale values are negative. The cull face has to be changed if so.
 	const float flScale = vecScale.x * vecScale.y * vecScale.z;
 
-	glCullFace( flScale > 0 ? GL_BACK : GL_FRONT );
+	g_pRenderContext->SetCullFace( flScale > 0 ? renderer::CullFace::BACK : renderer::CullFace::FRONT );
 
 	const unsigned int uiOldPolys = g_pStudioMdlRenderer->GetDrawnPolygonsCount();
 
@@ -8,6 +8,8 @@
 
 #include "graphics/OpenGL.h"
 
+#include "shared/renderer/CRenderCommandBuffer.h"
+
 class Color;
 
 namespace graphics
@@ -21,6 +23,13 @@ namespace helpers
 */
 void SetupRenderMode( RenderMode renderMode, const bool bBackfaceCulling );
 
+/**
+*	Gets the state to record models with for the specified render mode. Matches the state set by SetupRenderMode, except for the shade model.
+*	@param renderMode Render mode. Must be valid.
+*	@param bBackfaceCulling Whether backface culling should be enabled or not.
+*/
+renderer::RenderState_t GetRenderModeState( RenderMode renderMode, const bool bBackfaceCulling );
+
 /**
 *	Draws a floor quad.
 *	@param flSideLength Length of one side of the floor
@@ -5,6 +5,7 @@
 #include <algorithm>
 
 #include "shared/Logging.h"
+#include "shared/Stats.h"
 #include "shared/Utility.h"
 
 #include "lib/LibInterface.h"
@@ -155,6 +156,10 @@ void CSoundSystem::RunFrame()
 			m_SoundsLRU.erase( std::find( m_SoundsLRU.begin(), m_SoundsLRU.end(), uiIndex - 1 ) );
 		}
 	}
+
+	static auto& activeVoices = stats::Registry().GetGauge( "sound.active_voices" );
+
+	activeVoices.Set( static_cast<double>( m_SoundsLRU.size() ) );
 }
 
 void CSoundSystem::PlaySound( const char* pszFilename, float flVolume, int iPitch )
@@ -229,6 +234,10 @@ void CSoundSystem::PlaySound( const char* pszFilename, float flVolume, int iPitc
 	m_Sounds[ uiIndex ] = sound;
 
 	m_SoundsLRU.push_front( uiIndex );
+
+	static auto& soundsPlayed = stats::Registry().GetCounter( "sound.sounds_played" );
+
+	soundsPlayed.Add();
 }
 
 void CSoundSystem::StopAllSounds()
@@ -0,0 +1,199 @@
+#include <cstring>
+
+#include "GLPixelReadback.h"
+
+GLPixelReadback::~GLPixelReadback()
+{
+	Destroy();
+}
+
+bool GLPixelReadback::Setup( const GLsizei iWidth, const GLsizei iHeight, const size_t uiNumBuffers )
+{
+	if( iWidth <= 0 || iHeight <= 0 || uiNumBuffers == 0 )
+		return false;
+
+	if( IsSetup() && m_iWidth == iWidth && m_iHeight == iHeight && m_Buffers.size() == uiNumBuffers )
+	{
+		//Discard pending reads so the caller starts with a clean ring.
+		while( m_uiNumPending > 0 )
+		{
+			Buffer_t& buffer = m_Buffers[ m_uiFirstPending ];
+
+			if( buffer.fence )
+			{
+				glDeleteSync( buffer.fence );
+				buffer.fence = nullptr;
+			}
+
+			m_uiFirstPending = ( m_uiFirstPending + 1 ) % m_Buffers.size();
+			--m_uiNumPending;
+		}
+
+		m_uiFirstPending = 0;
+
+		return true;
+	}
+
+	Destroy();
+
+	m_iWidth = iWidth;
+	m_iHeight = iHeight;
+
+	m_bUsePBOs = SupportsPBOs();
+
+	m_Buffers.resize( uiNumBuffers );
+
+	const size_t uiImageSize = GetImageSize();
+
+	for( auto& buffer : m_Buffers )
+	{
+		if( m_bUsePBOs )
+		{
+			glGenBuffers( 1, &buffer.buffer );
+			glBindBuffer( GL_PIXEL_PACK_BUFFER, buffer.buffer );
+			glBufferData( GL_PIXEL_PACK_BUFFER, uiImageSize, nullptr, GL_STREAM_READ );
+		}
+		else
+		{
+			buffer.data.resize( uiImageSize );
+		}
+	}
+
+	if( m_bUsePBOs )
+		glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+	return true;
+}
+
+void GLPixelReadback::Destroy()
+{
+	for( auto& buffer : m_Buffers )
+	{
+		if( buffer.fence )
+		{
+			glDeleteSync( buffer.fence );
+			buffer.fence = nullptr;
+		}
+
+		if( buffer.buffer != 0 )
+		{
+			glDeleteBuffers( 1, &buffer.buffer );
+			buffer.buffer = 0;
+		}
+	}
+
+	m_Buffers.clear();
+
+	m_iWidth = m_iHeight = 0;
+
+	m_uiFirstPending = 0;
+	m_uiNumPending = 0;
+}
+
+bool GLPixelReadback::QueueRead()
+{
+	if( !IsSetup() || IsFull() )
+		return false;
+
+	Buffer_t& buffer = m_Buffers[ ( m_uiFirstPending + m_uiNumPending ) % m_Buffers.size() ];
+
+	GLint oldPackAlignment;
+
+	glGetIntegerv( GL_PACK_ALIGNMENT, &oldPackAlignment );
+
+	//Set pack alignment to 1 so no padding is added
+	glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+
+	if( m_bUsePBOs )
+	{
+		glBindBuffer( GL_PIXEL_PACK_BUFFER, buffer.buffer );
+
+		//With a pack buffer bound, the last parameter is an offset into the buffer and the call returns without waiting.
+		glReadPixels( 0, 0, m_iWidth, m_iHeight, GL_RGB, GL_UNSIGNED_BYTE, nullptr );
+
+		glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+		if( SupportsFences() )
+			buffer.fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+	}
+	else
+	{
+		glReadPixels( 0, 0, m_iWidth, m_iHeight, GL_RGB, GL_UNSIGNED_BYTE, buffer.data.data() );
+	}
+
+	glPixelStorei( GL_PACK_ALIGNMENT, oldPackAlignment );
+
+	++m_uiNumPending;
+
+	return true;
+}
+
+bool GLPixelReadback::IsOldestReady() const
+{
+	if( m_uiNumPending == 0 )
+		return false;
+
+	const Buffer_t& buffer = m_Buffers[ m_uiFirstPending ];
+
+	if( !m_bUsePBOs )
+		return true;
+
+	if( !buffer.fence )
+		return IsFull();
+
+	GLint iStatus = GL_UNSIGNALED;
+
+	glGetSynciv( buffer.fence, GL_SYNC_STATUS, 1, nullptr, &iStatus );
+
+	return iStatus == GL_SIGNALED;
+}
+
+bool GLPixelReadback::RetrieveOldest( void* pDest )
+{
+	if( m_uiNumPending == 0 || !pDest )
+		return false;
+
+	Buffer_t& buffer = m_Buffers[ m_uiFirstPending ];
+
+	m_uiFirstPending = ( m_uiFirstPending + 1 ) % m_Buffers.size();
+	--m_uiNumPending;
+
+	if( !m_bUsePBOs )
+	{
+		memcpy( pDest, buffer.data.data(), buffer.data.size() );
+		return true;
+	}
+
+	if( buffer.fence )
+	{
+		//Mapping would wait anyway, but this makes sure the commands are flushed first.
+		glClientWaitSync( buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED );
+		glDeleteSync( buffer.fence );
+		buffer.fence = nullptr;
+	}
+
+	glBindBuffer( GL_PIXEL_PACK_BUFFER, buffer.buffer );
+
+	const void* pData = glMapBuffer( GL_PIXEL_PACK_BUFFER, GL_READ_ONLY );
+
+	if( pData )
+	{
+		memcpy( pDest, pData, GetImageSize() );
+
+		glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+	}
+
+	glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+	return pData != nullptr;
+}
+
+bool GLPixelReadback::SupportsPBOs()
+{
+	return glGenBuffers && glMapBuffer && ( GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object );
+}
+
+bool GLPixelReadback::SupportsFences()
+{
+	return glFenceSync && ( GLEW_VERSION_3_2 || GLEW_ARB_sync );
+}
@@ -0,0 +1,112 @@
+#ifndef GRAPHICS_GLPIXELREADBACK_H
+#define GRAPHICS_GLPIXELREADBACK_H
+
+#include <cstddef>
+#include <vector>
+
+#include "OpenGL.h"
+
+/**
+*	Reads back 24 bit RGB pixel data from the current read framebuffer asynchronously.
+*	Reads are issued into a ring of pixel buffer objects, so the GPU can keep drawing while earlier reads are in flight.
+*	Only when the oldest read is retrieved will the CPU wait for it, if it hasn't completed by then.
+*	If pixel buffer objects are not supported, reads are performed synchronously into system memory.
+*	You must set the context to current yourself.
+*/
+class GLPixelReadback final
+{
+public:
+	static const size_t DEFAULT_NUM_BUFFERS = 3;
+
+	GLPixelReadback() = default;
+	~GLPixelReadback();
+
+	/**
+	*	Returns whether buffers have been set up.
+	*/
+	bool IsSetup() const { return !m_Buffers.empty(); }
+
+	GLsizei GetWidth() const { return m_iWidth; }
+
+	GLsizei GetHeight() const { return m_iHeight; }
+
+	/**
+	*	Gets the size, in bytes, of a single image.
+	*/
+	size_t GetImageSize() const { return static_cast<size_t>( m_iWidth ) * m_iHeight * 3; }
+
+	/**
+	*	Gets the number of reads that have been queued, but not yet retrieved.
+	*/
+	size_t GetPendingCount() const { return m_uiNumPending; }
+
+	/**
+	*	Returns whether all buffers have a pending read. The oldest read must be retrieved before another one can be queued.
+	*/
+	bool IsFull() const { return m_uiNumPending == m_Buffers.size(); }
+
+	/**
+	*	Sets up the buffers for reads of the given size. Any pending reads are discarded.
+	*	Does nothing if the buffers are already set up with these settings.
+	*	@param iWidth Width, in pixels.
+	*	@param iHeight Height, in pixels.
+	*	@param uiNumBuffers Number of reads that can be in flight at the same time.
+	*	@return true on success, false otherwise.
+	*/
+	bool Setup( const GLsizei iWidth, const GLsizei iHeight, const size_t uiNumBuffers = DEFAULT_NUM_BUFFERS );
+
+	/**
+	*	Destroys all buffers. Any pending reads are discarded.
+	*/
+	void Destroy();
+
+	/**
+	*	Starts reading the lower left corner of the current read buffer.
+	*	@return true on success, false if all buffers are pending.
+	*/
+	bool QueueRead();
+
+	/**
+	*	Returns whether the oldest pending read has completed. Never blocks.
+	*	If fence objects are not supported, this returns true once the ring is full.
+	*/
+	bool IsOldestReady() const;
+
+	/**
+	*	Copies the result of the oldest pending read into pDest, waiting for it to complete if needed.
+	*	@param pDest Destination. Must be at least GetImageSize() bytes large.
+	*	@return true on success, false if there are no pending reads or the buffer could not be mapped.
+	*/
+	bool RetrieveOldest( void* pDest );
+
+private:
+	struct Buffer_t
+	{
+		GLuint buffer = 0;
+		GLsync fence = nullptr;
+
+		//Used if pixel buffer objects are not supported.
+		std::vector<GLubyte> data;
+	};
+
+	static bool SupportsPBOs();
+
+	static bool SupportsFences();
+
+private:
+	std::vector<Buffer_t> m_Buffers;
+
+	GLsizei m_iWidth = 0;
+	GLsizei m_iHeight = 0;
+
+	bool m_bUsePBOs = false;
+
+	size_t m_uiFirstPending = 0;
+	size_t m_uiNumPending = 0;
+
+private:
+	GLPixelReadback( const GLPixelReadback& ) = delete;
+	GLPixelReadback& operator=( const GLPixelReadback& ) = delete;
+};
+
+#endif //GRAPHICS_GLPIXELREADBACK_H
@@ -2,12 +2,6 @@
 
 GLRenderTarget::GLRenderTarget( const bool bCreate )
 {
-	glGenFramebuffers( 1, &m_FrameBuffer );
-
-	glBindFramebuffer( GL_FRAMEBUFFER, m_FrameBuffer );
-
-	glGenTextures( 1, &m_Texture );
-
 	if( bCreate )
 		Create();
 }
@@ -47,6 +41,7 @@ void GLRenderTarget::Destroy()
 	if( m_Texture != GL_INVALID_TEXTURE_ID )
 	{
 		glDeleteTexture( m_Texture );
+		m_Texture = GL_INVALID_TEXTURE_ID;
 	}
 
 	if( m_FrameBuffer != 0 )
@@ -56,11 +51,14 @@ void GLRenderTarget::Destroy()
 	}
 }
 
-void GLRenderTarget::Setup( const GLsizei iWidth, const GLsizei iHeight, const bool bUseDepthBuffer )
+void GLRenderTarget::Setup( const GLsizei iWidth, const GLsizei iHeight, const bool bUseDepthBuffer, const bool bUseStencilBuffer )
 {
 	if( !Exists() || m_Texture == GL_INVALID_TEXTURE_ID )
 		return;
 
+	//Attachments are made to the currently bound framebuffer, so make sure it's ours.
+	glBindFramebuffer( GL_FRAMEBUFFER, m_FrameBuffer );
+
 	glBindTexture( GL_TEXTURE_2D, m_Texture );
 
 	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGB, iWidth, iHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr );
@@ -78,18 +76,19 @@ void GLRenderTarget::Setup( const GLsizei iWidth, const GLsizei iHeight, const b
 
 	glDrawBuffers( 1, &drawBuffer );
 
-	//TODO: depth buffer doesn't work properly at this time.
-	if( bUseDepthBuffer )
+	if( bUseDepthBuffer && m_DepthBuffer != 0 )
 	{
 		glBindRenderbuffer( GL_RENDERBUFFER, m_DepthBuffer );
-		glRenderbufferStorage( GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, iWidth, iHeight );
+		glRenderbufferStorage( GL_RENDERBUFFER, bUseStencilBuffer ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT24, iWidth, iHeight );
 
 		glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_DepthBuffer );
+		glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, bUseStencilBuffer ? m_DepthBuffer : 0 );
 		glBindRenderbuffer( GL_RENDERBUFFER, 0 );
 	}
 	else
 	{
 		glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, 0 );
+		glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, 0 );
 	}
 }
 
@@ -50,8 +50,9 @@ public:
 	*	@param iWidth Width, in pixels.
 	*	@param iHeight Height, in pixels.
 	*	@param bUseDepthBuffer Whether to use a depth buffer or not.
+	*	@param bUseStencilBuffer Whether to add a stencil buffer to the depth buffer. Only used if bUseDepthBuffer is true.
 	*/
-	void Setup( const GLsizei iWidth, const GLsizei iHeight, const bool bUseDepthBuffer );
+	void Setup( const GLsizei iWidth, const GLsizei iHeight, const bool bUseDepthBuffer, const bool bUseStencilBuffer = false );
 
 	/**
 	*	Binds the render target.
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "PNGFile.h"
+
+namespace graphics
+{
+namespace pngfile
+{
+namespace
+{
+//Largest amount of data that fits in a single stored deflate block.
+const size_t MAX_STORED_BLOCK_SIZE = 65535;
+
+struct CRCTable_t
+{
+	uint32_t values[ 256 ];
+};
+
+/**
+*	Gets the CRC table. It is built the first time this is called; initialization of function local statics is thread safe.
+*/
+const CRCTable_t& GetCRCTable()
+{
+	static const CRCTable_t table = []()
+	{
+		CRCTable_t table;
+
+		for( uint32_t uiIndex = 0; uiIndex < 256; ++uiIndex )
+		{
+			uint32_t uiValue = uiIndex;
+
+			for( int iBit = 0; iBit < 8; ++iBit )
+			{
+				uiValue = ( uiValue & 1 ) ? 0xEDB88320U ^ ( uiValue >> 1 ) : ( uiValue >> 1 );
+			}
+
+			table.values[ uiIndex ] = uiValue;
+		}
+
+		return table;
+	}();
+
+	return table;
+}
+
+uint32_t UpdateCRC( uint32_t uiCRC, const uint8_t* pData, const size_t uiSize )
+{
+	const CRCTable_t& table = GetCRCTable();
+
+	for( size_t uiIndex = 0; uiIndex < uiSize; ++uiIndex )
+	{
+		uiCRC = table.values[ ( uiCRC ^ pData[ uiIndex ] ) & 0xFF ] ^ ( uiCRC >> 8 );
+	}
+
+	return uiCRC;
+}
+
+void AppendUInt32BE( std::vector<uint8_t>& data, const uint32_t uiValue )
+{
+	data.push_back( static_cast<uint8_t>( uiValue >> 24 ) );
+	data.push_back( static_cast<uint8_t>( uiValue >> 16 ) );
+	data.push_back( static_cast<uint8_t>( uiValue >> 8 ) );
+	data.push_back( static_cast<uint8_t>( uiValue ) );
+}
+
+bool WriteChunk( FILE* pFile, const char* const pszType, const std::vector<uint8_t>& data )
+{
+	std::vector<uint8_t> chunk;
+
+	chunk.reserve( data.size() + 12 );
+
+	AppendUInt32BE( chunk, static_cast<uint32_t>( data.size() ) );
+
+	chunk.insert( chunk.end(), pszType, pszType + 4 );
+	chunk.insert( chunk.end(), data.begin(), data.end() );
+
+	//The CRC covers the type and data, not the length.
+	const uint32_t uiCRC = UpdateCRC( 0xFFFFFFFFU, chunk.data() + 4, chunk.size() - 4 ) ^ 0xFFFFFFFFU;
+
+	AppendUInt32BE( chunk, uiCRC );
+
+	return fwrite( chunk.data(), 1, chunk.size(), pFile ) == chunk.size();
+}
+}
+
+bool SaveRGBPNGFile( const char* const pszFilename, const int iWidth, const int iHeight, const uint8_t* pPixels, const bool bBottomUp )
+{
+	if( !pszFilename || !( *pszFilename ) )
+		return false;
+
+	if( iWidth <= 0 || iHeight <= 0 || !pPixels )
+		return false;
+
+	//Each row is prefixed with a filter type byte. No filtering is used.
+	const size_t uiRowSize = static_cast<size_t>( iWidth ) * 3;
+
+	std::vector<uint8_t> rawData;
+
+	rawData.reserve( ( uiRowSize + 1 ) * iHeight );
+
+	for( int iRow = 0; iRow < iHeight; ++iRow )
+	{
+		const int iSourceRow = bBottomUp ? iHeight - 1 - iRow : iRow;
+
+		const uint8_t* pRow = pPixels + uiRowSize * iSourceRow;
+
+		rawData.push_back( 0 );
+		rawData.insert( rawData.end(), pRow, pRow + uiRowSize );
+	}
+
+	//zlib stream made of stored deflate blocks.
+	std::vector<uint8_t> imageData;
+
+	imageData.reserve( rawData.size() + ( rawData.size() / MAX_STORED_BLOCK_SIZE + 1 ) * 5 + 6 );
+
+	//CMF, FLG: deflate with a 32K window, no preset dictionary, check bits valid.
+	imageData.push_back( 0x78 );
+	imageData.push_back( 0x01 );
+
+	size_t uiOffset = 0;
+
+	do
+	{
+		const size_t uiBlockSize = std::min( rawData.size() - uiOffset, MAX_STORED_BLOCK_SIZE );
+
+		const bool bFinal = uiOffset + uiBlockSize == rawData.size();
+
+		imageData.push_back( bFinal ? 1 : 0 );
+		imageData.push_back( static_cast<uint8_t>( uiBlockSize & 0xFF ) );
+		imageData.push_back( static_cast<uint8_t>( uiBlockSize >> 8 ) );
+		imageData.push_back( static_cast<uint8_t>( ~uiBlockSize & 0xFF ) );
+		imageData.push_back( static_cast<uint8_t>( ( ~uiBlockSize >> 8 ) & 0xFF ) );
+
+		imageData.insert( imageData.end(), rawData.begin() + uiOffset, rawData.begin() + uiOffset + uiBlockSize );
+
+		uiOffset += uiBlockSize;
+	}
+	while( uiOffset < rawData.size() );
+
+	//Adler-32 of the uncompressed data.
+	uint32_t uiA = 1, uiB = 0;
+
+	for( const auto value : rawData )
+	{
+		uiA = ( uiA + value ) % 65521;
+		uiB = ( uiB + uiA ) % 65521;
+	}
+
+	AppendUInt32BE( imageData, ( uiB << 16 ) | uiA );
+
+	std::vector<uint8_t> header;
+
+	AppendUInt32BE( header, static_cast<uint32_t>( iWidth ) );
+	AppendUInt32BE( header, static_cast<uint32_t>( iHeight ) );
+
+	header.push_back( 8 );	//Bit depth.
+	header.push_back( 2 );	//Color type: RGB.
+	header.push_back( 0 );	//Compression method.
+	header.push_back( 0 );	//Filter method.
+	header.push_back( 0 );	//No interlacing.
+
+	FILE* pFile = fopen( pszFilename, "wb" );
+
+	if( !pFile )
+		return false;
+
+	static const uint8_t SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	bool bSuccess = fwrite( SIGNATURE, sizeof( SIGNATURE ), 1, pFile ) == 1;
+
+	bSuccess = bSuccess && WriteChunk( pFile, "IHDR", header );
+	bSuccess = bSuccess && WriteChunk( pFile, "IDAT", imageData );
+	bSuccess = bSuccess && WriteChunk( pFile, "IEND", {} );
+
+	fclose( pFile );
+
+	return bSuccess;
+}
+}
+}
@@ -0,0 +1,24 @@
+#ifndef GRAPHICS_PNGFILE_H
+#define GRAPHICS_PNGFILE_H
+
+#include <cstdint>
+
+namespace graphics
+{
+namespace pngfile
+{
+/**
+*	Saves a 24 bit RGB PNG file.
+*	Image data is stored without compression, so no external compression library is needed. Intended for tools that can't use an image library.
+*	@param pszFilename Filename to save to.
+*	@param iWidth Width of the image.
+*	@param iHeight Height of the image.
+*	@param pPixels Array of pixels. Must be iWidth * iHeight * 3 bytes in size.
+*	@param bBottomUp Whether the first row in pPixels is the bottom row, as returned by glReadPixels.
+*	@return true on success, false otherwise.
+*/
+bool SaveRGBPNGFile( const char* const pszFilename, const int iWidth, const int iHeight, const uint8_t* pPixels, const bool bBottomUp );
+}
+}
+
+#endif //GRAPHICS_PNGFILE_H
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cerrno>
+#include <experimental/filesystem>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "CFileWatcher.h"
+
+namespace fs = std::experimental::filesystem;
+
+CFileWatcher::CFileWatcher()
+{
+#ifdef __linux__
+	m_iNotifyFD = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+#endif
+}
+
+CFileWatcher::~CFileWatcher()
+{
+	Clear();
+
+#ifdef __linux__
+	if( m_iNotifyFD != -1 )
+		close( m_iNotifyFD );
+#endif
+}
+
+bool CFileWatcher::Watch( const std::string& szFilename )
+{
+	if( m_Files.find( szFilename ) != m_Files.end() )
+		return true;
+
+	File_t file;
+
+#ifdef __linux__
+	if( IsUsingNotifications() )
+	{
+		const std::string szDirectory = fs::path( szFilename ).parent_path().string();
+
+		//Watching a directory that is already watched returns the same descriptor.
+		file.iWatch = inotify_add_watch( m_iNotifyFD, szDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO );
+
+		if( file.iWatch == -1 )
+			return false;
+
+		auto& directory = m_Directories[ file.iWatch ];
+
+		directory.szPath = szDirectory;
+		++directory.uiNumFiles;
+	}
+#endif
+
+	if( !IsUsingNotifications() )
+	{
+		UpdateFileState( szFilename, file );
+	}
+
+	m_Files.emplace( szFilename, file );
+
+	return true;
+}
+
+void CFileWatcher::Unwatch( const std::string& szFilename )
+{
+	auto it = m_Files.find( szFilename );
+
+	if( it == m_Files.end() )
+		return;
+
+	RemoveDirectoryWatch( it->second.iWatch );
+
+	m_Files.erase( it );
+}
+
+void CFileWatcher::Clear()
+{
+	for( const auto& file : m_Files )
+	{
+		RemoveDirectoryWatch( file.second.iWatch );
+	}
+
+	m_Files.clear();
+}
+
+bool CFileWatcher::Poll( std::vector<std::string>& changedFiles )
+{
+	changedFiles.clear();
+
+	if( m_Files.empty() )
+		return false;
+
+#ifdef __linux__
+	if( IsUsingNotifications() )
+	{
+		alignas( inotify_event ) char buffer[ 4096 ];
+
+		for( ;; )
+		{
+			const ssize_t iRead = read( m_iNotifyFD, buffer, sizeof( buffer ) );
+
+			//EAGAIN means there are no more events.
+			if( iRead <= 0 )
+				break;
+
+			for( ssize_t iOffset = 0; iOffset < iRead; )
+			{
+				const inotify_event* const pEvent = reinterpret_cast<const inotify_event*>( buffer + iOffset );
+
+				iOffset += sizeof( inotify_event ) + pEvent->len;
+
+				if( pEvent->len == 0 )
+					continue;
+
+				auto directory = m_Directories.find( pEvent->wd );
+
+				if( directory == m_Directories.end() )
+					continue;
+
+				std::string szFilename = directory->second.szPath + '/' + pEvent->name;
+
+				if( m_Files.find( szFilename ) != m_Files.end() &&
+					std::find( changedFiles.begin(), changedFiles.end(), szFilename ) == changedFiles.end() )
+				{
+					changedFiles.emplace_back( std::move( szFilename ) );
+				}
+			}
+		}
+
+		return !changedFiles.empty();
+	}
+#endif
+
+	for( auto& file : m_Files )
+	{
+		if( UpdateFileState( file.first, file.second ) )
+			changedFiles.emplace_back( file.first );
+	}
+
+	return !changedFiles.empty();
+}
+
+bool CFileWatcher::UpdateFileState( const std::string& szFilename, File_t& file )
+{
+	std::error_code error;
+
+	const bool bExists = fs::exists( szFilename, error );
+
+	int64_t iModificationTime = 0;
+	uint64_t uiSize = 0;
+
+	if( bExists )
+	{
+		iModificationTime = fs::last_write_time( szFilename, error ).time_since_epoch().count();
+		uiSize = fs::file_size( szFilename, error );
+	}
+
+	//Deleting a file doesn't count as a change; writing it again does.
+	const bool bChanged = bExists && ( !file.bExists || iModificationTime != file.iModificationTime || uiSize != file.uiSize );
+
+	file.bExists = bExists;
+	file.iModificationTime = iModificationTime;
+	file.uiSize = uiSize;
+
+	return bChanged;
+}
+
+void CFileWatcher::RemoveDirectoryWatch( const int iWatch )
+{
+#ifdef __linux__
+	auto it = m_Directories.find( iWatch );
+
+	if( it == m_Directories.end() )
+		return;
+
+	if( --it->second.uiNumFiles == 0 )
+	{
+		inotify_rm_watch( m_iNotifyFD, iWatch );
+		m_Directories.erase( it );
+	}
+#endif
+}
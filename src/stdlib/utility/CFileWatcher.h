@@ -0,0 +1,94 @@
+#ifndef UTILITY_CFILEWATCHER_H
+#define UTILITY_CFILEWATCHER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+*	Watches files for changes.
+*	On Linux, inotify is used to watch the directories that contain the files, so files that are replaced by renaming another file over them
+*	are also detected. Elsewhere, or if inotify is unavailable, the modification time and size of each file is checked when polling.
+*	Not thread safe.
+*/
+class CFileWatcher final
+{
+public:
+	CFileWatcher();
+	~CFileWatcher();
+
+	/**
+	*	Whether change notifications are used. If not, polling checks every watched file.
+	*/
+	bool IsUsingNotifications() const { return m_iNotifyFD != -1; }
+
+	/**
+	*	Starts watching a file. The file doesn't have to exist yet.
+	*	@param szFilename Absolute name of the file. Changes are reported using this name.
+	*	@return true if the file is being watched, false otherwise.
+	*/
+	bool Watch( const std::string& szFilename );
+
+	/**
+	*	Stops watching a file.
+	*/
+	void Unwatch( const std::string& szFilename );
+
+	/**
+	*	Stops watching all files.
+	*/
+	void Clear();
+
+	/**
+	*	Gets the files that changed since the last poll. Does not block.
+	*	Each file is reported once, no matter how many times it was written to.
+	*	@param changedFiles Receives the names of the files that changed. Cleared first.
+	*	@return Whether any files changed.
+	*/
+	bool Poll( std::vector<std::string>& changedFiles );
+
+private:
+	struct File_t
+	{
+		/**
+		*	Watch descriptor of the file's directory, if notifications are used.
+		*/
+		int iWatch = -1;
+
+		/**
+		*	State of the file when it was last checked. Only used when notifications aren't used.
+		*/
+		bool bExists = false;
+		int64_t iModificationTime = 0;
+		uint64_t uiSize = 0;
+	};
+
+	struct Directory_t
+	{
+		std::string szPath;
+
+		size_t uiNumFiles = 0;
+	};
+
+	/**
+	*	Checks a file's state on disk.
+	*	@return Whether the file changed since it was last checked.
+	*/
+	static bool UpdateFileState( const std::string& szFilename, File_t& file );
+
+	void RemoveDirectoryWatch( const int iWatch );
+
+private:
+	int m_iNotifyFD = -1;
+
+	std::unordered_map<std::string, File_t> m_Files;
+
+	std::unordered_map<int, Directory_t> m_Directories;
+
+private:
+	CFileWatcher( const CFileWatcher& ) = delete;
+	CFileWatcher& operator=( const CFileWatcher& ) = delete;
+};
+
+#endif //UTILITY_CFILEWATCHER_H
@@ -0,0 +1,60 @@
+#include <cinttypes>
+#include <cstdio>
+
+#include "Hash.h"
+
+namespace
+{
+const uint64_t FNV1A_64_PRIME = 1099511628211ULL;
+}
+
+uint64_t HashFNV1a64( const void* const pData, const size_t uiSize, uint64_t uiHash )
+{
+	const uint8_t* pBytes = reinterpret_cast<const uint8_t*>( pData );
+
+	for( size_t uiIndex = 0; uiIndex < uiSize; ++uiIndex )
+	{
+		uiHash ^= pBytes[ uiIndex ];
+		uiHash *= FNV1A_64_PRIME;
+	}
+
+	return uiHash;
+}
+
+bool HashFileContents( const char* const pszFilename, uint64_t& uiHash )
+{
+	if( !pszFilename || !( *pszFilename ) )
+		return false;
+
+	FILE* pFile = fopen( pszFilename, "rb" );
+
+	if( !pFile )
+		return false;
+
+	if( uiHash == 0 )
+		uiHash = FNV1A_64_OFFSET_BASIS;
+
+	uint8_t buffer[ 16384 ];
+
+	size_t uiRead;
+
+	while( ( uiRead = fread( buffer, 1, sizeof( buffer ), pFile ) ) > 0 )
+	{
+		uiHash = HashFNV1a64( buffer, uiRead, uiHash );
+	}
+
+	const bool bSuccess = ferror( pFile ) == 0;
+
+	fclose( pFile );
+
+	return bSuccess;
+}
+
+std::string HashToString( const uint64_t uiHash )
+{
+	char szBuffer[ 17 ];
+
+	snprintf( szBuffer, sizeof( szBuffer ), "%016" PRIx64, uiHash );
+
+	return szBuffer;
+}
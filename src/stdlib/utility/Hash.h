@@ -0,0 +1,34 @@
+#ifndef UTILITY_HASH_H
+#define UTILITY_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+*	Initial value for 64 bit FNV-1a hashes.
+*/
+const uint64_t FNV1A_64_OFFSET_BASIS = 14695981039346656037ULL;
+
+/**
+*	Computes a 64 bit FNV-1a hash of the given data.
+*	@param pData Data to hash.
+*	@param uiSize Size of the data, in bytes.
+*	@param uiHash Hash to continue from. Pass the result of a previous call to hash data in pieces.
+*/
+uint64_t HashFNV1a64( const void* const pData, const size_t uiSize, uint64_t uiHash = FNV1A_64_OFFSET_BASIS );
+
+/**
+*	Hashes the contents of a file.
+*	@param pszFilename Name of the file to hash.
+*	@param uiHash Receives the hash. If uiHash is non-zero on input, hashing continues from that value.
+*	@return true on success, false if the file could not be read.
+*/
+bool HashFileContents( const char* const pszFilename, uint64_t& uiHash );
+
+/**
+*	Formats a hash as a 16 character hexadecimal string.
+*/
+std::string HashToString( const uint64_t uiHash );
+
+#endif //UTILITY_HASH_H
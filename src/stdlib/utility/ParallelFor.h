@@ -0,0 +1,63 @@
+#ifndef UTILITY_PARALLELFOR_H
+#define UTILITY_PARALLELFOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+*	Calls func( uiIndex ) for every index in [ 0, uiCount ), spread over a number of threads.
+*	The calling thread does part of the work. Indices are handed out one at a time, so items that take longer don't hold up the others.
+*	Returns once all items have been processed.
+*	@param uiCount Number of items.
+*	@param func Function to call. Must be safe to call concurrently for different indices.
+*	@param uiMaxThreads Maximum number of threads to use, including the calling thread. 0 uses one thread per core.
+*/
+template<typename FUNC>
+void ParallelFor( const size_t uiCount, FUNC func, unsigned int uiMaxThreads = 0 )
+{
+	if( uiMaxThreads == 0 )
+		uiMaxThreads = std::max( 1u, std::thread::hardware_concurrency() );
+
+	const size_t uiNumThreads = std::min( static_cast<size_t>( uiMaxThreads ), uiCount );
+
+	if( uiNumThreads <= 1 )
+	{
+		for( size_t uiIndex = 0; uiIndex < uiCount; ++uiIndex )
+		{
+			func( uiIndex );
+		}
+
+		return;
+	}
+
+	std::atomic<size_t> uiNext{ 0 };
+
+	auto worker = [ & ]()
+	{
+		for( size_t uiIndex; ( uiIndex = uiNext++ ) < uiCount; )
+		{
+			func( uiIndex );
+		}
+	};
+
+	std::vector<std::thread> threads;
+
+	threads.reserve( uiNumThreads - 1 );
+
+	for( size_t uiThread = 1; uiThread < uiNumThreads; ++uiThread )
+	{
+		threads.emplace_back( worker );
+	}
+
+	worker();
+
+	for( auto& thread : threads )
+	{
+		thread.join();
+	}
+}
+
+#endif //UTILITY_PARALLELFOR_H
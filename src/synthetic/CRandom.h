@@ -0,0 +1,49 @@
+#ifndef SYNTHETIC_CRANDOM_H
+#define SYNTHETIC_CRANDOM_H
+
+#include <cstdint>
+#include <random>
+
+namespace synthetic
+{
+/**
+*	Random number generator that produces the same sequence for a given seed on every platform.
+*	The standard distributions are implementation defined, so they are not used.
+*/
+class CRandom final
+{
+public:
+	explicit CRandom( const uint32_t uiSeed )
+		: m_Engine( uiSeed )
+	{
+	}
+
+	uint32_t Next() { return static_cast<uint32_t>( m_Engine() ); }
+
+	/**
+	*	@return Integer in the range [iMin, iMax].
+	*/
+	int Int( const int iMin, const int iMax )
+	{
+		return iMin + static_cast<int>( Next() % static_cast<uint32_t>( iMax - iMin + 1 ) );
+	}
+
+	/**
+	*	@return Float in the range [flMin, flMax).
+	*/
+	float Float( const float flMin, const float flMax )
+	{
+		//24 bits fit in a float mantissa exactly.
+		return flMin + ( flMax - flMin ) * ( ( Next() >> 8 ) / 16777216.0f );
+	}
+
+private:
+	std::mt19937 m_Engine;
+
+private:
+	CRandom( const CRandom& ) = delete;
+	CRandom& operator=( const CRandom& ) = delete;
+};
+}
+
+#endif //SYNTHETIC_CRANDOM_H
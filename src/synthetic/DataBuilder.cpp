@@ -0,0 +1,28 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "DataBuilder.h"
+
+namespace synthetic
+{
+bool SaveFile( const std::string& szFilename, const std::vector<byte>& data, std::string& szError )
+{
+	FILE* pFile = fopen( szFilename.c_str(), "wb" );
+
+	if( !pFile )
+	{
+		szError = "Couldn't open \"" + szFilename + "\" for writing: " + strerror( errno );
+		return false;
+	}
+
+	const bool bSuccess = data.empty() || fwrite( data.data(), data.size(), 1, pFile ) == 1;
+
+	fclose( pFile );
+
+	if( !bSuccess )
+		szError = "Couldn't write \"" + szFilename + "\"";
+
+	return bSuccess;
+}
+}
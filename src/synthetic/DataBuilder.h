@@ -0,0 +1,68 @@
+#ifndef SYNTHETIC_DATABUILDER_H
+#define SYNTHETIC_DATABUILDER_H
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "shared/Const.h"
+
+/**
+*	@file
+*
+*	Helpers to build binary files in memory. Files are built in a byte vector, so pointers into it are invalidated by every append.
+*	Objects are therefore always accessed through their offset.
+*/
+
+namespace synthetic
+{
+/**
+*	Appends zero initialized storage for iCount objects of type T.
+*	@return Offset of the first object.
+*/
+template<typename T>
+int Append( std::vector<byte>& data, const int iCount = 1 )
+{
+	const int iOffset = static_cast<int>( data.size() );
+
+	data.resize( data.size() + sizeof( T ) * iCount, 0 );
+
+	return iOffset;
+}
+
+/**
+*	Pads the data with zeroes to a multiple of uiAlignment bytes.
+*/
+inline void Align( std::vector<byte>& data, const size_t uiAlignment = 4 )
+{
+	data.resize( ( data.size() + uiAlignment - 1 ) & ~( uiAlignment - 1 ), 0 );
+}
+
+/**
+*	Appends a copy of value. Use this for formats that don't keep their structures aligned.
+*	@return Offset of the object.
+*/
+template<typename T>
+int Write( std::vector<byte>& data, const T& value )
+{
+	const int iOffset = Append<T>( data );
+
+	memcpy( data.data() + iOffset, &value, sizeof( T ) );
+
+	return iOffset;
+}
+
+template<typename T>
+T* At( std::vector<byte>& data, const int iOffset )
+{
+	return reinterpret_cast<T*>( data.data() + iOffset );
+}
+
+/**
+*	Writes data to a file.
+*	@return Whether the file was written. If not, szError contains the reason.
+*/
+bool SaveFile( const std::string& szFilename, const std::vector<byte>& data, std::string& szError );
+}
+
+#endif //SYNTHETIC_DATABUILDER_H
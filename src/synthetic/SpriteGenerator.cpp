@@ -0,0 +1,122 @@
+#include <cmath>
+
+#include "graphics/Palette.h"
+
+#include "CRandom.h"
+#include "DataBuilder.h"
+
+#include "SpriteGenerator.h"
+
+namespace synthetic
+{
+namespace
+{
+void AppendFrame( CRandom& random, const SpriteSettings_t& settings, std::vector<byte>& data )
+{
+	sprite::dspriteframe_t frame;
+
+	frame.origin = glm::ivec2( -settings.iWidth / 2, settings.iHeight / 2 );
+	frame.width = settings.iWidth;
+	frame.height = settings.iHeight;
+
+	Write( data, frame );
+
+	const int iNumPixels = settings.iWidth * settings.iHeight;
+
+	const int iPixels = Append<byte>( data, iNumPixels );
+
+	auto pPixels = At<byte>( data, iPixels );
+
+	for( int iPixel = 0; iPixel < iNumPixels; ++iPixel )
+	{
+		pPixels[ iPixel ] = static_cast<byte>( random.Next() );
+	}
+}
+}
+
+bool GenerateSprite( CRandom& random, const SpriteSettings_t& settings, std::vector<byte>& data, std::string& szError )
+{
+	if( settings.iWidth < 1 || settings.iWidth > sprite::MAX_SPRITE_TEXTURE_DIMS ||
+		settings.iHeight < 1 || settings.iHeight > sprite::MAX_SPRITE_TEXTURE_DIMS )
+	{
+		szError = "Sprite dimensions must be in the range [1, " + std::to_string( sprite::MAX_SPRITE_TEXTURE_DIMS ) + "]";
+		return false;
+	}
+
+	if( settings.iNumFrames < 1 )
+	{
+		szError = "Sprites must have at least one frame";
+		return false;
+	}
+
+	if( settings.iNumGroupFrames < 0 )
+	{
+		szError = "Group frame count can't be negative";
+		return false;
+	}
+
+	data.clear();
+
+	//Frames are not padded, so everything after the first frame can be unaligned.
+
+	const int iHeader = Append<sprite::dsprite_t>( data );
+
+	auto& header = *At<sprite::dsprite_t>( data, iHeader );
+
+	header.ident = SPRITE_ID;
+	header.version = SPRITE_VERSION;
+	header.type = settings.type;
+	header.texFormat = settings.texFormat;
+	header.boundingradius = sqrt( static_cast<float>( settings.iWidth * settings.iWidth + settings.iHeight * settings.iHeight ) ) / 2;
+	header.width = settings.iWidth;
+	header.height = settings.iHeight;
+	header.numframes = settings.iNumFrames;
+	header.beamlength = 0;
+	header.synctype = sprite::synctype_t::SYNC;
+
+	*At<short>( data, Append<short>( data ) ) = PALETTE_ENTRIES;
+
+	const int iPalette = Append<byte>( data, PALETTE_SIZE );
+
+	for( size_t uiIndex = 0; uiIndex < PALETTE_SIZE; ++uiIndex )
+	{
+		At<byte>( data, iPalette )[ uiIndex ] = static_cast<byte>( random.Next() );
+	}
+
+	for( int iFrame = 0; iFrame < settings.iNumFrames; ++iFrame )
+	{
+		const auto type = settings.iNumGroupFrames > 0 ? sprite::spriteframetype_t::GROUP : sprite::spriteframetype_t::SINGLE;
+
+		Write( data, type );
+
+		if( type == sprite::spriteframetype_t::SINGLE )
+		{
+			AppendFrame( random, settings, data );
+			continue;
+		}
+
+		sprite::dspritegroup_t group;
+
+		group.numframes = settings.iNumGroupFrames;
+
+		Write( data, group );
+
+		for( int iGroupFrame = 0; iGroupFrame < settings.iNumGroupFrames; ++iGroupFrame )
+		{
+			//Intervals are the time at which each frame ends.
+			sprite::dspriteinterval_t interval;
+
+			interval.interval = 0.1f * ( iGroupFrame + 1 );
+
+			Write( data, interval );
+		}
+
+		for( int iGroupFrame = 0; iGroupFrame < settings.iNumGroupFrames; ++iGroupFrame )
+		{
+			AppendFrame( random, settings, data );
+		}
+	}
+
+	return true;
+}
+}
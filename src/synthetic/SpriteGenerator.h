@@ -0,0 +1,53 @@
+#ifndef SYNTHETIC_SPRITEGENERATOR_H
+#define SYNTHETIC_SPRITEGENERATOR_H
+
+#include <string>
+#include <vector>
+
+#include "shared/Const.h"
+
+#include "shared/sprite/sprite.h"
+
+/**
+*	@addtogroup Synthetic
+*
+*	@{
+*/
+
+namespace synthetic
+{
+class CRandom;
+
+/**
+*	Dimensions of a generated sprite.
+*/
+struct SpriteSettings_t
+{
+	int iWidth = 64;
+	int iHeight = 64;
+
+	int iNumFrames = 8;
+
+	/**
+	*	If not 0, every frame is a group containing this many frames.
+	*/
+	int iNumGroupFrames = 0;
+
+	sprite::Type::Type type = sprite::Type::VP_PARALLEL;
+	sprite::TexFormat::TexFormat texFormat = sprite::TexFormat::SPR_NORMAL;
+};
+
+/**
+*	Generates a sprite.
+*	@param random Random number generator used for all values.
+*	@param settings Dimensions of the sprite.
+*	@param data Receives the file contents.
+*	@param szError If the sprite could not be generated, contains the reason.
+*	@return Whether the sprite was generated.
+*/
+bool GenerateSprite( CRandom& random, const SpriteSettings_t& settings, std::vector<byte>& data, std::string& szError );
+}
+
+/** @} */
+
+#endif //SYNTHETIC_SPRITEGENERATOR_H
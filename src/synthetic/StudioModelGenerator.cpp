@@ -0,0 +1,690 @@
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+#include <glm/geometric.hpp>
+
+#include "utility/mathlib.h"
+
+#include "graphics/Palette.h"
+
+#include "shared/studiomodel/studio.h"
+#include "shared/studiomodel/StudioModelValidation.h"
+
+#include "CRandom.h"
+#include "DataBuilder.h"
+
+#include "StudioModelGenerator.h"
+
+namespace synthetic
+{
+namespace
+{
+/**
+*	Longest run of frames covered by a single animation value span.
+*/
+const int MAX_FRAMES_PER_SPAN = 16;
+
+/**
+*	Longest triangle strip or fan, in triangles.
+*/
+const int MAX_TRIS_PER_COMMAND = 14;
+
+bool CheckRange( const int iValue, const int iMin, const int iMax, const char* const pszName, std::string& szError )
+{
+	if( iValue < iMin || iValue > iMax )
+	{
+		szError = std::string( pszName ) + " must be in the range [" + std::to_string( iMin ) + ", " + std::to_string( iMax ) + "], got " + std::to_string( iValue );
+		return false;
+	}
+
+	return true;
+}
+
+bool CheckSettings( const StudioModelSettings_t& settings, std::string& szError )
+{
+	if( settings.szName.empty() || settings.szName.size() + sizeof( "00.mdl" ) > sizeof( studioseqhdr_t::name ) )
+	{
+		szError = "Model name must be between 1 and " + std::to_string( sizeof( studioseqhdr_t::name ) - sizeof( "00.mdl" ) ) + " characters long";
+		return false;
+	}
+
+	if( !CheckRange( settings.iNumBones, 1, MAXSTUDIOBONES, "Bone count", szError ) ||
+		!CheckRange( settings.iNumBoneControllers, 0, STUDIO_MOUTH_CONTROLLER + 1, "Bone controller count", szError ) ||
+		!CheckRange( settings.iNumAttachments, 0, MAXSTUDIOBONES, "Attachment count", szError ) ||
+		!CheckRange( settings.iNumBodyParts, 0, MAXSTUDIOBODYPARTS, "Body part count", szError ) ||
+		!CheckRange( settings.iNumSequences, 1, MAXSTUDIOSEQUENCES, "Sequence count", szError ) ||
+		!CheckRange( settings.iNumFrames, 1, INT_MAX, "Frame count", szError ) ||
+		!CheckRange( settings.iNumEvents, 0, MAXSTUDIOEVENTS, "Event count", szError ) ||
+		!CheckRange( settings.iNumSeqGroups, 1, 100, "Sequence group count", szError ) )
+	{
+		return false;
+	}
+
+	if( settings.iNumBlends != 1 && settings.iNumBlends != 2 && settings.iNumBlends != 4 )
+	{
+		szError = "Blend count must be 1, 2 or 4, got " + std::to_string( settings.iNumBlends );
+		return false;
+	}
+
+	if( settings.flAnimatedChannelFraction < 0 || settings.flAnimatedChannelFraction > 1 )
+	{
+		szError = "Animated channel fraction must be in the range [0, 1]";
+		return false;
+	}
+
+	if( settings.iNumBodyParts > 0 )
+	{
+		if( !CheckRange( settings.iNumModelsPerBodyPart, 1, MAXSTUDIOMODELS, "Models per body part", szError ) ||
+			!CheckRange( settings.iNumVerts, 1, MAXSTUDIOVERTS, "Vertex count", szError ) ||
+			!CheckRange( settings.iNumTris, 0, INT_MAX, "Triangle count", szError ) ||
+			!CheckRange( settings.iNumMeshes, 1, std::min<int>( MAXSTUDIOMESHES, settings.iNumVerts ), "Mesh count", szError ) )
+		{
+			return false;
+		}
+
+		//The body value selects a submodel in each body part, so the product of the model counts must fit in it.
+		int64_t iNumBodies = 1;
+
+		for( int iBodyPart = 0; iBodyPart < settings.iNumBodyParts; ++iBodyPart )
+		{
+			iNumBodies *= settings.iNumModelsPerBodyPart;
+
+			if( iNumBodies > INT_MAX )
+			{
+				szError = "Too many body part and model combinations";
+				return false;
+			}
+		}
+	}
+
+	//Models without textures make the loader look for a T.mdl, so there is always at least one.
+	if( !CheckRange( settings.iNumTextures, 1, MAXSTUDIOSKINS, "Texture count", szError ) ||
+		!CheckRange( settings.iTextureWidth, 1, MAX_TEXTURE_DIMS, "Texture width", szError ) ||
+		!CheckRange( settings.iTextureHeight, 1, MAX_TEXTURE_DIMS, "Texture height", szError ) ||
+		!CheckRange( settings.iNumSkinFamilies, 1, MAXSTUDIOSKINS, "Skin family count", szError ) )
+	{
+		return false;
+	}
+
+	return true;
+}
+
+glm::vec3 RandomVector( CRandom& random, const float flMin, const float flMax )
+{
+	return glm::vec3( random.Float( flMin, flMax ), random.Float( flMin, flMax ), random.Float( flMin, flMax ) );
+}
+
+/**
+*	Writes the run length encoded values of a single channel.
+*/
+void AppendAnimationValues( CRandom& random, std::vector<byte>& data, const int iNumFrames, const int iMaxValue )
+{
+	for( int iFrame = 0; iFrame < iNumFrames; )
+	{
+		const int iTotal = random.Int( 1, std::min( MAX_FRAMES_PER_SPAN, iNumFrames - iFrame ) );
+		const int iValid = random.Int( 1, iTotal );
+
+		const int iSpan = Append<mstudioanimvalue_t>( data, iValid + 1 );
+
+		auto pValues = At<mstudioanimvalue_t>( data, iSpan );
+
+		pValues[ 0 ].num.valid = static_cast<byte>( iValid );
+		pValues[ 0 ].num.total = static_cast<byte>( iTotal );
+
+		for( int iValue = 1; iValue <= iValid; ++iValue )
+		{
+			pValues[ iValue ].value = static_cast<short>( random.Int( -iMaxValue, iMaxValue ) );
+		}
+
+		iFrame += iTotal;
+	}
+}
+
+/**
+*	Writes the animations of all blends of a sequence, followed by their values. This is the layout studiomdl uses.
+*	@param szLabel Name of the sequence, used in error messages.
+*	@param iOutAnimIndex Receives the offset of the animations, which is the sequence's animindex.
+*/
+bool AppendAnimations( CRandom& random, const StudioModelSettings_t& settings, std::vector<byte>& data,
+					   const std::string& szLabel, int& iOutAnimIndex, std::string& szError )
+{
+	const int iNumAnims = settings.iNumBones * settings.iNumBlends;
+
+	const int iFirstAnim = Append<mstudioanim_t>( data, iNumAnims );
+
+	iOutAnimIndex = iFirstAnim;
+
+	//Compare against a threshold so the fraction is reproducible.
+	const uint32_t uiAnimatedThreshold = static_cast<uint32_t>( settings.flAnimatedChannelFraction * 65536.0f );
+
+	for( int iAnimIndex = 0; iAnimIndex < iNumAnims; ++iAnimIndex )
+	{
+		const int iAnim = iFirstAnim + iAnimIndex * sizeof( mstudioanim_t );
+
+		for( int iChannel = 0; iChannel < 6; ++iChannel )
+		{
+			if( ( random.Next() & 0xFFFF ) >= uiAnimatedThreshold )
+				continue;
+
+			const size_t uiOffset = data.size() - iAnim;
+
+			if( uiOffset > USHRT_MAX )
+			{
+				szError = "Sequence \"" + szLabel + "\" is too large for 16 bit animation offsets; "
+					"reduce the number of bones, blends, frames or animated channels";
+				return false;
+			}
+
+			At<mstudioanim_t>( data, iAnim )->offset[ iChannel ] = static_cast<unsigned short>( uiOffset );
+
+			AppendAnimationValues( random, data, settings.iNumFrames, iChannel < 3 ? 500 : 4000 );
+		}
+	}
+
+	Align( data );
+
+	return true;
+}
+
+void AppendTriangleCommands( CRandom& random, std::vector<byte>& data, const int iNumTris, const int iNumVerts,
+							 const int iFirstNorm, const int iNumNorms, const int iWidth, const int iHeight )
+{
+	for( int iRemaining = iNumTris; iRemaining > 0; )
+	{
+		const int iTris = random.Int( 1, std::min( MAX_TRIS_PER_COMMAND, iRemaining ) );
+		const int iCount = iTris + 2;
+
+		//Positive counts are strips, negative counts are fans.
+		*At<short>( data, Append<short>( data ) ) = static_cast<short>( random.Int( 0, 1 ) ? iCount : -iCount );
+
+		const int iVerts = Append<short>( data, iCount * 4 );
+
+		auto pVerts = At<short>( data, iVerts );
+
+		for( int iVert = 0; iVert < iCount; ++iVert, pVerts += 4 )
+		{
+			pVerts[ 0 ] = static_cast<short>( random.Int( 0, iNumVerts - 1 ) );
+			pVerts[ 1 ] = static_cast<short>( iFirstNorm + random.Int( 0, iNumNorms - 1 ) );
+			pVerts[ 2 ] = static_cast<short>( random.Int( 0, iWidth - 1 ) );
+			pVerts[ 3 ] = static_cast<short>( random.Int( 0, iHeight - 1 ) );
+		}
+
+		iRemaining -= iTris;
+	}
+
+	//Terminator.
+	Append<short>( data );
+
+	Align( data );
+}
+
+void AppendModel( CRandom& random, const StudioModelSettings_t& settings, std::vector<byte>& data, const int iModelOffset )
+{
+	const int iNumVerts = settings.iNumVerts;
+
+	const int iVertInfo = Append<byte>( data, iNumVerts );
+	const int iNormInfo = Append<byte>( data, iNumVerts );
+
+	Align( data );
+
+	const int iVerts = Append<glm::vec3>( data, iNumVerts );
+	const int iNorms = Append<glm::vec3>( data, iNumVerts );
+
+	for( int iVert = 0; iVert < iNumVerts; ++iVert )
+	{
+		//Vertices are sorted by bone, like studiomdl does. Normals use the same bone as their vertex.
+		const byte uiBone = static_cast<byte>( ( static_cast<int64_t>( iVert ) * settings.iNumBones ) / iNumVerts );
+
+		At<byte>( data, iVertInfo )[ iVert ] = uiBone;
+		At<byte>( data, iNormInfo )[ iVert ] = uiBone;
+
+		At<glm::vec3>( data, iVerts )[ iVert ] = RandomVector( random, -16, 16 );
+
+		glm::vec3 normal = RandomVector( random, -1, 1 );
+
+		//Avoid normalizing a zero vector.
+		if( glm::dot( normal, normal ) < 0.0001f )
+			normal = glm::vec3( 0, 0, 1 );
+
+		At<glm::vec3>( data, iNorms )[ iVert ] = glm::normalize( normal );
+	}
+
+	const int iMeshes = Append<mstudiomesh_t>( data, settings.iNumMeshes );
+
+	const int iNumSkinRefs = settings.iNumTextures;
+
+	//Each mesh gets a contiguous range of normals, which is how the renderer lights them.
+	const int iNormsPerMesh = iNumVerts / settings.iNumMeshes;
+
+	for( int iMesh = 0; iMesh < settings.iNumMeshes; ++iMesh )
+	{
+		const int iNumTris = settings.iNumTris / settings.iNumMeshes + ( iMesh < settings.iNumTris % settings.iNumMeshes ? 1 : 0 );
+
+		const int iTriIndex = static_cast<int>( data.size() );
+
+		AppendTriangleCommands( random, data, iNumTris, iNumVerts, iMesh * iNormsPerMesh, iNormsPerMesh, settings.iTextureWidth, settings.iTextureHeight );
+
+		auto& mesh = At<mstudiomesh_t>( data, iMeshes )[ iMesh ];
+
+		mesh.numtris = iNumTris;
+		mesh.triindex = iTriIndex;
+		mesh.skinref = iMesh % iNumSkinRefs;
+		mesh.numnorms = iNormsPerMesh;
+		mesh.normindex = iNorms + iMesh * iNormsPerMesh * sizeof( glm::vec3 );
+	}
+
+	auto& model = *At<mstudiomodel_t>( data, iModelOffset );
+
+	model.boundingradius = 32;
+	model.nummesh = settings.iNumMeshes;
+	model.meshindex = iMeshes;
+	model.numverts = iNumVerts;
+	model.vertinfoindex = iVertInfo;
+	model.vertindex = iVerts;
+	model.numnorms = iNumVerts;
+	model.norminfoindex = iNormInfo;
+	model.normindex = iNorms;
+}
+
+/**
+*	Writes the texture, skin and texture data of a file that contains textures.
+*/
+void AppendTextures( CRandom& random, const StudioModelSettings_t& settings, std::vector<byte>& data )
+{
+	const int iTextures = Append<mstudiotexture_t>( data, settings.iNumTextures );
+
+	const int iNumSkinRefs = settings.iNumTextures;
+
+	const int iSkins = Append<short>( data, iNumSkinRefs * settings.iNumSkinFamilies );
+
+	//Each skin family uses the textures in a different order.
+	for( int iFamily = 0; iFamily < settings.iNumSkinFamilies; ++iFamily )
+	{
+		for( int iSkinRef = 0; iSkinRef < iNumSkinRefs; ++iSkinRef )
+		{
+			At<short>( data, iSkins )[ iFamily * iNumSkinRefs + iSkinRef ] = static_cast<short>( ( iSkinRef + iFamily ) % settings.iNumTextures );
+		}
+	}
+
+	Align( data );
+
+	const int iTextureData = static_cast<int>( data.size() );
+
+	const int iNumPixels = settings.iTextureWidth * settings.iTextureHeight;
+
+	for( int iTexture = 0; iTexture < settings.iNumTextures; ++iTexture )
+	{
+		const int iPixels = Append<byte>( data, iNumPixels + PALETTE_SIZE );
+
+		auto pPixels = At<byte>( data, iPixels );
+
+		for( int iPixel = 0; iPixel < iNumPixels + static_cast<int>( PALETTE_SIZE ); ++iPixel )
+		{
+			pPixels[ iPixel ] = static_cast<byte>( random.Next() );
+		}
+
+		auto& texture = At<mstudiotexture_t>( data, iTextures )[ iTexture ];
+
+		snprintf( texture.name, sizeof( texture.name ), "texture%02d.bmp", iTexture );
+		texture.flags = settings.iTextureFlags;
+		texture.width = settings.iTextureWidth;
+		texture.height = settings.iTextureHeight;
+		texture.index = iPixels;
+	}
+
+	Align( data );
+
+	auto& header = *At<studiohdr_t>( data, 0 );
+
+	header.numtextures = settings.iNumTextures;
+	header.textureindex = iTextures;
+	header.texturedataindex = iTextureData;
+	header.numskinref = iNumSkinRefs;
+	header.numskinfamilies = settings.iNumSkinFamilies;
+	header.skinindex = iSkins;
+}
+
+void InitHeader( studiohdr_t& header, const char* const pszId, const std::string& szName )
+{
+	memcpy( &header.id, pszId, 4 );
+	header.version = STUDIO_VERSION;
+	strncpy( header.name, szName.c_str(), sizeof( header.name ) - 1 );
+}
+
+bool GenerateMainFile( CRandom& random, const StudioModelSettings_t& settings, GeneratedStudioModel_t& result, std::string& szError )
+{
+	auto& data = result.model;
+
+	data.clear();
+
+	Append<studiohdr_t>( data );
+
+	const int iBones = Append<mstudiobone_t>( data, settings.iNumBones );
+	const int iControllers = Append<mstudiobonecontroller_t>( data, settings.iNumBoneControllers );
+	const int iNumHitboxes = settings.bHitboxes ? settings.iNumBones : 0;
+	const int iHitboxes = Append<mstudiobbox_t>( data, iNumHitboxes );
+	const int iAttachments = Append<mstudioattachment_t>( data, settings.iNumAttachments );
+	const int iSeqGroups = Append<mstudioseqgroup_t>( data, settings.iNumSeqGroups );
+	const int iSequences = Append<mstudioseqdesc_t>( data, settings.iNumSequences );
+
+	for( int iBone = 0; iBone < settings.iNumBones; ++iBone )
+	{
+		auto& bone = At<mstudiobone_t>( data, iBones )[ iBone ];
+
+		snprintf( bone.name, sizeof( bone.name ), "Bone%03d", iBone );
+
+		bone.parent = iBone == 0 ? -1 : random.Int( 0, iBone - 1 );
+
+		for( int iChannel = 0; iChannel < STUDIO_MAX_PER_BONE_CONTROLLERS; ++iChannel )
+		{
+			bone.bonecontroller[ iChannel ] = -1;
+		}
+
+		for( int iAxis = 0; iAxis < 3; ++iAxis )
+		{
+			bone.value[ iAxis ] = iBone == 0 ? 0 : random.Float( -10, 10 );
+			bone.value[ iAxis + 3 ] = random.Float( -Q_PI, Q_PI );
+			bone.scale[ iAxis ] = 0.01f;
+			bone.scale[ iAxis + 3 ] = 0.0004f;
+		}
+	}
+
+	//Controllers alternate between rotating and moving bones, and are spread over the skeleton.
+	for( int iController = 0; iController < settings.iNumBoneControllers; ++iController )
+	{
+		const bool bRotation = ( iController % 2 ) == 0;
+		const int iBone = ( iController + 1 ) % settings.iNumBones;
+		const int iAxis = iController % 3;
+
+		auto& controller = At<mstudiobonecontroller_t>( data, iControllers )[ iController ];
+
+		controller.bone = iBone;
+		controller.type = ( bRotation ? STUDIO_XR : STUDIO_X ) << iAxis;
+		controller.start = bRotation ? -30.0f : 0.0f;
+		controller.end = bRotation ? 30.0f : 2.0f;
+		controller.index = iController;
+
+		auto& bone = At<mstudiobone_t>( data, iBones )[ iBone ];
+
+		//Only one controller can drive a channel; later ones win on small skeletons.
+		bone.bonecontroller[ ( bRotation ? 3 : 0 ) + iAxis ] = iController;
+	}
+
+	for( int iHitbox = 0; iHitbox < iNumHitboxes; ++iHitbox )
+	{
+		auto& hitbox = At<mstudiobbox_t>( data, iHitboxes )[ iHitbox ];
+
+		hitbox.bone = iHitbox;
+		hitbox.group = iHitbox % 8;
+		hitbox.bbmin = RandomVector( random, -4, -1 );
+		hitbox.bbmax = RandomVector( random, 1, 4 );
+	}
+
+	for( int iAttachment = 0; iAttachment < settings.iNumAttachments; ++iAttachment )
+	{
+		auto& attachment = At<mstudioattachment_t>( data, iAttachments )[ iAttachment ];
+
+		snprintf( attachment.name, sizeof( attachment.name ), "Attachment%d", iAttachment );
+		attachment.bone = random.Int( 0, settings.iNumBones - 1 );
+		attachment.org = RandomVector( random, -8, 8 );
+	}
+
+	for( int iGroup = 0; iGroup < settings.iNumSeqGroups; ++iGroup )
+	{
+		auto& group = At<mstudioseqgroup_t>( data, iSeqGroups )[ iGroup ];
+
+		if( iGroup == 0 )
+		{
+			strcpy( group.label, "default" );
+		}
+		else
+		{
+			snprintf( group.label, sizeof( group.label ), "seqgroup%02d", iGroup );
+			snprintf( group.name, sizeof( group.name ), "models/%s%02d.mdl", settings.szName.c_str(), iGroup );
+		}
+	}
+
+	for( int iSequence = 0; iSequence < settings.iNumSequences; ++iSequence )
+	{
+		const int iEvents = Append<mstudioevent_t>( data, settings.iNumEvents );
+
+		std::vector<int> eventFrames( settings.iNumEvents );
+
+		for( auto& iFrame : eventFrames )
+		{
+			iFrame = random.Int( 0, settings.iNumFrames - 1 );
+		}
+
+		//studiomdl sorts events by frame.
+		std::sort( eventFrames.begin(), eventFrames.end() );
+
+		for( int iEvent = 0; iEvent < settings.iNumEvents; ++iEvent )
+		{
+			auto& event = At<mstudioevent_t>( data, iEvents )[ iEvent ];
+
+			event.frame = eventFrames[ iEvent ];
+
+			//Alternate between server and client events.
+			event.event = ( ( iEvent % 2 ) ? 5000 : 1000 ) + random.Int( 0, 10 );
+
+			snprintf( event.options, sizeof( event.options ), "synthetic%d", iEvent );
+		}
+
+		auto& sequence = At<mstudioseqdesc_t>( data, iSequences )[ iSequence ];
+
+		snprintf( sequence.label, sizeof( sequence.label ), "sequence%04d", iSequence );
+		sequence.fps = 30;
+		sequence.flags = ( iSequence % 2 ) == 0 ? STUDIO_LOOPING : 0;
+		sequence.numevents = settings.iNumEvents;
+		sequence.eventindex = iEvents;
+		sequence.numframes = settings.iNumFrames;
+		sequence.bbmin = glm::vec3( -16, -16, 0 );
+		sequence.bbmax = glm::vec3( 16, 16, 72 );
+		sequence.numblends = settings.iNumBlends;
+		sequence.seqgroup = iSequence % settings.iNumSeqGroups;
+
+		if( settings.iNumBlends > 1 )
+		{
+			sequence.blendtype[ 0 ] = STUDIO_XR;
+			sequence.blendstart[ 0 ] = -45;
+			sequence.blendend[ 0 ] = 45;
+		}
+
+		if( settings.iNumBlends > 2 )
+		{
+			sequence.blendtype[ 1 ] = STUDIO_YR;
+			sequence.blendstart[ 1 ] = -45;
+			sequence.blendend[ 1 ] = 45;
+		}
+
+		//Appending the animations invalidates sequence.
+		const std::string szLabel = sequence.label;
+		const int iSeqGroup = sequence.seqgroup;
+
+		//Sequences in group 0 are stored in the model itself, others in their own file.
+		auto& animData = iSeqGroup == 0 ? data : result.seqGroups[ iSeqGroup ];
+
+		int iAnimIndex;
+
+		if( !AppendAnimations( random, settings, animData, szLabel, iAnimIndex, szError ) )
+			return false;
+
+		At<mstudioseqdesc_t>( data, iSequences )[ iSequence ].animindex = iAnimIndex;
+	}
+
+	int iBodyParts = 0;
+
+	if( settings.iNumBodyParts > 0 )
+	{
+		iBodyParts = Append<mstudiobodyparts_t>( data, settings.iNumBodyParts );
+
+		int iBase = 1;
+
+		for( int iBodyPart = 0; iBodyPart < settings.iNumBodyParts; ++iBodyPart )
+		{
+			const int iModels = Append<mstudiomodel_t>( data, settings.iNumModelsPerBodyPart );
+
+			auto& bodyPart = At<mstudiobodyparts_t>( data, iBodyParts )[ iBodyPart ];
+
+			snprintf( bodyPart.name, sizeof( bodyPart.name ), "bodypart%02d", iBodyPart );
+			bodyPart.nummodels = settings.iNumModelsPerBodyPart;
+			bodyPart.base = iBase;
+			bodyPart.modelindex = iModels;
+
+			iBase *= settings.iNumModelsPerBodyPart;
+
+			for( int iModel = 0; iModel < settings.iNumModelsPerBodyPart; ++iModel )
+			{
+				const int iModelOffset = iModels + iModel * sizeof( mstudiomodel_t );
+
+				snprintf( At<mstudiomodel_t>( data, iModelOffset )->name, sizeof( mstudiomodel_t::name ), "model%02d_%02d", iBodyPart, iModel );
+
+				AppendModel( random, settings, data, iModelOffset );
+			}
+		}
+	}
+
+	if( !settings.bExternalTextures )
+		AppendTextures( random, settings, data );
+
+	auto& header = *At<studiohdr_t>( data, 0 );
+
+	InitHeader( header, STUDIOMDL_HDR_ID, settings.szName + ".mdl" );
+
+	header.eyeposition = glm::vec3( 0, 0, 64 );
+	header.min = glm::vec3( -16, -16, 0 );
+	header.max = glm::vec3( 16, 16, 72 );
+	header.bbmin = header.min;
+	header.bbmax = header.max;
+
+	header.numbones = settings.iNumBones;
+	header.boneindex = iBones;
+	header.numbonecontrollers = settings.iNumBoneControllers;
+	header.bonecontrollerindex = iControllers;
+	header.numhitboxes = iNumHitboxes;
+	header.hitboxindex = iHitboxes;
+	header.numseq = settings.iNumSequences;
+	header.seqindex = iSequences;
+	header.numseqgroups = settings.iNumSeqGroups;
+	header.seqgroupindex = iSeqGroups;
+	header.numbodyparts = settings.iNumBodyParts;
+	header.bodypartindex = iBodyParts;
+	header.numattachments = settings.iNumAttachments;
+	header.attachmentindex = iAttachments;
+
+	//Models that use a T.mdl only store the number of skin references.
+	if( settings.bExternalTextures )
+		header.numskinref = settings.iNumTextures;
+
+	header.length = static_cast<int>( data.size() );
+
+	return true;
+}
+}
+
+bool GenerateStudioModel( CRandom& random, const StudioModelSettings_t& settings, GeneratedStudioModel_t& result, std::string& szError )
+{
+	if( !CheckSettings( settings, szError ) )
+		return false;
+
+	result.model.clear();
+	result.textures.clear();
+	result.seqGroups.clear();
+	result.seqGroups.resize( settings.iNumSeqGroups );
+
+	for( int iGroup = 1; iGroup < settings.iNumSeqGroups; ++iGroup )
+	{
+		auto& groupData = result.seqGroups[ iGroup ];
+
+		Append<studioseqhdr_t>( groupData );
+	}
+
+	if( !GenerateMainFile( random, settings, result, szError ) )
+		return false;
+
+	for( int iGroup = 1; iGroup < settings.iNumSeqGroups; ++iGroup )
+	{
+		auto& groupData = result.seqGroups[ iGroup ];
+
+		auto& header = *At<studioseqhdr_t>( groupData, 0 );
+
+		memcpy( &header.id, STUDIOMDL_SEQ_ID, 4 );
+		header.version = STUDIO_VERSION;
+		snprintf( header.name, sizeof( header.name ), "%s%02d.mdl", settings.szName.c_str(), iGroup );
+		header.length = static_cast<int>( groupData.size() );
+	}
+
+	if( settings.bExternalTextures )
+	{
+		Append<studiohdr_t>( result.textures );
+
+		AppendTextures( random, settings, result.textures );
+
+		auto& header = *At<studiohdr_t>( result.textures, 0 );
+
+		InitHeader( header, STUDIOMDL_HDR_ID, settings.szName + "T.mdl" );
+
+		header.length = static_cast<int>( result.textures.size() );
+	}
+
+	//Make sure the loaders accept the result.
+	std::string szValidationError;
+
+	const auto& studioHdr = *reinterpret_cast<const studiohdr_t*>( result.model.data() );
+
+	bool bValid = studiomdl::ValidateStudioFile( result.model.data(), result.model.size(), false, szValidationError );
+
+	if( bValid && !result.textures.empty() )
+	{
+		bValid = studiomdl::ValidateStudioFile( result.textures.data(), result.textures.size(), false, szValidationError ) &&
+			studiomdl::ValidateTextureReferences( studioHdr, *reinterpret_cast<const studiohdr_t*>( result.textures.data() ), szValidationError );
+	}
+
+	for( int iGroup = 1; bValid && iGroup < settings.iNumSeqGroups; ++iGroup )
+	{
+		const auto& groupData = result.seqGroups[ iGroup ];
+
+		bValid = studiomdl::ValidateStudioFile( groupData.data(), groupData.size(), false, szValidationError ) &&
+			studiomdl::ValidateSequenceGroupFile( studioHdr, iGroup, groupData.data(), groupData.size(), szValidationError );
+	}
+
+	if( !bValid )
+	{
+		szError = "Generated model is invalid: " + szValidationError;
+		return false;
+	}
+
+	return true;
+}
+
+bool WriteStudioModel( const std::string& szFilename, const GeneratedStudioModel_t& model, std::string& szError )
+{
+	if( szFilename.size() <= 4 || szFilename.compare( szFilename.size() - 4, 4, ".mdl" ) )
+	{
+		szError = "Studio model file name \"" + szFilename + "\" must end with .mdl";
+		return false;
+	}
+
+	if( !SaveFile( szFilename, model.model, szError ) )
+		return false;
+
+	const std::string szBaseName = szFilename.substr( 0, szFilename.size() - 4 );
+
+	if( !model.textures.empty() && !SaveFile( szBaseName + "T.mdl", model.textures, szError ) )
+		return false;
+
+	char szSuffix[ 16 ];
+
+	for( size_t uiGroup = 1; uiGroup < model.seqGroups.size(); ++uiGroup )
+	{
+		snprintf( szSuffix, sizeof( szSuffix ), "%02u.mdl", static_cast<unsigned int>( uiGroup ) );
+
+		if( !SaveFile( szBaseName + szSuffix, model.seqGroups[ uiGroup ], szError ) )
+			return false;
+	}
+
+	return true;
+}
+}
@@ -0,0 +1,147 @@
+#ifndef SYNTHETIC_STUDIOMODELGENERATOR_H
+#define SYNTHETIC_STUDIOMODELGENERATOR_H
+
+#include <string>
+#include <vector>
+
+#include "shared/Const.h"
+
+/**
+*	@defgroup Synthetic Synthetic assets
+*
+*	Generates studio models and sprites with configurable dimensions, so benchmarks and stress tests don't need real assets.
+*	Generated files use the same layouts the loaders read, and are checked by the same validation before they are returned.
+*
+*	@{
+*/
+
+namespace synthetic
+{
+class CRandom;
+
+/**
+*	Dimensions of a generated studio model.
+*	Counts for models apply to every model in every body part.
+*/
+struct StudioModelSettings_t
+{
+	/**
+	*	Name stored in the header. Sequence group names are derived from it.
+	*/
+	std::string szName = "synthetic";
+
+	int iNumBones = 16;
+
+	/**
+	*	Number of bone controllers, up to 5. Controllers 0-3 are user controllers, controller 4 is the mouth.
+	*/
+	int iNumBoneControllers = 2;
+
+	int iNumAttachments = 1;
+
+	/**
+	*	Whether each bone gets a hitbox.
+	*/
+	bool bHitboxes = true;
+
+	/**
+	*	Number of body parts. If 0, the model only contains a skeleton and animations.
+	*/
+	int iNumBodyParts = 1;
+	int iNumModelsPerBodyPart = 1;
+
+	/**
+	*	Number of vertices in each model. Each vertex has its own normal.
+	*/
+	int iNumVerts = 512;
+
+	/**
+	*	Number of triangles in each model. They are divided over the meshes, and stored as a mix of strips and fans.
+	*/
+	int iNumTris = 1024;
+
+	int iNumMeshes = 2;
+
+	int iNumTextures = 2;
+	int iTextureWidth = 256;
+	int iTextureHeight = 256;
+
+	/**
+	*	Flags for every texture.
+	*	@see STUDIO_NF_FLATSHADE
+	*/
+	int iTextureFlags = 0;
+
+	int iNumSkinFamilies = 1;
+
+	/**
+	*	Whether textures are stored in a separate T.mdl file.
+	*/
+	bool bExternalTextures = false;
+
+	int iNumSequences = 4;
+
+	/**
+	*	Number of frames in each sequence.
+	*/
+	int iNumFrames = 30;
+
+	/**
+	*	Number of blends in each sequence. Must be 1, 2 or 4.
+	*/
+	int iNumBlends = 1;
+
+	/**
+	*	Number of events in each sequence.
+	*/
+	int iNumEvents = 2;
+
+	/**
+	*	Number of sequence groups. Groups other than 0 are stored in separate NN.mdl files. Sequences are divided over the groups.
+	*/
+	int iNumSeqGroups = 1;
+
+	/**
+	*	Fraction of animation channels that are animated. Other channels use the bone's default value.
+	*/
+	float flAnimatedChannelFraction = 0.75f;
+};
+
+/**
+*	Contents of the files that make up a generated studio model.
+*/
+struct GeneratedStudioModel_t
+{
+	std::vector<byte> model;
+
+	/**
+	*	Contents of the T.mdl file. Empty if textures are stored in the model itself.
+	*/
+	std::vector<byte> textures;
+
+	/**
+	*	Contents of the sequence group files. Element 0 is always empty, since group 0 is stored in the model itself.
+	*/
+	std::vector<std::vector<byte>> seqGroups;
+};
+
+/**
+*	Generates a studio model.
+*	@param random Random number generator used for all values.
+*	@param settings Dimensions of the model.
+*	@param result Receives the file contents.
+*	@param szError If the model could not be generated, contains the reason.
+*	@return Whether the model was generated.
+*/
+bool GenerateStudioModel( CRandom& random, const StudioModelSettings_t& settings, GeneratedStudioModel_t& result, std::string& szError );
+
+/**
+*	Writes a generated studio model. The T.mdl and sequence group files are written next to it, using the names the loader expects.
+*	@param szFilename Name of the model file. Must end with .mdl.
+*/
+bool WriteStudioModel( const std::string& szFilename, const GeneratedStudioModel_t& model, std::string& szError );
+}
+
+/** @} */
+
+#endif //SYNTHETIC_STUDIOMODELGENERATOR_H
@@ -0,0 +1,314 @@
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <experimental/filesystem>
+#include <string>
+#include <vector>
+
+#include "synthetic/CRandom.h"
+#include "synthetic/DataBuilder.h"
+#include "synthetic/SpriteGenerator.h"
+#include "synthetic/StudioModelGenerator.h"
+
+namespace fs = std::experimental::filesystem;
+
+namespace
+{
+const uint32_t DEFAULT_SEED = 1;
+
+void PrintUsage( const char* const pszProgram )
+{
+	const synthetic::StudioModelSettings_t model;
+	const synthetic::SpriteSettings_t sprite;
+
+	printf(
+		"Usage: %s studiomodel <file.mdl> [options]\n"
+		"       %s sprite <file.spr> [options]\n"
+		"Generates studio models and sprites filled with random data, for benchmarks and stress tests.\n"
+		"The same seed and options always produce the same files.\n"
+		"\n"
+		"Common options:\n"
+		"  --seed <value>              Random seed (default %u)\n"
+		"\n"
+		"Studio model options:\n"
+		"  --bones <count>             Number of bones (default %d)\n"
+		"  --controllers <count>       Number of bone controllers, up to 5 (default %d)\n"
+		"  --attachments <count>       Number of attachments (default %d)\n"
+		"  --no-hitboxes               Don't add a hitbox for each bone\n"
+		"  --bodyparts <count>         Number of body parts, 0 for a skeleton only (default %d)\n"
+		"  --models <count>            Number of models in each body part (default %d)\n"
+		"  --verts <count>             Number of vertices in each model (default %d)\n"
+		"  --tris <count>              Number of triangles in each model (default %d)\n"
+		"  --meshes <count>            Number of meshes in each model (default %d)\n"
+		"  --textures <count>          Number of textures (default %d)\n"
+		"  --texture-size <w>x<h>      Texture dimensions (default %dx%d)\n"
+		"  --texture-flags <flags>     Flags for every texture (default %d)\n"
+		"  --skin-families <count>     Number of skin families (default %d)\n"
+		"  --external-textures         Store textures in a T.mdl file\n"
+		"  --sequences <count>         Number of sequences (default %d)\n"
+		"  --frames <count>            Number of frames in each sequence (default %d)\n"
+		"  --blends <1|2|4>            Number of blends in each sequence (default %d)\n"
+		"  --events <count>            Number of events in each sequence (default %d)\n"
+		"  --seqgroups <count>         Number of sequence groups; groups after the first are stored in NN.mdl files (default %d)\n"
+		"  --animated <fraction>       Fraction of animation channels that are animated (default %.2f)\n"
+		"\n"
+		"Sprite options:\n"
+		"  --size <w>x<h>              Frame dimensions (default %dx%d)\n"
+		"  --frames <count>            Number of frames (default %d)\n"
+		"  --group-frames <count>      If not 0, every frame is a group with this many frames (default %d)\n"
+		"  --type <type>               Orientation type, e.g. VP_PARALLEL (default %s)\n"
+		"  --format <format>           Texture format, e.g. ADDITIVE (default %s)\n",
+		pszProgram, pszProgram,
+		DEFAULT_SEED,
+		model.iNumBones, model.iNumBoneControllers, model.iNumAttachments,
+		model.iNumBodyParts, model.iNumModelsPerBodyPart, model.iNumVerts, model.iNumTris, model.iNumMeshes,
+		model.iNumTextures, model.iTextureWidth, model.iTextureHeight, model.iTextureFlags, model.iNumSkinFamilies,
+		model.iNumSequences, model.iNumFrames, model.iNumBlends, model.iNumEvents, model.iNumSeqGroups, model.flAnimatedChannelFraction,
+		sprite.iWidth, sprite.iHeight, sprite.iNumFrames, sprite.iNumGroupFrames,
+		sprite::TypeToString( sprite.type ), sprite::TexFormatToString( sprite.texFormat ) );
+}
+
+bool ParseInt( const char* const pszValue, int& iOutValue )
+{
+	char* pszEnd;
+
+	const long iValue = strtol( pszValue, &pszEnd, 0 );
+
+	if( pszEnd == pszValue || *pszEnd || iValue < INT_MIN || iValue > INT_MAX )
+	{
+		fprintf( stderr, "Invalid integer \"%s\"\n", pszValue );
+		return false;
+	}
+
+	iOutValue = static_cast<int>( iValue );
+
+	return true;
+}
+
+bool ParseSize( const char* const pszValue, int& iOutWidth, int& iOutHeight )
+{
+	if( sscanf( pszValue, "%dx%d", &iOutWidth, &iOutHeight ) != 2 )
+	{
+		fprintf( stderr, "Invalid size \"%s\", expected <width>x<height>\n", pszValue );
+		return false;
+	}
+
+	return true;
+}
+
+/**
+*	Parses the options that follow the output file name.
+*	@return Exit code, or -1 to continue.
+*/
+int ParseOptions( const int iArgc, char* pszArgV[], uint32_t& uiSeed,
+				  synthetic::StudioModelSettings_t& model, synthetic::SpriteSettings_t& sprite, const bool bIsSprite )
+{
+	for( int iArg = 3; iArg < iArgc; ++iArg )
+	{
+		const char* const pszArg = pszArgV[ iArg ];
+
+		const bool bHasValue = iArg + 1 < iArgc;
+
+		const char* const pszValue = bHasValue ? pszArgV[ iArg + 1 ] : nullptr;
+
+		bool bValid = true;
+
+		if( !strcmp( pszArg, "--help" ) || !strcmp( pszArg, "-h" ) )
+		{
+			PrintUsage( pszArgV[ 0 ] );
+			return EXIT_SUCCESS;
+		}
+		else if( !strcmp( pszArg, "--seed" ) && bHasValue )
+		{
+			uiSeed = static_cast<uint32_t>( strtoul( pszValue, nullptr, 0 ) );
+			++iArg;
+		}
+		else if( !strcmp( pszArg, "--frames" ) && bHasValue )
+		{
+			bValid = ParseInt( pszValue, bIsSprite ? sprite.iNumFrames : model.iNumFrames );
+			++iArg;
+		}
+		else if( bIsSprite )
+		{
+			bool bSuccess = true;
+
+			if( !strcmp( pszArg, "--size" ) && bHasValue )
+			{
+				bValid = ParseSize( pszValue, sprite.iWidth, sprite.iHeight );
+			}
+			else if( !strcmp( pszArg, "--group-frames" ) && bHasValue )
+			{
+				bValid = ParseInt( pszValue, sprite.iNumGroupFrames );
+			}
+			else if( !strcmp( pszArg, "--type" ) && bHasValue )
+			{
+				sprite.type = sprite::StringToType( pszValue, &bSuccess );
+			}
+			else if( !strcmp( pszArg, "--format" ) && bHasValue )
+			{
+				sprite.texFormat = sprite::StringToTexFormat( pszValue, &bSuccess );
+			}
+			else
+			{
+				fprintf( stderr, "Unknown or incomplete option \"%s\"\n", pszArg );
+				return 2;
+			}
+
+			if( !bSuccess )
+			{
+				fprintf( stderr, "Invalid value \"%s\" for option \"%s\"\n", pszValue, pszArg );
+				return 2;
+			}
+
+			++iArg;
+		}
+		else if( !strcmp( pszArg, "--no-hitboxes" ) )
+		{
+			model.bHitboxes = false;
+		}
+		else if( !strcmp( pszArg, "--external-textures" ) )
+		{
+			model.bExternalTextures = true;
+		}
+		else if( !strcmp( pszArg, "--texture-size" ) && bHasValue )
+		{
+			bValid = ParseSize( pszValue, model.iTextureWidth, model.iTextureHeight );
+			++iArg;
+		}
+		else if( !strcmp( pszArg, "--animated" ) && bHasValue )
+		{
+			model.flAnimatedChannelFraction = static_cast<float>( atof( pszValue ) );
+			++iArg;
+		}
+		else if( bHasValue )
+		{
+			static const struct
+			{
+				const char* pszName;
+				int synthetic::StudioModelSettings_t::* pValue;
+			} INT_OPTIONS[] =
+			{
+				{ "--bones",			&synthetic::StudioModelSettings_t::iNumBones },
+				{ "--controllers",		&synthetic::StudioModelSettings_t::iNumBoneControllers },
+				{ "--attachments",		&synthetic::StudioModelSettings_t::iNumAttachments },
+				{ "--bodyparts",		&synthetic::StudioModelSettings_t::iNumBodyParts },
+				{ "--models",			&synthetic::StudioModelSettings_t::iNumModelsPerBodyPart },
+				{ "--verts",			&synthetic::StudioModelSettings_t::iNumVerts },
+				{ "--tris",				&synthetic::StudioModelSettings_t::iNumTris },
+				{ "--meshes",			&synthetic::StudioModelSettings_t::iNumMeshes },
+				{ "--textures",			&synthetic::StudioModelSettings_t::iNumTextures },
+				{ "--texture-flags",	&synthetic::StudioModelSettings_t::iTextureFlags },
+				{ "--skin-families",	&synthetic::StudioModelSettings_t::iNumSkinFamilies },
+				{ "--sequences",		&synthetic::StudioModelSettings_t::iNumSequences },
+				{ "--blends",			&synthetic::StudioModelSettings_t::iNumBlends },
+				{ "--events",			&synthetic::StudioModelSettings_t::iNumEvents },
+				{ "--seqgroups",		&synthetic::StudioModelSettings_t::iNumSeqGroups }
+			};
+
+			bool bFound = false;
+
+			for( const auto& option : INT_OPTIONS )
+			{
+				if( !strcmp( pszArg, option.pszName ) )
+				{
+					bValid = ParseInt( pszValue, model.*option.pValue );
+					bFound = true;
+					break;
+				}
+			}
+
+			if( !bFound )
+			{
+				fprintf( stderr, "Unknown option \"%s\"\n", pszArg );
+				return 2;
+			}
+
+			++iArg;
+		}
+		else
+		{
+			fprintf( stderr, "Unknown or incomplete option \"%s\"\n", pszArg );
+			return 2;
+		}
+
+		if( !bValid )
+			return 2;
+	}
+
+	return -1;
+}
+}
+
+int main( int iArgc, char* pszArgV[] )
+{
+	if( iArgc < 3 || ( strcmp( pszArgV[ 1 ], "studiomodel" ) && strcmp( pszArgV[ 1 ], "sprite" ) ) )
+	{
+		if( iArgc >= 2 && ( !strcmp( pszArgV[ 1 ], "--help" ) || !strcmp( pszArgV[ 1 ], "-h" ) ) )
+		{
+			PrintUsage( pszArgV[ 0 ] );
+			return EXIT_SUCCESS;
+		}
+
+		PrintUsage( pszArgV[ 0 ] );
+		return 2;
+	}
+
+	const bool bIsSprite = !strcmp( pszArgV[ 1 ], "sprite" );
+
+	const std::string szFilename = pszArgV[ 2 ];
+
+	uint32_t uiSeed = DEFAULT_SEED;
+
+	synthetic::StudioModelSettings_t modelSettings;
+	synthetic::SpriteSettings_t spriteSettings;
+
+	modelSettings.szName = fs::path( szFilename ).stem().string();
+
+	const int iResult = ParseOptions( iArgc, pszArgV, uiSeed, modelSettings, spriteSettings, bIsSprite );
+
+	if( iResult != -1 )
+		return iResult;
+
+	synthetic::CRandom random( uiSeed );
+
+	std::string szError;
+
+	if( bIsSprite )
+	{
+		std::vector<byte> data;
+
+		if( !synthetic::GenerateSprite( random, spriteSettings, data, szError ) ||
+			!synthetic::SaveFile( szFilename, data, szError ) )
+		{
+			fprintf( stderr, "%s\n", szError.c_str() );
+			return EXIT_FAILURE;
+		}
+
+		printf( "Wrote \"%s\" (%u bytes)\n", szFilename.c_str(), static_cast<unsigned int>( data.size() ) );
+	}
+	else
+	{
+		synthetic::GeneratedStudioModel_t model;
+
+		if( !synthetic::GenerateStudioModel( random, modelSettings, model, szError ) ||
+			!synthetic::WriteStudioModel( szFilename, model, szError ) )
+		{
+			fprintf( stderr, "%s\n", szError.c_str() );
+			return EXIT_FAILURE;
+		}
+
+		size_t uiTotalSize = model.model.size() + model.textures.size();
+
+		for( const auto& group : model.seqGroups )
+		{
+			uiTotalSize += group.size();
+		}
+
+		printf( "Wrote \"%s\" (%u files, %u bytes)\n", szFilename.c_str(),
+				static_cast<unsigned int>( model.seqGroups.size() + ( model.textures.empty() ? 0 : 1 ) ),
+				static_cast<unsigned int>( uiTotalSize ) );
+	}
+
+	return EXIT_SUCCESS;
+}
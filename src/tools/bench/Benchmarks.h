@@ -0,0 +1,72 @@
+#ifndef TOOLS_BENCH_BENCHMARKS_H
+#define TOOLS_BENCH_BENCHMARKS_H
+
+class CRendererLibraries;
+
+namespace synthetic
+{
+class CRandom;
+}
+
+namespace bench
+{
+class CBenchmarkRunner;
+
+/**
+*	Registers benchmarks for the math library.
+*/
+void RegisterMathBenchmarks( CBenchmarkRunner& runner, synthetic::CRandom& random );
+
+/**
+*	Registers benchmarks for studio model texture conversion, bone setup and vertex transformation.
+*/
+void RegisterStudioModelBenchmarks( CBenchmarkRunner& runner, synthetic::CRandom& random );
+
+/**
+*	Checks that every supported skinning kernel matches the scalar kernel.
+*	The SSE kernel must match exactly, kernels that use fused multiply-add must be within a small tolerance.
+*	Lighting and chrome must match exactly for all kernels.
+*	Mismatches are printed to standard error.
+*	@return Whether all kernels passed.
+*/
+bool VerifySkinningKernels( synthetic::CRandom& random );
+
+/**
+*	Checks that the animation event index finds the same events as a linear scan of the sequence's events,
+*	using randomly generated sequences and frame ranges.
+*	Mismatches are printed to standard error.
+*	@param iNumCases Number of sequences to check.
+*	@return Whether all cases matched.
+*/
+bool VerifyAnimationEventIndex( synthetic::CRandom& random, const int iNumCases );
+
+/**
+*	Registers benchmarks for keyvalues parsing, sprite loading and filesystem lookups.
+*	Files needed by the benchmarks are written to a temporary directory that is removed by CleanupFileBenchmarks.
+*	@param bHasGLContext Whether an OpenGL context is current. Sprite loading uploads textures, so it is only registered if there is one.
+*	@return Whether the benchmark data could be written.
+*/
+bool RegisterFileBenchmarks( CBenchmarkRunner& runner, synthetic::CRandom& random, const bool bHasGLContext );
+
+/**
+*	Removes the temporary directory created by RegisterFileBenchmarks.
+*/
+void CleanupFileBenchmarks();
+
+/**
+*	Checks that drawing a grid of model instances with IStudioModelRenderer::DrawModelInstances
+*	looks the same as drawing each instance with IStudioModelRenderer::DrawModel.
+*	Instances are transformed on the CPU, so a small number of pixels may differ.
+*	Mismatches are printed to standard error.
+*	@return Whether both draws matched.
+*/
+bool VerifyInstancedDrawing( CRendererLibraries& renderer, synthetic::CRandom& random );
+
+/**
+*	Registers benchmarks that draw a grid of model instances separately and in a single batch.
+*	@return Whether the model could be created.
+*/
+bool RegisterRendererBenchmarks( CBenchmarkRunner& runner, synthetic::CRandom& random, CRendererLibraries& renderer );
+}
+
+#endif //TOOLS_BENCH_BENCHMARKS_H
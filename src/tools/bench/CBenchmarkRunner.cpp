@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+
+#include "CBenchmarkRunner.h"
+
+namespace bench
+{
+namespace
+{
+/**
+*	Larger than the last level cache of most desktop processors.
+*/
+const size_t EVICTION_BUFFER_SIZE = 64 * 1024 * 1024;
+
+/**
+*	Cache line size to assume when touching the eviction buffer.
+*/
+const size_t CACHE_LINE_SIZE = 64;
+}
+
+volatile byte g_ConsumeSink = 0;
+
+const char* CacheStateToString( const CacheState state )
+{
+	switch( state )
+	{
+	case CacheState::WARM:	return "warm";
+	case CacheState::COLD:	return "cold";
+
+	default: return "unknown";
+	}
+}
+
+CBenchmarkRunner::CBenchmarkRunner( const BenchmarkSettings_t& settings )
+	: m_Settings( settings )
+{
+}
+
+CBenchmarkRunner::~CBenchmarkRunner()
+{
+}
+
+void CBenchmarkRunner::Add( const char* const pszName, const size_t uiItems, RunFn run, SetupFn setup )
+{
+	assert( pszName );
+	assert( uiItems > 0 );
+	assert( run );
+
+	m_Benchmarks.push_back( { pszName, uiItems, std::move( run ), std::move( setup ) } );
+}
+
+void CBenchmarkRunner::List( FILE* pFile ) const
+{
+	for( const auto& benchmark : m_Benchmarks )
+	{
+		fprintf( pFile, "%s\n", benchmark.szName.c_str() );
+	}
+}
+
+void CBenchmarkRunner::RunAll()
+{
+	for( const auto& benchmark : m_Benchmarks )
+	{
+		if( !m_Settings.szFilter.empty() && benchmark.szName.find( m_Settings.szFilter ) == std::string::npos )
+			continue;
+
+		if( m_Settings.bRunWarm )
+			Run( benchmark, CacheState::WARM );
+
+		if( m_Settings.bRunCold )
+			Run( benchmark, CacheState::COLD );
+	}
+}
+
+void CBenchmarkRunner::WriteJSON( FILE* pFile ) const
+{
+	fprintf( pFile, "{\n\t\"seed\": %u,\n\t\"repetitions\": %d,\n\t\"warmup_repetitions\": %d,\n\t\"benchmarks\": [",
+			 m_Settings.uiSeed, m_Settings.iRepetitions, m_Settings.iWarmupRepetitions );
+
+	bool bFirst = true;
+
+	for( const auto& result : m_Results )
+	{
+		//Names are made up of identifiers and separators, so they don't need escaping.
+		fprintf( pFile,
+				 "%s\n\t\t{\"name\": \"%s\", \"cache\": \"%s\", \"items\": %u, \"repetitions\": %d, "
+				 "\"min_ns\": %.1f, \"median_ns\": %.1f, \"mean_ns\": %.1f, \"max_ns\": %.1f, \"median_ns_per_item\": %.3f}",
+				 bFirst ? "" : ",",
+				 result.szName.c_str(), CacheStateToString( result.cacheState ), static_cast<unsigned int>( result.uiItems ), result.iRepetitions,
+				 result.flMinNs, result.flMedianNs, result.flMeanNs, result.flMaxNs,
+				 result.flMedianNs / result.uiItems );
+
+		bFirst = false;
+	}
+
+	fprintf( pFile, "\n\t]\n}\n" );
+}
+
+void CBenchmarkRunner::Run( const Benchmark_t& benchmark, const CacheState cacheState )
+{
+	if( cacheState == CacheState::WARM )
+	{
+		for( int iRepetition = 0; iRepetition < m_Settings.iWarmupRepetitions; ++iRepetition )
+		{
+			if( benchmark.setup )
+				benchmark.setup();
+
+			benchmark.run();
+		}
+	}
+
+	std::vector<double> times;
+
+	times.reserve( m_Settings.iRepetitions );
+
+	for( int iRepetition = 0; iRepetition < m_Settings.iRepetitions; ++iRepetition )
+	{
+		if( benchmark.setup )
+			benchmark.setup();
+
+		if( cacheState == CacheState::COLD )
+			EvictCaches();
+
+		const auto start = std::chrono::steady_clock::now();
+
+		benchmark.run();
+
+		const auto end = std::chrono::steady_clock::now();
+
+		times.push_back( std::chrono::duration<double, std::nano>( end - start ).count() );
+	}
+
+	std::sort( times.begin(), times.end() );
+
+	BenchmarkResult_t result;
+
+	result.szName = benchmark.szName;
+	result.cacheState = cacheState;
+	result.uiItems = benchmark.uiItems;
+	result.iRepetitions = static_cast<int>( times.size() );
+	result.flMinNs = times.front();
+	result.flMaxNs = times.back();
+	result.flMeanNs = std::accumulate( times.begin(), times.end(), 0.0 ) / times.size();
+
+	const size_t uiMiddle = times.size() / 2;
+
+	result.flMedianNs = ( times.size() % 2 ) ? times[ uiMiddle ] : ( times[ uiMiddle - 1 ] + times[ uiMiddle ] ) / 2;
+
+	fprintf( stderr, "%-48s %-4s %12.1f ns %12.3f ns/item\n",
+			 result.szName.c_str(), CacheStateToString( cacheState ), result.flMedianNs, result.flMedianNs / result.uiItems );
+
+	m_Results.push_back( std::move( result ) );
+}
+
+void CBenchmarkRunner::EvictCaches()
+{
+	if( !m_EvictionBuffer )
+	{
+		m_EvictionBuffer = std::make_unique<byte[]>( EVICTION_BUFFER_SIZE );
+		memset( m_EvictionBuffer.get(), 0, EVICTION_BUFFER_SIZE );
+	}
+
+	//Writing forces the lines to be owned by this core, which also evicts them from other cores.
+	byte* const pBuffer = m_EvictionBuffer.get();
+
+	for( size_t uiOffset = 0; uiOffset < EVICTION_BUFFER_SIZE; uiOffset += CACHE_LINE_SIZE )
+	{
+		++pBuffer[ uiOffset ];
+	}
+
+	Consume( pBuffer[ 0 ] );
+}
+}
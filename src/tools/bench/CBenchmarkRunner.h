@@ -0,0 +1,183 @@
+#ifndef TOOLS_BENCH_CBENCHMARKRUNNER_H
+#define TOOLS_BENCH_CBENCHMARKRUNNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "shared/Const.h"
+
+namespace bench
+{
+/**
+*	Whether a benchmark runs with its data in the CPU caches or not.
+*/
+enum class CacheState
+{
+	/**
+	*	The benchmark has been run a few times before it is measured.
+	*/
+	WARM = 0,
+
+	/**
+	*	The CPU caches are flushed before every repetition.
+	*/
+	COLD
+};
+
+const char* CacheStateToString( const CacheState state );
+
+/**
+*	Settings for a benchmark run.
+*/
+struct BenchmarkSettings_t
+{
+	static const uint32_t DEFAULT_SEED = 0x484C5453;
+
+	/**
+	*	Seed used to generate all benchmark data. Using the same seed produces identical data on every platform.
+	*/
+	uint32_t uiSeed = DEFAULT_SEED;
+
+	/**
+	*	Number of measured repetitions of each benchmark.
+	*/
+	int iRepetitions = 20;
+
+	/**
+	*	Number of repetitions to run before measuring warm benchmarks.
+	*/
+	int iWarmupRepetitions = 3;
+
+	/**
+	*	If not empty, only benchmarks whose name contains this string are run.
+	*/
+	std::string szFilter;
+
+	bool bRunWarm = true;
+	bool bRunCold = true;
+};
+
+/**
+*	Timings for one benchmark in one cache state.
+*/
+struct BenchmarkResult_t
+{
+	std::string szName;
+	CacheState cacheState;
+
+	/**
+	*	Number of items processed by a single repetition.
+	*/
+	size_t uiItems;
+
+	int iRepetitions;
+
+	//Times for a single repetition, in nanoseconds.
+	double flMinNs;
+	double flMedianNs;
+	double flMeanNs;
+	double flMaxNs;
+};
+
+/**
+*	Runs a set of benchmarks and collects their timings.
+*	Each benchmark processes a batch of items per repetition; times are reported per repetition and per item.
+*/
+class CBenchmarkRunner final
+{
+public:
+	/**
+	*	Function that is run before every repetition. Not included in the timings.
+	*/
+	using SetupFn = std::function<void()>;
+
+	/**
+	*	Function that is measured.
+	*/
+	using RunFn = std::function<void()>;
+
+private:
+	struct Benchmark_t
+	{
+		std::string szName;
+		size_t uiItems;
+		RunFn run;
+		SetupFn setup;
+	};
+
+public:
+	CBenchmarkRunner( const BenchmarkSettings_t& settings );
+	~CBenchmarkRunner();
+
+	const BenchmarkSettings_t& GetSettings() const { return m_Settings; }
+
+	const std::vector<BenchmarkResult_t>& GetResults() const { return m_Results; }
+
+	/**
+	*	Adds a benchmark.
+	*	@param pszName Name of the benchmark. Uses the form "group/name".
+	*	@param uiItems Number of items processed by a single call to run.
+	*	@param run Function to measure.
+	*	@param setup Optional function to run before every repetition.
+	*/
+	void Add( const char* const pszName, const size_t uiItems, RunFn run, SetupFn setup = nullptr );
+
+	/**
+	*	Prints the names of all benchmarks.
+	*/
+	void List( FILE* pFile ) const;
+
+	/**
+	*	Runs all benchmarks that match the filter, in both cache states if enabled.
+	*	Progress is printed to stderr.
+	*/
+	void RunAll();
+
+	/**
+	*	Writes the results as a JSON document.
+	*/
+	void WriteJSON( FILE* pFile ) const;
+
+private:
+	void Run( const Benchmark_t& benchmark, const CacheState cacheState );
+
+	/**
+	*	Evicts benchmark data from the CPU caches by touching a buffer that is larger than the last level cache.
+	*/
+	void EvictCaches();
+
+private:
+	const BenchmarkSettings_t m_Settings;
+
+	std::vector<Benchmark_t> m_Benchmarks;
+
+	std::vector<BenchmarkResult_t> m_Results;
+
+	std::unique_ptr<byte[]> m_EvictionBuffer;
+
+private:
+	CBenchmarkRunner( const CBenchmarkRunner& ) = delete;
+	CBenchmarkRunner& operator=( const CBenchmarkRunner& ) = delete;
+};
+
+/**
+*	Written to by Consume.
+*/
+extern volatile byte g_ConsumeSink;
+
+/**
+*	Keeps the compiler from optimizing away the computation of a value.
+*/
+template<typename T>
+inline void Consume( const T& value )
+{
+	g_ConsumeSink = *reinterpret_cast<const volatile byte*>( &value );
+}
+}
+
+#endif //TOOLS_BENCH_CBENCHMARKRUNNER_H
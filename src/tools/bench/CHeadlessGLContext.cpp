@@ -0,0 +1,103 @@
+#ifndef WIN32
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include "CHeadlessGLContext.h"
+
+CHeadlessGLContext::CHeadlessGLContext()
+{
+}
+
+CHeadlessGLContext::~CHeadlessGLContext()
+{
+	Destroy();
+}
+
+#ifndef WIN32
+bool CHeadlessGLContext::Create()
+{
+	Destroy();
+
+	//See CThumbnailRendererApp::InitOpenGL; a surfaceless display is preferred so no display server is needed.
+	EGLDisplay display = EGL_NO_DISPLAY;
+
+	auto eglGetPlatformDisplayEXT = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>( eglGetProcAddress( "eglGetPlatformDisplayEXT" ) );
+
+	if( eglGetPlatformDisplayEXT )
+		display = eglGetPlatformDisplayEXT( EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr );
+
+	if( display == EGL_NO_DISPLAY )
+		display = eglGetDisplay( EGL_DEFAULT_DISPLAY );
+
+	if( display == EGL_NO_DISPLAY || !eglInitialize( display, nullptr, nullptr ) )
+		return false;
+
+	m_pDisplay = display;
+
+	const EGLint configAttribs[] =
+	{
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint iNumConfigs = 0;
+
+	if( !eglBindAPI( EGL_OPENGL_API ) || !eglChooseConfig( display, configAttribs, &config, 1, &iNumConfigs ) || iNumConfigs == 0 )
+	{
+		Destroy();
+		return false;
+	}
+
+	EGLContext context = eglCreateContext( display, config, EGL_NO_CONTEXT, nullptr );
+
+	if( context == EGL_NO_CONTEXT )
+	{
+		Destroy();
+		return false;
+	}
+
+	m_pContext = context;
+
+	if( !eglMakeCurrent( display, EGL_NO_SURFACE, EGL_NO_SURFACE, context ) )
+	{
+		Destroy();
+		return false;
+	}
+
+	m_bIsCurrent = true;
+
+	return true;
+}
+
+void CHeadlessGLContext::Destroy()
+{
+	if( m_bIsCurrent )
+	{
+		eglMakeCurrent( m_pDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+		m_bIsCurrent = false;
+	}
+
+	if( m_pContext )
+	{
+		eglDestroyContext( m_pDisplay, m_pContext );
+		m_pContext = nullptr;
+	}
+
+	if( m_pDisplay )
+	{
+		eglTerminate( m_pDisplay );
+		m_pDisplay = nullptr;
+	}
+}
+#else
+bool CHeadlessGLContext::Create()
+{
+	return false;
+}
+
+void CHeadlessGLContext::Destroy()
+{
+}
+#endif
@@ -0,0 +1,35 @@
+#ifndef TOOLS_BENCH_CHEADLESSGLCONTEXT_H
+#define TOOLS_BENCH_CHEADLESSGLCONTEXT_H
+
+/**
+*	OpenGL context that is not attached to a window, so code that uploads textures can be benchmarked.
+*	Only available on Linux, where it is created using EGL. On other platforms Create always fails.
+*/
+class CHeadlessGLContext final
+{
+public:
+	CHeadlessGLContext();
+	~CHeadlessGLContext();
+
+	bool IsCurrent() const { return m_bIsCurrent; }
+
+	/**
+	*	Creates the context and makes it current.
+	*	@return Whether the context was created.
+	*/
+	bool Create();
+
+	void Destroy();
+
+private:
+	void* m_pDisplay = nullptr;
+	void* m_pContext = nullptr;
+
+	bool m_bIsCurrent = false;
+
+private:
+	CHeadlessGLContext( const CHeadlessGLContext& ) = delete;
+	CHeadlessGLContext& operator=( const CHeadlessGLContext& ) = delete;
+};
+
+#endif //TOOLS_BENCH_CHEADLESSGLCONTEXT_H
@@ -0,0 +1,134 @@
+#include <cstdio>
+#include <experimental/filesystem>
+#include <string>
+
+#include "graphics/OpenGL.h"
+
+#include "lib/CLibArgs.h"
+#include "lib/ILibSystem.h"
+#include "lib/LibInterface.h"
+
+#include "utility/PlatUtils.h"
+
+#include "cvar/ICVarSystem.h"
+
+#include "shared/renderer/IRendererLibrary.h"
+#include "shared/renderer/IRenderContext.h"
+#include "shared/renderer/studiomodel/IStudioModelRenderer.h"
+
+#include "CRendererLibraries.h"
+
+CRendererLibraries::CRendererLibraries()
+{
+}
+
+CRendererLibraries::~CRendererLibraries()
+{
+	Unload();
+}
+
+bool CRendererLibraries::Load()
+{
+	Unload();
+
+	bool bSuccess;
+
+	const std::string szExePath = plat::GetExeFileName( &bSuccess );
+
+	if( !bSuccess )
+	{
+		fprintf( stderr, "Couldn't get the executable's filename\n" );
+		return false;
+	}
+
+	const std::string szDirectory = std::experimental::filesystem::path( szExePath ).parent_path().string();
+
+	if( !m_CVarLib.Load( CLibArgs( "CVar" ).Path( szDirectory.c_str() ) ) ||
+		!m_RendererLib.Load( CLibArgs( "Renderer" ).Path( szDirectory.c_str() ) ) )
+	{
+		fprintf( stderr, "Couldn't load the renderer libraries: %s\n", CLibrary::GetLoadErrorDescription() );
+		Unload();
+		return false;
+	}
+
+	//The renderer uses buffer objects, which are loaded by GLEW. See CThumbnailRendererApp::InitOpenGL.
+	glewExperimental = GL_TRUE;
+
+	const GLenum glewResult = glewInit();
+
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+	if( glewResult != GLEW_OK && glewResult != GLEW_ERROR_NO_GLX_DISPLAY )
+#else
+	if( glewResult != GLEW_OK )
+#endif
+	{
+		fprintf( stderr, "Error initializing GLEW: %s\n", reinterpret_cast<const char*>( glewGetErrorString( glewResult ) ) );
+		Unload();
+		return false;
+	}
+
+	const CreateInterfaceFn factories[] =
+	{
+		reinterpret_cast<CreateInterfaceFn>( m_CVarLib.GetFunctionAddress( CREATEINTERFACE_NAME ) ),
+		reinterpret_cast<CreateInterfaceFn>( m_RendererLib.GetFunctionAddress( CREATEINTERFACE_NAME ) )
+	};
+
+	if( !factories[ 0 ] || !factories[ 1 ] )
+	{
+		fprintf( stderr, "The renderer libraries don't export %s\n", CREATEINTERFACE_NAME );
+		Unload();
+		return false;
+	}
+
+	m_pCVar = static_cast<cvar::ICVarSystem*>( factories[ 0 ]( ICVARSYSTEM_NAME, nullptr ) );
+	m_pRendererLib = static_cast<ILibSystem*>( factories[ 1 ]( IRENDERERLIBRARY_NAME, nullptr ) );
+	m_pRenderContext = static_cast<renderer::IRenderContext*>( factories[ 1 ]( IRENDERCONTEXT_NAME, nullptr ) );
+	m_pStudioMdlRenderer = static_cast<studiomdl::IStudioModelRenderer*>( factories[ 1 ]( ISTUDIOMODELRENDERER_NAME, nullptr ) );
+
+	if( !m_pCVar || !m_pRendererLib || !m_pRenderContext || !m_pStudioMdlRenderer )
+	{
+		fprintf( stderr, "Couldn't get the renderer interfaces\n" );
+		Unload();
+		return false;
+	}
+
+	if( !( m_bCVarInitialized = m_pCVar->Initialize() ) ||
+		!( m_bRendererConnected = m_pRendererLib->Connect( factories, sizeof( factories ) / sizeof( factories[ 0 ] ) ) ) ||
+		!( m_bStudioMdlRendererInitialized = m_pStudioMdlRenderer->Initialize() ) )
+	{
+		fprintf( stderr, "Couldn't initialize the renderer\n" );
+		Unload();
+		return false;
+	}
+
+	return true;
+}
+
+void CRendererLibraries::Unload()
+{
+	if( m_bStudioMdlRendererInitialized )
+	{
+		m_pStudioMdlRenderer->Shutdown();
+		m_bStudioMdlRendererInitialized = false;
+	}
+
+	if( m_bRendererConnected )
+	{
+		m_pRendererLib->Disconnect();
+		m_bRendererConnected = false;
+	}
+
+	if( m_bCVarInitialized )
+	{
+		m_pCVar->Shutdown();
+		m_bCVarInitialized = false;
+	}
+
+	m_pStudioMdlRenderer = nullptr;
+	m_pRenderContext = nullptr;
+	m_pRendererLib = nullptr;
+	m_pCVar = nullptr;
+
+	m_RendererLib.Free();
+	m_CVarLib.Free();
+}
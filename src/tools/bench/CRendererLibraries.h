@@ -0,0 +1,64 @@
+#ifndef TOOLS_BENCH_CRENDERERLIBRARIES_H
+#define TOOLS_BENCH_CRENDERERLIBRARIES_H
+
+#include "lib/CLibrary.h"
+
+class ILibSystem;
+
+namespace cvar
+{
+class ICVarSystem;
+}
+
+namespace renderer
+{
+class IRenderContext;
+}
+
+namespace studiomdl
+{
+class IStudioModelRenderer;
+}
+
+/**
+*	Loads the CVar and Renderer libraries from the executable's directory, so the studio model renderer can be benchmarked.
+*	Unlike the tools, the working directory isn't changed, so relative paths given on the command line keep working.
+*/
+class CRendererLibraries final
+{
+public:
+	CRendererLibraries();
+	~CRendererLibraries();
+
+	renderer::IRenderContext* GetRenderContext() const { return m_pRenderContext; }
+
+	studiomdl::IStudioModelRenderer* GetStudioModelRenderer() const { return m_pStudioMdlRenderer; }
+
+	/**
+	*	Loads the libraries and initializes the renderer. An OpenGL context must be current.
+	*	The reason for failures is printed to standard error.
+	*	@return Whether the renderer is ready to use.
+	*/
+	bool Load();
+
+	void Unload();
+
+private:
+	CLibrary m_CVarLib;
+	CLibrary m_RendererLib;
+
+	cvar::ICVarSystem* m_pCVar = nullptr;
+	ILibSystem* m_pRendererLib = nullptr;
+	renderer::IRenderContext* m_pRenderContext = nullptr;
+	studiomdl::IStudioModelRenderer* m_pStudioMdlRenderer = nullptr;
+
+	bool m_bCVarInitialized = false;
+	bool m_bRendererConnected = false;
+	bool m_bStudioMdlRendererInitialized = false;
+
+private:
+	CRendererLibraries( const CRendererLibraries& ) = delete;
+	CRendererLibraries& operator=( const CRendererLibraries& ) = delete;
+};
+
+#endif //TOOLS_BENCH_CRENDERERLIBRARIES_H
@@ -0,0 +1,243 @@
+#include <cstdio>
+#include <cstring>
+#include <experimental/filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "keyvalues/Keyvalues.h"
+
+#include "engine/shared/sprite/CSprite.h"
+
+#include "filesystem/CFileSystem.h"
+
+#include "synthetic/SpriteGenerator.h"
+
+#include "CBenchmarkRunner.h"
+#include "SyntheticData.h"
+
+#include "Benchmarks.h"
+
+namespace fs = std::experimental::filesystem;
+
+namespace bench
+{
+namespace
+{
+/**
+*	Number of search paths added to the filesystem. Files only exist in the last one, which is the worst case.
+*/
+const int NUM_SEARCH_PATHS = 8;
+
+/**
+*	Number of lookups performed by a single repetition. Half of them are for files that don't exist.
+*/
+const int NUM_PATH_LOOKUPS = 64;
+
+const int SPRITE_NUM_FRAMES = 32;
+
+fs::path g_TempDirectory;
+
+bool WriteFile( const fs::path& path, const void* pData, const size_t uiSize )
+{
+	FILE* pFile = fopen( path.string().c_str(), "wb" );
+
+	if( !pFile )
+	{
+		fprintf( stderr, "Couldn't open \"%s\" for writing\n", path.string().c_str() );
+		return false;
+	}
+
+	const bool bSuccess = fwrite( pData, 1, uiSize, pFile ) == uiSize;
+
+	fclose( pFile );
+
+	if( !bSuccess )
+		fprintf( stderr, "Couldn't write \"%s\"\n", path.string().c_str() );
+
+	return bSuccess;
+}
+
+void RegisterKeyvaluesBenchmark( CBenchmarkRunner& runner, CRandom& random )
+{
+	const auto text = std::make_shared<std::string>( GenerateKeyvalues( random, 64, 16, 3 ) );
+
+	//The parser takes ownership of its memory, so every repetition gets a fresh copy.
+	auto memory = std::make_shared<keyvalues::CKeyvaluesLexer::Memory_t>();
+
+	runner.Add( "keyvalues/Parse", text->size(),
+		[ = ]()
+		{
+			keyvalues::CKeyvaluesParser parser( *memory );
+
+			const auto result = parser.Parse();
+
+			Consume( result );
+		},
+		[ = ]()
+		{
+			memory->Init( text->size() );
+			memcpy( memory->GetMemory(), text->data(), text->size() );
+		}
+	);
+}
+
+bool RegisterSpriteBenchmark( CBenchmarkRunner& runner, CRandom& random )
+{
+	synthetic::SpriteSettings_t settings;
+
+	settings.iNumFrames = SPRITE_NUM_FRAMES;
+
+	std::vector<byte> data;
+	std::string szError;
+
+	if( !synthetic::GenerateSprite( random, settings, data, szError ) )
+	{
+		fprintf( stderr, "%s\n", szError.c_str() );
+		return false;
+	}
+
+	const auto path = g_TempDirectory / "synthetic.spr";
+
+	if( !WriteFile( path, data.data(), data.size() ) )
+		return false;
+
+	const auto szFilename = std::make_shared<std::string>( path.string() );
+
+	runner.Add( "sprite/LoadSprite", SPRITE_NUM_FRAMES,
+		[ = ]()
+		{
+			sprite::msprite_t* pSprite = nullptr;
+
+			if( sprite::LoadSprite( szFilename->c_str(), pSprite ) )
+				sprite::FreeSprite( pSprite );
+
+			Consume( pSprite );
+		}
+	);
+
+	return true;
+}
+
+bool RegisterFileSystemBenchmark( CBenchmarkRunner& runner, CRandom& random )
+{
+	auto fileSystem = std::make_shared<filesystem::CFileSystem>();
+
+	fileSystem->SetBasePath( g_TempDirectory.string().c_str() );
+
+	char szName[ 64 ];
+
+	std::error_code error;
+
+	for( int iPath = 0; iPath < NUM_SEARCH_PATHS; ++iPath )
+	{
+		snprintf( szName, sizeof( szName ), "searchpath%d", iPath );
+
+		if( !fs::create_directories( g_TempDirectory / szName / "models", error ) && error )
+		{
+			fprintf( stderr, "Couldn't create search path directory: %s\n", error.message().c_str() );
+			return false;
+		}
+
+		fileSystem->AddSearchPath( szName );
+	}
+
+	auto lookups = std::make_shared<std::vector<std::string>>();
+
+	for( int iLookup = 0; iLookup < NUM_PATH_LOOKUPS; ++iLookup )
+	{
+		snprintf( szName, sizeof( szName ), "models/file%d_%u.mdl", iLookup, random.Next() );
+
+		lookups->push_back( szName );
+
+		if( ( iLookup % 2 ) == 0 )
+		{
+			const auto path = g_TempDirectory / ( "searchpath" + std::to_string( NUM_SEARCH_PATHS - 1 ) ) / szName;
+
+			if( !WriteFile( path, "", 0 ) )
+				return false;
+		}
+	}
+
+	runner.Add( "filesystem/GetRelativePath", NUM_PATH_LOOKUPS,
+		[ = ]()
+		{
+			char szPath[ MAX_PATH_LENGTH ];
+
+			int iFound = 0;
+
+			for( const auto& szLookup : *lookups )
+			{
+				if( fileSystem->GetRelativePath( szLookup.c_str(), szPath, sizeof( szPath ) ) )
+					++iFound;
+			}
+
+			Consume( iFound );
+		}
+	);
+
+	return true;
+}
+}
+
+bool RegisterFileBenchmarks( CBenchmarkRunner& runner, synthetic::CRandom& random, const bool bHasGLContext )
+{
+	std::error_code error;
+
+	const auto tempDirectory = fs::temp_directory_path( error );
+
+	if( error )
+	{
+		fprintf( stderr, "Couldn't get temporary directory: %s\n", error.message().c_str() );
+		return false;
+	}
+
+	g_TempDirectory = tempDirectory / ( "hl_bench_" + std::to_string( runner.GetSettings().uiSeed ) );
+
+	fs::remove_all( g_TempDirectory, error );
+
+	if( !fs::create_directories( g_TempDirectory, error ) )
+	{
+		fprintf( stderr, "Couldn't create temporary directory \"%s\": %s\n", g_TempDirectory.string().c_str(), error.message().c_str() );
+		g_TempDirectory.clear();
+		return false;
+	}
+
+	RegisterKeyvaluesBenchmark( runner, random );
+
+	//Always generate the sprite so the remaining data doesn't depend on whether there is a context.
+	if( bHasGLContext )
+	{
+		if( !RegisterSpriteBenchmark( runner, random ) )
+			return false;
+	}
+	else
+	{
+		synthetic::SpriteSettings_t settings;
+
+		settings.iNumFrames = SPRITE_NUM_FRAMES;
+
+		std::vector<byte> data;
+		std::string szError;
+
+		synthetic::GenerateSprite( random, settings, data, szError );
+
+		fprintf( stderr, "No OpenGL context available, skipping sprite benchmarks\n" );
+	}
+
+	return RegisterFileSystemBenchmark( runner, random );
+}
+
+void CleanupFileBenchmarks()
+{
+	if( g_TempDirectory.empty() )
+		return;
+
+	std::error_code error;
+
+	fs::remove_all( g_TempDirectory, error );
+
+	g_TempDirectory.clear();
+}
+}
@@ -0,0 +1,146 @@
+#include <memory>
+#include <vector>
+
+#include "utility/mathlib.h"
+
+#include "CBenchmarkRunner.h"
+#include "SyntheticData.h"
+
+#include "Benchmarks.h"
+
+namespace bench
+{
+namespace
+{
+/**
+*	Number of operations performed by a single repetition.
+*/
+const size_t MATH_BATCH_SIZE = 4096;
+
+struct MathData_t
+{
+	std::vector<glm::vec3> angles;
+	std::vector<glm::vec4> quaternions1;
+	std::vector<glm::vec4> quaternions2;
+	std::vector<float> fractions;
+	std::vector<glm::vec4> outQuaternions;
+
+	std::vector<glm::mat3x4> matrices1;
+	std::vector<glm::mat3x4> matrices2;
+	std::vector<glm::mat3x4> outMatrices;
+
+	std::vector<glm::vec3> vectors;
+	std::vector<glm::vec3> outVectors;
+};
+
+glm::vec3 RandomAngles( CRandom& random )
+{
+	return glm::vec3( random.Float( -Q_PI, Q_PI ), random.Float( -Q_PI, Q_PI ), random.Float( -Q_PI, Q_PI ) );
+}
+
+glm::mat3x4 RandomTransform( CRandom& random )
+{
+	glm::vec4 q;
+
+	AngleQuaternion( RandomAngles( random ), q );
+
+	glm::mat3x4 matrix;
+
+	QuaternionMatrix( q, matrix );
+
+	matrix[ 0 ][ 3 ] = random.Float( -100, 100 );
+	matrix[ 1 ][ 3 ] = random.Float( -100, 100 );
+	matrix[ 2 ][ 3 ] = random.Float( -100, 100 );
+
+	return matrix;
+}
+}
+
+void RegisterMathBenchmarks( CBenchmarkRunner& runner, synthetic::CRandom& random )
+{
+	auto data = std::make_shared<MathData_t>();
+
+	data->angles.resize( MATH_BATCH_SIZE );
+	data->quaternions1.resize( MATH_BATCH_SIZE );
+	data->quaternions2.resize( MATH_BATCH_SIZE );
+	data->fractions.resize( MATH_BATCH_SIZE );
+	data->outQuaternions.resize( MATH_BATCH_SIZE );
+	data->matrices1.resize( MATH_BATCH_SIZE );
+	data->matrices2.resize( MATH_BATCH_SIZE );
+	data->outMatrices.resize( MATH_BATCH_SIZE );
+	data->vectors.resize( MATH_BATCH_SIZE );
+	data->outVectors.resize( MATH_BATCH_SIZE );
+
+	for( size_t uiIndex = 0; uiIndex < MATH_BATCH_SIZE; ++uiIndex )
+	{
+		data->angles[ uiIndex ] = RandomAngles( random );
+
+		AngleQuaternion( RandomAngles( random ), data->quaternions1[ uiIndex ] );
+		AngleQuaternion( RandomAngles( random ), data->quaternions2[ uiIndex ] );
+
+		data->fractions[ uiIndex ] = random.Float( 0, 1 );
+
+		data->matrices1[ uiIndex ] = RandomTransform( random );
+		data->matrices2[ uiIndex ] = RandomTransform( random );
+
+		data->vectors[ uiIndex ] = glm::vec3( random.Float( -100, 100 ), random.Float( -100, 100 ), random.Float( -100, 100 ) );
+	}
+
+	runner.Add( "mathlib/AngleQuaternion", MATH_BATCH_SIZE,
+		[ = ]()
+		{
+			for( size_t uiIndex = 0; uiIndex < MATH_BATCH_SIZE; ++uiIndex )
+			{
+				AngleQuaternion( data->angles[ uiIndex ], data->outQuaternions[ uiIndex ] );
+			}
+
+			Consume( data->outQuaternions.back() );
+		}
+	);
+
+	//QuaternionSlerp may flip the second quaternion, so it works on a copy that is restored before every repetition.
+	auto slerpTargets = std::make_shared<std::vector<glm::vec4>>();
+
+	runner.Add( "mathlib/QuaternionSlerp", MATH_BATCH_SIZE,
+		[ = ]()
+		{
+			auto& targets = *slerpTargets;
+
+			for( size_t uiIndex = 0; uiIndex < MATH_BATCH_SIZE; ++uiIndex )
+			{
+				QuaternionSlerp( data->quaternions1[ uiIndex ], targets[ uiIndex ], data->fractions[ uiIndex ], data->outQuaternions[ uiIndex ] );
+			}
+
+			Consume( data->outQuaternions.back() );
+		},
+		[ = ]()
+		{
+			*slerpTargets = data->quaternions2;
+		}
+	);
+
+	runner.Add( "mathlib/R_ConcatTransforms", MATH_BATCH_SIZE,
+		[ = ]()
+		{
+			for( size_t uiIndex = 0; uiIndex < MATH_BATCH_SIZE; ++uiIndex )
+			{
+				R_ConcatTransforms( data->matrices1[ uiIndex ], data->matrices2[ uiIndex ], data->outMatrices[ uiIndex ] );
+			}
+
+			Consume( data->outMatrices.back() );
+		}
+	);
+
+	runner.Add( "mathlib/VectorTransform", MATH_BATCH_SIZE,
+		[ = ]()
+		{
+			for( size_t uiIndex = 0; uiIndex < MATH_BATCH_SIZE; ++uiIndex )
+			{
+				VectorTransform( data->vectors[ uiIndex ], data->matrices1[ uiIndex ], data->outVectors[ uiIndex ] );
+			}
+
+			Consume( data->outVectors.back() );
+		}
+	);
+}
+}
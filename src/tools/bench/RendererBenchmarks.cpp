@@ -0,0 +1,359 @@
+#include <cstdio>
+#include <cstdlib>
+#include <experimental/filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "graphics/GraphicsUtils.h"
+#include "graphics/GLRenderTarget.h"
+#include "graphics/OpenGL.h"
+
+#include "shared/studiomodel/CStudioModel.h"
+#include "shared/renderer/IRenderContext.h"
+#include "shared/renderer/studiomodel/CModelRenderInfo.h"
+#include "shared/renderer/studiomodel/CStudioModelPoseCache.h"
+#include "shared/renderer/studiomodel/IStudioModelRenderer.h"
+
+#include "synthetic/StudioModelGenerator.h"
+
+#include "CBenchmarkRunner.h"
+#include "CRendererLibraries.h"
+#include "SyntheticData.h"
+
+#include "Benchmarks.h"
+
+namespace fs = std::experimental::filesystem;
+
+namespace bench
+{
+namespace
+{
+/**
+*	Instances are placed on a square grid with this many instances on each side.
+*/
+const int INSTANCE_GRID_SIZE = 8;
+
+const size_t NUM_INSTANCES = INSTANCE_GRID_SIZE * INSTANCE_GRID_SIZE;
+
+const float INSTANCE_SPACING = 64.0f;
+
+const int RENDER_TARGET_SIZE = 256;
+
+const float SCENE_FOV = 65.0f;
+
+/**
+*	Maximum difference of a color channel for pixels to be considered equal.
+*	Instanced drawing transforms vertices on the CPU instead of using the model view matrix, so rasterization can differ slightly.
+*/
+const int PIXEL_TOLERANCE = 8;
+
+/**
+*	Fraction of pixels that may differ by more than PIXEL_TOLERANCE. These are edge pixels that are covered by a different triangle.
+*/
+const double MAX_DIFFERENT_PIXEL_FRACTION = 0.005;
+
+/**
+*	A grid of instances of a single model, drawn into its own render target.
+*/
+struct InstanceScene_t
+{
+	InstanceScene_t()
+		: renderTarget( true )
+	{
+	}
+
+	~InstanceScene_t()
+	{
+		delete pModel;
+	}
+
+	studiomdl::CStudioModel* pModel = nullptr;
+
+	std::vector<studiomdl::CModelRenderInfo> renderInfos;
+	std::vector<studiomdl::CModelRenderInfo*> renderInfoPtrs;
+
+	std::unique_ptr<studiomdl::CStudioModelPoseCache[]> poseCaches;
+
+	GLRenderTarget renderTarget;
+
+	glm::vec3 vecViewerOrigin;
+	glm::vec3 vecViewerRight;
+	glm::mat4x4 modelView;
+};
+
+/**
+*	Generates a model and places instances of it on a grid, each with its own sequence, frame and angles.
+*	The model is loaded from a temporary file, so it is set up the same way as models loaded by the tools.
+*	@param bUsePoseCaches Whether each instance gets a pose cache, like entities have.
+*	@return The scene, or null if it couldn't be created.
+*/
+std::shared_ptr<InstanceScene_t> CreateInstanceScene( CRandom& random, const bool bUsePoseCaches )
+{
+	synthetic::StudioModelSettings_t settings;
+
+	settings.iNumVerts = 256;
+	settings.iNumTris = 512;
+	settings.iTextureWidth = settings.iTextureHeight = 64;
+
+	synthetic::GeneratedStudioModel_t generated;
+	std::string szError;
+
+	if( !synthetic::GenerateStudioModel( random, settings, generated, szError ) )
+	{
+		fprintf( stderr, "%s\n", szError.c_str() );
+		return nullptr;
+	}
+
+	std::error_code error;
+
+	const auto tempDirectory = fs::temp_directory_path( error );
+
+	if( error )
+	{
+		fprintf( stderr, "Couldn't get temporary directory: %s\n", error.message().c_str() );
+		return nullptr;
+	}
+
+	const std::string szFilename = ( tempDirectory / ( "hl_bench_instances_" + std::to_string( random.Next() ) + ".mdl" ) ).string();
+
+	if( !synthetic::WriteStudioModel( szFilename, generated, szError ) )
+	{
+		fprintf( stderr, "%s\n", szError.c_str() );
+		return nullptr;
+	}
+
+	auto scene = std::make_shared<InstanceScene_t>();
+
+	const auto result = studiomdl::LoadStudioModel( szFilename.c_str(), scene->pModel );
+
+	fs::remove( szFilename, error );
+
+	if( result != studiomdl::StudioModelLoadResult::SUCCESS )
+	{
+		fprintf( stderr, "Couldn't load generated model \"%s\"\n", szFilename.c_str() );
+		return nullptr;
+	}
+
+	scene->renderInfos.resize( NUM_INSTANCES );
+	scene->renderInfoPtrs.resize( NUM_INSTANCES );
+
+	if( bUsePoseCaches )
+		scene->poseCaches.reset( new studiomdl::CStudioModelPoseCache[ NUM_INSTANCES ] );
+
+	const float flGridOffset = ( INSTANCE_GRID_SIZE - 1 ) * INSTANCE_SPACING / 2;
+
+	for( size_t uiIndex = 0; uiIndex < NUM_INSTANCES; ++uiIndex )
+	{
+		auto& renderInfo = scene->renderInfos[ uiIndex ];
+
+		renderInfo.vecOrigin = glm::vec3(
+			( uiIndex % INSTANCE_GRID_SIZE ) * INSTANCE_SPACING - flGridOffset,
+			( uiIndex / INSTANCE_GRID_SIZE ) * INSTANCE_SPACING - flGridOffset,
+			0 );
+		renderInfo.vecAngles = glm::vec3( 0, random.Float( 0, 360 ), 0 );
+		renderInfo.vecScale = glm::vec3( 1, 1, 1 );
+		renderInfo.pModel = scene->pModel;
+		renderInfo.flTransparency = 1;
+		renderInfo.iSequence = random.Int( 0, settings.iNumSequences - 1 );
+		renderInfo.flFrame = random.Float( 0, static_cast<float>( settings.iNumFrames - 1 ) );
+		renderInfo.iBodygroup = 0;
+		renderInfo.iSkin = 0;
+		renderInfo.iBlender[ 0 ] = renderInfo.iBlender[ 1 ] = 0;
+
+		for( auto& controller : renderInfo.iController )
+		{
+			controller = static_cast<byte>( random.Int( 0, 255 ) );
+		}
+
+		renderInfo.iMouth = 0;
+
+		renderInfo.pPoseCache = bUsePoseCaches ? &scene->poseCaches[ uiIndex ] : nullptr;
+
+		scene->renderInfoPtrs[ uiIndex ] = &renderInfo;
+	}
+
+	scene->renderTarget.Setup( RENDER_TARGET_SIZE, RENDER_TARGET_SIZE, true );
+
+	if( scene->renderTarget.GetStatus() != GL_FRAMEBUFFER_COMPLETE )
+	{
+		fprintf( stderr, "Instance scene framebuffer is incomplete: %s\n", glFrameBufferStatusToString( scene->renderTarget.GetStatus() ) );
+		return nullptr;
+	}
+
+	//Look at the grid from above and to the side, so instances overlap.
+	scene->vecViewerOrigin = glm::vec3( 0, -2.5f * flGridOffset, 1.5f * flGridOffset );
+	scene->vecViewerRight = glm::normalize( glm::cross( -scene->vecViewerOrigin, glm::vec3( 0, 0, 1 ) ) );
+	scene->modelView = glm::lookAt( scene->vecViewerOrigin, glm::vec3( 0, 0, 0 ), glm::vec3( 0, 0, 1 ) );
+
+	return scene;
+}
+
+/**
+*	Binds the scene's render target, clears it and sets up the camera and render state.
+*/
+void BeginScene( InstanceScene_t& scene, CRendererLibraries& renderer )
+{
+	scene.renderTarget.Bind();
+
+	glViewport( 0, 0, RENDER_TARGET_SIZE, RENDER_TARGET_SIZE );
+
+	glClearColor( 0, 0, 0, 1 );
+	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+
+	graphics::SetProjection( SCENE_FOV, RENDER_TARGET_SIZE, RENDER_TARGET_SIZE );
+
+	glMatrixMode( GL_MODELVIEW );
+	glLoadMatrixf( glm::value_ptr( scene.modelView ) );
+
+	glShadeModel( GL_SMOOTH );
+
+	auto pRenderContext = renderer.GetRenderContext();
+
+	//Binding the render target and setting up the matrices change state directly.
+	pRenderContext->InvalidateState();
+
+	pRenderContext->SetPolygonMode( renderer::PolygonMode::FILL );
+	pRenderContext->SetTexture2DEnabled( true );
+	pRenderContext->SetCullFaceEnabled( true );
+	pRenderContext->SetCullFace( renderer::CullFace::FRONT );
+	pRenderContext->SetDepthTestEnabled( true );
+
+	auto pStudioMdlRenderer = renderer.GetStudioModelRenderer();
+
+	pStudioMdlRenderer->SetViewerOrigin( scene.vecViewerOrigin );
+	pStudioMdlRenderer->SetViewerRight( scene.vecViewerRight );
+}
+
+unsigned int DrawSeparately( InstanceScene_t& scene, CRendererLibraries& renderer )
+{
+	unsigned int uiDrawnPolys = 0;
+
+	for( auto pRenderInfo : scene.renderInfoPtrs )
+	{
+		uiDrawnPolys += renderer.GetStudioModelRenderer()->DrawModel( pRenderInfo );
+	}
+
+	return uiDrawnPolys;
+}
+
+unsigned int DrawInstanced( InstanceScene_t& scene, CRendererLibraries& renderer )
+{
+	return renderer.GetStudioModelRenderer()->DrawModelInstances( scene.renderInfoPtrs.data(), scene.renderInfoPtrs.size() );
+}
+
+void ReadPixels( InstanceScene_t& scene, std::vector<byte>& pixels )
+{
+	pixels.resize( RENDER_TARGET_SIZE * RENDER_TARGET_SIZE * 4 );
+
+	scene.renderTarget.GetPixels( RENDER_TARGET_SIZE, RENDER_TARGET_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data() );
+}
+}
+
+bool VerifyInstancedDrawing( CRendererLibraries& renderer, synthetic::CRandom& random )
+{
+	//Without pose caches both paths pose, skin and light every instance themselves.
+	auto scene = CreateInstanceScene( random, false );
+
+	if( !scene )
+		return false;
+
+	std::vector<byte> expected;
+	std::vector<byte> actual;
+
+	BeginScene( *scene, renderer );
+	const unsigned int uiExpectedPolys = DrawSeparately( *scene, renderer );
+	ReadPixels( *scene, expected );
+
+	BeginScene( *scene, renderer );
+	const unsigned int uiActualPolys = DrawInstanced( *scene, renderer );
+	ReadPixels( *scene, actual );
+
+	scene->renderTarget.Unbind();
+
+	bool bSuccess = true;
+
+	if( uiActualPolys != uiExpectedPolys )
+	{
+		fprintf( stderr, "Instanced drawing drew %u polygons, drawing models separately drew %u\n", uiActualPolys, uiExpectedPolys );
+		bSuccess = false;
+	}
+
+	size_t uiCovered = 0;
+	size_t uiDifferent = 0;
+
+	for( size_t uiPixel = 0; uiPixel < expected.size(); uiPixel += 4 )
+	{
+		bool bCovered = false;
+		bool bDifferent = false;
+
+		for( size_t uiChannel = 0; uiChannel < 3; ++uiChannel )
+		{
+			bCovered = bCovered || expected[ uiPixel + uiChannel ] != 0 || actual[ uiPixel + uiChannel ] != 0;
+			bDifferent = bDifferent || abs( expected[ uiPixel + uiChannel ] - actual[ uiPixel + uiChannel ] ) > PIXEL_TOLERANCE;
+		}
+
+		if( bCovered )
+			++uiCovered;
+
+		if( bDifferent )
+			++uiDifferent;
+	}
+
+	//An empty image would match trivially.
+	if( uiCovered == 0 )
+	{
+		fprintf( stderr, "Instanced drawing check rendered nothing\n" );
+		bSuccess = false;
+	}
+
+	const size_t uiNumPixels = expected.size() / 4;
+
+	if( uiDifferent > uiNumPixels * MAX_DIFFERENT_PIXEL_FRACTION )
+	{
+		fprintf( stderr, "Instanced drawing differs from drawing models separately in %u of %u pixels\n",
+				 static_cast<unsigned int>( uiDifferent ), static_cast<unsigned int>( uiNumPixels ) );
+		bSuccess = false;
+	}
+
+	return bSuccess;
+}
+
+bool RegisterRendererBenchmarks( CBenchmarkRunner& runner, synthetic::CRandom& random, CRendererLibraries& renderer )
+{
+	//Instances keep their pose between repetitions, so this measures what batching saves when nothing animates.
+	auto scene = CreateInstanceScene( random, true );
+
+	if( !scene )
+		return false;
+
+	auto pRenderer = &renderer;
+
+	//glFinish includes the time the driver spends on the draw calls.
+	runner.Add( "renderer/DrawModel_Grid", NUM_INSTANCES,
+		[ = ]()
+		{
+			BeginScene( *scene, *pRenderer );
+			Consume( DrawSeparately( *scene, *pRenderer ) );
+			glFinish();
+		}
+	);
+
+	runner.Add( "renderer/DrawModelInstances_Grid", NUM_INSTANCES,
+		[ = ]()
+		{
+			BeginScene( *scene, *pRenderer );
+			Consume( DrawInstanced( *scene, *pRenderer ) );
+			glFinish();
+		}
+	);
+
+	return true;
+}
+}
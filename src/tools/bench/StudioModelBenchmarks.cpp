@@ -0,0 +1,601 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "graphics/Palette.h"
+
+#include "shared/studiomodel/CStudioModel.h"
+#include "shared/studiomodel/StudioPose.h"
+#include "shared/studiomodel/StudioEvents.h"
+#include "shared/studiomodel/StudioSkinning.h"
+#include "shared/studiomodel/StudioModelValidation.h"
+
+#include "synthetic/StudioModelGenerator.h"
+
+#include "CBenchmarkRunner.h"
+#include "SyntheticData.h"
+
+#include "Benchmarks.h"
+
+namespace bench
+{
+namespace
+{
+const int SKELETON_NUM_BONES = 64;
+const int SKELETON_NUM_FRAMES = 30;
+const int SKELETON_NUM_BLENDS = 2;
+
+/**
+*	Number of poses calculated by a single repetition.
+*/
+const size_t POSE_BATCH_SIZE = 64;
+
+/**
+*	Number of vertices transformed by a single repetition. Matches MAXSTUDIOVERTS.
+*/
+const size_t VERTEX_BATCH_SIZE = 2048;
+
+struct TextureData_t
+{
+	mstudiotexture_t texture;
+	std::vector<byte> pixels;
+	byte palette[ PALETTE_SIZE ];
+
+	int iOutWidth;
+	int iOutHeight;
+	std::vector<byte> rgba;
+};
+
+struct PoseData_t
+{
+	std::vector<byte> model;
+
+	vec_t adj[ MAXSTUDIOCONTROLLERS ];
+
+	struct Pose_t
+	{
+		float flFrame;
+		byte blender[ 2 ];
+	};
+
+	std::vector<Pose_t> poses;
+
+	studiomdl::SequenceChannels_t channels;
+
+	glm::mat3x4 boneTransforms[ MAXSTUDIOBONES ];
+
+	std::vector<glm::vec3> verts;
+	std::vector<byte> vertBones;
+	std::vector<glm::vec3> outVerts;
+
+	studiomdl::LightingParams_t lighting;
+
+	glm::vec3 boneLightVectors[ MAXSTUDIOBONES ];
+	glm::vec3 chromeUp[ MAXSTUDIOBONES ];
+	glm::vec3 chromeRight[ MAXSTUDIOBONES ];
+
+	std::vector<glm::vec3> norms;
+	std::vector<glm::vec3> outLight;
+	std::vector<glm::vec2> outChrome;
+
+	const studiohdr_t& GetHeader() const { return *reinterpret_cast<const studiohdr_t*>( model.data() ); }
+
+	const mstudioanim_t* GetAnim() const
+	{
+		//The skeleton's only sequence is stored in the model itself.
+		return reinterpret_cast<const mstudioanim_t*>( model.data() + GetHeader().GetSequence( 0 )->animindex );
+	}
+};
+
+std::shared_ptr<TextureData_t> CreateTextureData( CRandom& random, const int iWidth, const int iHeight, const int iOutWidth, const int iOutHeight, const int iFlags )
+{
+	auto data = std::make_shared<TextureData_t>();
+
+	memset( &data->texture, 0, sizeof( data->texture ) );
+
+	strcpy( data->texture.name, "synthetic.bmp" );
+	data->texture.flags = iFlags;
+	data->texture.width = iWidth;
+	data->texture.height = iHeight;
+
+	data->pixels.resize( iWidth * iHeight );
+
+	for( auto& pixel : data->pixels )
+	{
+		pixel = static_cast<byte>( random.Next() );
+	}
+
+	for( auto& value : data->palette )
+	{
+		value = static_cast<byte>( random.Next() );
+	}
+
+	data->iOutWidth = iOutWidth;
+	data->iOutHeight = iOutHeight;
+	data->rgba.resize( iOutWidth * iOutHeight * 4 );
+
+	return data;
+}
+
+void AddTextureBenchmark( CBenchmarkRunner& runner, const char* const pszName, std::shared_ptr<TextureData_t> data )
+{
+	runner.Add( pszName, data->iOutWidth * data->iOutHeight,
+		[ = ]()
+		{
+			studiomdl::ConvertTextureToRGBA( data->texture, data->pixels.data(), data->palette, data->iOutWidth, data->iOutHeight, data->rgba.data() );
+
+			Consume( data->rgba.back() );
+		}
+	);
+}
+std::shared_ptr<PoseData_t> CreatePoseData( CRandom& random, const float flAnimatedChannelFraction )
+{
+	auto data = std::make_shared<PoseData_t>();
+
+	{
+		//Only the skeleton and a single sequence are needed.
+		synthetic::StudioModelSettings_t settings;
+
+		settings.iNumBones = SKELETON_NUM_BONES;
+		settings.iNumAttachments = 0;
+		settings.bHitboxes = false;
+		settings.iNumBodyParts = 0;
+		settings.iNumTextures = 1;
+		settings.iTextureWidth = settings.iTextureHeight = 8;
+		settings.iNumSequences = 1;
+		settings.iNumFrames = SKELETON_NUM_FRAMES;
+		settings.iNumBlends = SKELETON_NUM_BLENDS;
+		settings.iNumEvents = 0;
+		settings.flAnimatedChannelFraction = flAnimatedChannelFraction;
+
+		synthetic::GeneratedStudioModel_t model;
+		std::string szError;
+
+		if( !synthetic::GenerateStudioModel( random, settings, model, szError ) )
+		{
+			fprintf( stderr, "%s\n", szError.c_str() );
+			exit( EXIT_FAILURE );
+		}
+
+		//Like models loaded for rendering.
+		model.model.resize( model.model.size() + studiomdl::STUDIO_FILE_PADDING, 0 );
+
+		data->model = std::move( model.model );
+	}
+
+	const byte controllers[ STUDIO_MAX_CONTROLLERS ] = { 64, 0, 0, 0 };
+
+	studiomdl::CalcBoneAdj( data->GetHeader(), controllers, 32, data->adj );
+
+	studiomdl::BuildSequenceChannels( data->GetHeader(), *data->GetHeader().GetSequence( 0 ), data->GetAnim(), data->channels );
+
+	data->poses.resize( POSE_BATCH_SIZE );
+
+	for( auto& pose : data->poses )
+	{
+		pose.flFrame = random.Float( 0, SKELETON_NUM_FRAMES - 1 );
+		pose.blender[ 0 ] = static_cast<byte>( random.Int( 0, 255 ) );
+		pose.blender[ 1 ] = static_cast<byte>( random.Int( 0, 255 ) );
+	}
+
+	return data;
+}
+
+/**
+*	Adds benchmarks that calculate poses with and without the sequence channel analysis.
+*/
+void AddPoseBenchmarks( CBenchmarkRunner& runner, const char* const pszName, const std::shared_ptr<PoseData_t>& data )
+{
+	runner.Add( pszName, POSE_BATCH_SIZE,
+		[ = ]()
+		{
+			const auto& header = data->GetHeader();
+			const auto& seqdesc = *header.GetSequence( 0 );
+			const auto pAnim = data->GetAnim();
+
+			for( const auto& pose : data->poses )
+			{
+				studiomdl::SetUpBoneTransforms( header, seqdesc, pAnim, pose.flFrame, pose.blender, data->adj, data->boneTransforms );
+			}
+
+			Consume( data->boneTransforms[ SKELETON_NUM_BONES - 1 ] );
+		}
+	);
+
+	const std::string szChannelsName = std::string( pszName ) + "/Channels";
+
+	runner.Add( szChannelsName.c_str(), POSE_BATCH_SIZE,
+		[ = ]()
+		{
+			const auto& header = data->GetHeader();
+			const auto& seqdesc = *header.GetSequence( 0 );
+			const auto pAnim = data->GetAnim();
+
+			for( const auto& pose : data->poses )
+			{
+				studiomdl::SetUpBoneTransforms( header, seqdesc, pAnim, pose.flFrame, pose.blender, data->adj, data->channels, data->boneTransforms );
+			}
+
+			Consume( data->boneTransforms[ SKELETON_NUM_BONES - 1 ] );
+		}
+	);
+}
+}
+
+void RegisterStudioModelBenchmarks( CBenchmarkRunner& runner, synthetic::CRandom& random )
+{
+	AddTextureBenchmark( runner, "studiomodel/ConvertTextureToRGBA", CreateTextureData( random, 256, 256, 256, 256, 0 ) );
+	AddTextureBenchmark( runner, "studiomodel/ConvertTextureToRGBA_MaskedResample", CreateTextureData( random, 320, 200, 256, 256, STUDIO_NF_MASKED ) );
+
+	auto data = CreatePoseData( random, synthetic::StudioModelSettings_t().flAnimatedChannelFraction );
+
+	AddPoseBenchmarks( runner, "studiomodel/SetUpBoneTransforms", data );
+
+	//Most channels and many bones are static, like a gesture that only moves the arms.
+	AddPoseBenchmarks( runner, "studiomodel/SetUpBoneTransforms_PartialBody", CreatePoseData( random, 0.1f ) );
+
+	//Transform vertices using the last pose.
+	{
+		const auto& header = data->GetHeader();
+
+		studiomdl::SetUpBoneTransforms( header, *header.GetSequence( 0 ), data->GetAnim(),
+										data->poses.back().flFrame, data->poses.back().blender, data->adj, data->boneTransforms );
+	}
+
+	data->verts.resize( VERTEX_BATCH_SIZE );
+	data->vertBones.resize( VERTEX_BATCH_SIZE );
+	data->outVerts.resize( VERTEX_BATCH_SIZE );
+
+	for( size_t uiIndex = 0; uiIndex < VERTEX_BATCH_SIZE; ++uiIndex )
+	{
+		data->verts[ uiIndex ] = glm::vec3( random.Float( -64, 64 ), random.Float( -64, 64 ), random.Float( 0, 72 ) );
+		//Vertices are usually sorted by bone.
+		data->vertBones[ uiIndex ] = static_cast<byte>( ( uiIndex * SKELETON_NUM_BONES ) / VERTEX_BATCH_SIZE );
+	}
+
+	runner.Add( "studiomodel/TransformVertices", VERTEX_BATCH_SIZE,
+		[ = ]()
+		{
+			studiomdl::TransformVertices( data->verts.data(), data->vertBones.data(), static_cast<int>( VERTEX_BATCH_SIZE ),
+										  data->boneTransforms, data->outVerts.data() );
+
+			Consume( data->outVerts.back() );
+		}
+	);
+
+	//Light and chrome map the vertices as if they were normals, using the last pose.
+	data->lighting.flAmbient = 32 / 255.0f;
+	data->lighting.flShade = 192 / 255.0f;
+	data->lighting.flLambert = 1.5f;
+
+	for( int iBone = 0; iBone < SKELETON_NUM_BONES; ++iBone )
+	{
+		VectorIRotate( glm::vec3( 0, 0, -1 ), data->boneTransforms[ iBone ], data->boneLightVectors[ iBone ] );
+	}
+
+	studiomdl::SetupChromeVectors( SKELETON_NUM_BONES, data->boneTransforms, glm::vec3( -100, 0, 36 ), glm::vec3( 0, -1, 0 ),
+								   data->chromeUp, data->chromeRight );
+
+	data->norms.resize( VERTEX_BATCH_SIZE );
+	data->outLight.resize( VERTEX_BATCH_SIZE );
+	data->outChrome.resize( VERTEX_BATCH_SIZE );
+
+	for( size_t uiIndex = 0; uiIndex < VERTEX_BATCH_SIZE; ++uiIndex )
+	{
+		data->norms[ uiIndex ] = data->verts[ uiIndex ];
+		VectorNormalize( data->norms[ uiIndex ] );
+	}
+
+	for( int iKernel = 0; iKernel < static_cast<int>( studiomdl::SkinningKernel::COUNT ); ++iKernel )
+	{
+		const auto kernel = static_cast<studiomdl::SkinningKernel>( iKernel );
+
+		if( !studiomdl::IsSkinningKernelSupported( kernel ) )
+			continue;
+
+		const std::string szName = std::string( "studiomodel/TransformVertices/" ) + studiomdl::SkinningKernelToString( kernel );
+
+		runner.Add( szName.c_str(), VERTEX_BATCH_SIZE,
+			[ = ]()
+			{
+				studiomdl::TransformVertices( kernel, data->verts.data(), data->vertBones.data(), static_cast<int>( VERTEX_BATCH_SIZE ),
+											  data->boneTransforms, data->outVerts.data() );
+
+				Consume( data->outVerts.back() );
+			}
+		);
+
+		const std::string szLightName = std::string( "studiomodel/LightNormals/" ) + studiomdl::SkinningKernelToString( kernel );
+
+		runner.Add( szLightName.c_str(), VERTEX_BATCH_SIZE,
+			[ = ]()
+			{
+				studiomdl::LightNormals( kernel, data->lighting, data->norms.data(), data->vertBones.data(), static_cast<int>( VERTEX_BATCH_SIZE ),
+										 data->boneLightVectors, data->outLight.data() );
+
+				Consume( data->outLight.back() );
+			}
+		);
+
+		const std::string szChromeName = std::string( "studiomodel/ComputeChrome/" ) + studiomdl::SkinningKernelToString( kernel );
+
+		runner.Add( szChromeName.c_str(), VERTEX_BATCH_SIZE,
+			[ = ]()
+			{
+				studiomdl::ComputeChrome( kernel, data->norms.data(), data->vertBones.data(), static_cast<int>( VERTEX_BATCH_SIZE ),
+										  data->chromeUp, data->chromeRight, data->outChrome.data() );
+
+				Consume( data->outChrome.back() );
+			}
+		);
+	}
+}
+
+bool VerifySkinningKernels( synthetic::CRandom& random )
+{
+	//Relative to the magnitude of the result. A few units in the last place.
+	const float TOLERANCE = 1e-6f;
+
+	std::vector<glm::mat3x4> boneTransforms( MAXSTUDIOBONES );
+
+	for( auto& matrix : boneTransforms )
+	{
+		for( int iRow = 0; iRow < 3; ++iRow )
+		{
+			for( int iColumn = 0; iColumn < 3; ++iColumn )
+			{
+				matrix[ iRow ][ iColumn ] = random.Float( -1, 1 );
+			}
+
+			matrix[ iRow ][ 3 ] = random.Float( -128, 128 );
+		}
+	}
+
+	studiomdl::LightingParams_t lighting;
+
+	lighting.flAmbient = 32 / 255.0f;
+	lighting.flShade = 192 / 255.0f;
+	lighting.flLambert = 1.5f;
+	lighting.vecLightColor = glm::vec3( 1.0f, 0.75f, 0.5f );
+
+	std::vector<glm::vec3> boneLightVectors( MAXSTUDIOBONES );
+	std::vector<glm::vec3> chromeUp( MAXSTUDIOBONES );
+	std::vector<glm::vec3> chromeRight( MAXSTUDIOBONES );
+
+	for( int iBone = 0; iBone < MAXSTUDIOBONES; ++iBone )
+	{
+		VectorIRotate( glm::vec3( 0, 0, -1 ), boneTransforms[ iBone ], boneLightVectors[ iBone ] );
+	}
+
+	studiomdl::SetupChromeVectors( MAXSTUDIOBONES, boneTransforms.data(), glm::vec3( -100, 0, 36 ), glm::vec3( 0, -1, 0 ),
+								   chromeUp.data(), chromeRight.data() );
+
+	bool bSuccess = true;
+
+	//Odd counts and short runs exercise the remainder handling of the wide kernels.
+	const int vertexCounts[] = { 0, 1, 2, 3, 7, 64, 255, static_cast<int>( VERTEX_BATCH_SIZE ) };
+
+	for( const auto iNumVerts : vertexCounts )
+	{
+		for( int iSorted = 0; iSorted < 2; ++iSorted )
+		{
+			std::vector<glm::vec3> verts( iNumVerts );
+			std::vector<byte> vertBones( iNumVerts );
+
+			for( int i = 0; i < iNumVerts; ++i )
+			{
+				verts[ i ] = glm::vec3( random.Float( -64, 64 ), random.Float( -64, 64 ), random.Float( 0, 72 ) );
+				vertBones[ i ] = static_cast<byte>( iSorted ? ( i * SKELETON_NUM_BONES ) / iNumVerts : random.Int( 0, MAXSTUDIOBONES - 1 ) );
+			}
+
+			std::vector<glm::vec3> norms( verts );
+
+			for( auto& norm : norms )
+			{
+				VectorNormalize( norm );
+			}
+
+			std::vector<glm::vec3> expected( iNumVerts );
+			std::vector<glm::vec3> expectedLight( iNumVerts );
+			std::vector<glm::vec2> expectedChrome( iNumVerts );
+
+			studiomdl::TransformVertices( studiomdl::SkinningKernel::SCALAR, verts.data(), vertBones.data(), iNumVerts,
+										  boneTransforms.data(), expected.data() );
+
+			studiomdl::LightNormals( studiomdl::SkinningKernel::SCALAR, lighting, norms.data(), vertBones.data(), iNumVerts,
+									 boneLightVectors.data(), expectedLight.data() );
+
+			studiomdl::ComputeChrome( studiomdl::SkinningKernel::SCALAR, norms.data(), vertBones.data(), iNumVerts,
+									  chromeUp.data(), chromeRight.data(), expectedChrome.data() );
+
+			for( int iKernel = 1; iKernel < static_cast<int>( studiomdl::SkinningKernel::COUNT ); ++iKernel )
+			{
+				const auto kernel = static_cast<studiomdl::SkinningKernel>( iKernel );
+
+				if( !studiomdl::IsSkinningKernelSupported( kernel ) )
+					continue;
+
+				const bool bExact = kernel == studiomdl::SkinningKernel::SSE;
+
+				std::vector<glm::vec3> actual( iNumVerts, glm::vec3( NAN ) );
+
+				studiomdl::TransformVertices( kernel, verts.data(), vertBones.data(), iNumVerts,
+											  boneTransforms.data(), actual.data() );
+
+				for( int i = 0; i < iNumVerts; ++i )
+				{
+					for( int iAxis = 0; iAxis < 3; ++iAxis )
+					{
+						const float flExpected = expected[ i ][ iAxis ];
+						const float flActual = actual[ i ][ iAxis ];
+
+						const bool bMatches = bExact ?
+							flActual == flExpected :
+							std::fabs( flActual - flExpected ) <= TOLERANCE * std::max( 1.0f, std::fabs( flExpected ) );
+
+						if( !bMatches )
+						{
+							fprintf( stderr, "Skinning kernel \"%s\" mismatch at vertex %d of %d (%s bones): expected %.9g, got %.9g\n",
+									 studiomdl::SkinningKernelToString( kernel ), i, iNumVerts, iSorted ? "sorted" : "random",
+									 flExpected, flActual );
+
+							bSuccess = false;
+
+							//One report per kernel and batch is enough.
+							i = iNumVerts;
+							break;
+						}
+					}
+				}
+
+				//Lighting and chrome don't use fused multiply-add, so all kernels must match exactly.
+				std::vector<glm::vec3> actualLight( iNumVerts, glm::vec3( NAN ) );
+				std::vector<glm::vec2> actualChrome( iNumVerts, glm::vec2( NAN ) );
+
+				studiomdl::LightNormals( kernel, lighting, norms.data(), vertBones.data(), iNumVerts,
+										 boneLightVectors.data(), actualLight.data() );
+
+				studiomdl::ComputeChrome( kernel, norms.data(), vertBones.data(), iNumVerts,
+										  chromeUp.data(), chromeRight.data(), actualChrome.data() );
+
+				for( int i = 0; i < iNumVerts; ++i )
+				{
+					if( actualLight[ i ] != expectedLight[ i ] || actualChrome[ i ] != expectedChrome[ i ] )
+					{
+						fprintf( stderr, "Lighting kernel \"%s\" mismatch at normal %d of %d (%s bones)\n",
+								 studiomdl::SkinningKernelToString( kernel ), i, iNumVerts, iSorted ? "sorted" : "random" );
+
+						bSuccess = false;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	return bSuccess;
+}
+
+namespace
+{
+/**
+*	Finds events the way CStudioModelEntity::GetAnimationEvent did before events were indexed.
+*	@return Indices of the matching events, in file order.
+*/
+std::vector<int> FindSequenceEventsLinear( const mstudioseqdesc_t& seqdesc, const mstudioevent_t* pevent, const bool bAllowClientEvents,
+										   float flStart, float flEnd )
+{
+	std::vector<int> events;
+
+	if( seqdesc.numevents == 0 )
+		return events;
+
+	if( seqdesc.numframes <= 1 )
+	{
+		flStart = 0;
+		flEnd = 1.0;
+	}
+
+	for( int index = 0; index < seqdesc.numevents; ++index )
+	{
+		if( !bAllowClientEvents && pevent[ index ].event >= studiomdl::STUDIO_FIRST_CLIENT_EVENT )
+			continue;
+
+		if( ( pevent[ index ].frame >= flStart && pevent[ index ].frame < flEnd ) ||
+			( ( seqdesc.flags & STUDIO_LOOPING ) && flEnd >= seqdesc.numframes - 1 && pevent[ index ].frame < flEnd - seqdesc.numframes + 1 ) )
+		{
+			events.push_back( index );
+		}
+	}
+
+	return events;
+}
+}
+
+bool VerifyAnimationEventIndex( synthetic::CRandom& random, const int iNumCases )
+{
+	const int MAX_EVENTS = 16;
+
+	std::vector<byte> data( sizeof( studiohdr_t ) + MAX_EVENTS * sizeof( mstudioevent_t ) );
+
+	auto pStudioHdr = reinterpret_cast<studiohdr_t*>( data.data() );
+	auto pevent = reinterpret_cast<mstudioevent_t*>( data.data() + sizeof( studiohdr_t ) );
+
+	mstudioseqdesc_t seqdesc;
+
+	memset( &seqdesc, 0, sizeof( seqdesc ) );
+
+	seqdesc.eventindex = sizeof( studiohdr_t );
+
+	studiomdl::SequenceEvents_t events;
+
+	for( int iCase = 0; iCase < iNumCases; ++iCase )
+	{
+		seqdesc.numframes = random.Int( 1, 40 );
+		seqdesc.flags = random.Int( 0, 1 ) ? STUDIO_LOOPING : 0;
+		seqdesc.numevents = random.Int( 0, MAX_EVENTS );
+
+		for( int i = 0; i < seqdesc.numevents; ++i )
+		{
+			//Few distinct frames so events often share a frame, and some outside the sequence.
+			pevent[ i ].frame = random.Int( -1, seqdesc.numframes );
+			pevent[ i ].event = random.Int( 0, 1 ) ? random.Int( 1000, 1010 ) : studiomdl::STUDIO_FIRST_CLIENT_EVENT + random.Int( 0, 10 );
+		}
+
+		studiomdl::BuildSequenceEvents( *pStudioHdr, seqdesc, events );
+
+		//Whole frames hit the boundaries of the range exactly.
+		float flStart = random.Float( 0, static_cast<float>( seqdesc.numframes ) );
+		float flEnd = flStart + random.Float( 0, 2 );
+
+		if( random.Int( 0, 3 ) == 0 )
+		{
+			flStart = std::floor( flStart );
+			flEnd = std::floor( flEnd );
+		}
+
+		const bool bAllowClientEvents = random.Int( 0, 1 ) != 0;
+
+		const auto expected = FindSequenceEventsLinear( seqdesc, pevent, bAllowClientEvents, flStart, flEnd );
+
+		studiomdl::EventRange_t ranges[ 2 ];
+
+		const int iNumRanges = studiomdl::FindSequenceEvents( seqdesc, events, bAllowClientEvents, flStart, flEnd, ranges );
+
+		std::vector<int> actual;
+
+		bool bOrdered = true;
+
+		for( int iRange = 0; iRange < iNumRanges; ++iRange )
+		{
+			for( auto pEntry = ranges[ iRange ].pBegin; pEntry != ranges[ iRange ].pEnd; ++pEntry )
+			{
+				if( pEntry != ranges[ iRange ].pBegin && pEntry[ -1 ].iFrame > pEntry->iFrame )
+					bOrdered = false;
+
+				actual.push_back( pEntry->iEvent );
+			}
+		}
+
+		//Events are returned in frame order, the old scan returned them in file order.
+		std::sort( actual.begin(), actual.end() );
+
+		if( !bOrdered || actual != expected )
+		{
+			fprintf( stderr, "Animation event index mismatch: %d frames, %s, %d events, range [%.9g, %.9g), %s: expected %u events, got %u%s\n",
+					 seqdesc.numframes, ( seqdesc.flags & STUDIO_LOOPING ) ? "looping" : "not looping", seqdesc.numevents,
+					 flStart, flEnd, bAllowClientEvents ? "client events" : "server events",
+					 static_cast<unsigned int>( expected.size() ), static_cast<unsigned int>( actual.size() ),
+					 bOrdered ? "" : ", not in frame order" );
+
+			return false;
+		}
+	}
+
+	return true;
+}
+}
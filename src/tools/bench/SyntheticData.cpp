@@ -0,0 +1,54 @@
+#include <cstdio>
+
+#include "SyntheticData.h"
+
+namespace bench
+{
+namespace
+{
+void AppendKeyvaluesBlock( CRandom& random, std::string& szText, const char* const pszName, const int iKeysPerBlock, const int iDepth, const int iIndent )
+{
+	const std::string szIndent( iIndent, '\t' );
+
+	szText += szIndent + '"' + pszName + "\"\n" + szIndent + "{\n";
+
+	char szLine[ 256 ];
+
+	for( int iKey = 0; iKey < iKeysPerBlock; ++iKey )
+	{
+		if( random.Int( 0, 1 ) )
+		{
+			snprintf( szLine, sizeof( szLine ), "%s\t\"key%d\" \"%d\"\n", szIndent.c_str(), iKey, random.Int( -100000, 100000 ) );
+		}
+		else
+		{
+			snprintf( szLine, sizeof( szLine ), "%s\t\"key%d\" \"%.4f %.4f %.4f\"\n", szIndent.c_str(), iKey,
+					  random.Float( -1000, 1000 ), random.Float( -1000, 1000 ), random.Float( -1000, 1000 ) );
+		}
+
+		szText += szLine;
+	}
+
+	if( iDepth > 0 )
+		AppendKeyvaluesBlock( random, szText, "child", iKeysPerBlock, iDepth - 1, iIndent + 1 );
+
+	szText += szIndent + "}\n";
+}
+}
+
+std::string GenerateKeyvalues( CRandom& random, const int iNumBlocks, const int iKeysPerBlock, const int iDepth )
+{
+	std::string szText;
+
+	char szName[ 32 ];
+
+	for( int iBlock = 0; iBlock < iNumBlocks; ++iBlock )
+	{
+		snprintf( szName, sizeof( szName ), "block%d", iBlock );
+
+		AppendKeyvaluesBlock( random, szText, szName, iKeysPerBlock, iDepth, 0 );
+	}
+
+	return szText;
+}
+}
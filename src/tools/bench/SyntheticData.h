@@ -0,0 +1,22 @@
+#ifndef TOOLS_BENCH_SYNTHETICDATA_H
+#define TOOLS_BENCH_SYNTHETICDATA_H
+
+#include <string>
+
+#include "synthetic/CRandom.h"
+
+namespace bench
+{
+using synthetic::CRandom;
+
+/**
+*	Generates a keyvalues text file.
+*	@param random Random number generator.
+*	@param iNumBlocks Number of blocks in the root.
+*	@param iKeysPerBlock Number of keys in each block.
+*	@param iDepth Depth of nested blocks inside of each root block.
+*/
+std::string GenerateKeyvalues( CRandom& random, const int iNumBlocks, const int iKeysPerBlock, const int iDepth );
+}
+
+#endif //TOOLS_BENCH_SYNTHETICDATA_H
@@ -0,0 +1,223 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "CBenchmarkRunner.h"
+#include "CHeadlessGLContext.h"
+#include "CRendererLibraries.h"
+#include "SyntheticData.h"
+
+#include "Benchmarks.h"
+
+namespace
+{
+void PrintUsage( const char* const pszProgram )
+{
+	printf(
+		"Usage: %s [options]\n"
+		"Runs micro benchmarks on synthetic data and writes the timings as JSON.\n"
+		"\n"
+		"Options:\n"
+		"  --seed <value>         Seed used to generate benchmark data (default %u)\n"
+		"  --repetitions <count>  Number of measured repetitions of each benchmark (default %d)\n"
+		"  --warmup <count>       Number of repetitions before measuring warm benchmarks (default %d)\n"
+		"  --filter <text>        Only run benchmarks whose name contains this text\n"
+		"  --warm-only            Only run benchmarks with warm caches\n"
+		"  --cold-only            Only run benchmarks with cold caches\n"
+		"  --output <file>        Write results to this file instead of standard output\n"
+		"  --list                 List all benchmarks and exit\n"
+		"\n"
+		"Progress is printed to standard error.\n",
+		pszProgram,
+		bench::BenchmarkSettings_t::DEFAULT_SEED,
+		bench::BenchmarkSettings_t().iRepetitions,
+		bench::BenchmarkSettings_t().iWarmupRepetitions );
+}
+}
+
+int main( int iArgc, char* pszArgV[] )
+{
+	bench::BenchmarkSettings_t settings;
+
+	const char* pszOutput = nullptr;
+
+	bool bList = false;
+
+	for( int iArg = 1; iArg < iArgc; ++iArg )
+	{
+		const char* const pszArg = pszArgV[ iArg ];
+
+		const bool bHasValue = iArg + 1 < iArgc;
+
+		if( !strcmp( pszArg, "--help" ) || !strcmp( pszArg, "-h" ) )
+		{
+			PrintUsage( pszArgV[ 0 ] );
+			return EXIT_SUCCESS;
+		}
+		else if( !strcmp( pszArg, "--seed" ) && bHasValue )
+		{
+			settings.uiSeed = static_cast<uint32_t>( strtoul( pszArgV[ ++iArg ], nullptr, 0 ) );
+		}
+		else if( !strcmp( pszArg, "--repetitions" ) && bHasValue )
+		{
+			settings.iRepetitions = atoi( pszArgV[ ++iArg ] );
+
+			if( settings.iRepetitions <= 0 )
+			{
+				fprintf( stderr, "The number of repetitions must be positive\n" );
+				return 2;
+			}
+		}
+		else if( !strcmp( pszArg, "--warmup" ) && bHasValue )
+		{
+			settings.iWarmupRepetitions = atoi( pszArgV[ ++iArg ] );
+
+			if( settings.iWarmupRepetitions < 0 )
+			{
+				fprintf( stderr, "The number of warmup repetitions can't be negative\n" );
+				return 2;
+			}
+		}
+		else if( !strcmp( pszArg, "--filter" ) && bHasValue )
+		{
+			settings.szFilter = pszArgV[ ++iArg ];
+		}
+		else if( !strcmp( pszArg, "--warm-only" ) )
+		{
+			settings.bRunWarm = true;
+			settings.bRunCold = false;
+		}
+		else if( !strcmp( pszArg, "--cold-only" ) )
+		{
+			settings.bRunWarm = false;
+			settings.bRunCold = true;
+		}
+		else if( !strcmp( pszArg, "--output" ) && bHasValue )
+		{
+			pszOutput = pszArgV[ ++iArg ];
+		}
+		else if( !strcmp( pszArg, "--list" ) )
+		{
+			bList = true;
+		}
+		else
+		{
+			fprintf( stderr, "Unknown or incomplete option \"%s\"\n", pszArg );
+			PrintUsage( pszArgV[ 0 ] );
+			return 2;
+		}
+	}
+
+	CHeadlessGLContext context;
+
+	context.Create();
+
+	//Declared before the runner so benchmarks that use the renderer are destroyed first.
+	CRendererLibraries rendererLibraries;
+
+	bool bHasRenderer = false;
+
+	if( context.IsCurrent() )
+		bHasRenderer = rendererLibraries.Load();
+
+	if( !bHasRenderer )
+		fprintf( stderr, "The renderer isn't available, skipping renderer benchmarks\n" );
+
+	{
+		synthetic::CRandom random( settings.uiSeed + 3 );
+
+		if( !bench::VerifySkinningKernels( random ) )
+		{
+			fprintf( stderr, "Skinning kernels produced incorrect results\n" );
+			return EXIT_FAILURE;
+		}
+	}
+
+	{
+		synthetic::CRandom random( settings.uiSeed + 4 );
+
+		if( !bench::VerifyAnimationEventIndex( random, 200000 ) )
+		{
+			fprintf( stderr, "Animation event index produced incorrect results\n" );
+			return EXIT_FAILURE;
+		}
+	}
+
+	if( bHasRenderer )
+	{
+		synthetic::CRandom random( settings.uiSeed + 5 );
+
+		if( !bench::VerifyInstancedDrawing( rendererLibraries, random ) )
+		{
+			fprintf( stderr, "Instanced model drawing produced incorrect results\n" );
+			return EXIT_FAILURE;
+		}
+	}
+
+	bench::CBenchmarkRunner runner( settings );
+
+	//Each group gets its own generator so adding benchmarks to one group doesn't change the data of another.
+	{
+		synthetic::CRandom random( settings.uiSeed );
+		bench::RegisterMathBenchmarks( runner, random );
+	}
+
+	{
+		synthetic::CRandom random( settings.uiSeed + 1 );
+		bench::RegisterStudioModelBenchmarks( runner, random );
+	}
+
+	if( bHasRenderer )
+	{
+		synthetic::CRandom random( settings.uiSeed + 6 );
+
+		if( !bench::RegisterRendererBenchmarks( runner, random, rendererLibraries ) )
+			return EXIT_FAILURE;
+	}
+
+	bool bSuccess;
+
+	{
+		synthetic::CRandom random( settings.uiSeed + 2 );
+		bSuccess = bench::RegisterFileBenchmarks( runner, random, context.IsCurrent() );
+	}
+
+	if( !bSuccess )
+	{
+		bench::CleanupFileBenchmarks();
+		return EXIT_FAILURE;
+	}
+
+	if( bList )
+	{
+		runner.List( stdout );
+		bench::CleanupFileBenchmarks();
+		return EXIT_SUCCESS;
+	}
+
+	FILE* pOutput = stdout;
+
+	if( pszOutput )
+	{
+		pOutput = fopen( pszOutput, "w" );
+
+		if( !pOutput )
+		{
+			fprintf( stderr, "Couldn't open \"%s\" for writing: %s\n", pszOutput, strerror( errno ) );
+			bench::CleanupFileBenchmarks();
+			return 2;
+		}
+	}
+
+	runner.RunAll();
+
+	runner.WriteJSON( pOutput );
+
+	if( pOutput != stdout )
+		fclose( pOutput );
+
+	bench::CleanupFileBenchmarks();
+
+	return EXIT_SUCCESS;
+}
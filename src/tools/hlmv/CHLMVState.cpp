@@ -8,6 +8,19 @@
 
 namespace hlmv
 {
+const char* ViewportLayoutToString( const ViewportLayout layout )
+{
+	switch( layout )
+	{
+	case ViewportLayout::SINGLE:			return "Single";
+	case ViewportLayout::SPLIT_VERTICAL:	return "Split Vertical";
+	case ViewportLayout::SPLIT_HORIZONTAL:	return "Split Horizontal";
+	case ViewportLayout::QUAD:				return "Quad";
+
+	default:								return "Invalid";
+	}
+}
+
 const glm::vec3 CHLMVState::DEFAULT_ROTATION = glm::vec3( -90.0f, 0, -90.0f );
 
 const float CHLMVState::DEFAULT_FOV = 65.0f;
@@ -64,6 +77,8 @@ void CHLMVState::ResetToDefaults()
 
 	renderMode = RenderMode::TEXTURE_SHADED;
 
+	viewportLayout = ViewportLayout::SINGLE;
+
 	showGround = false;
 
 	pause = false;
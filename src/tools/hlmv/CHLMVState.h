@@ -18,6 +18,39 @@
 */
 namespace hlmv
 {
+/**
+*	How the 3D view is split into viewports.
+*/
+enum class ViewportLayout
+{
+	FIRST = 0,
+
+	/**
+	*	One perspective view.
+	*/
+	SINGLE = FIRST,
+
+	/**
+	*	Perspective view on the left, front view on the right.
+	*/
+	SPLIT_VERTICAL,
+
+	/**
+	*	Perspective view at the top, front view at the bottom.
+	*/
+	SPLIT_HORIZONTAL,
+
+	/**
+	*	Perspective, front, side and top views.
+	*/
+	QUAD,
+
+	COUNT,
+	LAST = COUNT - 1 //Must be last
+};
+
+const char* ViewportLayoutToString( const ViewportLayout layout );
+
 class CHLMVState final
 {
 public:
@@ -107,6 +140,8 @@ public:
 
 	RenderMode renderMode;
 
+	ViewportLayout viewportLayout;
+
 	bool showGround;
 
 	bool pause;
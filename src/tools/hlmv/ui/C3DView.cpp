@@ -1,12 +1,21 @@
+#include <algorithm>
 #include <memory>
 
 #include <glm/mat4x4.hpp>
 #include <glm/gtx/transform.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <wx/filename.h>
 #include <wx/image.h>
 #include <wx/notebook.h>
 
+#include "shared/Logging.h"
+#include "shared/Stats.h"
+#include "shared/Utility.h"
+
+#include "cvar/CVar.h"
+
 #include "CModelViewerApp.h"
 #include "../settings/CHLMVSettings.h"
 #include "../CHLMVState.h"
@@ -17,7 +26,10 @@
 #include "graphics/GraphicsUtils.h"
 #include "graphics/GraphicsHelpers.h"
 #include "graphics/GLRenderTarget.h"
+#include "graphics/PNGFile.h"
 
+#include "shared/renderer/IRenderContext.h"
+#include "shared/renderer/studiomodel/CModelRenderInfo.h"
 #include "shared/renderer/studiomodel/IStudioModelRenderer.h"
 
 #include "game/entity/CStudioModelEntity.h"
@@ -31,10 +43,92 @@
 #include "C3DView.h"
 
 //TODO: remove
+extern renderer::IRenderContext* g_pRenderContext;
 extern studiomdl::IStudioModelRenderer* g_pStudioMdlRenderer;
 
 namespace hlmv
 {
+static cvar::CCVar screenshot_width( "screenshot_width", cvar::CCVarArgsBuilder().HelpInfo( "Width of screenshots and sequence captures. 0 uses the width of the 3D view" ).FloatValue( 0 ).Flags( cvar::Flag::ARCHIVE ) );
+static cvar::CCVar screenshot_height( "screenshot_height", cvar::CCVarArgsBuilder().HelpInfo( "Height of screenshots and sequence captures. 0 uses the height of the 3D view" ).FloatValue( 0 ).Flags( cvar::Flag::ARCHIVE ) );
+
+static cvar::CCVar r_speeds( "r_speeds", cvar::CCVarArgsBuilder().HelpInfo( "If non-zero, draws runtime statistics on top of the 3D view" ).FloatValue( 0 ) );
+static cvar::CCVar r_viewport_split_x( "r_viewport_split_x", cvar::CCVarArgsBuilder().HelpInfo( "Position of the vertical split between viewports, as a fraction of the 3D view's width" ).FloatValue( 0.5f ).Flags( cvar::Flag::ARCHIVE ) );
+static cvar::CCVar r_viewport_split_y( "r_viewport_split_y", cvar::CCVarArgsBuilder().HelpInfo( "Position of the horizontal split between viewports, as a fraction of the 3D view's height measured from the top" ).FloatValue( 0.5f ).Flags( cvar::Flag::ARCHIVE ) );
+
+static cvar::CCVar r_speeds_filter( "r_speeds_filter", cvar::CCVarArgsBuilder().HelpInfo( "If set, r_speeds only draws statistics whose name contains this" ).StringValue( "" ) );
+
+//Splits are kept away from the edges so no viewport collapses.
+static const float VIEWPORT_SPLIT_MIN = 0.1f;
+static const float VIEWPORT_SPLIT_MAX = 0.9f;
+
+static const int VIEWPORT_BORDER_WIDTH = 1;
+
+//Half the size of the area shown by orthographic views if there is no model.
+static const float ORTHO_DEFAULT_EXTENT = 64.0f;
+
+//Orthographic views show this much more than the model's bounding box.
+static const float ORTHO_MARGIN = 1.1f;
+
+/**
+*	Gets the number of frames that a sequence capture saves for an entity.
+*/
+static int GetSequenceCaptureFrameCount( CStudioModelEntity* pEntity )
+{
+	//SetFrame wraps the last frame around to the first, so it can't be captured separately.
+	return std::max( 1, pEntity->GetNumFrames() - 1 );
+}
+
+/**
+*	Gets the face to cull for an entity. The cull face has to be changed if an odd number of scale values are negative.
+*/
+static renderer::CullFace GetCullFace( const CStudioModelEntity* pEntity )
+{
+	const glm::vec3& vecScale = pEntity->GetScale();
+
+	const float flScale = vecScale.x * vecScale.y * vecScale.z;
+
+	return flScale > 0 ? renderer::CullFace::FRONT : renderer::CullFace::BACK;
+}
+
+/**
+*	Gets the flags to draw the model with.
+*/
+static renderer::DrawFlags_t GetDrawFlags( const CHLMVState& state )
+{
+	renderer::DrawFlags_t flags = renderer::DrawFlag::NONE;
+
+	//Draw wireframe overlay
+	if( state.wireframeOverlay )
+	{
+		flags |= renderer::DrawFlag::WIREFRAME_OVERLAY;
+	}
+
+	if( state.UsingWeaponOrigin() )
+	{
+		flags |= renderer::DrawFlag::IS_VIEW_MODEL;
+	}
+
+	return flags;
+}
+
+/**
+*	Extracts the unique UV map edges of the meshes that use a texture.
+*	@param pUVMesh If not null, only this mesh is used.
+*/
+static void CollectUVMapEdges( const studiomdl::CStudioModel* pModel, const int iTexture, const mstudiomesh_t* const pUVMesh,
+							   std::vector<studiomdl::UVEdge_t>& edges )
+{
+	edges.clear();
+
+	for( const auto& mesh : pModel->GetTextureMeshes( iTexture ) )
+	{
+		if( !pUVMesh || mesh.pMesh == pUVMesh )
+			studiomdl::AppendUVEdges( mesh.pTriCmds, edges );
+	}
+
+	studiomdl::RemoveDuplicateUVEdges( edges );
+}
+
 wxBEGIN_EVENT_TABLE( C3DView, CwxBase3DView )
 	EVT_MOUSE_EVENTS( C3DView::MouseEvents )
 wxEND_EVENT_TABLE()
@@ -46,6 +140,11 @@ C3DView::C3DView( wxWindow* pParent, CModelViewerApp* const pHLMV, CMainPanel* c
 	, m_pListener( pListener )
 {
 	wxASSERT( pMainPanel );
+
+	m_ImageWriter.SetFailureHandler( []( const wxString& szFilename )
+	{
+		wxMessageBox( wxString::Format( "Failed to save image \"%s\"!", szFilename.c_str() ) );
+	} );
 }
 
 C3DView::~C3DView()
@@ -54,11 +153,22 @@ C3DView::~C3DView()
 
 	glDeleteTexture( m_GroundTexture );
 	glDeleteTexture( m_BackgroundTexture );
+
+	m_CaptureReadback.Destroy();
+	m_pCaptureTarget.reset();
+
+	if( m_UVMapBuffer != 0 )
+		glDeleteBuffers( 1, &m_UVMapBuffer );
+
+	m_StatsOverlay.Shutdown();
 }
 
 void C3DView::PrepareForLoad()
 {
 	SetCurrent( *GetContext() );
+
+	//The cache refers to the model's meshes.
+	m_bUVMapCacheValid = false;
 }
 
 void C3DView::UpdateView()
@@ -72,12 +182,29 @@ void C3DView::UpdateView()
 
 void C3DView::OnDraw()
 {
+	const wxSize size = GetClientSize();
+
+	DrawView( size.GetWidth(), size.GetHeight() );
+
+	//Not part of DrawView so captures don't include it.
+	if( r_speeds.GetBool() )
+	{
+		m_StatsOverlay.Draw( size.GetWidth(), size.GetHeight(), r_speeds_filter.GetString() );
+	}
+
+	if( m_pListener )
+		m_pListener->Draw3D( size );
+}
+
+void C3DView::DrawView( const int iWidth, const int iHeight )
+{
+	//Other views and panels share the OpenGL context and change its state directly.
+	g_pRenderContext->InvalidateState();
+
 	const Color& backgroundColor = m_pHLMV->GetSettings()->GetBackgroundColor();
 
 	glClearColor( backgroundColor.GetRed() / 255.0f, backgroundColor.GetGreen() / 255.0f, backgroundColor.GetBlue() / 255.0f, 1.0 );
 
-	const wxSize size = GetClientSize();
-
 	if( m_pHLMV->GetState()->mirror )
 	{
 		glClearStencil( 0 );
@@ -87,23 +214,25 @@ void C3DView::OnDraw()
 	else
 		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-	glViewport( 0, 0, size.GetX(), size.GetY() );
+	glViewport( 0, 0, iWidth, iHeight );
 
 	m_pHLMV->GetState()->drawnPolys = 0;
 
 	if( m_pHLMV->GetState()->showTexture )
 	{
-		DrawTexture( m_pHLMV->GetState()->texture, m_pHLMV->GetState()->textureScale,
+		DrawTexture( iWidth, iHeight, m_pHLMV->GetState()->texture, m_pHLMV->GetState()->textureScale,
 					 m_pHLMV->GetState()->showUVMap, m_pHLMV->GetState()->overlayUVMap,
 					 m_pHLMV->GetState()->antiAliasUVLines, m_pHLMV->GetState()->pUVMesh );
 	}
 	else
 	{
-		DrawModel();
+		DrawModel( iWidth, iHeight );
 	}
 
-	if( m_pListener )
-		m_pListener->Draw3D( size );
+	static auto& framePolygons = stats::Registry().GetGauge( "hlmv.frame_polygons" );
+
+	framePolygons.Set( m_pHLMV->GetState()->drawnPolys );
+
 }
 
 void C3DView::ApplyCameraToScene()
@@ -311,16 +440,14 @@ void C3DView::SetupRenderMode( RenderMode renderMode )
 	graphics::helpers::SetupRenderMode( renderMode, m_pHLMV->GetState()->backfaceCulling );
 }
 
-void C3DView::DrawTexture( const int iTexture, const float flTextureScale, const bool bShowUVMap, const bool bOverlayUVMap, const bool bAntiAliasLines, const mstudiomesh_t* const pUVMesh )
+void C3DView::DrawTexture( const int iWidth, const int iHeight, const int iTexture, const float flTextureScale, const bool bShowUVMap, const bool bOverlayUVMap, const bool bAntiAliasLines, const mstudiomesh_t* const pUVMesh )
 {
 	auto pEntity = m_pHLMV->GetState()->GetEntity();
 
 	if( !pEntity )
 		return;
 
-	const wxSize size = GetClientSize();
-
-	DrawTexture( m_pHLMV->GetState()->iTextureXOffset, m_pHLMV->GetState()->iTextureYOffset, size.GetWidth(), size.GetHeight(), 
+	DrawTexture( m_pHLMV->GetState()->iTextureXOffset, m_pHLMV->GetState()->iTextureYOffset, iWidth, iHeight, 
 				 pEntity, iTexture, flTextureScale, bShowUVMap, bOverlayUVMap, bAntiAliasLines, pUVMesh );
 }
 
@@ -355,33 +482,33 @@ void C3DView::DrawTexture( const int iXOffset, const int iYOffset, const int iWi
 		glPushMatrix();
 		glLoadIdentity();
 
-		glDisable( GL_CULL_FACE );
-		glDisable( GL_BLEND );
+		g_pRenderContext->SetCullFaceEnabled( false );
+		g_pRenderContext->SetBlendEnabled( false );
 
 		if( texture.flags & STUDIO_NF_MASKED )
 		{
-			glEnable( GL_ALPHA_TEST );
-			glAlphaFunc( GL_GREATER, 0.5f );
+			g_pRenderContext->SetAlphaTestEnabled( true );
+			g_pRenderContext->SetAlphaFunc( renderer::CompareFunc::GREATER, 0.5f );
 		}
 
-		glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
+		g_pRenderContext->SetPolygonMode( renderer::PolygonMode::FILL );
 		float x = ( ( ( float ) iWidth - w ) / 2 ) + iXOffset;
 		float y = ( ( ( float ) iHeight - h ) / 2 ) + iYOffset;
 
-		glDisable( GL_DEPTH_TEST );
+		g_pRenderContext->SetDepthTestEnabled( false );
 
 		if( bShowUVMap && !bOverlayUVMap )
 		{
 			glColor4f( 0.0f, 0.0f, 0.0f, 1.0f );
-			glDisable( GL_TEXTURE_2D );
+			g_pRenderContext->SetTexture2DEnabled( false );
 			glRectf( x, y, x + w, y + h );
 		}
 
 		if( !bShowUVMap || bOverlayUVMap )
 		{
-			glEnable( GL_TEXTURE_2D );
+			g_pRenderContext->SetTexture2DEnabled( true );
 			glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
-			glBindTexture( GL_TEXTURE_2D, pModel->GetTextureId( iTexture ) );
+			g_pRenderContext->BindTexture( reinterpret_cast<renderer::HTexture_t>( pModel->GetTextureId( iTexture ) ) );
 
 			glBegin( GL_TRIANGLE_STRIP );
 
@@ -399,60 +526,48 @@ void C3DView::DrawTexture( const int iXOffset, const int iYOffset, const int iWi
 
 			glEnd();
 
-			glBindTexture( GL_TEXTURE_2D, 0 );
+			g_pRenderContext->BindTexture( NULL_TEXTURE_HANDLE );
 		}
 
 		if( bShowUVMap )
 		{
 			glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
 
-			CStudioModelEntity::MeshList_t meshes;
-
-			if( pUVMesh )
-			{
-				meshes.push_back( pUVMesh );
-			}
-			else
-			{
-				meshes = pEntity->ComputeMeshList( iTexture );
-			}
+			UpdateUVMapCache( pModel, iTexture, pUVMesh );
 
 			graphics::helpers::SetupRenderMode( RenderMode::WIREFRAME, true );
 
 			if( bAntiAliasLines )
 			{
-				glEnable( GL_BLEND );
-				glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+				g_pRenderContext->SetBlendEnabled( true );
+				g_pRenderContext->SetBlendFunc( renderer::BlendFactor::SRC_ALPHA, renderer::BlendFactor::ONE_MINUS_SRC_ALPHA );
 				glEnable( GL_LINE_SMOOTH );
 			}
 
-			int i;
-
-			const mstudiomesh_t* const* ppMeshes = meshes.data();
-
-			for( size_t uiIndex = 0; uiIndex < meshes.size(); ++uiIndex, ++ppMeshes )
+			if( !m_UVMapEdges.empty() )
 			{
-				const short* ptricmds = ( short* ) ( ( byte* ) pModel->GetStudioHeader() + ( *ppMeshes )->triindex );
+				//Edges are stored in texels.
+				glTranslatef( x, y, 0 );
+				glScalef( flTextureScale, flTextureScale, 1 );
 
-				while( i = *( ptricmds++ ) )
-				{
-					if( i < 0 )
-					{
-						glBegin( GL_TRIANGLE_FAN );
-						i = -i;
-					}
-					else
-					{
-						glBegin( GL_TRIANGLE_STRIP );
-					}
+				glEnableClientState( GL_VERTEX_ARRAY );
 
-					for( ; i > 0; i--, ptricmds += 4 )
-					{
-						// FIX: put these in as integer coords, not floats
-						glVertex2f( x + ptricmds[ 2 ] * flTextureScale, y + ptricmds[ 3 ] * flTextureScale );
-					}
-					glEnd();
+				if( m_UVMapBuffer != 0 )
+				{
+					glBindBuffer( GL_ARRAY_BUFFER, m_UVMapBuffer );
+					glVertexPointer( 2, GL_SHORT, 0, nullptr );
 				}
+				else
+				{
+					glVertexPointer( 2, GL_SHORT, 0, m_UVMapEdges.data() );
+				}
+
+				glDrawArrays( GL_LINES, 0, static_cast<GLsizei>( m_UVMapEdges.size() * 2 ) );
+
+				if( m_UVMapBuffer != 0 )
+					glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+				glDisableClientState( GL_VERTEX_ARRAY );
 			}
 
 			if( bAntiAliasLines )
@@ -466,14 +581,35 @@ void C3DView::DrawTexture( const int iXOffset, const int iYOffset, const int iWi
 		glClear( GL_DEPTH_BUFFER_BIT );
 
 		if( texture.flags & STUDIO_NF_MASKED )
-			glDisable( GL_ALPHA_TEST );
+			g_pRenderContext->SetAlphaTestEnabled( false );
 	}
 }
 
-void C3DView::DrawModel()
+void C3DView::UpdateUVMapCache( const studiomdl::CStudioModel* pModel, const int iTexture, const mstudiomesh_t* const pUVMesh )
 {
-	const wxSize size = GetClientSize();
+	if( m_bUVMapCacheValid && m_pUVMapModel == pModel && m_iUVMapTexture == iTexture && m_pUVMapMesh == pUVMesh )
+		return;
+
+	CollectUVMapEdges( pModel, iTexture, pUVMesh, m_UVMapEdges );
+
+	if( glGenBuffers )
+	{
+		if( m_UVMapBuffer == 0 )
+			glGenBuffers( 1, &m_UVMapBuffer );
+
+		glBindBuffer( GL_ARRAY_BUFFER, m_UVMapBuffer );
+		glBufferData( GL_ARRAY_BUFFER, m_UVMapEdges.size() * sizeof( studiomdl::UVEdge_t ), m_UVMapEdges.data(), GL_STATIC_DRAW );
+		glBindBuffer( GL_ARRAY_BUFFER, 0 );
+	}
+
+	m_bUVMapCacheValid = true;
+	m_pUVMapModel = pModel;
+	m_iUVMapTexture = iTexture;
+	m_pUVMapMesh = pUVMesh;
+}
 
+void C3DView::DrawModel( const int iWidth, const int iHeight )
+{
 	//
 	// draw background
 	//
@@ -481,45 +617,132 @@ void C3DView::DrawModel()
 	if( m_pHLMV->GetState()->showBackground && m_BackgroundTexture != GL_INVALID_TEXTURE_ID && !m_pHLMV->GetState()->showTexture )
 	{
 		graphics::DrawBackground( m_BackgroundTexture );
+
+		//Changes state directly.
+		g_pRenderContext->InvalidateState();
 	}
 
-	graphics::SetProjection( m_pHLMV->GetState()->GetCurrentFOV(), size.GetWidth(), size.GetHeight() );
+	SetupViewer();
 
-	glMatrixMode( GL_MODELVIEW );
-	glPushMatrix();
-	glLoadIdentity();
+	const unsigned int uiOldPolys = g_pStudioMdlRenderer->GetDrawnPolygonsCount();
 
-	ApplyCameraToScene();
+	Viewport_t viewports[ MAX_VIEWPORTS ];
 
-	if( m_pHLMV->GetState()->drawAxes )
+	const size_t uiNumViewports = GetViewports( m_pHLMV->GetState()->viewportLayout, iWidth, iHeight, viewports );
+
+	if( uiNumViewports == 1 )
 	{
-		glDisable( GL_TEXTURE_2D );
-		glEnable( GL_DEPTH_TEST );
+		DrawScene( viewports[ 0 ].view, iWidth, iHeight, nullptr );
+	}
+	else
+	{
+		const renderer::CRenderCommandBuffer* pCommands = nullptr;
 
-		const float flLength = 50.0f;
+		auto pEntity = m_pHLMV->GetState()->GetEntity();
 
-		glLineWidth( 1.0f );
+		if( pEntity )
+		{
+			//Pose, skin and light the model once; every viewport submits the same commands.
+			m_ModelCommands.Clear();
 
-		glBegin( GL_LINES );
+			studiomdl::CModelRenderInfo renderInfo{};
 
-		glColor3f( 1.0f, 0, 0 );
+			pEntity->GetRenderInfo( renderInfo );
 
-		glVertex3f( 0, 0, 0 );
-		glVertex3f( flLength, 0, 0 );
+			auto state = graphics::helpers::GetRenderModeState( m_pHLMV->GetState()->renderMode, m_pHLMV->GetState()->backfaceCulling );
 
-		glColor3f( 0, 1, 0 );
+			state.cullFace = GetCullFace( pEntity );
 
-		glVertex3f( 0, 0, 0 );
-		glVertex3f( 0, flLength, 0 );
+			g_pStudioMdlRenderer->RecordModel( &renderInfo, m_ModelCommands, state, GetDrawFlags( *m_pHLMV->GetState() ) );
 
-		glColor3f( 0, 0, 1.0f );
+			pCommands = &m_ModelCommands;
+		}
 
-		glVertex3f( 0, 0, 0 );
-		glVertex3f( 0, 0, flLength );
+		for( size_t uiIndex = 0; uiIndex < uiNumViewports; ++uiIndex )
+		{
+			const auto& viewport = viewports[ uiIndex ];
 
-		glEnd();
+			glViewport( viewport.x, viewport.y, viewport.iWidth, viewport.iHeight );
+
+			DrawScene( viewport.view, viewport.iWidth, viewport.iHeight, pCommands );
+		}
+
+		glViewport( 0, 0, iWidth, iHeight );
+
+		//Separate the viewports with lines along their left and bottom edges.
+		glEnable( GL_SCISSOR_TEST );
+
+		glClearColor( 0, 0, 0, 1 );
+
+		for( size_t uiIndex = 0; uiIndex < uiNumViewports; ++uiIndex )
+		{
+			const auto& viewport = viewports[ uiIndex ];
+
+			if( viewport.x > 0 )
+			{
+				glScissor( viewport.x, viewport.y, VIEWPORT_BORDER_WIDTH, viewport.iHeight );
+				glClear( GL_COLOR_BUFFER_BIT );
+			}
+
+			if( viewport.y > 0 )
+			{
+				glScissor( viewport.x, viewport.y, viewport.iWidth, VIEWPORT_BORDER_WIDTH );
+				glClear( GL_COLOR_BUFFER_BIT );
+			}
+		}
+
+		glDisable( GL_SCISSOR_TEST );
+	}
+
+	m_pHLMV->GetState()->drawnPolys = g_pStudioMdlRenderer->GetDrawnPolygonsCount() - uiOldPolys;
+}
+
+size_t C3DView::GetViewports( const ViewportLayout layout, const int iWidth, const int iHeight, Viewport_t* pViewports )
+{
+	const int iSplitX = static_cast<int>( iWidth * clamp( r_viewport_split_x.GetFloat(), VIEWPORT_SPLIT_MIN, VIEWPORT_SPLIT_MAX ) );
+
+	//The split is measured from the top, window coordinates from the bottom.
+	const int iSplitY = iHeight - static_cast<int>( iHeight * clamp( r_viewport_split_y.GetFloat(), VIEWPORT_SPLIT_MIN, VIEWPORT_SPLIT_MAX ) );
+
+	switch( layout )
+	{
+	case ViewportLayout::SPLIT_VERTICAL:
+		{
+			pViewports[ 0 ] = { View::PERSPECTIVE, 0, 0, iSplitX, iHeight };
+			pViewports[ 1 ] = { View::FRONT, iSplitX, 0, iWidth - iSplitX, iHeight };
+
+			return 2;
+		}
+
+	case ViewportLayout::SPLIT_HORIZONTAL:
+		{
+			pViewports[ 0 ] = { View::PERSPECTIVE, 0, iSplitY, iWidth, iHeight - iSplitY };
+			pViewports[ 1 ] = { View::FRONT, 0, 0, iWidth, iSplitY };
+
+			return 2;
+		}
+
+	case ViewportLayout::QUAD:
+		{
+			pViewports[ 0 ] = { View::PERSPECTIVE, 0, iSplitY, iSplitX, iHeight - iSplitY };
+			pViewports[ 1 ] = { View::FRONT, iSplitX, iSplitY, iWidth - iSplitX, iHeight - iSplitY };
+			pViewports[ 2 ] = { View::SIDE, 0, 0, iSplitX, iSplitY };
+			pViewports[ 3 ] = { View::TOP, iSplitX, 0, iWidth - iSplitX, iSplitY };
+
+			return 4;
+		}
+
+	default:
+		{
+			pViewports[ 0 ] = { View::PERSPECTIVE, 0, 0, iWidth, iHeight };
+
+			return 1;
+		}
 	}
+}
 
+void C3DView::SetupViewer()
+{
 	const auto vecAngles = m_pHLMV->GetState()->GetCurrentCamera()->GetViewDirection();
 
 	auto mat = Mat4x4ModelView();
@@ -552,15 +775,121 @@ void C3DView::DrawModel()
 
 	//Invert it so it points down instead of up. This allows chrome to match the in-game look.
 	g_pStudioMdlRenderer->SetViewerRight( -vecViewerRight );
+}
 
-	const unsigned int uiOldPolys = g_pStudioMdlRenderer->GetDrawnPolygonsCount();
+void C3DView::SetupOrthographicView( const View view, const int iWidth, const int iHeight )
+{
+	glm::vec3 vecMins( -ORTHO_DEFAULT_EXTENT );
+	glm::vec3 vecMaxs( ORTHO_DEFAULT_EXTENT );
+
+	glm::vec3 vecOrigin( 0 );
+
+	if( auto pEntity = m_pHLMV->GetState()->GetEntity() )
+	{
+		pEntity->ExtractBbox( vecMins, vecMaxs );
+
+		//Clamp the values to a reasonable range, like CHLMVState::CenterView does.
+		vecMins = glm::clamp( vecMins * pEntity->GetScale(), glm::vec3( -2000.0f ), glm::vec3( 2000.0f ) );
+		vecMaxs = glm::clamp( vecMaxs * pEntity->GetScale(), glm::vec3( -2000.0f ), glm::vec3( 2000.0f ) );
+
+		vecOrigin = pEntity->GetOrigin();
+	}
+
+	const glm::vec3 vecCenter = vecOrigin + ( vecMins + vecMaxs ) * 0.5f;
+
+	//Frame the sphere around the bounding box so every view shows the model at the same size.
+	const float flRadius = std::max( glm::length( vecMaxs - vecMins ) * 0.5f, 1.0f ) * ORTHO_MARGIN;
+
+	const float flAspect = static_cast<float>( iWidth ) / std::max( iHeight, 1 );
+
+	float flHalfWidth = flRadius;
+	float flHalfHeight = flRadius;
+
+	if( flAspect >= 1 )
+		flHalfWidth *= flAspect;
+	else
+		flHalfHeight /= flAspect;
+
+	//The eye is twice the radius away from the center, so this depth range contains the whole sphere.
+	glMatrixMode( GL_PROJECTION );
+	glLoadIdentity();
+	glOrtho( -flHalfWidth, flHalfWidth, -flHalfHeight, flHalfHeight, flRadius, flRadius * 3 );
+
+	glm::vec3 vecDirection;
+	glm::vec3 vecUp( 0, 0, 1 );
+
+	switch( view )
+	{
+	//Models face along the X axis.
+	case View::FRONT:	vecDirection = glm::vec3( 1, 0, 0 ); break;
+	case View::SIDE:	vecDirection = glm::vec3( 0, -1, 0 ); break;
+
+	case View::TOP:
+		{
+			vecDirection = glm::vec3( 0, 0, 1 );
+			vecUp = glm::vec3( 1, 0, 0 );
+			break;
+		}
+
+	default: break;
+	}
+
+	glMatrixMode( GL_MODELVIEW );
+	glLoadMatrixf( glm::value_ptr( glm::lookAt( vecCenter + vecDirection * ( flRadius * 2 ), vecCenter, vecUp ) ) );
+}
+
+void C3DView::DrawScene( const View view, const int iWidth, const int iHeight, const renderer::CRenderCommandBuffer* pCommands )
+{
+	if( view == View::PERSPECTIVE )
+		graphics::SetProjection( m_pHLMV->GetState()->GetCurrentFOV(), iWidth, iHeight );
+
+	glMatrixMode( GL_MODELVIEW );
+	glPushMatrix();
+	glLoadIdentity();
+
+	if( view == View::PERSPECTIVE )
+		ApplyCameraToScene();
+	else
+		SetupOrthographicView( view, iWidth, iHeight );
+
+	if( m_pHLMV->GetState()->drawAxes )
+	{
+		g_pRenderContext->SetTexture2DEnabled( false );
+		g_pRenderContext->SetDepthTestEnabled( true );
+
+		const float flLength = 50.0f;
+
+		glLineWidth( 1.0f );
+
+		glBegin( GL_LINES );
+
+		glColor3f( 1.0f, 0, 0 );
+
+		glVertex3f( 0, 0, 0 );
+		glVertex3f( flLength, 0, 0 );
+
+		glColor3f( 0, 1, 0 );
+
+		glVertex3f( 0, 0, 0 );
+		glVertex3f( 0, flLength, 0 );
+
+		glColor3f( 0, 0, 1.0f );
+
+		glVertex3f( 0, 0, 0 );
+		glVertex3f( 0, 0, flLength );
+
+		glEnd();
+	}
+
+	//The ground and mirror are only drawn in the perspective view; they would hide the model in the top view.
+	const bool bDrawGround = view == View::PERSPECTIVE;
 
 	auto pEntity = m_pHLMV->GetState()->GetEntity();
 
 	if( pEntity )
 	{
 		// setup stencil buffer and draw mirror
-		if( m_pHLMV->GetState()->mirror )
+		if( bDrawGround && m_pHLMV->GetState()->mirror )
 		{
 			graphics::helpers::DrawMirroredModel( pEntity, m_pHLMV->GetState()->renderMode,
 												  m_pHLMV->GetState()->wireframeOverlay, 
@@ -573,40 +902,30 @@ void C3DView::DrawModel()
 
 	if( pEntity )
 	{
-		const glm::vec3& vecScale = pEntity->GetScale();
-
-		//Determine if an odd number of scale values are negative. The cull face has to be changed if so.
-		const float flScale = vecScale.x * vecScale.y * vecScale.z;
-
-		glCullFace( flScale > 0 ? GL_FRONT : GL_BACK );
+		g_pRenderContext->SetCullFace( GetCullFace( pEntity ) );
 
-		renderer::DrawFlags_t flags = renderer::DrawFlag::NONE;
+		const renderer::DrawFlags_t flags = GetDrawFlags( *m_pHLMV->GetState() );
 
-		//Draw wireframe overlay
-		if( m_pHLMV->GetState()->wireframeOverlay )
+		if( pCommands )
 		{
-			flags |= renderer::DrawFlag::WIREFRAME_OVERLAY;
-		}
+			g_pRenderContext->SubmitCommands( &pCommands, 1 );
 
-		if( m_pHLMV->GetState()->UsingWeaponOrigin() )
-		{
-			flags |= renderer::DrawFlag::IS_VIEW_MODEL;
+			//Draws the debug overlays and lets the listener draw, reusing the pose that was recorded.
+			pEntity->Draw( ( flags & ~renderer::DrawFlag::WIREFRAME_OVERLAY ) | renderer::DrawFlag::NODRAW );
 		}
-
-		pEntity->Draw( flags );
+		else
+			pEntity->Draw( flags );
 	}
 
 	//
 	// draw ground
 	//
 
-	if( m_pHLMV->GetState()->showGround )
+	if( bDrawGround && m_pHLMV->GetState()->showGround )
 	{
 		graphics::helpers::DrawFloor( m_pHLMV->GetSettings()->GetFloorLength(), m_GroundTexture, m_pHLMV->GetSettings()->GetGroundColor(), m_pHLMV->GetState()->mirror );
 	}
 
-	m_pHLMV->GetState()->drawnPolys = g_pStudioMdlRenderer->GetDrawnPolygonsCount() - uiOldPolys;
-
 	glPopMatrix();
 }
 
@@ -641,8 +960,124 @@ void C3DView::UnloadGroundTexture()
 	glDeleteTexture( m_GroundTexture );
 }
 
+void C3DView::GetCaptureSize( int& iWidth, int& iHeight )
+{
+	const wxSize size = GetClientSize();
+
+	iWidth = screenshot_width.GetInt() > 0 ? screenshot_width.GetInt() : size.GetWidth();
+	iHeight = screenshot_height.GetInt() > 0 ? screenshot_height.GetInt() : size.GetHeight();
+}
+
+bool C3DView::BeginCapture( int& iWidth, int& iHeight )
+{
+	SetCurrent( *GetContext() );
+
+	m_bCaptureToBackBuffer = false;
+
+	//Framebuffer objects may not be supported.
+	if( glGenFramebuffers )
+	{
+		GLint iMaxTextureSize;
+		GLint iMaxRenderbufferSize;
+
+		glGetIntegerv( GL_MAX_TEXTURE_SIZE, &iMaxTextureSize );
+		glGetIntegerv( GL_MAX_RENDERBUFFER_SIZE, &iMaxRenderbufferSize );
+
+		const int iMaxSize = std::min( iMaxTextureSize, iMaxRenderbufferSize );
+
+		iWidth = clamp( iWidth, 1, iMaxSize );
+		iHeight = clamp( iHeight, 1, iMaxSize );
+
+		if( !m_pCaptureTarget )
+			m_pCaptureTarget = std::make_unique<GLRenderTarget>( true );
+
+		if( m_pCaptureTarget->Exists() && m_pCaptureTarget->Bind() )
+		{
+			//Stencil is needed to draw the mirrored model.
+			m_pCaptureTarget->Setup( iWidth, iHeight, true, true );
+
+			const GLenum status = m_pCaptureTarget->GetStatus();
+
+			if( status == GL_FRAMEBUFFER_COMPLETE )
+			{
+				glReadBuffer( GL_COLOR_ATTACHMENT0 );
+
+				return m_CaptureReadback.Setup( iWidth, iHeight );
+			}
+
+			Warning( "Capture framebuffer is incomplete: %s (status code %d), using the back buffer instead\n", glFrameBufferStatusToString( status ), status );
+
+			m_pCaptureTarget->Unbind();
+		}
+	}
+
+	//Draw to the back buffer to avoid modifying displayed data. This limits the size to that of the view.
+	const wxSize size = GetClientSize();
+
+	iWidth = clamp( iWidth, 1, size.GetWidth() );
+	iHeight = clamp( iHeight, 1, size.GetHeight() );
+
+	m_bCaptureToBackBuffer = true;
+
+	glGetIntegerv( GL_READ_BUFFER, &m_iOldReadBuffer );
+	glGetIntegerv( GL_DRAW_BUFFER, &m_iOldDrawBuffer );
+
+	glReadBuffer( GL_BACK );
+	glDrawBuffer( GL_BACK );
+
+	return m_CaptureReadback.Setup( iWidth, iHeight );
+}
+
+void C3DView::EndCapture()
+{
+	if( m_bCaptureToBackBuffer )
+	{
+		glReadBuffer( m_iOldReadBuffer );
+		glDrawBuffer( m_iOldDrawBuffer );
+
+		m_bCaptureToBackBuffer = false;
+	}
+	else if( m_pCaptureTarget )
+	{
+		m_pCaptureTarget->Unbind();
+	}
+}
+
+bool C3DView::WriteOldestCapture( const wxString& szFilename, const wxBitmapType type, const bool bReportFailure )
+{
+	std::unique_ptr<byte[]> rgbData = std::make_unique<byte[]>( m_CaptureReadback.GetImageSize() );
+
+	const int iWidth = m_CaptureReadback.GetWidth();
+	const int iHeight = m_CaptureReadback.GetHeight();
+
+	if( !m_CaptureReadback.RetrieveOldest( rgbData.get() ) )
+		return false;
+
+	//Encoding happens on the writer's thread.
+	m_ImageWriter.QueueImage( szFilename, iWidth, iHeight, std::move( rgbData ), type, bReportFailure );
+
+	return true;
+}
+
+bool C3DView::CaptureImage( const wxString& szFilename, int iWidth, int iHeight, const std::function<void( int, int )>& drawFn, const wxBitmapType type )
+{
+	bool bResult = false;
+
+	if( BeginCapture( iWidth, iHeight ) )
+	{
+		drawFn( iWidth, iHeight );
+
+		bResult = m_CaptureReadback.QueueRead() && WriteOldestCapture( szFilename, type );
+	}
+
+	EndCapture();
+
+	return bResult;
+}
+
 /*
 *	Saves the given texture's UV map.
+*	The UV map is rasterized on the CPU, so this doesn't depend on the 3D view or OpenGL.
 */
 void C3DView::SaveUVMap( const wxString& szFilename, const int iTexture )
 {
@@ -660,147 +1095,188 @@ void C3DView::SaveUVMap( const wxString& szFilename, const int iTexture )
 
 	const mstudiotexture_t& texture = ( ( mstudiotexture_t* ) ( ( byte* ) pHdr + pHdr->textureindex ) )[ iTexture ];
 
-	SetCurrent( *GetContext() );
+	std::vector<studiomdl::UVEdge_t> edges;
 
-	//This is the old way UV render to texture was done, but it doesn't work with some 2.1 compliant GPUs so a workaround is used
-	/*
-	GLRenderTarget* const pScratchTarget = wxOpenGL().GetScratchTarget();
+	CollectUVMapEdges( pModel, iTexture, m_pHLMV->GetState()->pUVMesh, edges );
 
-	if( !pScratchTarget )
-	{
-		wxMessageBox( "Unable to create target to draw UV map to!" );
-		return;
-	}
+	//Black background with white lines.
+	std::vector<uint8_t> pixels( static_cast<size_t>( texture.width ) * texture.height * 3, 0 );
 
-	pScratchTarget->Bind();
+	const uint8_t color[ 3 ] = { 255, 255, 255 };
 
-	pScratchTarget->Setup( texture.width, texture.height, false );
+	studiomdl::RasterizeUVEdges( edges.data(), edges.size(), texture.width, texture.height, pixels.data(), color );
 
-	const GLenum completeness = pScratchTarget->GetStatus();
+	bool bResult;
 
-	if( completeness != GL_FRAMEBUFFER_COMPLETE )
+	if( wxFileName( szFilename ).GetExt().Lower() == "png" )
+	{
+		bResult = graphics::pngfile::SaveRGBPNGFile( szFilename.c_str(), texture.width, texture.height, pixels.data(), false );
+	}
+	else
 	{
-		wxMessageBox( wxString::Format( "UV map framebuffer is incomplete!\n%s (status code %d)", glFrameBufferStatusToString( completeness ), completeness ) );
+		const wxImage image( texture.width, texture.height, pixels.data(), true );
 
-		pScratchTarget->Unbind();
+		bResult = image.SaveFile( szFilename, wxBITMAP_TYPE_BMP );
+	}
 
-		return;
+	if( !bResult )
+	{
+		wxMessageBox( wxString::Format( "Failed to save image \"%s\"!", szFilename.c_str() ) );
 	}
+}
 
-	glViewport( 0, 0, texture.width, texture.height );
+void C3DView::TakeScreenshot()
+{
+	//Ask for a filename first; the image is drawn offscreen, so it doesn't matter what's on screen.
+	wxFileDialog dlg( this, _( "Save screenshot" ), wxEmptyString, "screenshot.png",
+		"PNG files (*.png)|*.png|BMP files (*.bmp)|*.bmp|JPG files(*.jpg;*.jpeg)|*.jpg;*.jpeg|All files (*.*)|*.*", wxFD_SAVE | wxFD_OVERWRITE_PROMPT );
 
-	glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
+	if( dlg.ShowModal() == wxID_CANCEL )
+		return;
 
-	glClear( GL_COLOR_BUFFER_BIT );
+	const wxString szFilename = dlg.GetPath();
 
-	DrawTexture( 0, 0, texture.width, texture.height, pEntity, iTexture, 1.0f, true, false, false, m_pHLMV->GetState()->pUVMesh );
+	int iWidth, iHeight;
 
-	pScratchTarget->FinishDraw();
+	GetCaptureSize( iWidth, iHeight );
 
-	std::unique_ptr<byte[]> rgbData = std::make_unique<byte[]>( texture.width * texture.height * 3 );
+	//Let extension determine format
+	const bool bResult = CaptureImage( szFilename, iWidth, iHeight, 
+		[ this ]( const int iWidth, const int iHeight )
+		{
+			DrawView( iWidth, iHeight );
 
-	pScratchTarget->GetPixels( texture.width, texture.height, GL_RGB, GL_UNSIGNED_BYTE, rgbData.get() );
+			if( m_pListener )
+				m_pListener->Draw3D( wxSize( iWidth, iHeight ) );
+		} );
 
-	pScratchTarget->Unbind();
-	*/
+	if( !bResult )
+	{
+		wxMessageBox( wxString::Format( "Failed to save image \"%s\"!", szFilename.c_str() ) );
+	}
+}
 
-	//Save off all settings we're about to modify
-	//Don't need to restore the viewport since it's reset every frame anyway
-	GLint oldReadBuffer;
-	GLint oldDrawBuffer;
-	GLint oldPackAlignment;
+void C3DView::CaptureSequence()
+{
+	auto pEntity = m_pHLMV->GetState()->GetEntity();
 
-	glGetIntegerv( GL_READ_BUFFER, &oldReadBuffer );
-	glGetIntegerv( GL_DRAW_BUFFER, &oldDrawBuffer );
-	glGetIntegerv( GL_PACK_ALIGNMENT, &oldPackAlignment );
+	if( !pEntity )
+	{
+		wxMessageBox( "No model loaded!" );
+		return;
+	}
 
-	//Use the back buffer to avoid modifying displayed data
-	glReadBuffer( GL_BACK );
-	glDrawBuffer( GL_BACK );
+	wxFileDialog dlg( this, _( "Capture sequence" ), wxEmptyString, "sequence.png",
+		"PNG files (*.png)|*.png|BMP files (*.bmp)|*.bmp|JPG files(*.jpg;*.jpeg)|*.jpg;*.jpeg|All files (*.*)|*.*", wxFD_SAVE | wxFD_OVERWRITE_PROMPT );
 
-	//Set pack alignment to 1 so no padding is added
-	glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+	if( dlg.ShowModal() == wxID_CANCEL )
+		return;
 
-	glViewport( 0, 0, texture.width, texture.height );
+	int iWidth, iHeight;
 
-	glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
+	GetCaptureSize( iWidth, iHeight );
 
-	glClear( GL_COLOR_BUFFER_BIT );
+	wxBusyCursor busy;
 
-	DrawTexture( 0, 0, texture.width, texture.height, pEntity, iTexture, 1.0f, true, false, false, m_pHLMV->GetState()->pUVMesh );
+	const int iNumFrames = GetSequenceCaptureFrameCount( pEntity );
 
-	glFlush();
-	glFinish();
+	const int iNumCaptured = CaptureSequence( dlg.GetPath(), iWidth, iHeight );
 
-	std::unique_ptr<byte[]> rgbData = std::make_unique<byte[]>( texture.width * texture.height * 3 );
+	const int iNumSaved = iNumCaptured - static_cast<int>( m_ImageWriter.WaitForPending() );
 
-	glReadPixels( 0, 0, texture.width, texture.height, GL_RGB, GL_UNSIGNED_BYTE, rgbData.get() );
+	if( iNumSaved < iNumFrames )
+	{
+		wxMessageBox( wxString::Format( "Failed to save %d of %d frames", iNumFrames - iNumSaved, iNumFrames ) );
+	}
+}
 
-	glReadBuffer( oldReadBuffer );
-	glDrawBuffer( oldDrawBuffer );
-	glPixelStorei( GL_PACK_ALIGNMENT, oldPackAlignment );
+int C3DView::CaptureSequence( const wxString& szFilename, int iWidth, int iHeight )
+{
+	auto pEntity = m_pHLMV->GetState()->GetEntity();
 
-	//We have to flip the image vertically, since OpenGL reads it upside down.
-	graphics::FlipImageVertically( texture.width, texture.height, rgbData.get() );
+	if( !pEntity || !pEntity->GetModel() )
+		return 0;
 
-	wxImage image( texture.width, texture.height, rgbData.get(), true );
+	const wxFileName baseName( szFilename );
 
-	if( !image.SaveFile( szFilename, wxBITMAP_TYPE_BMP ) )
+	auto frameFilename = [ & ]( const int iFrame )
 	{
-		wxMessageBox( wxString::Format( "Failed to save image \"%s\"!", szFilename.c_str() ) );
-	}
-}
+		wxFileName frameName( baseName );
 
-void C3DView::TakeScreenshot()
-{
-	SetCurrent( *GetContext() );
+		frameName.SetName( wxString::Format( "%s_%04d", baseName.GetName(), iFrame ) );
 
-	//Use the actual viewport size
-	GLint viewportSize[ 4 ];
+		return frameName.GetFullPath();
+	};
 
-	glGetIntegerv( GL_VIEWPORT, viewportSize );
+	const float flOldFrame = pEntity->GetFrame();
 
-	const auto width = viewportSize[ 2 ];
-	const auto height = viewportSize[ 3 ];
+	const int iNumFrames = GetSequenceCaptureFrameCount( pEntity );
 
-	std::unique_ptr<byte[]> rgbData = std::make_unique<byte[]>( width * height * 3 );
+	int iNextWrite = 0;
+	int iNumWritten = 0;
 
-	GLint oldReadBuffer;
-	GLint oldPackAlignment;
+	bool bSuccess = true;
 
-	glGetIntegerv( GL_READ_BUFFER, &oldReadBuffer );
-	glGetIntegerv( GL_PACK_ALIGNMENT, &oldPackAlignment );
+	//Frames that fail to save are counted by the image writer, so they can be reported once for the whole sequence.
+	auto writeFrame = [ & ]()
+	{
+		const int iFrame = iNextWrite++;
 
-	//Read currently displayed buffer.
-	glReadBuffer( GL_FRONT );
+		if( !WriteOldestCapture( frameFilename( iFrame ), wxBITMAP_TYPE_ANY, false ) )
+		{
+			Error( "Failed to read back frame %d\n", iFrame );
+			bSuccess = false;
+			return false;
+		}
 
-	//Set pack alignment to 1 so no padding is added
-	glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+		++iNumWritten;
 
-	//Grab the image from the 3D view itself.
-	glReadPixels( viewportSize[ 0 ], viewportSize[ 1 ], width, height, GL_RGB, GL_UNSIGNED_BYTE, rgbData.get() );
+		return true;
+	};
 
-	glReadBuffer( oldReadBuffer );
-	glPixelStorei( GL_PACK_ALIGNMENT, oldPackAlignment );
+	if( BeginCapture( iWidth, iHeight ) )
+	{
+		const wxSize size( iWidth, iHeight );
 
-	//Now ask for a filename.
-	wxFileDialog dlg( this, _( "Save screenshot" ), wxEmptyString, "screenshot.png",
-		"PNG files (*.png)|*.png|BMP files (*.bmp)|*.bmp|JPG files(*.jpg;*.jpeg)|*.jpg;*.jpeg|All files (*.*)|*.*", wxFD_SAVE | wxFD_OVERWRITE_PROMPT );
+		for( int iFrame = 0; iFrame < iNumFrames; ++iFrame )
+		{
+			pEntity->SetFrame( iFrame );
 
-	if( dlg.ShowModal() == wxID_CANCEL )
-		return;
+			DrawView( iWidth, iHeight );
 
-	const wxString szFilename = dlg.GetPath();
+			if( m_pListener )
+				m_pListener->Draw3D( size );
 
-	//We have to flip the image vertically, since OpenGL reads it upside down.
-	graphics::FlipImageVertically( width, height, rgbData.get() );
+			//Only wait for the oldest read once every buffer is in flight; the GPU keeps working on the rest.
+			if( m_CaptureReadback.IsFull() && !writeFrame() )
+				break;
 
-	wxImage image( width, height, rgbData.get(), true );
+			if( !m_CaptureReadback.QueueRead() )
+			{
+				Error( "Failed to read back frame %d\n", iFrame );
+				bSuccess = false;
+				break;
+			}
+		}
 
-	//Let extension determine format
-	if( !image.SaveFile( szFilename ) )
-	{
-		wxMessageBox( wxString::Format( "Failed to save image \"%s\"!", szFilename.c_str() ) );
+		//Frames that were already read back are still saved after a failure.
+		while( m_CaptureReadback.GetPendingCount() > 0 )
+		{
+			writeFrame();
+		}
 	}
+	else
+		bSuccess = false;
+
+	EndCapture();
+
+	pEntity->SetFrame( static_cast<int>( flOldFrame ) );
+
+	if( bSuccess )
+		Message( "Captured %d frames to \"%s\"\n", iNumWritten, szFilename.ToStdString().c_str() );
+	else
+		Error( "Stopped capturing after %d of %d frames to \"%s\"\n", iNumWritten, iNumFrames, szFilename.ToStdString().c_str() );
+
+	return iNumWritten;
+}
 }
-}
\ No newline at end of file
@@ -1,24 +1,43 @@
 #ifndef C3DVIEW_H
 #define C3DVIEW_H
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include "wxHLMV.h"
 
 #include "ui/wx/shared/CwxBase3DView.h"
+#include "ui/wx/utility/CwxImageWriter.h"
 
 #include <glm/vec3.hpp>
 
 #include "graphics/Constants.h"
 #include "graphics/CCamera.h"
+#include "graphics/GLPixelReadback.h"
+
+#include "shared/renderer/CRenderCommandBuffer.h"
 
 #include "shared/studiomodel/studio.h"
+#include "shared/studiomodel/StudioUVMap.h"
+
+#include "CStatsOverlay.h"
 
 class CStudioModelEntity;
+class GLRenderTarget;
+
+namespace studiomdl
+{
+class CStudioModel;
+}
 
 namespace hlmv
 {
 class CModelViewerApp;
 class CMainPanel;
 
+enum class ViewportLayout;
+
 class I3DViewListener
 {
 public:
@@ -33,6 +52,38 @@ inline I3DViewListener::~I3DViewListener()
 
 class C3DView final : public ui::CwxBase3DView
 {
+private:
+	/**
+	*	Direction that a viewport looks at the model from.
+	*/
+	enum class View
+	{
+		/**
+		*	Perspective view controlled by the camera.
+		*/
+		PERSPECTIVE = 0,
+
+		/**
+		*	Orthographic views that frame the current sequence's bounding box.
+		*/
+		FRONT,
+		SIDE,
+		TOP
+	};
+
+	struct Viewport_t
+	{
+		View view;
+
+		//In OpenGL window coordinates; the origin is the lower left corner.
+		int x;
+		int y;
+		int iWidth;
+		int iHeight;
+	};
+
+	static const size_t MAX_VIEWPORTS = 4;
+
 public:
 	C3DView( wxWindow* pParent, CModelViewerApp* const pHLMV, CMainPanel* const pMainPanel, I3DViewListener* pListener = nullptr );
 	~C3DView();
@@ -55,6 +106,22 @@ public:
 
 	void TakeScreenshot();
 
+	/**
+	*	Prompts for a filename and captures every frame of the current sequence.
+	*/
+	void CaptureSequence();
+
+	/**
+	*	Captures every frame of the current sequence to numbered images, rendered offscreen.
+	*	Frames are named <name>_<frame number>.<extension> after the given filename.
+	*	@param szFilename Base filename. The extension determines the image format.
+	*	@param iWidth Image width, in pixels.
+	*	@param iHeight Image height, in pixels.
+	*	@return Number of frames that were read back and queued to be saved. Capturing stops at the first frame that can't be read back.
+	*		Saving is asynchronous; frames that fail to save are counted by the image writer.
+	*/
+	int CaptureSequence( const wxString& szFilename, int iWidth, int iHeight );
+
 protected:
 	wxDECLARE_EVENT_TABLE();
 
@@ -70,7 +137,41 @@ private:
 
 	void SetupRenderMode( RenderMode renderMode = RenderMode::INVALID );
 
-	void DrawTexture( const int iTexture, const float flTextureScale, const bool bShowUVMap, const bool bOverlayUVMap, const bool bAntiAliasLines, const mstudiomesh_t* const pUVMesh );
+	/**
+	*	Draws the current view to the current draw buffer at the given size.
+	*/
+	void DrawView( const int iWidth, const int iHeight );
+
+	/**
+	*	Gets the size to capture screenshots and sequences at.
+	*/
+	void GetCaptureSize( int& iWidth, int& iHeight );
+
+	/**
+	*	Sets up offscreen rendering for a capture. Falls back to the back buffer if offscreen rendering is not available.
+	*	@param iWidth Requested width. Clamped to the maximum supported size.
+	*	@param iHeight Requested height. Clamped to the maximum supported size.
+	*	@return Whether capturing can proceed. EndCapture must be called regardless.
+	*/
+	bool BeginCapture( int& iWidth, int& iHeight );
+
+	void EndCapture();
+
+	/**
+	*	Retrieves the oldest pending readback and queues it to be saved.
+	*	@param bReportFailure Whether to show a message if saving fails. If false, the image writer counts the failure instead.
+	*	@return Whether the image was read back. Saving happens later and can still fail.
+	*/
+	bool WriteOldestCapture( const wxString& szFilename, const wxBitmapType type = wxBITMAP_TYPE_ANY, const bool bReportFailure = true );
+
+	/**
+	*	Draws a single image offscreen and saves it.
+	*	@param drawFn Function that draws the image. Receives the final capture size.
+	*/
+	bool CaptureImage( const wxString& szFilename, int iWidth, int iHeight, const std::function<void( int, int )>& drawFn,
+					   const wxBitmapType type = wxBITMAP_TYPE_ANY );
+
+	void DrawTexture( const int iWidth, const int iHeight, const int iTexture, const float flTextureScale, const bool bShowUVMap, const bool bOverlayUVMap, const bool bAntiAliasLines, const mstudiomesh_t* const pUVMesh );
 
 	/**
 	*	Draws a texture onto the screen. Optionally draws a UV map, either on a black background, or on top of the texture.
@@ -91,8 +192,40 @@ private:
 					  const int iTexture, const float flTextureScale, const bool bShowUVMap, const bool bOverlayUVMap, const bool bAntiAliasLines,
 					  const mstudiomesh_t* const pUVMesh );
 
+	/**
+	*	Extracts the UV map edges for the given texture and mesh selection, unless they are already cached,
+	*	and uploads them to a vertex buffer if buffers are supported.
+	*/
+	void UpdateUVMapCache( const studiomdl::CStudioModel* pModel, const int iTexture, const mstudiomesh_t* const pUVMesh );
 
-	void DrawModel();
+	/**
+	*	Draws the model into every viewport of the current layout.
+	*	If there are multiple viewports, the model is posed, skinned and lit once and the result is drawn in every viewport.
+	*/
+	void DrawModel( const int iWidth, const int iHeight );
+
+	/**
+	*	Gets the viewports of a layout.
+	*	@param pViewports Array of at least MAX_VIEWPORTS viewports.
+	*	@return Number of viewports.
+	*/
+	static size_t GetViewports( const ViewportLayout layout, const int iWidth, const int iHeight, Viewport_t* pViewports );
+
+	/**
+	*	Tells the studio model renderer where the viewer is, based on the current camera. Chrome depends on this.
+	*/
+	void SetupViewer();
+
+	/**
+	*	Sets up the projection and model view matrices of an orthographic view.
+	*/
+	void SetupOrthographicView( const View view, const int iWidth, const int iHeight );
+
+	/**
+	*	Draws the scene as seen from the given view into the current viewport.
+	*	@param pCommands If not null, the model was already recorded into this buffer, and it is submitted instead of drawing the model again.
+	*/
+	void DrawScene( const View view, const int iWidth, const int iHeight, const renderer::CRenderCommandBuffer* pCommands );
 
 private:
 	CModelViewerApp* const m_pHLMV;
@@ -118,6 +251,34 @@ private:
 	GLuint m_BackgroundTexture	= GL_INVALID_TEXTURE_ID;
 	GLuint m_GroundTexture		= GL_INVALID_TEXTURE_ID;
 
+	std::unique_ptr<GLRenderTarget> m_pCaptureTarget;
+
+	GLPixelReadback m_CaptureReadback;
+
+	ui::CwxImageWriter m_ImageWriter;
+
+	//Set if the current capture is drawn to the back buffer because offscreen rendering is unavailable.
+	bool m_bCaptureToBackBuffer = false;
+
+	GLint m_iOldReadBuffer = GL_BACK;
+	GLint m_iOldDrawBuffer = GL_BACK;
+
+	CStatsOverlay m_StatsOverlay;
+
+	//UV map edges of the last texture and mesh selection that was drawn. Invalidated when a model is loaded or freed.
+	bool m_bUVMapCacheValid = false;
+	const studiomdl::CStudioModel* m_pUVMapModel = nullptr;
+	int m_iUVMapTexture = -1;
+	const mstudiomesh_t* m_pUVMapMesh = nullptr;
+
+	std::vector<studiomdl::UVEdge_t> m_UVMapEdges;
+
+	//Vertex buffer containing m_UVMapEdges. 0 if buffers aren't supported.
+	GLuint m_UVMapBuffer = 0;
+
+	//The model as recorded for the current frame. Only used if there are multiple viewports.
+	renderer::CRenderCommandBuffer m_ModelCommands;
+
 private:
 	C3DView( const C3DView& ) = delete;
 	C3DView& operator=( const C3DView& ) = delete;
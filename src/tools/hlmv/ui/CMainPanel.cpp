@@ -14,6 +14,11 @@
 #include "controlpanels/CFullscreenPanel.h"
 #include "controlpanels/CGlobalFlagsPanel.h"
 
+#include "shared/Logging.h"
+
+#include "cvar/CCVar.h"
+
+#include "shared/resource/CResourceCache.h"
 #include "shared/studiomodel/CStudioModel.h"
 #include "shared/renderer/studiomodel/IStudioModelRenderer.h"
 #include "game/entity/CStudioModelEntity.h"
@@ -37,6 +42,15 @@ static const wxString VIEWORIGINS[] =
 
 static const int VIEWORIGIN_WEAPON = 1;
 
+/**
+*	Time between checks for changed files, in milliseconds.
+*/
+static const long long FILE_CHECK_INTERVAL = 100;
+
+static cvar::CCVar progressiveload( "progressiveload", cvar::CCVarArgsBuilder().Flags( cvar::Flag::ARCHIVE ).FloatValue( 1 ).HelpInfo( "Whether to show models while their textures and sequence groups are still loading" ) );
+
+static cvar::CCVar hotreload( "hotreload", cvar::CCVarArgsBuilder().Flags( cvar::Flag::ARCHIVE ).FloatValue( 1 ).HelpInfo( "Whether to reload the model and textures when their files change on disk" ) );
+
 const glm::vec3 CMainPanel::DEFAULT_LIGHT_VECTOR{ 0, 0, -1 };
 
 wxBEGIN_EVENT_TABLE( CMainPanel, wxPanel )
@@ -155,6 +169,8 @@ void CMainPanel::RunFrame()
 
 	const long long iCurrentTick = GetCurrentTick();
 
+	UpdateModelLoad();
+
 	ForEachPanel( &CBaseControlPanel::ViewPreUpdate );
 
 	m_p3DView->UpdateView();
@@ -186,6 +202,14 @@ void CMainPanel::RunFrame()
 	}
 
 	ForEachPanel( &CBaseControlPanel::ViewUpdated );
+
+	if( iCurrentTick - m_iLastFileCheck >= FILE_CHECK_INTERVAL )
+	{
+		m_iLastFileCheck = iCurrentTick;
+
+		if( hotreload.GetBool() )
+			ReloadChangedFiles();
+	}
 }
 
 void CMainPanel::Draw3D( const wxSize& size )
@@ -204,38 +228,41 @@ bool CMainPanel::LoadModel( const wxString& szFilename )
 {
 	m_p3DView->PrepareForLoad();
 
+	CancelModelLoad();
+
+	DiscardChangedModel();
+
 	m_pHLMV->GetState()->ResetModelData();
 
 	m_pHLMV->GetState()->ClearEntity();
 
-	auto szCFilename = szFilename.char_str( wxMBConvUTF8() );
+	m_szModelFilename.clear();
 
-	studiomdl::CStudioModel* pModel;
+	UpdateWatchedFiles();
 
-	const auto res = studiomdl::LoadStudioModel( szFilename.c_str(), pModel );
+	auto szCFilename = szFilename.char_str( wxMBConvUTF8() );
 
-	switch( res )
-	{
-	default:
-	case studiomdl::StudioModelLoadResult::FAILURE:
-		{
-			wxMessageBox( wxString::Format( "Error loading model \"%s\"\n", szCFilename.data() ), "Error" );
-			return false;
-		}
+	studiomdl::StudioModelHandle_t model;
 
-	case studiomdl::StudioModelLoadResult::POSTLOADFAILURE:
+	if( progressiveload.GetBool() )
+	{
+		//Only called if the model isn't cached.
+		model = m_pHLMV->GetModelCache().Load( szFilename.c_str(), [ this ]( const char* const pszFilename, studiomdl::CStudioModel*& pModel )
 		{
-			wxMessageBox( wxString::Format( "Error post-loading model \"%s\"\n", szCFilename.data() ), "Error" );
-			return false;
-		}
+			return m_ModelLoader.Start( pszFilename, pModel ) == studiomdl::StudioModelLoadResult::SUCCESS;
+		} );
+	}
+	else
+	{
+		model = m_pHLMV->GetModelCache().Load( szFilename.c_str() );
+	}
 
-	case studiomdl::StudioModelLoadResult::VERSIONDIFFERS:
-		{
-			wxMessageBox( wxString::Format( "Error loading model \"%s\": version differs\n", szCFilename.data() ), "Error" );
-			return false;
-		}
+	m_ModelLoadStage = m_ModelLoader.IsLoading() ? m_ModelLoader.GetStage() : studiomdl::StudioModelLoadStage::NONE;
 
-	case studiomdl::StudioModelLoadResult::SUCCESS: break;
+	if( !model )
+	{
+		wxMessageBox( wxString::Format( "Error loading model \"%s\". See the console for details\n", szCFilename.data() ), "Error" );
+		return false;
 	}
 
 	CHLMVStudioModelEntity* pEntity = static_cast<CHLMVStudioModelEntity*>( CBaseEntity::Create( "studiomodel", glm::vec3(), glm::vec3(), false ) );
@@ -244,15 +271,22 @@ bool CMainPanel::LoadModel( const wxString& szFilename )
 	{
 		pEntity->m_pState = m_pHLMV->GetState();
 
-		pEntity->SetModel( pModel );
+		pEntity->SetModel( model );
 
 		pEntity->Spawn();
 
 		m_pHLMV->GetState()->SetEntity( pEntity );
+
+		m_szModelFilename = resource::CanonicalizePath( szFilename.c_str() );
+
+		UpdateWatchedFiles();
 	}
-	else
+	else if( m_ModelLoader.IsLoading() )
 	{
-		delete pModel;
+		//Nothing uses the model, so the load can't be finished.
+		m_ModelLoader.Cancel();
+
+		m_pHLMV->GetModelCache().Discard( model );
 	}
 
 	InitializeUI();
@@ -266,7 +300,247 @@ void CMainPanel::FreeModel()
 {
 	m_p3DView->PrepareForLoad();
 
+	CancelModelLoad();
+
+	DiscardChangedModel();
+
 	m_pHLMV->GetState()->ClearEntity();
+
+	m_szModelFilename.clear();
+
+	UpdateWatchedFiles();
+}
+
+void CMainPanel::CancelModelLoad()
+{
+	if( !m_ModelLoader.IsLoading() )
+		return;
+
+	m_ModelLoader.Cancel();
+
+	if( auto pEntity = m_pHLMV->GetState()->GetEntity() )
+	{
+		//The model is incomplete; the next load must start over.
+		m_pHLMV->GetModelCache().Discard( pEntity->GetModelHandle() );
+	}
+}
+
+void CMainPanel::UpdateModelLoad()
+{
+	if( !m_ModelLoader.IsLoading() )
+		return;
+
+	//Uploading textures needs the context.
+	m_p3DView->PrepareForLoad();
+
+	if( !m_ModelLoader.Update() )
+		return;
+
+	auto pEntity = m_pHLMV->GetState()->GetEntity();
+
+	if( !pEntity )
+		return;
+
+	if( m_ModelLoader.HasFailed() )
+	{
+		//Same as failing to load the model at all.
+		m_pHLMV->GetModelCache().Discard( pEntity->GetModelHandle() );
+
+		const std::string szFilename = m_szModelFilename;
+
+		FreeModel();
+
+		InitializeUI();
+
+		wxMessageBox( wxString::Format( "Error loading model \"%s\". See the console for details\n", szFilename.c_str() ), "Error" );
+		return;
+	}
+
+	const auto stage = m_ModelLoader.GetStage();
+
+	//The texture header replaced the placeholder, so skins changed.
+	if( stage >= studiomdl::StudioModelLoadStage::PREVIEWTEXTURES && m_ModelLoadStage < studiomdl::StudioModelLoadStage::PREVIEWTEXTURES )
+	{
+		m_pBodyParts->InitializeUI();
+	}
+
+	if( stage >= studiomdl::StudioModelLoadStage::TEXTURES && m_ModelLoadStage < studiomdl::StudioModelLoadStage::TEXTURES )
+	{
+		m_pTextures->InitializeUI();
+	}
+
+	if( stage == studiomdl::StudioModelLoadStage::COMPLETE )
+	{
+		//Sequences in other groups no longer use the bind pose.
+		pEntity->ModelDataChanged();
+
+		m_pHLMV->GetModelCache().UpdateMemoryUsage( pEntity->GetModelHandle() );
+	}
+
+	m_ModelLoadStage = stage;
+}
+
+void CMainPanel::DiscardChangedModel()
+{
+	if( !m_pHLMV->GetState()->modelChanged )
+		return;
+
+	if( auto pEntity = m_pHLMV->GetState()->GetEntity() )
+	{
+		//Unsaved changes only exist in memory; the next load must read the file again.
+		m_pHLMV->GetModelCache().Discard( pEntity->GetModelHandle() );
+	}
+}
+
+void CMainPanel::UpdateWatchedFiles()
+{
+	m_FileWatcher.Clear();
+
+	if( !m_szModelFilename.empty() )
+	{
+		if( auto pEntity = m_pHLMV->GetState()->GetEntity() )
+		{
+			std::vector<std::string> files;
+
+			studiomdl::GetStudioModelFiles( m_szModelFilename.c_str(), *pEntity->GetModel(), files );
+
+			for( const auto& szFilename : files )
+			{
+				m_FileWatcher.Watch( szFilename );
+			}
+		}
+	}
+
+	if( !m_szBackgroundTextureFilename.empty() )
+		m_FileWatcher.Watch( m_szBackgroundTextureFilename );
+
+	if( !m_szGroundTextureFilename.empty() )
+		m_FileWatcher.Watch( m_szGroundTextureFilename );
+}
+
+void CMainPanel::ReloadChangedFiles()
+{
+	if( !m_FileWatcher.Poll( m_ChangedFiles ) )
+		return;
+
+	m_p3DView->PrepareForLoad();
+
+	for( const auto& szFilename : m_ChangedFiles )
+	{
+		if( szFilename == m_szBackgroundTextureFilename )
+		{
+			//Keep the background hidden if it was.
+			const bool bShowBackground = m_pHLMV->GetState()->showBackground;
+
+			m_p3DView->LoadBackgroundTexture( szFilename );
+
+			m_pHLMV->GetState()->showBackground = bShowBackground && m_pHLMV->GetState()->showBackground;
+
+			Message( "Reloaded background texture \"%s\"\n", szFilename.c_str() );
+		}
+
+		else if( szFilename == m_szGroundTextureFilename )
+		{
+			m_p3DView->LoadGroundTexture( szFilename );
+
+			Message( "Reloaded ground texture \"%s\"\n", szFilename.c_str() );
+		}
+		else if( !m_szModelFilename.empty() )
+		{
+			ReloadModelFile( szFilename );
+		}
+	}
+}
+
+void CMainPanel::ReloadModelFile( const std::string& szFilename )
+{
+	auto pEntity = m_pHLMV->GetState()->GetEntity();
+
+	if( !pEntity )
+		return;
+
+	if( m_pHLMV->GetState()->modelChanged )
+	{
+		Warning( "The model has unsaved changes, not reloading \"%s\"\n", szFilename.c_str() );
+		return;
+	}
+
+	const auto result = studiomdl::ReloadStudioModelFile( m_szModelFilename.c_str(), *pEntity->GetModel(), szFilename.c_str() );
+
+	switch( result )
+	{
+	case studiomdl::StudioModelReloadResult::UNCHANGED: break;
+
+	case studiomdl::StudioModelReloadResult::TEXTURESUPDATED:
+		{
+			Message( "Reloaded textures from \"%s\"\n", szFilename.c_str() );
+			break;
+		}
+
+	case studiomdl::StudioModelReloadResult::TEXTURESREPLACED:
+		{
+			//The model is shared, every entity that uses it has cached poses with the old textures.
+			CStudioModelEntity::ModelDataChanged( pEntity->GetModel() );
+
+			//Skin families are part of the texture header.
+			m_pBodyParts->InitializeUI();
+			m_pTextures->InitializeUI();
+
+			Message( "Reloaded textures from \"%s\"\n", szFilename.c_str() );
+			break;
+		}
+
+	case studiomdl::StudioModelReloadResult::SEQUENCEGROUP:
+		{
+			CStudioModelEntity::ModelDataChanged( pEntity->GetModel() );
+
+			Message( "Reloaded sequence group \"%s\"\n", szFilename.c_str() );
+			break;
+		}
+
+	case studiomdl::StudioModelReloadResult::NEEDSFULLRELOAD:
+		{
+			ReloadModel();
+			break;
+		}
+
+	default:
+	case studiomdl::StudioModelReloadResult::FAILURE:
+		{
+			Warning( "Couldn't reload \"%s\", keeping the loaded version\n", szFilename.c_str() );
+			break;
+		}
+	}
+}
+
+void CMainPanel::ReloadModel()
+{
+	auto pState = m_pHLMV->GetState();
+
+	auto pEntity = pState->GetEntity();
+
+	if( !pEntity )
+		return;
+
+	const int iSequence = pEntity->GetSequence();
+	const int iFrame = static_cast<int>( pEntity->GetFrame() );
+
+	const auto camera = pState->camera;
+	const auto weaponOriginCamera = pState->weaponOriginCamera;
+
+	//Copy the name, loading clears it.
+	const std::string szFilename = m_szModelFilename;
+
+	if( !LoadModel( szFilename ) )
+		return;
+
+	pState->camera = camera;
+	pState->weaponOriginCamera = weaponOriginCamera;
+
+	m_pSequencesPanel->SetSequence( iSequence );
+	m_pSequencesPanel->SetFrame( iFrame );
+
+	Message( "Reloaded model \"%s\"\n", szFilename.c_str() );
 }
 
 void CMainPanel::InitializeUI()
@@ -298,22 +572,42 @@ void CMainPanel::PageChanged( wxBookCtrlEvent& event )
 
 bool CMainPanel::LoadBackgroundTexture( const wxString& szFilename )
 {
-	return m_p3DView->LoadBackgroundTexture( szFilename );
+	const bool bSuccess = m_p3DView->LoadBackgroundTexture( szFilename );
+
+	m_szBackgroundTextureFilename = bSuccess ? resource::CanonicalizePath( szFilename.c_str() ) : "";
+
+	UpdateWatchedFiles();
+
+	return bSuccess;
 }
 
 void CMainPanel::UnloadBackgroundTexture()
 {
-	return m_p3DView->UnloadBackgroundTexture();
+	m_p3DView->UnloadBackgroundTexture();
+
+	m_szBackgroundTextureFilename.clear();
+
+	UpdateWatchedFiles();
 }
 
 bool CMainPanel::LoadGroundTexture( const wxString& szFilename )
 {
-	return m_p3DView->LoadGroundTexture( szFilename );
+	const bool bSuccess = m_p3DView->LoadGroundTexture( szFilename );
+
+	m_szGroundTextureFilename = bSuccess ? resource::CanonicalizePath( szFilename.c_str() ) : "";
+
+	UpdateWatchedFiles();
+
+	return bSuccess;
 }
 
 void CMainPanel::UnloadGroundTexture()
 {
 	m_p3DView->UnloadGroundTexture();
+
+	m_szGroundTextureFilename.clear();
+
+	UpdateWatchedFiles();
 }
 
 void CMainPanel::SaveUVMap( const wxString& szFilename, const int iTexture )
@@ -326,6 +620,11 @@ void CMainPanel::TakeScreenshot()
 	m_p3DView->TakeScreenshot();
 }
 
+void CMainPanel::CaptureSequence()
+{
+	m_p3DView->CaptureSequence();
+}
+
 void CMainPanel::OnPostDraw( studiomdl::IStudioModelRenderer& renderer, const studiomdl::CModelRenderInfo& info )
 {
 	auto pPage = static_cast<CBaseControlPanel*>( m_pControlPanels->GetCurrentPage() );
@@ -3,10 +3,17 @@
 
 #include "wxHLMV.h"
 
+#include <string>
+#include <vector>
+
 #include <wx/notebook.h>
 
 #include "shared/Utility.h"
 
+#include "utility/CFileWatcher.h"
+
+#include "shared/studiomodel/CStudioModel.h"
+
 #include "shared/renderer/studiomodel/IStudioModelRendererListener.h"
 
 #include "controlpanels/CBaseControlPanel.h"
@@ -107,6 +114,8 @@ public:
 
 	void TakeScreenshot();
 
+	void CaptureSequence();
+
 protected:
 	wxDECLARE_EVENT_TABLE();
 
@@ -134,6 +143,41 @@ private:
 
 	void ResetLightVector( wxCommandEvent& event );
 
+	/**
+	*	Stops loading the current model, if it's still loading. The incomplete model is removed from the model cache.
+	*/
+	void CancelModelLoad();
+
+	/**
+	*	Applies the stages of the model load that completed, and updates the control panels that depend on them.
+	*/
+	void UpdateModelLoad();
+
+	/**
+	*	Removes the current model from the model cache if it has unsaved changes.
+	*/
+	void DiscardChangedModel();
+
+	/**
+	*	Watches the files of the current model and the background and ground textures.
+	*/
+	void UpdateWatchedFiles();
+
+	/**
+	*	Reloads files that changed on disk.
+	*/
+	void ReloadChangedFiles();
+
+	/**
+	*	Reloads a file of the current model, updating only what changed.
+	*/
+	void ReloadModelFile( const std::string& szFilename );
+
+	/**
+	*	Loads the current model again, keeping the current sequence, frame and view.
+	*/
+	void ReloadModel();
+
 private:
 	CModelViewerApp* const m_pHLMV;
 
@@ -152,6 +196,26 @@ private:
 	long long m_iLastFPSUpdate = GetCurrentTick();
 	unsigned int m_uiCurrentFPS = 0;
 
+	studiomdl::CStudioModelLoader m_ModelLoader;
+
+	/**
+	*	Stage of the model load that the control panels were last updated for.
+	*/
+	studiomdl::StudioModelLoadStage m_ModelLoadStage = studiomdl::StudioModelLoadStage::NONE;
+
+	CFileWatcher m_FileWatcher;
+
+	long long m_iLastFileCheck = GetCurrentTick();
+
+	std::vector<std::string> m_ChangedFiles;
+
+	/**
+	*	Canonical names of the loaded files. Empty if not loaded.
+	*/
+	std::string m_szModelFilename;
+	std::string m_szBackgroundTextureFilename;
+	std::string m_szGroundTextureFilename;
+
 	wxStaticText* m_pFPS;
 
 	wxStaticText* m_pLightVector;
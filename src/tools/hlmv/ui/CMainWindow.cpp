@@ -33,6 +33,7 @@ wxBEGIN_EVENT_TABLE( CMainWindow, ui::CwxBaseFrame )
 	EVT_MENU( wxID_MAINWND_SAVEVIEW, CMainWindow::SaveView )
 	EVT_MENU( wxID_MAINWND_RESTOREVIEW, CMainWindow::RestoreView )
 	EVT_MENU( wxID_MAINWND_TAKESCREENSHOT, CMainWindow::TakeScreenshot )
+	EVT_MENU( wxID_MAINWND_CAPTURESEQUENCE, CMainWindow::CaptureSequence )
 	EVT_MENU( wxID_MAINWND_DUMPMODELINFO, CMainWindow::DumpModelInfo )
 	EVT_MENU( wxID_MAINWND_TOGGLEMESSAGES, CMainWindow::ShowMessagesWindow )
 	EVT_MENU( wxID_MAINWND_COMPILEMODEL, CMainWindow::OnCompileModel )
@@ -97,6 +98,8 @@ CMainWindow::CMainWindow( CModelViewerApp* const pHLMV )
 
 	pMenuView->Append( wxID_MAINWND_TAKESCREENSHOT, "Take Screenshot" );
 
+	pMenuView->Append( wxID_MAINWND_CAPTURESEQUENCE, "Capture Sequence..." );
+
 	pMenuView->Append( wxID_MAINWND_DUMPMODELINFO, "Dump Model Info" );
 
 	wxMenu* pMenuTools = new wxMenu;
@@ -308,6 +311,11 @@ void CMainWindow::TakeScreenshot()
 	m_pMainPanel->TakeScreenshot();
 }
 
+void CMainWindow::CaptureSequence()
+{
+	m_pMainPanel->CaptureSequence();
+}
+
 void CMainWindow::DumpModelInfo()
 {
 	if( !m_pHLMV->GetState()->GetEntity() )
@@ -415,6 +423,11 @@ void CMainWindow::TakeScreenshot( wxCommandEvent& event )
 	TakeScreenshot();
 }
 
+void CMainWindow::CaptureSequence( wxCommandEvent& event )
+{
+	CaptureSequence();
+}
+
 void CMainWindow::DumpModelInfo( wxCommandEvent& event )
 {
 	DumpModelInfo();
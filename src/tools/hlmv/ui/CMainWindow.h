@@ -68,6 +68,8 @@ public:
 
 	void TakeScreenshot();
 
+	void CaptureSequence();
+
 	void DumpModelInfo();
 
 	bool OnDropFiles( wxCoord x, wxCoord y, const wxArrayString& filenames );
@@ -90,6 +92,7 @@ private:
 	void SaveView( wxCommandEvent& event );
 	void RestoreView( wxCommandEvent& event );
 	void TakeScreenshot( wxCommandEvent& event );
+	void CaptureSequence( wxCommandEvent& event );
 	void DumpModelInfo( wxCommandEvent& event );
 
 	void ShowMessagesWindow( wxCommandEvent& event );
@@ -122,6 +122,9 @@ void CModelViewerApp::ShutdownApp()
 
 	EntityManager().Shutdown();
 
+	//All entities are gone, so no models are referenced anymore.
+	m_ModelCache.Clear();
+
 	if( m_pSettings )
 	{
 		delete m_pSettings;
@@ -5,6 +5,8 @@
 
 #include "tools/shared/CBaseWXToolApp.h"
 
+#include "shared/studiomodel/StudioModelCache.h"
+
 #include "../CHLMVState.h"
 #include "../settings/CHLMVSettings.h"
 
@@ -57,6 +59,11 @@ public:
 	*/
 	CFullscreenWindow* GetFullscreenWindow() { return m_pFullscreenWindow; }
 
+	/**
+	*	Gets the model cache.
+	*/
+	studiomdl::CStudioModelCache& GetModelCache() { return m_ModelCache; }
+
 	/**
 	*	Sets the fullscreen window.
 	*/
@@ -149,6 +156,8 @@ private:
 	CMainWindow* m_pMainWindow = nullptr;
 	CFullscreenWindow* m_pFullscreenWindow = nullptr;
 
+	studiomdl::CStudioModelCache m_ModelCache{ "studiomodel" };
+
 	wxString m_szModel;		//Model to load on startup, if any.
 };
 }
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include <wx/dcmemory.h>
+#include <wx/image.h>
+
+#include "shared/Stats.h"
+
+#include "CStatsOverlay.h"
+
+namespace hlmv
+{
+namespace
+{
+const int OVERLAY_MARGIN = 4;
+
+double GetOverlayTime()
+{
+	return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+}
+
+CStatsOverlay::~CStatsOverlay()
+{
+	//The context may not be current anymore, Shutdown should have been called.
+	wxASSERT( m_Texture == GL_INVALID_TEXTURE_ID );
+}
+
+void CStatsOverlay::Shutdown()
+{
+	glDeleteTexture( m_Texture );
+
+	m_iTextureWidth = m_iTextureHeight = 0;
+	m_flNextUpdateTime = 0;
+}
+
+void CStatsOverlay::Draw( const int iWidth, const int iHeight, const char* const pszFilter )
+{
+	const double flTime = GetOverlayTime();
+
+	if( m_Texture == GL_INVALID_TEXTURE_ID || flTime >= m_flNextUpdateTime )
+	{
+		m_flNextUpdateTime = flTime + UPDATE_INTERVAL;
+
+		std::vector<std::string> lines;
+
+		stats::Registry().Format( lines, pszFilter );
+
+		UpdateTexture( lines );
+	}
+
+	if( m_Texture == GL_INVALID_TEXTURE_ID )
+		return;
+
+	glMatrixMode( GL_PROJECTION );
+	glPushMatrix();
+	glLoadIdentity();
+
+	glOrtho( 0.0f, ( float ) iWidth, ( float ) iHeight, 0.0f, 1.0f, -1.0f );
+
+	glMatrixMode( GL_MODELVIEW );
+	glPushMatrix();
+	glLoadIdentity();
+
+	glPushAttrib( GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_POLYGON_BIT | GL_TEXTURE_BIT );
+
+	glDisable( GL_DEPTH_TEST );
+	glDisable( GL_CULL_FACE );
+	glDisable( GL_ALPHA_TEST );
+	glEnable( GL_TEXTURE_2D );
+	glEnable( GL_BLEND );
+	glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
+
+	glTexEnvf( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
+
+	glBindTexture( GL_TEXTURE_2D, m_Texture );
+
+	const float x = OVERLAY_MARGIN;
+	const float y = OVERLAY_MARGIN;
+
+	glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
+
+	glBegin( GL_TRIANGLE_STRIP );
+
+	glTexCoord2f( 0, 0 );
+	glVertex2f( x, y );
+
+	glTexCoord2f( 1, 0 );
+	glVertex2f( x + m_iTextureWidth, y );
+
+	glTexCoord2f( 0, 1 );
+	glVertex2f( x, y + m_iTextureHeight );
+
+	glTexCoord2f( 1, 1 );
+	glVertex2f( x + m_iTextureWidth, y + m_iTextureHeight );
+
+	glEnd();
+
+	glPopAttrib();
+
+	glMatrixMode( GL_MODELVIEW );
+	glPopMatrix();
+
+	glMatrixMode( GL_PROJECTION );
+	glPopMatrix();
+
+	glMatrixMode( GL_MODELVIEW );
+}
+
+void CStatsOverlay::UpdateTexture( const std::vector<std::string>& lines )
+{
+	glDeleteTexture( m_Texture );
+
+	if( lines.empty() )
+		return;
+
+	wxFont font( wxFontInfo( 9 ).Family( wxFONTFAMILY_TELETYPE ) );
+
+	int iWidth = 0;
+	int iHeight = 0;
+
+	std::vector<wxString> text;
+
+	text.reserve( lines.size() );
+
+	{
+		wxBitmap measure( 1, 1 );
+		wxMemoryDC dc( measure );
+
+		dc.SetFont( font );
+
+		for( const auto& line : lines )
+		{
+			text.emplace_back( line.c_str(), wxConvUTF8 );
+
+			const wxSize size = dc.GetTextExtent( text.back() );
+
+			iWidth = std::max( iWidth, size.GetWidth() );
+			iHeight += size.GetHeight();
+		}
+	}
+
+	iWidth += OVERLAY_MARGIN * 2;
+	iHeight += OVERLAY_MARGIN * 2;
+
+	wxBitmap bitmap( iWidth, iHeight, 24 );
+
+	{
+		wxMemoryDC dc( bitmap );
+
+		dc.SetBackground( *wxBLACK_BRUSH );
+		dc.Clear();
+
+		dc.SetFont( font );
+		dc.SetTextForeground( *wxWHITE );
+
+		int y = OVERLAY_MARGIN;
+
+		for( const auto& line : text )
+		{
+			dc.DrawText( line, OVERLAY_MARGIN, y );
+
+			y += dc.GetTextExtent( line ).GetHeight();
+		}
+	}
+
+	const wxImage image = bitmap.ConvertToImage();
+
+	const unsigned char* const pSource = image.GetData();
+
+	std::unique_ptr<GLubyte[]> pData( new GLubyte[ iWidth * iHeight * 4 ] );
+
+	//Text is drawn white on black. Use the brightness as coverage on top of a translucent black background so it's readable on any model.
+	for( int i = 0; i < iWidth * iHeight; ++i )
+	{
+		const GLubyte coverage = pSource[ i * 3 ];
+
+		pData[ i * 4 + 0 ] = coverage;
+		pData[ i * 4 + 1 ] = coverage;
+		pData[ i * 4 + 2 ] = coverage;
+		pData[ i * 4 + 3 ] = std::max<GLubyte>( coverage, 128 );
+	}
+
+	glGenTextures( 1, &m_Texture );
+
+	glBindTexture( GL_TEXTURE_2D, m_Texture );
+	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, iWidth, iHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, pData.get() );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+
+	m_iTextureWidth = iWidth;
+	m_iTextureHeight = iHeight;
+}
+}
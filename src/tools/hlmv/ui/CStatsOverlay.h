@@ -0,0 +1,57 @@
+#ifndef CSTATSOVERLAY_H
+#define CSTATSOVERLAY_H
+
+#include <string>
+#include <vector>
+
+#include "wxHLMV.h"
+
+#include "graphics/OpenGL.h"
+
+namespace hlmv
+{
+/**
+*	Draws the runtime stats on top of the 3D view, like r_speeds in the engine.
+*	The text is rendered into a texture using wxWidgets, and only updated periodically since that is slow.
+*/
+class CStatsOverlay final
+{
+public:
+	/**
+	*	Time between text updates, in seconds.
+	*/
+	static constexpr double UPDATE_INTERVAL = 0.5;
+
+public:
+	CStatsOverlay() = default;
+	~CStatsOverlay();
+
+	/**
+	*	Deletes the texture. The OpenGL context must be current.
+	*/
+	void Shutdown();
+
+	/**
+	*	Draws the overlay in the top left corner of the viewport. Updates the text if needed.
+	*	@param pszFilter Only stats whose name contains this are drawn. May be null.
+	*/
+	void Draw( const int iWidth, const int iHeight, const char* const pszFilter );
+
+private:
+	void UpdateTexture( const std::vector<std::string>& lines );
+
+private:
+	GLuint m_Texture = GL_INVALID_TEXTURE_ID;
+
+	int m_iTextureWidth = 0;
+	int m_iTextureHeight = 0;
+
+	double m_flNextUpdateTime = 0;
+
+private:
+	CStatsOverlay( const CStatsOverlay& ) = delete;
+	CStatsOverlay& operator=( const CStatsOverlay& ) = delete;
+};
+}
+
+#endif //CSTATSOVERLAY_H
@@ -16,6 +16,7 @@ namespace hlmv
 {
 wxBEGIN_EVENT_TABLE( CModelDisplayPanel, CBaseControlPanel )
 	EVT_CHOICE( wxID_MDLDISP_RENDERMODE, CModelDisplayPanel::RenderModeChanged )
+	EVT_CHOICE( wxID_MDLDISP_VIEWPORTLAYOUT, CModelDisplayPanel::ViewportLayoutChanged )
 	EVT_SLIDER( wxID_MDLDISP_OPACITY, CModelDisplayPanel::OpacityChanged )
 	EVT_CHECKBOX( wxID_MDLDISP_CHECKBOX, CModelDisplayPanel::CheckBoxChanged )
 	EVT_BUTTON( wxID_MDLDISP_SCALEMESH, CModelDisplayPanel::ScaleMesh )
@@ -51,6 +52,17 @@ CModelDisplayPanel::CModelDisplayPanel( wxWindow* pParent, CModelViewerApp* cons
 
 	m_pRenderMode->SetSelection( static_cast<int>( RenderMode::TEXTURE_SHADED ) );
 
+	wxStaticText* pViewportLayout = new wxStaticText( pElemParent, wxID_ANY, "Viewports:" );
+
+	m_pViewportLayout = new wxChoice( pElemParent, wxID_MDLDISP_VIEWPORTLAYOUT );
+
+	for( int iLayout = static_cast<int>( ViewportLayout::FIRST ); iLayout < static_cast<int>( ViewportLayout::COUNT ); ++iLayout )
+	{
+		m_pViewportLayout->Append( ViewportLayoutToString( static_cast<ViewportLayout>( iLayout ) ) );
+	}
+
+	m_pViewportLayout->SetSelection( static_cast<int>( m_pHLMV->GetState()->viewportLayout ) );
+
 	m_pCheckBoxes[ CheckBox::SHOW_HITBOXES ]		= new wxCheckBox( pElemParent, wxID_MDLDISP_CHECKBOX, "Show Hit Boxes" );
 	m_pCheckBoxes[ CheckBox::SHOW_BONES ]			= new wxCheckBox( pElemParent, wxID_MDLDISP_CHECKBOX, "Show Bones" );
 	m_pCheckBoxes[ CheckBox::SHOW_ATTACHMENTS ]		= new wxCheckBox( pElemParent, wxID_MDLDISP_CHECKBOX, "Show Attachments" );
@@ -106,6 +118,9 @@ CModelDisplayPanel::CModelDisplayPanel( wxWindow* pParent, CModelViewerApp* cons
 	pFirstColSizer->Add( pRenderMode, wxSizerFlags().Expand() );
 	pFirstColSizer->Add( m_pRenderMode, wxSizerFlags().Expand() );
 
+	pFirstColSizer->Add( pViewportLayout, wxSizerFlags().Expand() );
+	pFirstColSizer->Add( m_pViewportLayout, wxSizerFlags().Expand() );
+
 	pFirstColSizer->Add( m_pOpacity, wxSizerFlags().Expand() );
 	pFirstColSizer->Add( m_pOpacitySlider, wxSizerFlags().Expand() );
 
@@ -186,6 +201,18 @@ void CModelDisplayPanel::SetRenderMode( RenderMode renderMode )
 	m_pHLMV->GetState()->renderMode = renderMode;
 }
 
+void CModelDisplayPanel::SetViewportLayout( ViewportLayout layout )
+{
+	if( layout < ViewportLayout::FIRST )
+		layout = ViewportLayout::FIRST;
+	else if( layout > ViewportLayout::LAST )
+		layout = ViewportLayout::LAST;
+
+	m_pViewportLayout->Select( static_cast<int>( layout ) );
+
+	m_pHLMV->GetState()->viewportLayout = layout;
+}
+
 void CModelDisplayPanel::SetOpacity( int iValue, const bool bUpdateSlider )
 {
 	if( iValue < OPACITY_MIN )
@@ -319,6 +346,16 @@ void CModelDisplayPanel::RenderModeChanged( wxCommandEvent& event )
 	SetRenderMode( static_cast<RenderMode>( iValue ) );
 }
 
+void CModelDisplayPanel::ViewportLayoutChanged( wxCommandEvent& event )
+{
+	const int iValue = m_pViewportLayout->GetSelection();
+
+	if( iValue == wxNOT_FOUND )
+		return;
+
+	SetViewportLayout( static_cast<ViewportLayout>( iValue ) );
+}
+
 void CModelDisplayPanel::OpacityChanged( wxCommandEvent& event )
 {
 	SetOpacity( m_pOpacitySlider->GetValue(), false );
@@ -344,6 +381,9 @@ void CModelDisplayPanel::ScaleMesh( wxCommandEvent& event )
 	{
 		studiomdl::ScaleMeshes( pEntity->GetModel(), m_pMeshScale->GetValue() );
 
+		//Cached poses still use the old data.
+		CStudioModelEntity::ModelDataChanged( pEntity->GetModel() );
+
 		m_pHLMV->GetState()->modelChanged = true;
 	}
 }
@@ -356,6 +396,9 @@ void CModelDisplayPanel::ScaleBones( wxCommandEvent& event )
 	{
 		studiomdl::ScaleBones( pEntity->GetModel(), m_pBonesScale->GetValue() );
 
+		//Cached poses still use the old data.
+		CStudioModelEntity::ModelDataChanged( pEntity->GetModel() );
+
 		m_pHLMV->GetState()->modelChanged = true;
 	}
 }
@@ -66,6 +66,8 @@ public:
 
 	void SetRenderMode( RenderMode renderMode );
 
+	void SetViewportLayout( ViewportLayout layout );
+
 	//0..100
 	void SetOpacity( int iValue, const bool bUpdateSlider = true );
 
@@ -79,6 +81,8 @@ private:
 
 	void RenderModeChanged( wxCommandEvent& event );
 
+	void ViewportLayoutChanged( wxCommandEvent& event );
+
 	void OpacityChanged( wxCommandEvent& event );
 
 	void CheckBoxChanged( wxCommandEvent& event );
@@ -98,6 +102,8 @@ private:
 private:
 	wxChoice* m_pRenderMode;
 
+	wxChoice* m_pViewportLayout;
+
 	wxStaticText* m_pOpacity;
 	wxSlider* m_pOpacitySlider;
 
@@ -650,7 +650,12 @@ void CSequencesPanel::OnEditEvents( wxCommandEvent& event )
 	UpdateEventInfo( m_pEvent->GetSelection() );
 
 	if( dlg.ChangesSaved() )
+	{
+		//Event frames may have changed.
+		pModel->BuildSequenceEvents();
+
 		m_pHLMV->GetState()->modelChanged = true;
+	}
 }
 
 void CSequencesPanel::PlaySoundChanged( wxCommandEvent& event )
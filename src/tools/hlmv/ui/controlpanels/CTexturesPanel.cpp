@@ -125,7 +125,8 @@ void CTexturesPanel::InitializeUI()
 		{
 			const studiohdr_t* const pHdr = pModel->GetTextureHeader();
 
-			if( pHdr )
+			//Textures can't be edited until they've finished loading.
+			if( pHdr && pModel->AreTexturesLoaded() )
 			{
 				m_pTexture->Enable( true );
 
@@ -213,12 +214,12 @@ void CTexturesPanel::SetTexture( int iIndex )
 
 	for( uiIndex = 0; uiIndex < meshes.size(); ++uiIndex )
 	{
-		m_pMesh->Append( wxString::Format( "Mesh %u", uiIndex + 1 ), new ui::CMeshClientData( meshes[ uiIndex ] ) );
+		m_pMesh->Append( wxString::Format( "Mesh %u", uiIndex + 1 ), new ui::CMeshClientData( meshes[ uiIndex ].pMesh ) );
 	}
 
 	if( uiIndex > 0 )
 	{
-		m_pHLMV->GetState()->pUVMesh = meshes[ 0 ];
+		m_pHLMV->GetState()->pUVMesh = meshes[ 0 ].pMesh;
 
 		if( uiIndex > 1 )
 		{
@@ -567,7 +568,7 @@ void CTexturesPanel::ExportUVMap( wxCommandEvent& event )
 		return;
 	}
 
-	wxFileDialog dlg( this, wxFileSelectorPromptStr, wxEmptyString, wxEmptyString, "Windows Bitmap (*.bmp)|*.bmp", wxFD_SAVE | wxFD_OVERWRITE_PROMPT );
+	wxFileDialog dlg( this, wxFileSelectorPromptStr, wxEmptyString, wxEmptyString, "PNG files (*.png)|*.png|Windows Bitmap (*.bmp)|*.bmp", wxFD_SAVE | wxFD_OVERWRITE_PROMPT );
 
 	if( dlg.ShowModal() == wxID_CANCEL )
 		return;
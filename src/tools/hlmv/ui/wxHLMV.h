@@ -20,6 +20,7 @@ enum wxIdentifier
 	wxID_MAINWND_SAVEVIEW,
 	wxID_MAINWND_RESTOREVIEW,
 	wxID_MAINWND_TAKESCREENSHOT,
+	wxID_MAINWND_CAPTURESEQUENCE,
 	wxID_MAINWND_DUMPMODELINFO,
 
 	//Tools menu
@@ -36,6 +37,7 @@ enum wxIdentifier
 
 	//Model Display panel
 	wxID_MDLDISP_RENDERMODE,
+	wxID_MDLDISP_VIEWPORTLAYOUT,
 	wxID_MDLDISP_OPACITY,
 	wxID_MDLDISP_CHECKBOX,
 	wxID_MDLDISP_SCALEMESH,
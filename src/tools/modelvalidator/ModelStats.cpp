@@ -0,0 +1,107 @@
+#include <cstring>
+
+#include "ModelStats.h"
+
+namespace tools
+{
+namespace
+{
+int64_t CountTriangles( const short* ptricmds )
+{
+	int64_t iTriangles = 0;
+
+	int i;
+
+	//Strips and fans both add one triangle for each vertex after the first 2.
+	while( ( i = *( ptricmds++ ) ) )
+	{
+		if( i < 0 )
+			i = -i;
+
+		if( i > 2 )
+			iTriangles += i - 2;
+
+		ptricmds += i * 4;
+	}
+
+	return iTriangles;
+}
+}
+
+void GetModelStats( const byte* const pData, const size_t uiSize, ModelStats_t& stats )
+{
+	stats = ModelStats_t();
+
+	stats.uiFileSize = uiSize;
+
+	if( !strncmp( reinterpret_cast<const char*>( pData ), STUDIOMDL_SEQ_ID, 4 ) )
+	{
+		stats.type = ModelFileType::SEQUENCEGROUP;
+		return;
+	}
+
+	const studiohdr_t* const pStudioHdr = reinterpret_cast<const studiohdr_t*>( pData );
+
+	stats.type = pStudioHdr->numbones == 0 && pStudioHdr->numtextures > 0 ? ModelFileType::TEXTURES : ModelFileType::MODEL;
+
+	stats.iBones = pStudioHdr->numbones;
+	stats.iBoneControllers = pStudioHdr->numbonecontrollers;
+	stats.iHitboxes = pStudioHdr->numhitboxes;
+	stats.iSequences = pStudioHdr->numseq;
+	stats.iSequenceGroups = pStudioHdr->numseqgroups;
+
+	for( int iSequence = 0; iSequence < pStudioHdr->numseq; ++iSequence )
+	{
+		stats.iFrames += pStudioHdr->GetSequence( iSequence )->numframes;
+	}
+
+	stats.iBodyparts = pStudioHdr->numbodyparts;
+
+	for( int iBodypart = 0; iBodypart < pStudioHdr->numbodyparts; ++iBodypart )
+	{
+		const mstudiobodyparts_t* const pBodypart = pStudioHdr->GetBodypart( iBodypart );
+
+		stats.iSubModels += pBodypart->nummodels;
+
+		const mstudiomodel_t* const pModels = reinterpret_cast<const mstudiomodel_t*>( pData + pBodypart->modelindex );
+
+		for( int iModel = 0; iModel < pBodypart->nummodels; ++iModel )
+		{
+			const mstudiomodel_t& model = pModels[ iModel ];
+
+			stats.iMeshes += model.nummesh;
+			stats.iVertices += model.numverts;
+			stats.iNormals += model.numnorms;
+
+			const mstudiomesh_t* const pMeshes = reinterpret_cast<const mstudiomesh_t*>( pData + model.meshindex );
+
+			for( int iMesh = 0; iMesh < model.nummesh; ++iMesh )
+			{
+				stats.iTriangles += CountTriangles( reinterpret_cast<const short*>( pData + pMeshes[ iMesh ].triindex ) );
+			}
+		}
+	}
+
+	stats.iTextures = pStudioHdr->numtextures;
+	stats.iSkinFamilies = pStudioHdr->numskinfamilies;
+
+	for( int iTexture = 0; iTexture < pStudioHdr->numtextures; ++iTexture )
+	{
+		const mstudiotexture_t* const pTexture = pStudioHdr->GetTexture( iTexture );
+
+		stats.uiTextureMemory += static_cast<uint64_t>( pTexture->width ) * pTexture->height * 4;
+	}
+}
+
+const char* ModelFileTypeToString( const ModelFileType type )
+{
+	switch( type )
+	{
+	case ModelFileType::MODEL:			return "model";
+	case ModelFileType::TEXTURES:		return "textures";
+	case ModelFileType::SEQUENCEGROUP:	return "sequencegroup";
+
+	default: return "unknown";
+	}
+}
+}
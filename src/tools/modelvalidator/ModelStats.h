@@ -0,0 +1,82 @@
+#ifndef TOOLS_MODELVALIDATOR_MODELSTATS_H
+#define TOOLS_MODELVALIDATOR_MODELSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "shared/studiomodel/studio.h"
+
+namespace tools
+{
+/**
+*	Kind of studio model file.
+*/
+enum class ModelFileType
+{
+	MODEL = 0,
+	TEXTURES,		//T.mdl file; only contains textures.
+	SEQUENCEGROUP	//NN.mdl file; only contains animations.
+};
+
+/**
+*	Statistics gathered from a single studio model file.
+*/
+struct ModelStats_t
+{
+	ModelFileType type = ModelFileType::MODEL;
+
+	uint64_t uiFileSize = 0;
+
+	int iBones = 0;
+	int iBoneControllers = 0;
+	int iHitboxes = 0;
+	int iSequences = 0;
+	int iSequenceGroups = 0;
+
+	/**
+	*	Total number of frames in all sequences.
+	*/
+	int64_t iFrames = 0;
+
+	int iBodyparts = 0;
+
+	/**
+	*	Number of submodels in all body parts.
+	*/
+	int iSubModels = 0;
+	int iMeshes = 0;
+
+	int64_t iVertices = 0;
+	int64_t iNormals = 0;
+
+	/**
+	*	Number of triangles, counted from the triangle strips and fans of every mesh.
+	*/
+	int64_t iTriangles = 0;
+
+	int iTextures = 0;
+	int iSkinFamilies = 0;
+
+	/**
+	*	Memory needed to store all textures as 32 bit RGBA, in bytes. This is what the renderer uploads.
+	*/
+	uint64_t uiTextureMemory = 0;
+};
+
+/**
+*	Gathers statistics from a studio model file.
+*	The file must have been validated with studiomdl::ValidateStudioFile first.
+*	@param pData File contents.
+*	@param uiSize Size of the file, in bytes.
+*	@param stats Receives the statistics.
+*/
+void GetModelStats( const byte* const pData, const size_t uiSize, ModelStats_t& stats );
+
+/**
+*	Gets the name of a file type, as used in output.
+*/
+const char* ModelFileTypeToString( const ModelFileType type );
+}
+
+#endif //TOOLS_MODELVALIDATOR_MODELSTATS_H
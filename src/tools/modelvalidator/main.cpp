@@ -0,0 +1,588 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <experimental/filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shared/studiomodel/StudioModelValidation.h"
+#include "shared/studiomodel/StudioUVMap.h"
+
+#include "graphics/PNGFile.h"
+
+#include "ModelStats.h"
+
+namespace fs = std::experimental::filesystem;
+
+namespace
+{
+enum class OutputFormat
+{
+	JSON_LINES = 0,
+	CSV
+};
+
+void PrintUsage( const char* const pszProgram )
+{
+	printf(
+		"Usage: %s [options] <file or directory> ...\n"
+		"Validates studio models and prints statistics for each file. OpenGL is not needed.\n"
+		"Directories are searched recursively for .mdl and .dol files.\n"
+		"\n"
+		"Options:\n"
+		"  --format <jsonl|csv>   Output format (default jsonl)\n"
+		"  --output <file>        Write results to this file instead of standard output\n"
+		"  --threads <count>      Number of files to process at the same time (default: number of cores)\n"
+		"  --uvmaps <directory>   Also save the UV map of each texture of valid models as <model>_<texture>.png in this directory\n"
+		"\n"
+		"Results are written in the order the files were found. The exit code is 1 if any file is invalid\n"
+		"or a UV map couldn't be saved.\n",
+		pszProgram );
+}
+
+bool IsStudioModelFile( const fs::path& path )
+{
+	std::string szExtension = path.extension().string();
+
+	std::transform( szExtension.begin(), szExtension.end(), szExtension.begin(), ::tolower );
+
+	return szExtension == ".mdl" || szExtension == ".dol";
+}
+
+void AddInput( const std::string& szInput, std::vector<std::string>& files )
+{
+	std::error_code error;
+
+	const fs::path path( szInput );
+
+	if( fs::is_directory( path, error ) )
+	{
+		const size_t uiFirst = files.size();
+
+		for( fs::recursive_directory_iterator it( path, error ), end; !error && it != end; it.increment( error ) )
+		{
+			if( fs::is_regular_file( it->status() ) && IsStudioModelFile( it->path() ) )
+				files.emplace_back( it->path().string() );
+		}
+
+		if( error )
+			fprintf( stderr, "Error scanning \"%s\": %s\n", szInput.c_str(), error.message().c_str() );
+
+		//Directory iteration order is unspecified; sort so results are stable between runs.
+		std::sort( files.begin() + uiFirst, files.end() );
+	}
+	else
+	{
+		files.emplace_back( szInput );
+	}
+}
+
+void AppendJSONString( std::string& szOutput, const std::string& szString )
+{
+	szOutput += '"';
+
+	for( const char c : szString )
+	{
+		switch( c )
+		{
+		case '"':	szOutput += "\\\""; break;
+		case '\\':	szOutput += "\\\\"; break;
+		case '\n':	szOutput += "\\n"; break;
+		case '\r':	szOutput += "\\r"; break;
+		case '\t':	szOutput += "\\t"; break;
+
+		default:
+			{
+				if( static_cast<unsigned char>( c ) < 0x20 )
+				{
+					char szEscape[ 8 ];
+					snprintf( szEscape, sizeof( szEscape ), "\\u%04x", c );
+					szOutput += szEscape;
+				}
+				else
+				{
+					szOutput += c;
+				}
+
+				break;
+			}
+		}
+	}
+
+	szOutput += '"';
+}
+
+void AppendCSVString( std::string& szOutput, const std::string& szString )
+{
+	if( szString.find_first_of( ",\"\r\n" ) == std::string::npos )
+	{
+		szOutput += szString;
+		return;
+	}
+
+	szOutput += '"';
+
+	for( const char c : szString )
+	{
+		if( c == '"' )
+			szOutput += '"';
+
+		szOutput += c;
+	}
+
+	szOutput += '"';
+}
+
+bool ReadFile( const std::string& szFilename, std::vector<byte>& data, std::string& szError )
+{
+	FILE* pFile = fopen( szFilename.c_str(), "rb" );
+
+	if( !pFile )
+	{
+		szError = "Couldn't open \"" + szFilename + "\": " + strerror( errno );
+		return false;
+	}
+
+	fseek( pFile, 0, SEEK_END );
+	const long iSize = ftell( pFile );
+	fseek( pFile, 0, SEEK_SET );
+
+	bool bSuccess = false;
+
+	if( iSize < 0 )
+	{
+		szError = "Couldn't get size of \"" + szFilename + "\"";
+	}
+	else
+	{
+		data.resize( static_cast<size_t>( iSize ) );
+
+		bSuccess = data.empty() || fread( data.data(), data.size(), 1, pFile ) == 1;
+
+		if( !bSuccess )
+			szError = "Couldn't read \"" + szFilename + "\"";
+	}
+
+	fclose( pFile );
+
+	return bSuccess;
+}
+
+/**
+*	Saves the UV map of each texture in a model. The model must have been validated.
+*	Textures are loaded from the model's T.mdl file if the model doesn't contain them.
+*	@return true on success, false otherwise.
+*/
+bool SaveUVMaps( const std::string& szFilename, const byte* const pData, const bool bIsDol, const std::string& szDirectory, std::string& szError )
+{
+	const auto& header = *reinterpret_cast<const studiohdr_t*>( pData );
+
+	const studiohdr_t* pTextureHdr = &header;
+
+	std::vector<byte> textureData;
+
+	const fs::path path( szFilename );
+
+	if( header.numtextures == 0 )
+	{
+		fs::path texturePath( path );
+
+		texturePath.replace_filename( path.stem().string() + "T" + path.extension().string() );
+
+		if( !ReadFile( texturePath.string(), textureData, szError ) ||
+			!studiomdl::ValidateStudioFile( textureData.data(), textureData.size(), bIsDol, szError ) )
+			return false;
+
+		pTextureHdr = reinterpret_cast<const studiohdr_t*>( textureData.data() );
+
+		if( !studiomdl::ValidateTextureReferences( header, *pTextureHdr, szError ) )
+			return false;
+	}
+
+	std::vector<studiomdl::UVEdge_t> edges;
+	std::vector<uint8_t> pixels;
+
+	const uint8_t color[ 3 ] = { 255, 255, 255 };
+
+	for( int iTexture = 0; iTexture < pTextureHdr->numtextures; ++iTexture )
+	{
+		const mstudiotexture_t& texture = *pTextureHdr->GetTexture( iTexture );
+
+		studiomdl::ExtractTextureUVEdges( header, *pTextureHdr, iTexture, edges );
+
+		//Black background with white lines.
+		pixels.assign( static_cast<size_t>( texture.width ) * texture.height * 3, 0 );
+
+		studiomdl::RasterizeUVEdges( edges.data(), edges.size(), texture.width, texture.height, pixels.data(), color );
+
+		const std::string szTextureName( texture.name, strnlen( texture.name, sizeof( texture.name ) ) );
+
+		const fs::path outputPath = fs::path( szDirectory ) / ( path.stem().string() + "_" + fs::path( szTextureName ).stem().string() + ".png" );
+
+		if( !graphics::pngfile::SaveRGBPNGFile( outputPath.string().c_str(), texture.width, texture.height, pixels.data(), false ) )
+		{
+			szError = "Couldn't save \"" + outputPath.string() + "\"";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+const char CSV_HEADER[] =
+	"file,valid,error,type,file_size,bones,bone_controllers,hitboxes,sequences,sequence_groups,frames,"
+	"bodyparts,submodels,meshes,vertices,normals,triangles,textures,skin_families,texture_memory\n";
+
+/**
+*	Formats the result for a single file.
+*/
+std::string FormatResult( const OutputFormat format, const std::string& szFilename, const bool bValid, const std::string& szError, const tools::ModelStats_t& stats )
+{
+	std::string szLine;
+
+	char szStats[ 512 ];
+
+	if( format == OutputFormat::JSON_LINES )
+	{
+		szLine += "{\"file\":";
+		AppendJSONString( szLine, szFilename );
+
+		if( !bValid )
+		{
+			szLine += ",\"valid\":false,\"error\":";
+			AppendJSONString( szLine, szError );
+			szLine += "}\n";
+			return szLine;
+		}
+
+		snprintf( szStats, sizeof( szStats ),
+				  ",\"valid\":true,\"type\":\"%s\",\"file_size\":%" PRIu64 ",\"bones\":%d,\"bone_controllers\":%d,\"hitboxes\":%d,"
+				  "\"sequences\":%d,\"sequence_groups\":%d,\"frames\":%" PRId64 ",\"bodyparts\":%d,\"submodels\":%d,\"meshes\":%d,"
+				  "\"vertices\":%" PRId64 ",\"normals\":%" PRId64 ",\"triangles\":%" PRId64 ",\"textures\":%d,\"skin_families\":%d,"
+				  "\"texture_memory\":%" PRIu64 "}\n",
+				  tools::ModelFileTypeToString( stats.type ), stats.uiFileSize, stats.iBones, stats.iBoneControllers, stats.iHitboxes,
+				  stats.iSequences, stats.iSequenceGroups, stats.iFrames, stats.iBodyparts, stats.iSubModels, stats.iMeshes,
+				  stats.iVertices, stats.iNormals, stats.iTriangles, stats.iTextures, stats.iSkinFamilies,
+				  stats.uiTextureMemory );
+	}
+	else
+	{
+		AppendCSVString( szLine, szFilename );
+
+		if( !bValid )
+		{
+			szLine += ",0,";
+			AppendCSVString( szLine, szError );
+			szLine += ",,,,,,,,,,,,,,,,,\n";
+			return szLine;
+		}
+
+		snprintf( szStats, sizeof( szStats ),
+				  ",1,,%s,%" PRIu64 ",%d,%d,%d,%d,%d,%" PRId64 ",%d,%d,%d,%" PRId64 ",%" PRId64 ",%" PRId64 ",%d,%d,%" PRIu64 "\n",
+				  tools::ModelFileTypeToString( stats.type ), stats.uiFileSize, stats.iBones, stats.iBoneControllers, stats.iHitboxes,
+				  stats.iSequences, stats.iSequenceGroups, stats.iFrames, stats.iBodyparts, stats.iSubModels, stats.iMeshes,
+				  stats.iVertices, stats.iNormals, stats.iTriangles, stats.iTextures, stats.iSkinFamilies,
+				  stats.uiTextureMemory );
+	}
+
+	szLine += szStats;
+
+	return szLine;
+}
+
+/**
+*	Processes files on a number of threads, and writes results in the original file order as soon as they're available.
+*/
+class CModelValidator final
+{
+public:
+	CModelValidator( const std::vector<std::string>& files, const OutputFormat format, FILE* pOutput, const char* const pszUVMapDirectory )
+		: m_Files( files )
+		, m_Format( format )
+		, m_pOutput( pOutput )
+		, m_pszUVMapDirectory( pszUVMapDirectory )
+		, m_Results( files.size() )
+		, m_Done( files.size(), false )
+	{
+	}
+
+	void Run( const unsigned int uiNumThreads )
+	{
+		std::vector<std::thread> threads;
+
+		for( unsigned int uiThread = 1; uiThread < uiNumThreads; ++uiThread )
+		{
+			threads.emplace_back( &CModelValidator::WorkerMain, this );
+		}
+
+		WorkerMain();
+
+		for( auto& thread : threads )
+		{
+			thread.join();
+		}
+	}
+
+	size_t GetInvalidCount() const { return m_uiInvalid; }
+
+	size_t GetUVMapFailureCount() const { return m_uiUVMapFailures; }
+
+	uint64_t GetBytesRead() const { return m_uiBytesRead; }
+
+private:
+	void WorkerMain()
+	{
+		//Reused between files to avoid reallocating for every file.
+		std::unique_ptr<byte[]> buffer;
+		size_t uiBufferSize = 0;
+
+		uint64_t uiBytesRead = 0;
+		size_t uiInvalid = 0;
+
+		for( size_t uiIndex; ( uiIndex = m_uiNextFile++ ) < m_Files.size(); )
+		{
+			const std::string& szFilename = m_Files[ uiIndex ];
+
+			std::string szError;
+			tools::ModelStats_t stats;
+
+			bool bValid = false;
+
+			if( FILE* pFile = fopen( szFilename.c_str(), "rb" ) )
+			{
+				fseek( pFile, 0, SEEK_END );
+				const long iSize = ftell( pFile );
+				fseek( pFile, 0, SEEK_SET );
+
+				if( iSize < 0 )
+				{
+					szError = "Couldn't get file size";
+				}
+				else
+				{
+					const size_t uiSize = static_cast<size_t>( iSize );
+
+					if( uiSize > uiBufferSize )
+					{
+						buffer.reset( new byte[ uiSize ] );
+						uiBufferSize = uiSize;
+					}
+
+					if( uiSize > 0 && fread( buffer.get(), uiSize, 1, pFile ) != 1 )
+					{
+						szError = "Couldn't read file";
+					}
+					else
+					{
+						uiBytesRead += uiSize;
+
+						const bool bIsDol = fs::path( szFilename ).extension() == ".dol";
+
+						bValid = studiomdl::ValidateStudioFile( buffer.get(), uiSize, bIsDol, szError );
+
+						if( bValid )
+						{
+							tools::GetModelStats( buffer.get(), uiSize, stats );
+
+							std::string szUVMapError;
+
+							if( m_pszUVMapDirectory && !SaveUVMaps( szFilename, buffer.get(), bIsDol, m_pszUVMapDirectory, szUVMapError ) )
+							{
+								fprintf( stderr, "Couldn't save UV maps for \"%s\": %s\n", szFilename.c_str(), szUVMapError.c_str() );
+								++m_uiUVMapFailures;
+							}
+						}
+					}
+				}
+
+				fclose( pFile );
+			}
+			else
+			{
+				szError = std::string( "Couldn't open file: " ) + strerror( errno );
+			}
+
+			if( !bValid )
+				++uiInvalid;
+
+			OnFileDone( uiIndex, FormatResult( m_Format, szFilename, bValid, szError, stats ) );
+		}
+
+		m_uiBytesRead += uiBytesRead;
+		m_uiInvalid += uiInvalid;
+	}
+
+	void OnFileDone( const size_t uiIndex, std::string&& szResult )
+	{
+		std::lock_guard<std::mutex> lock( m_Mutex );
+
+		m_Results[ uiIndex ] = std::move( szResult );
+		m_Done[ uiIndex ] = true;
+
+		//Write out all results that are now in order.
+		for( ; m_uiNextToWrite < m_Files.size() && m_Done[ m_uiNextToWrite ]; ++m_uiNextToWrite )
+		{
+			auto& szLine = m_Results[ m_uiNextToWrite ];
+
+			fwrite( szLine.c_str(), 1, szLine.size(), m_pOutput );
+
+			std::string().swap( szLine );
+		}
+	}
+
+private:
+	const std::vector<std::string>& m_Files;
+	const OutputFormat m_Format;
+	FILE* const m_pOutput;
+	const char* const m_pszUVMapDirectory;
+
+	std::atomic<size_t> m_uiNextFile{ 0 };
+
+	std::atomic<uint64_t> m_uiBytesRead{ 0 };
+	std::atomic<size_t> m_uiInvalid{ 0 };
+	std::atomic<size_t> m_uiUVMapFailures{ 0 };
+
+	std::mutex m_Mutex;
+
+	//Results that are waiting for earlier files to finish.
+	std::vector<std::string> m_Results;
+	std::vector<bool> m_Done;
+
+	size_t m_uiNextToWrite = 0;
+
+private:
+	CModelValidator( const CModelValidator& ) = delete;
+	CModelValidator& operator=( const CModelValidator& ) = delete;
+};
+}
+
+int main( int iArgc, char* pszArgV[] )
+{
+	OutputFormat format = OutputFormat::JSON_LINES;
+
+	const char* pszOutput = nullptr;
+
+	const char* pszUVMapDirectory = nullptr;
+
+	unsigned int uiNumThreads = std::max( 1u, std::thread::hardware_concurrency() );
+
+	std::vector<std::string> files;
+
+	for( int iArg = 1; iArg < iArgc; ++iArg )
+	{
+		const char* const pszArg = pszArgV[ iArg ];
+
+		const bool bHasValue = iArg + 1 < iArgc;
+
+		if( !strcmp( pszArg, "--help" ) || !strcmp( pszArg, "-h" ) )
+		{
+			PrintUsage( pszArgV[ 0 ] );
+			return EXIT_SUCCESS;
+		}
+		else if( !strcmp( pszArg, "--format" ) && bHasValue )
+		{
+			const char* const pszFormat = pszArgV[ ++iArg ];
+
+			if( !strcmp( pszFormat, "jsonl" ) || !strcmp( pszFormat, "json" ) )
+			{
+				format = OutputFormat::JSON_LINES;
+			}
+			else if( !strcmp( pszFormat, "csv" ) )
+			{
+				format = OutputFormat::CSV;
+			}
+			else
+			{
+				fprintf( stderr, "Unknown format \"%s\"\n", pszFormat );
+				return 2;
+			}
+		}
+		else if( !strcmp( pszArg, "--output" ) && bHasValue )
+		{
+			pszOutput = pszArgV[ ++iArg ];
+		}
+		else if( !strcmp( pszArg, "--uvmaps" ) && bHasValue )
+		{
+			pszUVMapDirectory = pszArgV[ ++iArg ];
+		}
+		else if( !strcmp( pszArg, "--threads" ) && bHasValue )
+		{
+			uiNumThreads = static_cast<unsigned int>( std::max( 1, atoi( pszArgV[ ++iArg ] ) ) );
+		}
+		else if( pszArg[ 0 ] == '-' && pszArg[ 1 ] == '-' )
+		{
+			fprintf( stderr, "Unknown or incomplete option \"%s\"\n", pszArg );
+			PrintUsage( pszArgV[ 0 ] );
+			return 2;
+		}
+		else
+		{
+			AddInput( pszArg, files );
+		}
+	}
+
+	if( files.empty() )
+	{
+		PrintUsage( pszArgV[ 0 ] );
+		return 2;
+	}
+
+	FILE* pOutput = stdout;
+
+	if( pszOutput )
+	{
+		pOutput = fopen( pszOutput, "w" );
+
+		if( !pOutput )
+		{
+			fprintf( stderr, "Couldn't open \"%s\" for writing: %s\n", pszOutput, strerror( errno ) );
+			return 2;
+		}
+	}
+
+	if( format == OutputFormat::CSV )
+		fputs( CSV_HEADER, pOutput );
+
+	const auto start = std::chrono::steady_clock::now();
+
+	if( pszUVMapDirectory )
+	{
+		std::error_code error;
+
+		fs::create_directories( pszUVMapDirectory, error );
+
+		if( error )
+		{
+			fprintf( stderr, "Couldn't create directory \"%s\": %s\n", pszUVMapDirectory, error.message().c_str() );
+			return 2;
+		}
+	}
+
+	CModelValidator validator( files, format, pOutput, pszUVMapDirectory );
+
+	validator.Run( static_cast<unsigned int>( std::min<size_t>( uiNumThreads, files.size() ) ) );
+
+	const double flSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	if( pOutput != stdout )
+		fclose( pOutput );
+	else
+		fflush( pOutput );
+
+	const double flMegabytes = validator.GetBytesRead() / ( 1024.0 * 1024.0 );
+
+	fprintf( stderr, "%u files, %u invalid, %.1f MiB in %.2f seconds (%.1f MiB/s)\n",
+			 static_cast<unsigned int>( files.size() ), static_cast<unsigned int>( validator.GetInvalidCount() ),
+			 flMegabytes, flSeconds, flSeconds > 0 ? flMegabytes / flSeconds : 0.0 );
+
+	return validator.GetInvalidCount() == 0 && validator.GetUVMapFailureCount() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
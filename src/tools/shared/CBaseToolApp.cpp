@@ -59,7 +59,10 @@ bool CBaseToolApp::StartupApp()
 
 bool CBaseToolApp::LoadAppLibraries()
 {
-	if( !LoadLibraries( "CVar", "FileSystem", "SoundSystem", "Renderer" ) )
+	if( !LoadLibraries( "CVar", "FileSystem", "Renderer" ) )
+		return false;
+
+	if( UsesSoundSystem() && !LoadLibraries( "SoundSystem" ) )
 		return false;
 
 	return true;
@@ -70,7 +73,7 @@ bool CBaseToolApp::Connect( const CreateInterfaceFn* pFactories, const size_t ui
 	if( !LoadAndCheckInterfaces( pFactories, uiNumFactories, 
 							IFace( ICVARSYSTEM_NAME, g_pCVar, "CVar System" ),
 							IFace( IFILESYSTEM_NAME, m_pFileSystem, "File System" ),
-							IFace( ISOUNDSYSTEM_NAME, m_pSoundSystem, "Sound System" ),
+							IFace( ISOUNDSYSTEM_NAME, m_pSoundSystem, "Sound System", !UsesSoundSystem() ),
 							IFace( IRENDERERLIBRARY_NAME, m_pRendererLib, "Render Library" ),
 							IFace( IRENDERCONTEXT_NAME, g_pRenderContext, "Render Context" ),
 							IFace( ISTUDIOMODELRENDERER_NAME, g_pStudioMdlRenderer, "StudioModel Renderer" ) ) )
@@ -114,16 +117,19 @@ bool CBaseToolApp::Connect( const CreateInterfaceFn* pFactories, const size_t ui
 		return false;
 	}
 
-	if( !m_pSoundSystem->Connect( pFactories, uiNumFactories ) )
+	if( m_pSoundSystem )
 	{
-		FatalError( "Failed to connect sound system!\n" );
-		return false;
-	}
+		if( !m_pSoundSystem->Connect( pFactories, uiNumFactories ) )
+		{
+			FatalError( "Failed to connect sound system!\n" );
+			return false;
+		}
 
-	if( !m_pSoundSystem->Initialize() )
-	{
-		FatalError( "Failed to initialize sound system!\n" );
-		return false;
+		if( !m_pSoundSystem->Initialize() )
+		{
+			FatalError( "Failed to initialize sound system!\n" );
+			return false;
+		}
 	}
 
 	return true;
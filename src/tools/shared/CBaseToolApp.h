@@ -70,6 +70,11 @@ protected:
 	*/
 	virtual void ShutdownOpenGL() = 0;
 
+	/**
+	*	Whether this tool needs the sound system. Tools that don't play sounds can skip loading it.
+	*/
+	virtual bool UsesSoundSystem() const { return true; }
+
 private:
 	std::string m_szLogFilename;
 
@@ -1,6 +1,8 @@
 #include "core/shared/Platform.h"
 
 #include "core/shared/Logging.h"
+#include "core/shared/Profiler.h"
+#include "core/shared/Stats.h"
 
 #include "core/shared/Utility.h"
 #include "core/shared/CWorldTime.h"
@@ -100,6 +102,8 @@ bool CBaseWXToolApp::OnInit()
 	//Install the wxWidgets specific default log listener.
 	SetDefaultLogListener( GetwxDefaultLogListener() );
 
+	prof::SetThreadName( "Main" );
+
 	const bool bResult = [ = ]
 	{
 		if( !Start() )
@@ -118,6 +122,9 @@ bool CBaseWXToolApp::OnInit()
 		return false;
 	}
 
+	//Messages are now delivered once per frame in OnIdle.
+	logging().SetQueuedDeliveryEnabled( true );
+
 	wxApp::Connect( wxEVT_IDLE, wxIdleEventHandler( CBaseWXToolApp::OnIdle ) );
 
 	//Reduce the idle event strain on the system a bit.
@@ -130,6 +137,9 @@ int CBaseWXToolApp::OnExit()
 {
 	wxApp::Disconnect( wxEVT_IDLE, wxIdleEventHandler( CBaseWXToolApp::OnIdle ) );
 
+	//No more frames will run, deliver messages immediately.
+	logging().SetQueuedDeliveryEnabled( false );
+
 	OnShutdown();
 
 	UseMessagesWindow( false );
@@ -145,6 +155,9 @@ void CBaseWXToolApp::Exit( const bool bMainWndClosed )
 
 	m_bExiting = true;
 
+	//Flush pending messages to the messages window while it still exists.
+	logging().DispatchQueuedMessages();
+
 	//Close messages window if needed.
 	UseMessagesWindow( false );
 
@@ -243,6 +256,14 @@ void CBaseWXToolApp::OnIdle( wxIdleEvent& event )
 
 	WorldTime.TimeChanged( flCurTime );
 
+	PROF_FRAME();
+
+	PROF_ZONE( "CBaseWXToolApp::OnIdle" );
+
+	static auto& frameTime = stats::Registry().GetHistogram( "app.frame_time", "ms" );
+
+	frameTime.Record( flFrameTime * 1000.0 );
+
 	g_pCVar->RunFrame();
 
 	g_pStudioMdlRenderer->RunFrame();
@@ -250,5 +271,10 @@ void CBaseWXToolApp::OnIdle( wxIdleEvent& event )
 	GetSoundSystem()->RunFrame();
 
 	RunFrame();
+
+	stats::Registry().RunFrame();
+
+	//Deliver everything logged during this frame in one batch.
+	logging().DispatchQueuedMessages();
 }
 }
@@ -54,6 +54,9 @@ void C3DView::UpdateView()
 
 void C3DView::DrawScene()
 {
+	//Other views and panels share the OpenGL context and change its state directly.
+	g_pRenderContext->InvalidateState();
+
 	const Color& backgroundColor = m_pSpriteViewer->GetSettings()->GetBackgroundColor();
 
 	g_pRenderContext->ClearColor( backgroundColor.GetRed() / 255.0f, backgroundColor.GetGreen() / 255.0f, backgroundColor.GetBlue() / 255.0f, 1.0 );
@@ -131,6 +134,9 @@ void C3DView::DrawSprite()
 	if( m_pSpriteViewer->GetState()->showBackground && m_BackgroundTexture != GL_INVALID_TEXTURE_ID )
 	{
 		graphics::DrawBackground( m_BackgroundTexture );
+
+		//Changes state directly.
+		g_pRenderContext->InvalidateState();
 	}
 
 	graphics::SetProjection( 65.0f, size.GetWidth(), size.GetHeight() );
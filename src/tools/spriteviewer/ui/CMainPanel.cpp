@@ -139,11 +139,9 @@ bool CMainPanel::LoadSprite( const wxString& szFilename )
 
 	auto szCFilename = szFilename.char_str( wxMBConvUTF8() );
 
-	sprite::msprite_t* pSprite;
+	auto sprite = m_pSpriteViewer->GetSpriteCache().Load( szFilename.c_str() );
 
-	const auto result = sprite::LoadSprite( szFilename.c_str(), pSprite );
-
-	if( !result )
+	if( !sprite )
 	{
 		wxMessageBox( wxString::Format( "Error loading sprite \"%s\"\n", szFilename ), "Error" );
 		return false;
@@ -156,17 +154,13 @@ bool CMainPanel::LoadSprite( const wxString& szFilename )
 		//TODO:
 		//pEntity->m_pState = m_pSpriteViewer->GetState();
 
-		pEntity->SetSprite( pSprite );
+		pEntity->SetSprite( sprite );
 
 		pEntity->Spawn();
 
 		m_pSpriteViewer->GetState()->SetEntity( pEntity );
 
-		m_pFramesList->SetSprite( pSprite );
-	}
-	else
-	{
-		delete pSprite;
+		m_pFramesList->SetSprite( sprite.get() );
 	}
 
 	InitializeUI();
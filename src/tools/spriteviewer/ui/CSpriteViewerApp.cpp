@@ -128,6 +128,9 @@ void CSpriteViewerApp::ShutdownApp()
 
 	EntityManager().Shutdown();
 
+	//All entities are gone, so no sprites are referenced anymore.
+	m_SpriteCache.Clear();
+
 	if( m_pSettings )
 	{
 		delete m_pSettings;
@@ -5,6 +5,8 @@
 
 #include "tools/shared/CBaseWXToolApp.h"
 
+#include "shared/sprite/SpriteCache.h"
+
 #include "../settings/CSpriteViewerSettings.h"
 #include "../CSpriteViewerState.h"
 
@@ -32,6 +34,11 @@ public:
 	*/
 	CMainWindow* GetMainWindow() { return m_pMainWindow; }
 
+	/**
+	*	Gets the sprite cache.
+	*/
+	sprite::CSpriteCache& GetSpriteCache() { return m_SpriteCache; }
+
 	/**
 	*	Sets the main window.
 	*/
@@ -55,6 +62,8 @@ private:
 	CSpriteViewerSettings* m_pSettings = nullptr;
 	sprview::CMainWindow* m_pMainWindow = nullptr;
 
+	sprite::CSpriteCache m_SpriteCache{ "sprite" };
+
 	wxString m_szSprite;		//Sprite to load on startup, if any.
 };
 }
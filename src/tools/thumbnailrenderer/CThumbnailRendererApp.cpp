@@ -0,0 +1,566 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <experimental/filesystem>
+#include <utility>
+
+#include <glm/mat4x4.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "shared/Logging.h"
+#include "shared/Profiler.h"
+#include "shared/Stats.h"
+#include "shared/Utility.h"
+
+#include "utility/Hash.h"
+#include "utility/mathlib.h"
+
+#include "graphics/GraphicsUtils.h"
+#include "graphics/GLRenderTarget.h"
+#include "graphics/GLPixelReadback.h"
+#include "graphics/PNGFile.h"
+
+#include "shared/studiomodel/CStudioModel.h"
+#include "shared/renderer/IRenderContext.h"
+#include "shared/renderer/studiomodel/CModelRenderInfo.h"
+#include "shared/renderer/studiomodel/IStudioModelRenderer.h"
+
+#include "CThumbnailRendererApp.h"
+
+namespace fs = std::experimental::filesystem;
+
+extern renderer::IRenderContext* g_pRenderContext;
+extern studiomdl::IStudioModelRenderer* g_pStudioMdlRenderer;
+
+namespace
+{
+//Same as HLMV's default field of view and background color, so thumbnails look like the model does when opened.
+const float THUMBNAIL_FOV = 65.0f;
+
+const float BACKGROUND_COLOR[ 3 ] = { 63 / 255.0f, 127 / 255.0f, 127 / 255.0f };
+
+/**
+*	Converts a controller or blender value to its byte setting, the same way the entity does.
+*/
+byte ValueToSetting( const int iType, const float flStart, const float flEnd, float flValue )
+{
+	//Invert value if end < start for rotational controllers.
+	if( ( iType & ( STUDIO_XR | STUDIO_YR | STUDIO_ZR ) ) && flEnd < flStart )
+		flValue = -flValue;
+
+	if( flEnd == flStart )
+		return 0;
+
+	int iSetting = static_cast<int>( 255 * ( flValue - flStart ) / ( flEnd - flStart ) );
+
+	if( iSetting < 0 )
+		iSetting = 0;
+	if( iSetting > 255 )
+		iSetting = 255;
+
+	return static_cast<byte>( iSetting );
+}
+
+/**
+*	Computes the hash that identifies a model's thumbnail. The texture model and thumbnail size are included so changes to either invalidate the thumbnail.
+*/
+bool ComputeThumbnailHash( const std::string& szModel, const int iSize, uint64_t& uiHash )
+{
+	uiHash = FNV1A_64_OFFSET_BASIS;
+
+	if( !HashFileContents( szModel.c_str(), uiHash ) )
+		return false;
+
+	fs::path texturePath( szModel );
+
+	texturePath.replace_filename( texturePath.stem().string() + "T" + texturePath.extension().string() );
+
+	std::error_code error;
+
+	if( fs::exists( texturePath, error ) && !HashFileContents( texturePath.string().c_str(), uiHash ) )
+		return false;
+
+	uiHash = HashFNV1a64( &iSize, sizeof( iSize ), uiHash );
+
+	return true;
+}
+}
+
+namespace tools
+{
+CThumbnailRendererApp::CThumbnailRendererApp( const ThumbnailSettings_t& settings, std::vector<std::string>&& models )
+	: m_Settings( settings )
+	, m_Models( std::move( models ) )
+{
+}
+
+CThumbnailRendererApp::~CThumbnailRendererApp()
+{
+	StopRecorder();
+}
+
+bool CThumbnailRendererApp::InitOpenGL()
+{
+	//Prefer a surfaceless display so no display server or window system is needed.
+	auto eglGetPlatformDisplayEXT = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>( eglGetProcAddress( "eglGetPlatformDisplayEXT" ) );
+
+	if( eglGetPlatformDisplayEXT )
+		m_Display = eglGetPlatformDisplayEXT( EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr );
+
+	if( m_Display == EGL_NO_DISPLAY )
+		m_Display = eglGetDisplay( EGL_DEFAULT_DISPLAY );
+
+	if( m_Display == EGL_NO_DISPLAY )
+	{
+		FatalError( "Failed to get EGL display!\n" );
+		return false;
+	}
+
+	EGLint iMajor, iMinor;
+
+	if( !eglInitialize( m_Display, &iMajor, &iMinor ) )
+	{
+		FatalError( "Failed to initialize EGL (error 0x%X)!\n", eglGetError() );
+		m_Display = EGL_NO_DISPLAY;
+		return false;
+	}
+
+	if( !eglBindAPI( EGL_OPENGL_API ) )
+	{
+		FatalError( "EGL does not support desktop OpenGL!\n" );
+		return false;
+	}
+
+	const EGLint configAttribs[] =
+	{
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint iNumConfigs = 0;
+
+	if( !eglChooseConfig( m_Display, configAttribs, &config, 1, &iNumConfigs ) || iNumConfigs == 0 )
+	{
+		FatalError( "Failed to find an EGL config that supports OpenGL!\n" );
+		return false;
+	}
+
+	//Same version as the GUI tools use.
+	const EGLint contextAttribs[] =
+	{
+		EGL_CONTEXT_MAJOR_VERSION, 2,
+		EGL_CONTEXT_MINOR_VERSION, 1,
+		EGL_NONE
+	};
+
+	m_Context = eglCreateContext( m_Display, config, EGL_NO_CONTEXT, contextAttribs );
+
+	if( m_Context == EGL_NO_CONTEXT )
+	{
+		FatalError( "Failed to create OpenGL context (error 0x%X)!\n", eglGetError() );
+		return false;
+	}
+
+	//All drawing is done to framebuffer objects, so no surface is needed.
+	if( !eglMakeCurrent( m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_Context ) )
+	{
+		FatalError( "Failed to make OpenGL context current (error 0x%X)!\n", eglGetError() );
+		return false;
+	}
+
+	glewExperimental = GL_TRUE;
+
+	const GLenum glewResult = glewInit();
+
+	//GLEW tries to initialize GLX as well, which fails without an X display. The OpenGL functions have been loaded at that point.
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+	if( glewResult != GLEW_OK && glewResult != GLEW_ERROR_NO_GLX_DISPLAY )
+#else
+	if( glewResult != GLEW_OK )
+#endif
+	{
+		FatalError( "Error initializing GLEW:\n%s\n", reinterpret_cast<const char*>( glewGetErrorString( glewResult ) ) );
+		return false;
+	}
+
+	if( !glGenFramebuffers )
+	{
+		FatalError( "Framebuffer objects are not supported!\n" );
+		return false;
+	}
+
+	Message( "EGL %d.%d, OpenGL renderer: %s\n", iMajor, iMinor, reinterpret_cast<const char*>( glGetString( GL_RENDERER ) ) );
+
+	return true;
+}
+
+void CThumbnailRendererApp::ShutdownOpenGL()
+{
+	if( m_Context != EGL_NO_CONTEXT )
+	{
+		m_Readback.reset();
+		m_RenderTarget.reset();
+
+		eglMakeCurrent( m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+		eglDestroyContext( m_Display, m_Context );
+		m_Context = EGL_NO_CONTEXT;
+	}
+
+	if( m_Display != EGL_NO_DISPLAY )
+	{
+		eglTerminate( m_Display );
+		m_Display = EGL_NO_DISPLAY;
+	}
+}
+
+bool CThumbnailRendererApp::RunApp( int, wchar_t*[] )
+{
+	const int iSize = m_Settings.iSize;
+
+	m_RenderTarget = std::make_unique<GLRenderTarget>( true );
+
+	m_RenderTarget->Setup( iSize, iSize, true );
+
+	if( m_RenderTarget->GetStatus() != GL_FRAMEBUFFER_COMPLETE )
+	{
+		Error( "Thumbnail framebuffer is incomplete: %s\n", glFrameBufferStatusToString( m_RenderTarget->GetStatus() ) );
+		return false;
+	}
+
+	glReadBuffer( GL_COLOR_ATTACHMENT0 );
+
+	m_Readback = std::make_unique<GLPixelReadback>();
+
+	if( !m_Readback->Setup( iSize, iSize ) )
+	{
+		Error( "Failed to set up pixel readback\n" );
+		return false;
+	}
+
+	m_Pixels = std::make_unique<uint8_t[]>( m_Readback->GetImageSize() );
+
+	FILE* pManifest = nullptr;
+
+	if( !m_Settings.szManifest.empty() )
+	{
+		pManifest = fopen( m_Settings.szManifest.c_str(), "a" );
+
+		if( !pManifest )
+			Warning( "Couldn't open manifest \"%s\" for writing\n", m_Settings.szManifest.c_str() );
+	}
+
+	if( !m_Settings.szStatsFile.empty() )
+		stats::Registry().SetPeriodicExport( m_Settings.szStatsFile.c_str(), m_Settings.flStatsInterval );
+
+	for( const auto& szModel : m_Models )
+	{
+		stats::Registry().RunFrame();
+
+		uint64_t uiHash;
+
+		if( !ComputeThumbnailHash( szModel, iSize, uiHash ) )
+		{
+			Error( "Couldn't read \"%s\"\n", szModel.c_str() );
+			++m_Results.uiFailed;
+			continue;
+		}
+
+		const std::string szName = HashToString( uiHash ) + ".png";
+
+		const std::string szFilename = ( fs::path( m_Settings.szOutputDir ) / szName ).string();
+
+		std::error_code error;
+
+		if( !m_Settings.bForce && fs::exists( szFilename, error ) )
+		{
+			++m_Results.uiCached;
+		}
+		else
+		{
+			studiomdl::CStudioModel* pModel = nullptr;
+
+			const auto result = studiomdl::LoadStudioModel( szModel.c_str(), pModel );
+
+			if( result != studiomdl::StudioModelLoadResult::SUCCESS )
+			{
+				Error( "Couldn't load \"%s\"\n", szModel.c_str() );
+				++m_Results.uiFailed;
+				continue;
+			}
+
+			studiomdl::CModelRenderInfo renderInfo{};
+			glm::mat4x4 modelView;
+
+			if( !SetUpModel( pModel, renderInfo, modelView ) )
+			{
+				delete pModel;
+				++m_Results.uiFailed;
+				continue;
+			}
+
+			if( m_Readback->IsFull() )
+			{
+				//Record the model while the oldest thumbnail is encoded. Only OpenGL calls need to be made on this thread.
+				BeginRecording( renderInfo );
+
+				WriteOldestThumbnail();
+
+				FinishRecording();
+			}
+			else
+			{
+				RecordModel( renderInfo );
+			}
+
+			RenderCommands( modelView );
+
+			//The commands reference the model's textures.
+			delete pModel;
+
+			m_Readback->QueueRead();
+
+			m_Pending.push_back( PendingThumbnail_t{ szModel, szFilename } );
+		}
+
+		if( pManifest )
+		{
+			//Write the line in one call so lines from worker processes don't interleave.
+			const std::string szLine = szModel + '\t' + szName + '\n';
+			fwrite( szLine.c_str(), 1, szLine.size(), pManifest );
+			fflush( pManifest );
+		}
+	}
+
+	StopRecorder();
+
+	while( !m_Pending.empty() )
+	{
+		WriteOldestThumbnail();
+	}
+
+	if( pManifest )
+		fclose( pManifest );
+
+	if( !m_Settings.szStatsFile.empty() )
+	{
+		if( !stats::Registry().ExportToFile( m_Settings.szStatsFile.c_str() ) )
+			Warning( "Couldn't write stats to \"%s\"\n", m_Settings.szStatsFile.c_str() );
+	}
+
+	return true;
+}
+
+bool CThumbnailRendererApp::SetUpModel( studiomdl::CStudioModel* pModel, studiomdl::CModelRenderInfo& renderInfo, glm::mat4x4& modelView )
+{
+	const studiohdr_t* const pStudioHdr = pModel->GetStudioHeader();
+
+	if( pStudioHdr->numseq <= 0 )
+	{
+		Error( "Model \"%s\" has no sequences\n", pStudioHdr->name );
+		return false;
+	}
+
+	const mstudioseqdesc_t* const pSequence = pStudioHdr->GetSequence( 0 );
+
+	renderInfo.vecScale = glm::vec3( 1, 1, 1 );
+	renderInfo.pModel = pModel;
+	renderInfo.flTransparency = 1;
+	renderInfo.iSequence = 0;
+	renderInfo.flFrame = 0;
+
+	for( int iBlender = 0; iBlender < 2; ++iBlender )
+	{
+		renderInfo.iBlender[ iBlender ] = ValueToSetting(
+			pSequence->blendtype[ iBlender ], pSequence->blendstart[ iBlender ], pSequence->blendend[ iBlender ], 0 );
+	}
+
+	for( int iController = 0; iController < pStudioHdr->numbonecontrollers; ++iController )
+	{
+		const mstudiobonecontroller_t* const pController = pStudioHdr->GetBoneController( iController );
+
+		const byte setting = ValueToSetting( pController->type, pController->start, pController->end, 0 );
+
+		if( pController->index == STUDIO_MOUTH_CONTROLLER )
+			renderInfo.iMouth = setting;
+		else if( pController->index >= 0 && pController->index < 4 )
+			renderInfo.iController[ pController->index ] = setting;
+	}
+
+	//Position the camera like HLMV's center view.
+	glm::vec3 vecMins = pSequence->bbmin;
+	glm::vec3 vecMaxs = pSequence->bbmax;
+
+	for( int i = 0; i < 3; ++i )
+	{
+		vecMins[ i ] = clamp( vecMins[ i ], -2000.f, 2000.f );
+		vecMaxs[ i ] = clamp( vecMaxs[ i ], -1000.f, 1000.f );
+	}
+
+	const glm::vec3 vecExtents = vecMaxs - vecMins;
+
+	const float flDistance = std::max( vecExtents.x, std::max( vecExtents.y, vecExtents.z ) );
+
+	const glm::vec3 vecCameraOrigin( -( vecMins.z + vecExtents.z / 2 ), flDistance, 0 );
+	const glm::vec3 vecCameraAngles( -90.0f, 0.0f, -90.0f );
+
+	modelView = Mat4x4ModelView();
+
+	modelView *= glm::translate( -vecCameraOrigin );
+	modelView *= glm::rotate( glm::radians( vecCameraAngles[ 2 ] ), glm::vec3{ 1, 0, 0 } );
+	modelView *= glm::rotate( glm::radians( vecCameraAngles[ 0 ] ), glm::vec3{ 0, 1, 0 } );
+	modelView *= glm::rotate( glm::radians( vecCameraAngles[ 1 ] ), glm::vec3{ 0, 0, 1 } );
+
+	g_pStudioMdlRenderer->SetViewerOrigin( glm::vec3( glm::inverse( modelView )[ 3 ] ) );
+
+	glm::vec3 vecViewerRight;
+
+	AngleVectors( -vecCameraAngles + 180.0f, nullptr, nullptr, &vecViewerRight );
+
+	g_pStudioMdlRenderer->SetViewerRight( -vecViewerRight );
+
+	return true;
+}
+
+void CThumbnailRendererApp::RecordModel( studiomdl::CModelRenderInfo& renderInfo )
+{
+	PROF_ZONE( "CThumbnailRendererApp::RecordModel" );
+
+	m_Commands.Clear();
+
+	renderer::RenderState_t state;
+
+	state.polygonMode = renderer::PolygonMode::FILL;
+	state.bTexture2D = true;
+	state.bCullFace = true;
+	state.cullFace = renderer::CullFace::FRONT;
+	state.bDepthTest = true;
+
+	g_pStudioMdlRenderer->RecordModel( &renderInfo, m_Commands, state );
+}
+
+void CThumbnailRendererApp::BeginRecording( studiomdl::CModelRenderInfo& renderInfo )
+{
+	if( !m_Recorder.joinable() )
+	{
+		m_bStopRecorder = false;
+		m_Recorder = std::thread( &CThumbnailRendererApp::RecorderMain, this );
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( m_RecorderMutex );
+
+		assert( !m_pRecordInfo );
+
+		m_pRecordInfo = &renderInfo;
+	}
+
+	m_RecordStarted.notify_one();
+}
+
+void CThumbnailRendererApp::FinishRecording()
+{
+	std::unique_lock<std::mutex> lock( m_RecorderMutex );
+
+	m_RecordFinished.wait( lock, [ this ] { return !m_pRecordInfo; } );
+}
+
+void CThumbnailRendererApp::StopRecorder()
+{
+	if( !m_Recorder.joinable() )
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock( m_RecorderMutex );
+
+		m_bStopRecorder = true;
+	}
+
+	m_RecordStarted.notify_one();
+
+	m_Recorder.join();
+}
+
+void CThumbnailRendererApp::RecorderMain()
+{
+	prof::SetThreadName( "Thumbnail recorder" );
+
+	std::unique_lock<std::mutex> lock( m_RecorderMutex );
+
+	for( ;; )
+	{
+		m_RecordStarted.wait( lock, [ this ] { return m_bStopRecorder || m_pRecordInfo; } );
+
+		//Finish pending work before shutting down.
+		if( !m_pRecordInfo )
+			break;
+
+		const auto pRenderInfo = m_pRecordInfo;
+
+		lock.unlock();
+
+		RecordModel( *pRenderInfo );
+
+		lock.lock();
+
+		m_pRecordInfo = nullptr;
+
+		m_RecordFinished.notify_all();
+	}
+}
+
+void CThumbnailRendererApp::RenderCommands( const glm::mat4x4& modelView )
+{
+	PROF_ZONE( "CThumbnailRendererApp::RenderCommands" );
+
+	const int iSize = m_Settings.iSize;
+
+	m_RenderTarget->Bind();
+
+	glViewport( 0, 0, iSize, iSize );
+
+	glClearColor( BACKGROUND_COLOR[ 0 ], BACKGROUND_COLOR[ 1 ], BACKGROUND_COLOR[ 2 ], 1.0f );
+	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+
+	graphics::SetProjection( THUMBNAIL_FOV, iSize, iSize );
+
+	glMatrixMode( GL_MODELVIEW );
+	glLoadMatrixf( glm::value_ptr( modelView ) );
+
+	//Loading the model and binding the render target change state directly.
+	g_pRenderContext->InvalidateState();
+
+	glShadeModel( GL_SMOOTH );
+
+	const renderer::CRenderCommandBuffer* const pCommands = &m_Commands;
+
+	g_pRenderContext->SubmitCommands( &pCommands, 1 );
+}
+
+void CThumbnailRendererApp::WriteOldestThumbnail()
+{
+	const PendingThumbnail_t thumbnail = std::move( m_Pending.front() );
+
+	m_Pending.pop_front();
+
+	if( !m_Readback->RetrieveOldest( m_Pixels.get() ) )
+	{
+		Error( "Couldn't read back thumbnail for \"%s\"\n", thumbnail.szModel.c_str() );
+		++m_Results.uiFailed;
+		return;
+	}
+
+	if( !graphics::pngfile::SaveRGBPNGFile( thumbnail.szFilename.c_str(), m_Settings.iSize, m_Settings.iSize, m_Pixels.get(), true ) )
+	{
+		Error( "Couldn't save thumbnail \"%s\"\n", thumbnail.szFilename.c_str() );
+		++m_Results.uiFailed;
+		return;
+	}
+
+	++m_Results.uiRendered;
+}
+}
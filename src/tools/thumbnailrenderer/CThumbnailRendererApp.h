@@ -0,0 +1,197 @@
+#ifndef TOOLS_THUMBNAILRENDERER_CTHUMBNAILRENDERERAPP_H
+#define TOOLS_THUMBNAILRENDERER_CTHUMBNAILRENDERERAPP_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <EGL/egl.h>
+
+#include <glm/mat4x4.hpp>
+
+#include "graphics/OpenGL.h"
+
+#include "shared/renderer/CRenderCommandBuffer.h"
+
+#include "../shared/CBaseToolApp.h"
+
+class GLRenderTarget;
+class GLPixelReadback;
+
+namespace studiomdl
+{
+class CStudioModel;
+struct CModelRenderInfo;
+}
+
+namespace tools
+{
+/**
+*	Settings for a thumbnail rendering run.
+*/
+struct ThumbnailSettings_t
+{
+	static const int DEFAULT_SIZE = 256;
+
+	/**
+	*	Directory to write thumbnails to. Thumbnails are named after the hash of the model's contents.
+	*/
+	std::string szOutputDir = "thumbnails";
+
+	/**
+	*	If not empty, a line mapping each model to its thumbnail is appended to this file.
+	*/
+	std::string szManifest;
+
+	/**
+	*	If not empty, runtime stats are appended to this file as lines of JSON, periodically and once when done.
+	*/
+	std::string szStatsFile;
+
+	/**
+	*	Time between stats exports, in seconds.
+	*/
+	double flStatsInterval = 10;
+
+	int iSize = DEFAULT_SIZE;
+
+	/**
+	*	Render even if a thumbnail with the same hash already exists.
+	*/
+	bool bForce = false;
+};
+
+/**
+*	Counts reported by a thumbnail rendering run.
+*/
+struct ThumbnailResults_t
+{
+	uint32_t uiRendered = 0;
+	uint32_t uiCached = 0;
+	uint32_t uiFailed = 0;
+};
+
+/**
+*	Renders thumbnails for a list of studio models without a window.
+*	An offscreen OpenGL context is created using EGL, so no display server is required.
+*/
+class CThumbnailRendererApp final : public CBaseToolApp
+{
+public:
+	/**
+	*	@param settings Settings to use.
+	*	@param models Absolute paths to the models to render.
+	*/
+	CThumbnailRendererApp( const ThumbnailSettings_t& settings, std::vector<std::string>&& models );
+	~CThumbnailRendererApp();
+
+	const ThumbnailResults_t& GetResults() const { return m_Results; }
+
+protected:
+	bool InitOpenGL() override;
+
+	void ShutdownOpenGL() override;
+
+	bool UsesSoundSystem() const override { return false; }
+
+	bool RunApp( int iArgc, wchar_t* pszArgV[] ) override;
+
+private:
+	/**
+	*	Sets up the render info and camera for a model, and points the studio model renderer's viewer at it.
+	*	@param[ out ] renderInfo Render info for the model.
+	*	@param[ out ] modelView Model view matrix of the camera.
+	*	@return true if the model can be rendered, false otherwise.
+	*/
+	bool SetUpModel( studiomdl::CStudioModel* pModel, studiomdl::CModelRenderInfo& renderInfo, glm::mat4x4& modelView );
+
+	/**
+	*	Records a model into m_Commands. Does not use OpenGL, so this can run while the main thread writes thumbnails.
+	*/
+	void RecordModel( studiomdl::CModelRenderInfo& renderInfo );
+
+	/**
+	*	Starts recording a model on the recorder thread. The thread is started the first time this is called.
+	*	The render info must stay valid until FinishRecording returns.
+	*/
+	void BeginRecording( studiomdl::CModelRenderInfo& renderInfo );
+
+	/**
+	*	Waits for the recording started by BeginRecording to finish.
+	*/
+	void FinishRecording();
+
+	/**
+	*	Stops the recorder thread, if it was started.
+	*/
+	void StopRecorder();
+
+	void RecorderMain();
+
+	/**
+	*	Renders the commands in m_Commands into the render target.
+	*/
+	void RenderCommands( const glm::mat4x4& modelView );
+
+	/**
+	*	Retrieves the oldest pending readback and saves it.
+	*/
+	void WriteOldestThumbnail();
+
+private:
+	struct PendingThumbnail_t
+	{
+		std::string szModel;
+		std::string szFilename;
+	};
+
+	const ThumbnailSettings_t m_Settings;
+
+	const std::vector<std::string> m_Models;
+
+	ThumbnailResults_t m_Results;
+
+	EGLDisplay m_Display = EGL_NO_DISPLAY;
+	EGLContext m_Context = EGL_NO_CONTEXT;
+
+	std::unique_ptr<GLRenderTarget> m_RenderTarget;
+	std::unique_ptr<GLPixelReadback> m_Readback;
+
+	//Thumbnails whose pixels are still being read back, oldest first.
+	std::deque<PendingThumbnail_t> m_Pending;
+
+	std::unique_ptr<uint8_t[]> m_Pixels;
+
+	renderer::CRenderCommandBuffer m_Commands;
+
+	std::mutex m_RecorderMutex;
+
+	/**
+	*	Signaled when a model is given to the recorder, or when it should stop.
+	*/
+	std::condition_variable m_RecordStarted;
+
+	/**
+	*	Signaled when the recorder has finished recording a model.
+	*/
+	std::condition_variable m_RecordFinished;
+
+	//Model for the recorder to record, null once it's done.
+	studiomdl::CModelRenderInfo* m_pRecordInfo = nullptr;
+
+	bool m_bStopRecorder = false;
+
+	std::thread m_Recorder;
+
+private:
+	CThumbnailRendererApp( const CThumbnailRendererApp& ) = delete;
+	CThumbnailRendererApp& operator=( const CThumbnailRendererApp& ) = delete;
+};
+}
+
+#endif //TOOLS_THUMBNAILRENDERER_CTHUMBNAILRENDERERAPP_H
@@ -0,0 +1,390 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <experimental/filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "shared/Logging.h"
+
+#include "CThumbnailRendererApp.h"
+
+namespace fs = std::experimental::filesystem;
+
+namespace
+{
+void PrintUsage( const char* const pszProgram )
+{
+	printf(
+		"Usage: %s [options] <model.mdl | directory | listfile.txt | -> ...\n"
+		"Renders thumbnails of studio models without a window.\n"
+		"Thumbnails are named after a hash of the model's contents, so unchanged models are skipped on later runs.\n"
+		"\n"
+		"Options:\n"
+		"  --output <dir>      Directory to write thumbnails to (default \"thumbnails\")\n"
+		"  --size <pixels>     Width and height of thumbnails (default %d)\n"
+		"  --workers <count>   Number of worker processes, each with its own OpenGL context (default: number of cores)\n"
+		"  --manifest <file>   Append a \"<model>\\t<thumbnail>\" line for each model to this file\n"
+		"  --force             Render thumbnails even if they already exist\n"
+		"  --stats <file>      Append runtime stats to this file as lines of JSON, periodically and when done. Each worker writes its own lines\n"
+		"  --stats-interval <seconds>  Time between periodic stats exports (default 10)\n"
+		"\n"
+		"Directories are searched recursively for models. Any other file that isn't a .mdl file is read as a list of models, one per line. "
+		"\"-\" reads the list from standard input.\n",
+		pszProgram, tools::ThumbnailSettings_t::DEFAULT_SIZE );
+}
+
+bool IsModelFile( const fs::path& path )
+{
+	std::string szExtension = path.extension().string();
+
+	std::transform( szExtension.begin(), szExtension.end(), szExtension.begin(), ::tolower );
+
+	return szExtension == ".mdl";
+}
+
+/**
+*	Returns whether the given model is a texture or sequence group model that belongs to another model.
+*	These are loaded along with their main model.
+*/
+bool IsCompanionModel( const fs::path& path )
+{
+	const std::string szStem = path.stem().string();
+
+	size_t uiSuffixLength = 0;
+
+	if( szStem.size() > 1 && ( szStem.back() == 'T' || szStem.back() == 't' ) )
+		uiSuffixLength = 1;
+	else if( szStem.size() > 2 && isdigit( szStem[ szStem.size() - 1 ] ) && isdigit( szStem[ szStem.size() - 2 ] ) )
+		uiSuffixLength = 2;
+
+	if( uiSuffixLength == 0 )
+		return false;
+
+	fs::path mainPath( path );
+
+	mainPath.replace_filename( szStem.substr( 0, szStem.size() - uiSuffixLength ) + path.extension().string() );
+
+	std::error_code error;
+
+	return fs::exists( mainPath, error );
+}
+
+void AddModel( const fs::path& path, std::vector<std::string>& models )
+{
+	std::error_code error;
+
+	const fs::path absolutePath = fs::absolute( path );
+
+	if( !fs::is_regular_file( absolutePath, error ) )
+	{
+		Warning( "\"%s\" does not exist\n", path.string().c_str() );
+		return;
+	}
+
+	models.emplace_back( absolutePath.string() );
+}
+
+void AddModelList( std::istream& stream, std::vector<std::string>& models )
+{
+	std::string szLine;
+
+	while( std::getline( stream, szLine ) )
+	{
+		//Strip trailing carriage returns and whitespace from lists made on Windows.
+		while( !szLine.empty() && isspace( static_cast<unsigned char>( szLine.back() ) ) )
+			szLine.pop_back();
+
+		if( !szLine.empty() )
+			AddModel( szLine, models );
+	}
+}
+
+void AddInput( const std::string& szInput, std::vector<std::string>& models )
+{
+	if( szInput == "-" )
+	{
+		AddModelList( std::cin, models );
+		return;
+	}
+
+	std::error_code error;
+
+	const fs::path path( szInput );
+
+	if( fs::is_directory( path, error ) )
+	{
+		for( fs::recursive_directory_iterator it( path, error ), end; !error && it != end; it.increment( error ) )
+		{
+			if( fs::is_regular_file( it->status() ) && IsModelFile( it->path() ) && !IsCompanionModel( it->path() ) )
+				AddModel( it->path(), models );
+		}
+	}
+	else if( IsModelFile( path ) )
+	{
+		AddModel( path, models );
+	}
+	else
+	{
+		std::ifstream stream( szInput );
+
+		if( !stream )
+		{
+			Warning( "Couldn't open model list \"%s\"\n", szInput.c_str() );
+			return;
+		}
+
+		AddModelList( stream, models );
+	}
+}
+
+/**
+*	Renders the given models in this process.
+*/
+tools::ThumbnailResults_t RenderModels( const tools::ThumbnailSettings_t& settings, std::vector<std::string>&& models )
+{
+	tools::CThumbnailRendererApp app( settings, std::move( models ) );
+
+	app.Run( 0, nullptr );
+
+	return app.GetResults();
+}
+
+/**
+*	Splits the models between worker processes. Each worker creates its own OpenGL context.
+*	Processes are used instead of threads since the renderer's state is global.
+*/
+tools::ThumbnailResults_t RenderModelsInWorkers( const tools::ThumbnailSettings_t& settings, const std::vector<std::string>& models, const unsigned int uiNumWorkers )
+{
+	struct Worker_t
+	{
+		pid_t pid;
+		int iResultPipe;
+		size_t uiNumModels;
+	};
+
+	std::vector<Worker_t> workers;
+
+	tools::ThumbnailResults_t totals;
+
+	//Make sure buffered output isn't written by every child.
+	fflush( stdout );
+	fflush( stderr );
+
+	for( unsigned int uiWorker = 0; uiWorker < uiNumWorkers; ++uiWorker )
+	{
+		//Interleave models so workers get a similar mix of large and small models.
+		std::vector<std::string> shard;
+
+		for( size_t uiIndex = uiWorker; uiIndex < models.size(); uiIndex += uiNumWorkers )
+		{
+			shard.emplace_back( models[ uiIndex ] );
+		}
+
+		int pipeFds[ 2 ];
+
+		if( pipe( pipeFds ) != 0 )
+		{
+			Error( "Couldn't create pipe for worker %u: %s\n", uiWorker, strerror( errno ) );
+			totals.uiFailed += static_cast<uint32_t>( shard.size() );
+			continue;
+		}
+
+		const pid_t pid = fork();
+
+		if( pid == 0 )
+		{
+			close( pipeFds[ 0 ] );
+
+			const tools::ThumbnailResults_t results = RenderModels( settings, std::move( shard ) );
+
+			const ssize_t iWritten = write( pipeFds[ 1 ], &results, sizeof( results ) );
+
+			close( pipeFds[ 1 ] );
+
+			_exit( iWritten == sizeof( results ) ? EXIT_SUCCESS : EXIT_FAILURE );
+		}
+
+		close( pipeFds[ 1 ] );
+
+		if( pid < 0 )
+		{
+			Error( "Couldn't start worker %u: %s\n", uiWorker, strerror( errno ) );
+			close( pipeFds[ 0 ] );
+			totals.uiFailed += static_cast<uint32_t>( shard.size() );
+			continue;
+		}
+
+		workers.push_back( Worker_t{ pid, pipeFds[ 0 ], shard.size() } );
+	}
+
+	for( const auto& worker : workers )
+	{
+		tools::ThumbnailResults_t results;
+
+		const bool bGotResults = read( worker.iResultPipe, &results, sizeof( results ) ) == sizeof( results );
+
+		close( worker.iResultPipe );
+
+		int iStatus;
+
+		waitpid( worker.pid, &iStatus, 0 );
+
+		if( bGotResults )
+		{
+			totals.uiRendered += results.uiRendered;
+			totals.uiCached += results.uiCached;
+			totals.uiFailed += results.uiFailed;
+		}
+		else
+		{
+			//The worker crashed; its models can't be accounted for individually.
+			Error( "Worker process %d exited without reporting results\n", static_cast<int>( worker.pid ) );
+
+			totals.uiFailed += static_cast<uint32_t>( worker.uiNumModels );
+		}
+	}
+
+	return totals;
+}
+}
+
+int main( int iArgc, char* pszArgV[] )
+{
+	logging().SetLogListener( GetStdOutLogListener() );
+
+	tools::ThumbnailSettings_t settings;
+
+	unsigned int uiNumWorkers = std::max( 1u, std::thread::hardware_concurrency() );
+
+	std::vector<std::string> inputs;
+
+	for( int iArg = 1; iArg < iArgc; ++iArg )
+	{
+		const char* const pszArg = pszArgV[ iArg ];
+
+		const bool bHasValue = iArg + 1 < iArgc;
+
+		if( !strcmp( pszArg, "--help" ) || !strcmp( pszArg, "-h" ) )
+		{
+			PrintUsage( pszArgV[ 0 ] );
+			return EXIT_SUCCESS;
+		}
+		else if( !strcmp( pszArg, "--output" ) && bHasValue )
+		{
+			settings.szOutputDir = pszArgV[ ++iArg ];
+		}
+		else if( !strcmp( pszArg, "--size" ) && bHasValue )
+		{
+			settings.iSize = atoi( pszArgV[ ++iArg ] );
+		}
+		else if( !strcmp( pszArg, "--workers" ) && bHasValue )
+		{
+			uiNumWorkers = static_cast<unsigned int>( std::max( 1, atoi( pszArgV[ ++iArg ] ) ) );
+		}
+		else if( !strcmp( pszArg, "--manifest" ) && bHasValue )
+		{
+			settings.szManifest = pszArgV[ ++iArg ];
+		}
+		else if( !strcmp( pszArg, "--stats" ) && bHasValue )
+		{
+			settings.szStatsFile = pszArgV[ ++iArg ];
+		}
+		else if( !strcmp( pszArg, "--stats-interval" ) && bHasValue )
+		{
+			settings.flStatsInterval = atof( pszArgV[ ++iArg ] );
+		}
+		else if( !strcmp( pszArg, "--force" ) )
+		{
+			settings.bForce = true;
+		}
+		else if( pszArg[ 0 ] == '-' && pszArg[ 1 ] == '-' )
+		{
+			Error( "Unknown or incomplete option \"%s\"\n", pszArg );
+			PrintUsage( pszArgV[ 0 ] );
+			return EXIT_FAILURE;
+		}
+		else
+		{
+			inputs.emplace_back( pszArg );
+		}
+	}
+
+	if( settings.iSize <= 0 )
+	{
+		Error( "Thumbnail size must be positive\n" );
+		return EXIT_FAILURE;
+	}
+
+	if( settings.flStatsInterval <= 0 )
+	{
+		Error( "Stats interval must be positive\n" );
+		return EXIT_FAILURE;
+	}
+
+	if( inputs.empty() )
+	{
+		PrintUsage( pszArgV[ 0 ] );
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::string> models;
+
+	for( const auto& szInput : inputs )
+	{
+		AddInput( szInput, models );
+	}
+
+	//The app changes the working directory to the executable's directory, so all paths have to be absolute.
+	settings.szOutputDir = fs::absolute( settings.szOutputDir ).string();
+
+	if( !settings.szManifest.empty() )
+		settings.szManifest = fs::absolute( settings.szManifest ).string();
+
+	std::error_code error;
+
+	fs::create_directories( settings.szOutputDir, error );
+
+	if( error )
+	{
+		Error( "Couldn't create output directory \"%s\": %s\n", settings.szOutputDir.c_str(), error.message().c_str() );
+		return EXIT_FAILURE;
+	}
+
+	if( models.empty() )
+	{
+		Message( "No models to render\n" );
+		return EXIT_SUCCESS;
+	}
+
+	uiNumWorkers = static_cast<unsigned int>( std::min<size_t>( uiNumWorkers, models.size() ) );
+
+	const size_t uiNumModels = models.size();
+
+	Message( "Rendering %u models at %dx%d using %u worker(s)\n", static_cast<unsigned int>( uiNumModels ), settings.iSize, settings.iSize, uiNumWorkers );
+
+	const auto start = std::chrono::steady_clock::now();
+
+	const tools::ThumbnailResults_t results = uiNumWorkers > 1 ?
+		RenderModelsInWorkers( settings, models, uiNumWorkers ) :
+		RenderModels( settings, std::move( models ) );
+
+	const double flSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	//Cached models are excluded from the rate, since they aren't loaded.
+	Message( "%u rendered, %u cached, %u failed in %.2f seconds (%.1f models/sec)\n",
+			 results.uiRendered, results.uiCached, results.uiFailed, flSeconds,
+			 flSeconds > 0 ? results.uiRendered / flSeconds : 0.0 );
+
+	return results.uiFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -8,6 +8,49 @@
 
 namespace ui
 {
+/**
+*	Virtual list control that displays the messages stored by the messages window.
+*/
+class CMessagesListCtrl final : public wxListView
+{
+public:
+	CMessagesListCtrl( wxWindow* pParent, const std::deque<MessagesWindowEntry_t>& messages )
+		: wxListView( pParent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_HRULES | wxLC_VIRTUAL )
+		, m_Messages( messages )
+	{
+		m_Attrs[ static_cast<size_t>( LogType::MESSAGE ) ].SetTextColour( wxColor( 0, 0, 0 ) );
+		m_Attrs[ static_cast<size_t>( LogType::WARNING ) ].SetTextColour( wxColor( 128, 0, 0 ) );
+		m_Attrs[ static_cast<size_t>( LogType::ERROR ) ].SetTextColour( wxColor( 255, 0, 0 ) );
+		m_Attrs[ static_cast<size_t>( LogType::FATAL_ERROR ) ].SetTextColour( wxColor( 255, 0, 0 ) );
+	}
+
+protected:
+	wxString OnGetItemText( long item, long column ) const override
+	{
+		if( item < 0 || static_cast<size_t>( item ) >= m_Messages.size() )
+			return wxEmptyString;
+
+		return m_Messages[ item ].szText;
+	}
+
+	wxListItemAttr* OnGetItemAttr( long item ) const override
+	{
+		if( item < 0 || static_cast<size_t>( item ) >= m_Messages.size() )
+			return nullptr;
+
+		return &m_Attrs[ static_cast<size_t>( m_Messages[ item ].type ) ];
+	}
+
+private:
+	const std::deque<MessagesWindowEntry_t>& m_Messages;
+
+	mutable wxListItemAttr m_Attrs[ static_cast<size_t>( LogType::FATAL_ERROR ) + 1 ];
+
+private:
+	CMessagesListCtrl( const CMessagesListCtrl& ) = delete;
+	CMessagesListCtrl& operator=( const CMessagesListCtrl& ) = delete;
+};
+
 wxBEGIN_EVENT_TABLE( CMessagesWindow, wxFrame )
 	EVT_SIZE( CMessagesWindow::OnSize )
 	EVT_BUTTON( wxID_SHARED_MESSAGES_CLEAR, CMessagesWindow::OnClear )
@@ -25,7 +68,7 @@ CMessagesWindow::CMessagesWindow( const size_t uiMaxMessagesCount, IWindowCloseL
 
 	wxButton* pClear = new wxButton( this, wxID_SHARED_MESSAGES_CLEAR, "Clear" );
 
-	m_pList = new wxListView( this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_HRULES );
+	m_pList = new CMessagesListCtrl( this, m_Messages );
 
 	m_pList->InsertColumn( 0, "", wxLIST_FORMAT_LEFT, wxLIST_AUTOSIZE_USEHEADER );
 
@@ -70,52 +113,43 @@ void CMessagesWindow::SetMaxMessagesCount( const size_t uiMaxMessagesCount )
 	m_uiMaxMessagesCount = uiMaxMessagesCount;
 }
 
-void CMessagesWindow::AddMessage( const LogType type, const wxString& szMessage )
+void CMessagesWindow::BeginLogBatch()
 {
-	wxListItem item;
+	m_bInBatch = true;
+}
 
-	wxString szPrefix;
+void CMessagesWindow::EndLogBatch()
+{
+	m_bInBatch = false;
+
+	UpdateList();
+}
 
-	item.SetId( m_pList->GetItemCount() );
+void CMessagesWindow::AddMessage( const LogType type, const wxString& szMessage )
+{
+	wxString szPrefix;
 
 	switch( type )
 	{
 	default:
-	case LogType::MESSAGE:
-		{
-			item.SetTextColour( wxColor( 0, 0, 0 ) );
-			break;
-		}
-
-	case LogType::WARNING:
-		{
-			item.SetTextColour( wxColor( 128, 0, 0 ) );
-			szPrefix = "WARNING: ";
-			break;
-		}
-
-	case LogType::ERROR:
-		{
-			item.SetTextColour( wxColor( 255, 0, 0 ) );
-			szPrefix = "ERROR: ";
-			break;
-		}
-
-	case LogType::FATAL_ERROR:
-		{
-			item.SetTextColour( wxColor( 255, 0, 0 ) );
-			szPrefix = "FATAL ERROR: ";
-			break;
-		}
+	case LogType::MESSAGE:		break;
+	case LogType::WARNING:		szPrefix = "WARNING: "; break;
+	case LogType::ERROR:		szPrefix = "ERROR: "; break;
+	case LogType::FATAL_ERROR:	szPrefix = "FATAL ERROR: "; break;
 	}
 
-	item.SetText( szPrefix + szMessage );
+	m_Messages.push_back( { type, szPrefix + szMessage } );
 
-	m_pList->InsertItem( item );
-
-	Truncate();
+	//Drop the oldest messages without touching the control; it only needs the new count.
+	while( m_Messages.size() > m_uiMaxMessagesCount )
+	{
+		m_Messages.pop_front();
+	}
 
-	UpdateHeader();
+	if( !m_bInBatch || type == LogType::FATAL_ERROR )
+	{
+		UpdateList();
+	}
 
 	if( type == LogType::FATAL_ERROR )
 	{
@@ -125,19 +159,12 @@ void CMessagesWindow::AddMessage( const LogType type, const wxString& szMessage
 
 void CMessagesWindow::TruncateToCount( size_t uiCount )
 {
-	const size_t uiTotal = static_cast<size_t>( m_pList->GetItemCount() );
-
-	if( uiCount >= uiTotal )
+	if( uiCount >= m_Messages.size() )
 		return;
 
-	const size_t uiRemove = uiTotal - uiCount;
-
-	for( size_t uiIndex = 0; uiIndex < uiRemove; ++uiIndex )
-	{
-		m_pList->DeleteItem( 0 );
-	}
+	m_Messages.erase( m_Messages.begin(), m_Messages.begin() + ( m_Messages.size() - uiCount ) );
 
-	UpdateHeader();
+	UpdateList();
 }
 
 void CMessagesWindow::Truncate()
@@ -147,9 +174,9 @@ void CMessagesWindow::Truncate()
 
 void CMessagesWindow::Clear()
 {
-	m_pList->DeleteAllItems();
+	m_Messages.clear();
 
-	UpdateHeader();
+	UpdateList();
 }
 
 void CMessagesWindow::OnSize( wxSizeEvent& event )
@@ -223,8 +250,28 @@ void CMessagesWindow::UpdateHeader()
 {
 	wxListItem column;
 
-	column.SetText( wxString::Format( "Messages (%d)", m_pList->GetItemCount() ) );
+	column.SetText( wxString::Format( "Messages (%u)", static_cast<unsigned int>( m_Messages.size() ) ) );
 
 	m_pList->SetColumn( 0, column );
 }
+
+void CMessagesWindow::UpdateList()
+{
+	const long iCount = static_cast<long>( m_Messages.size() );
+
+	m_pList->SetItemCount( iCount );
+
+	if( iCount > 0 )
+	{
+		//Contents shift when old messages are dropped, so everything visible needs to be redrawn.
+		m_pList->RefreshItems( m_pList->GetTopItem(), iCount - 1 );
+		m_pList->EnsureVisible( iCount - 1 );
+	}
+	else
+	{
+		m_pList->Refresh();
+	}
+
+	UpdateHeader();
+}
 }
\ No newline at end of file
@@ -1,19 +1,32 @@
 #ifndef UI_CMESSAGESWINDOW_H
 #define UI_CMESSAGESWINDOW_H
 
+#include <deque>
+
 #include "ui/wx/wxInclude.h"
 
 #include <wx/listctrl.h>
 
 #include "shared/Logging.h"
 
-class wxListView;
 class IWindowCloseListener;
 
 namespace ui
 {
+class CMessagesListCtrl;
+
+/**
+*	A single message shown in the messages window.
+*/
+struct MessagesWindowEntry_t
+{
+	LogType type;
+	wxString szText;
+};
+
 /**
 *	A window that lists a number of log messages.
+*	The list is virtual: messages are stored here and the control only queries the visible ones.
 */
 class CMessagesWindow final : public wxFrame, public ILogListener
 {
@@ -26,6 +39,10 @@ public:
 		AddMessage( type, pszMessage );
 	}
 
+	void BeginLogBatch() override final;
+
+	void EndLogBatch() override final;
+
 	size_t GetMaxMessagesCount() const { return m_uiMaxMessagesCount; }
 
 	void SetMaxMessagesCount( const size_t uiMaxMessagesCount );
@@ -63,12 +80,22 @@ private:
 
 	void UpdateHeader();
 
+	/**
+	*	Updates the list control to match the stored messages.
+	*/
+	void UpdateList();
+
 private:
 	size_t m_uiMaxMessagesCount;
 
 	IWindowCloseListener* m_pWindowCloseListener;
 
-	wxListView* m_pList;
+	std::deque<MessagesWindowEntry_t> m_Messages;
+
+	//While in a batch, list updates are deferred until the batch ends.
+	bool m_bInBatch = false;
+
+	CMessagesListCtrl* m_pList;
 
 	wxTextCtrl* m_pCommand;
 
@@ -0,0 +1,124 @@
+#include <utility>
+
+#include <wx/app.h>
+#include <wx/image.h>
+
+#include "shared/Logging.h"
+
+#include "graphics/GraphicsUtils.h"
+
+#include "CwxImageWriter.h"
+
+namespace ui
+{
+CwxImageWriter::CwxImageWriter( const size_t uiMaxPending )
+	: m_uiMaxPending( uiMaxPending > 0 ? uiMaxPending : 1 )
+	, m_Worker( &CwxImageWriter::WorkerMain, this )
+{
+}
+
+CwxImageWriter::~CwxImageWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock( m_Mutex );
+
+		m_bShutdown = true;
+	}
+
+	m_JobAdded.notify_all();
+
+	m_Worker.join();
+}
+
+void CwxImageWriter::SetFailureHandler( FailureHandler_t handler )
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	m_FailureHandler = std::move( handler );
+}
+
+void CwxImageWriter::QueueImage( const wxString& szFilename, const int iWidth, const int iHeight, std::unique_ptr<byte[]>&& pixels,
+								 const wxBitmapType type, const bool bReportFailure )
+{
+	std::unique_lock<std::mutex> lock( m_Mutex );
+
+	m_JobFinished.wait( lock, [ this ] { return m_uiPending < m_uiMaxPending; } );
+
+	//Make a deep copy so the worker never shares string data with this thread.
+	m_Jobs.push_back( Job_t{ szFilename.Clone(), iWidth, iHeight, std::move( pixels ), type, bReportFailure } );
+
+	++m_uiPending;
+
+	lock.unlock();
+
+	m_JobAdded.notify_one();
+}
+
+size_t CwxImageWriter::WaitForPending()
+{
+	std::unique_lock<std::mutex> lock( m_Mutex );
+
+	m_JobFinished.wait( lock, [ this ] { return m_uiPending == 0; } );
+
+	const size_t uiFailed = m_uiFailed;
+
+	m_uiFailed = 0;
+
+	return uiFailed;
+}
+
+void CwxImageWriter::WorkerMain()
+{
+	std::unique_lock<std::mutex> lock( m_Mutex );
+
+	for( ;; )
+	{
+		m_JobAdded.wait( lock, [ this ] { return m_bShutdown || !m_Jobs.empty(); } );
+
+		//Finish pending work before shutting down.
+		if( m_Jobs.empty() )
+			break;
+
+		Job_t job = std::move( m_Jobs.front() );
+
+		m_Jobs.pop_front();
+
+		lock.unlock();
+
+		//We have to flip the image vertically, since OpenGL reads it upside down.
+		graphics::FlipImageVertically( job.iWidth, job.iHeight, job.pixels.get() );
+
+		//The image doesn't own the data; the job keeps it alive until saving is done.
+		wxImage image( job.iWidth, job.iHeight, job.pixels.get(), true );
+
+		const bool bSuccess = job.type == wxBITMAP_TYPE_ANY ? image.SaveFile( job.szFilename ) : image.SaveFile( job.szFilename, job.type );
+
+		if( !bSuccess )
+		{
+			Error( "Failed to save image \"%s\"\n", job.szFilename.ToStdString().c_str() );
+		}
+
+		lock.lock();
+
+		if( !bSuccess )
+		{
+			if( !job.bReportFailure )
+			{
+				++m_uiFailed;
+			}
+			else if( m_FailureHandler && wxTheApp )
+			{
+				//Message boxes and other UI can only be shown on the main thread.
+				wxTheApp->CallAfter( [ handler = m_FailureHandler, szFilename = std::move( job.szFilename ) ]()
+				{
+					handler( szFilename );
+				} );
+			}
+		}
+
+		--m_uiPending;
+
+		m_JobFinished.notify_all();
+	}
+}
+}
@@ -0,0 +1,109 @@
+#ifndef UI_WX_UTILITY_CWXIMAGEWRITER_H
+#define UI_WX_UTILITY_CWXIMAGEWRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "ui/wx/wxInclude.h"
+
+#include "shared/Const.h"
+
+namespace ui
+{
+/**
+*	Encodes and saves images on a worker thread.
+*	Images are 24 bit RGB as read from OpenGL; they are flipped vertically before being saved.
+*	The number of pending images is limited so capturing faster than images can be encoded doesn't exhaust memory.
+*/
+class CwxImageWriter final
+{
+public:
+	static const size_t DEFAULT_MAX_PENDING = 8;
+
+	/**
+	*	Called on the main thread when an image failed to save.
+	*/
+	typedef std::function<void( const wxString& szFilename )> FailureHandler_t;
+
+	/**
+	*	@param uiMaxPending Maximum number of images that can be waiting to be saved. QueueImage blocks when this is reached.
+	*/
+	CwxImageWriter( const size_t uiMaxPending = DEFAULT_MAX_PENDING );
+
+	/**
+	*	Saves all pending images before returning.
+	*/
+	~CwxImageWriter();
+
+	/**
+	*	Sets the handler that is called when an image failed to save. Must not be called while images are pending.
+	*/
+	void SetFailureHandler( FailureHandler_t handler );
+
+	/**
+	*	Queues an image to be saved.
+	*	@param szFilename Name of the file to save to.
+	*	@param iWidth Image width, in pixels.
+	*	@param iHeight Image height, in pixels.
+	*	@param pixels RGB pixel data, bottom row first. The writer takes ownership.
+	*	@param type Image format. If wxBITMAP_TYPE_ANY, the format is determined from the file extension.
+	*	@param bReportFailure Whether to call the failure handler if the image fails to save.
+	*		If false, the failure is counted instead; see WaitForPending.
+	*/
+	void QueueImage( const wxString& szFilename, const int iWidth, const int iHeight, std::unique_ptr<byte[]>&& pixels,
+					 const wxBitmapType type = wxBITMAP_TYPE_ANY, const bool bReportFailure = true );
+
+	/**
+	*	Blocks until all queued images have been saved.
+	*	@return Number of images queued without failure reporting that failed to save since the last call.
+	*/
+	size_t WaitForPending();
+
+private:
+	struct Job_t
+	{
+		wxString szFilename;
+		int iWidth;
+		int iHeight;
+		std::unique_ptr<byte[]> pixels;
+		wxBitmapType type;
+		bool bReportFailure;
+	};
+
+	void WorkerMain();
+
+private:
+	const size_t m_uiMaxPending;
+
+	FailureHandler_t m_FailureHandler;
+
+	std::mutex m_Mutex;
+
+	//Signaled when a job is added or shutdown is requested.
+	std::condition_variable m_JobAdded;
+
+	//Signaled when a job has finished.
+	std::condition_variable m_JobFinished;
+
+	std::deque<Job_t> m_Jobs;
+
+	//Number of jobs that have been queued but not finished, including the one being written.
+	size_t m_uiPending = 0;
+
+	size_t m_uiFailed = 0;
+
+	bool m_bShutdown = false;
+
+	std::thread m_Worker;
+
+private:
+	CwxImageWriter( const CwxImageWriter& ) = delete;
+	CwxImageWriter& operator=( const CwxImageWriter& ) = delete;
+};
+}
+
+#endif //UI_WX_UTILITY_CWXIMAGEWRITER_H